@@ -0,0 +1,196 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+bool is_size_valid(const XMLB::u8Node& node)
+{
+	std::size_t size = 0;
+
+	for (auto it = node.first_level_cbegin(); it != node.first_level_cend();
+		++it)
+	{
+		if (!is_size_valid(**it))
+		{
+			return false;
+		}
+
+		size += (*it)->size() + 1;
+	}
+
+	return node.size() == size;
+}
+
+//-----------------------------------------------------------------------------
+
+XMLB::u8Node generate(std::mt19937& random, int depth)
+{
+	XMLB::u8Node node{ "n" + std::to_string(random() % 10) };
+
+	if (random() % 3 == 0)
+	{
+		node.set_value("v" + std::to_string(random() % 100));
+	}
+
+	for (int i = depth > 4 ? 0 : random() % 4; i > 0; --i)
+	{
+		node.add_child(generate(random, depth + 1));
+	}
+
+	return node;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Copies, moves and pointers give the same tree as add_child
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 26 };
+
+	for (int round = 0; round < 20; ++round)
+	{
+		std::vector<XMLB::u8Node> sources;
+
+		for (int i = random() % 20; i > 0; --i)
+		{
+			sources.push_back(generate(random, 0));
+		}
+
+		// Children go under a deep node so that every ancestor is updated
+		auto make_doc = []()
+		{
+			XMLB::u8Document doc;
+			doc.root(XMLB::u8Node{ "r" });
+			doc.root().add_child(XMLB::u8Node{ "a" }).add_child(
+				XMLB::u8Node{ "b" });
+			doc.root().add_child(XMLB::u8Node{ "tail" });
+
+			return doc;
+		};
+
+		auto target = [](XMLB::u8Document& doc) -> XMLB::u8Node&
+		{
+			return **(*doc.root().first_level_begin())->first_level_begin();
+		};
+
+		XMLB::u8Document expected = make_doc();
+
+		for (const auto& source : sources)
+		{
+			target(expected).add_child(source);
+		}
+
+		const std::string expected_text = XMLB::save_to_string(expected);
+		const std::string message = " of round " + std::to_string(round);
+
+		XMLB::u8Document copied = make_doc();
+		target(copied).add_children(sources.begin(), sources.end());
+
+		check(XMLB::save_to_string(copied) == expected_text &&
+			is_size_valid(copied.root()) &&
+			copied.size() == expected.size(), "copied children" + message);
+
+		std::vector<XMLB::u8Node::Ptr> pointers;
+
+		for (const auto& source : sources)
+		{
+			pointers.push_back(std::make_unique<XMLB::u8Node>(source));
+			pointers.push_back(nullptr);
+		}
+
+		XMLB::u8Document owned = make_doc();
+		target(owned).add_children(pointers.begin(), pointers.end());
+
+		check(XMLB::save_to_string(owned) == expected_text &&
+			is_size_valid(owned.root()), "owned children" + message);
+
+		auto moved_sources = sources;
+
+		XMLB::u8Document moved = make_doc();
+		target(moved).add_children(std::make_move_iterator(
+			moved_sources.begin()), std::make_move_iterator(
+			moved_sources.end()));
+
+		check(XMLB::save_to_string(moved) == expected_text &&
+			is_size_valid(moved.root()), "moved children" + message);
+
+		//---------------------------------------------------------------------
+		// CHECK 2. Copies and loaded documents are linked with right sizes
+		//---------------------------------------------------------------------
+
+		XMLB::u8Node copy{ expected.root() };
+
+		check(is_size_valid(copy) && copy.size() == expected.root().size(),
+			"copied node" + message);
+
+		auto loaded = XMLB::load_from(expected_text.begin(),
+			expected_text.end());
+
+		check(loaded && is_size_valid(loaded->root()) &&
+			loaded->size() == expected.size(), "loaded document" + message);
+
+		XMLB::u8Buffer_sink sink;
+		XMLB::save_binary(expected, sink);
+
+		auto binary = XMLB::load_binary(std::string(sink.data(), sink.size()));
+
+		check(binary && is_size_valid(binary->root()),
+			"binary snapshot" + message);
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Children added before a failed one stay counted
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document indexed;
+	indexed.root(XMLB::u8Node{ "r" });
+	indexed.root().add_child(XMLB::u8Node{ "c" }).set_attribute("id", "1");
+	indexed.create_attribute_index("id", true);
+
+	std::vector<XMLB::u8Node> children(3, XMLB::u8Node{ "c" });
+	children[0].set_attribute("id", "2");
+	children[1].set_attribute("id", "1");
+	children[2].set_attribute("id", "3");
+
+	bool is_thrown = false;
+
+	try
+	{
+		indexed.root().add_children(children.begin(), children.end());
+	}
+	catch (const std::invalid_argument&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "duplicate of unique attribute");
+	check(indexed.root().child_size() == 2 && indexed.size() == 3 &&
+		is_size_valid(indexed.root()), "sizes after failure");
+	check(indexed.find_by_attribute("id", "2") != indexed.end() &&
+		indexed.find_by_attribute("id", "3") == indexed.end(),
+		"index after failure");
+
+	return errors ? 1 : 0;
+}
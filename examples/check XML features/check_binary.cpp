@@ -0,0 +1,194 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+template<typename CharT>
+std::string save_binary(const XMLB::Document<CharT>& doc)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_binary(doc, sink);
+
+	return std::string(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename CharT>
+bool is_round_trip(const XMLB::Document<CharT>& doc)
+{
+	auto loaded = XMLB::load_binary<CharT>(save_binary(doc));
+
+	return loaded && loaded->size() == doc.size() &&
+		XMLB::save_to_string(*loaded) == XMLB::save_to_string(doc);
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Round trip of parsed, built and empty documents
+	//-------------------------------------------------------------------------
+
+	std::string xml
+	{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<root a=\"1\" b=\"x&amp;y\">\n"
+		"\t<item id=\"1\">hello</item>\n"
+		"\t<item id=\"2\">\n"
+		"\t\t<sub>v</sub>\n"
+		"\t\t<sub/>\n"
+		"\t</item>\n"
+		"\t<empty/>\n"
+		"</root>\n"
+	};
+
+	auto doc = XMLB::load_from(xml.begin(), xml.end());
+	doc->root().add_child(XMLB::u8Node{ "num" }).set_value(42.5);
+
+	const std::string binary = save_binary(*doc);
+	auto loaded = XMLB::load_binary(binary);
+
+	check(is_round_trip(*doc), "parsed document");
+	check(loaded && loaded->find("num")->get_value_as<double>() == 42.5,
+		"typed value");
+
+	loaded->create_attribute_index("id");
+
+	check(loaded->find_by_attribute("id", "2")->get_name() == "item",
+		"index of loaded document");
+
+	XMLB::u8Document empty_doc;
+	auto empty_loaded = XMLB::load_binary(save_binary(empty_doc));
+
+	check(empty_loaded && empty_loaded->is_empty(), "empty document");
+
+	std::wstring wide_xml{ L"<r x=\"Ж\"><a>б</a><a>б</a></r>" };
+	auto wide_doc = XMLB::load_from(wide_xml.begin(), wide_xml.end());
+
+	check(is_round_trip(*wide_doc), "wchar_t document");
+
+	std::u16string u16_xml{ u"<r x=\"y\"><a>b</a></r>" };
+	auto u16_doc = XMLB::load_from(u16_xml.begin(), u16_xml.end());
+
+	check(is_round_trip(*u16_doc), "char16_t document");
+
+	std::mt19937 random{ 50 };
+
+	for (int round = 0; round < 20; ++round)
+	{
+		XMLB::u8Document random_doc;
+		random_doc.root(XMLB::u8Node{ "root" });
+
+		std::vector<XMLB::u8Node*> nodes{ &random_doc.root() };
+
+		for (int i = random() % 500; i > 0; --i)
+		{
+			XMLB::u8Node node{ "n" + std::to_string(random() % 20) };
+
+			if (random() % 3 == 0)
+			{
+				node.add_attribute(XMLB::u8Node_attribute{ "k",
+					std::to_string(random() % 100) });
+			}
+
+			if (random() % 3 == 0)
+			{
+				node.set_value(static_cast<int>(random() % 1000) - 500);
+			}
+			else if (random() % 2)
+			{
+				node.set_value("v" + std::to_string(i));
+			}
+
+			nodes.push_back(&nodes[random() % nodes.size()]->add_child(
+				std::move(node)));
+		}
+
+		check(is_round_trip(random_doc), "random document " +
+			std::to_string(round));
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Truncated snapshots are rejected, damaged ones are safe
+	//-------------------------------------------------------------------------
+
+	for (std::size_t size = 0; size < binary.size(); ++size)
+	{
+		check(!XMLB::load_binary(std::string_view(binary.data(), size)),
+			"snapshot truncated to " + std::to_string(size) + " bytes");
+	}
+
+	check(!XMLB::load_binary<wchar_t>(binary), "other symbol type");
+
+	// A damaged snapshot is either rejected or loaded as some document,
+	// but never read past its end
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::string damaged = binary;
+		damaged[random() % damaged.size()] ^= static_cast<char>(
+			1 << (random() % 8));
+
+		auto damaged_doc = XMLB::load_binary(damaged);
+
+		if (damaged_doc)
+		{
+			XMLB::save_to_string(*damaged_doc);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Snapshot files
+	//-------------------------------------------------------------------------
+
+	const std::string file_name{ "check_binary.bin" };
+
+	{
+		std::ofstream out_file{ file_name, std::ios::binary };
+		out_file.write(binary.data(),
+			static_cast<std::streamsize>(binary.size()));
+	}
+
+	auto file_doc = XMLB::load_binary_file(file_name);
+
+	check(file_doc && XMLB::save_to_string(*file_doc) ==
+		XMLB::save_to_string(*doc), "snapshot file");
+
+	file_doc.reset();
+	std::remove(file_name.c_str());
+
+	bool is_thrown = false;
+
+	try
+	{
+		(void)XMLB::load_binary_file(file_name);
+	}
+	catch (const std::system_error&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "missing file");
+
+	return errors ? 1 : 0;
+}
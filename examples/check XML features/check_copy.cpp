@@ -0,0 +1,165 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+std::string dump(const XMLB::u8Document& doc)
+{
+	std::string result;
+
+	for (auto it = doc.cbegin(); it != doc.cend(); ++it)
+	{
+		result += std::string{ it->get_name() } + "=" +
+			std::string{ it->get_value() } + ";";
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	XMLB::u8Document original;
+
+	{
+		XMLB::u8Node root{ "catalog" };
+
+		for (int i = 0; i < 50; ++i)
+		{
+			XMLB::u8Node book{ "book", std::to_string(i) };
+
+			book.add_attribute(XMLB::u8Node_attribute{ "id",
+				std::to_string(i) });
+			book.add_child(XMLB::u8Node{ "title", "t" + std::to_string(i) });
+
+			root.add_child(std::move(book));
+		}
+
+		original.root(std::move(root));
+	}
+
+	original.create_attribute_index("id");
+	original.create_name_index();
+
+	const std::string original_dump = dump(original);
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Changes of a copy do not reach the original and back
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document copy{ original };
+
+	check(dump(copy) == original_dump, "copy has the same content");
+	check(copy.has_attribute_index("id") && copy.has_name_index(),
+		"copy has the same indexes");
+
+	copy.find_by_attribute("id", "7")->set_value("changed");
+	copy.root().add_child(XMLB::u8Node{ "x" }).add_attribute(
+		XMLB::u8Node_attribute{ "id", "new" });
+
+	check(dump(original) == original_dump, "original is kept");
+	check(copy.find_by_attribute("id", "7")->get_value() == "changed",
+		"copy is changed");
+	check(copy.find_by_attribute("id", "new") != copy.end() &&
+		original.find_by_attribute("id", "new") == original.end(),
+		"indexes are not shared");
+
+	XMLB::u8Document second_copy{ original };
+
+	original.find("book")->set_value("changed");
+	original.root().set_value("changed");
+
+	check(dump(second_copy) == original_dump, "copy is kept");
+
+	second_copy.clear();
+
+	check(second_copy.is_empty() && !original.is_empty(),
+		"clear of a copy");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Assignment, move and node copies
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document assigned;
+	assigned = copy;
+
+	XMLB::u8Document moved{ std::move(assigned) };
+
+	check(dump(moved) == dump(copy), "assigned and moved copy");
+
+	moved.find("title")->set_value("changed");
+
+	check(std::as_const(copy).find("title")->get_value() == "t0",
+		"assigned copy is independent");
+
+	XMLB::u8Node node_copy{ *copy.find_by_attribute("id", "3") };
+
+	node_copy.set_value("changed");
+	node_copy.begin()->set_value("changed");
+
+	check(copy.find_by_attribute("id", "3")->get_value() == "3" &&
+		copy.find_by_attribute("id", "3")->begin()->get_value() == "t3",
+		"node copy is independent");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Copies of a shared template in several threads
+	//-------------------------------------------------------------------------
+
+	const XMLB::u8Document& template_doc = copy;
+	const std::string template_dump = dump(template_doc);
+
+	std::vector<std::thread> threads;
+	std::vector<int> thread_errors(4, 0);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&template_doc, &thread_errors, i]
+			{
+				for (int k = 0; k < 50; ++k)
+				{
+					XMLB::u8Document response{ template_doc };
+					const std::string id = std::to_string(k);
+
+					response.find_by_attribute("id", id)->set_value(
+						std::to_string(i));
+
+					if (response.find_by_attribute("id", id)->get_value() !=
+						std::to_string(i))
+					{
+						++thread_errors[i];
+					}
+				}
+			});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		check(!thread_errors[i], "copy in thread " + std::to_string(i));
+	}
+
+	check(dump(template_doc) == template_dump, "template is kept");
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+// Version k has k children, each with value k
+XMLB::u8Document make_version(int version)
+{
+	XMLB::u8Document doc;
+	doc.root(XMLB::u8Node{ "r" });
+	doc.root().set_attribute("v", std::to_string(version));
+
+	for (int i = 0; i < version; ++i)
+	{
+		doc.root().add_child(XMLB::u8Node{ "c", std::to_string(version) });
+	}
+
+	return doc;
+}
+
+//-----------------------------------------------------------------------------
+
+// Version of the snapshot, or -1 if its nodes do not belong to one version
+int read_version(const XMLB::u8Frozen_document& snapshot)
+{
+	const auto& root = snapshot.root();
+	const auto attribute = root.find_attribute("v");
+
+	if (attribute == root.attr_end())
+	{
+		return -1;
+	}
+
+	const std::string value{ attribute->value };
+	const int version = std::stoi(value);
+
+	if (root.child_size() != static_cast<std::size_t>(version))
+	{
+		return -1;
+	}
+
+	for (auto it = root.first_level_begin(); it != root.first_level_end();
+		++it)
+	{
+		if (it->get_value() != value)
+		{
+			return -1;
+		}
+	}
+
+	return version;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Store returns the previous version
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document_holder empty_holder;
+
+	check(!empty_holder.load(), "empty holder");
+	check(!empty_holder.store(make_version(1)) &&
+		read_version(*empty_holder.load()) == 1, "first version");
+
+	XMLB::u8Document_holder holder{ make_version(2).freeze() };
+
+	check(read_version(*holder.load()) == 2, "initial snapshot");
+
+	auto previous = holder.store(make_version(3));
+
+	check(previous && read_version(*previous) == 2 &&
+		read_version(*holder.load()) == 3, "previous version");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Old snapshots live while readers hold them
+	//-------------------------------------------------------------------------
+
+	auto reader_snapshot = holder.load();
+	std::weak_ptr<const XMLB::u8Frozen_document> watcher = reader_snapshot;
+
+	holder.store(make_version(4).freeze());
+
+	check(read_version(*reader_snapshot) == 3 && !watcher.expired(),
+		"snapshot held by reader");
+
+	reader_snapshot.reset();
+
+	check(watcher.expired(), "snapshot released by last reader");
+	check(holder.store(nullptr) && !holder.load(), "holder cleared");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Readers on other threads see whole versions in order
+	//-------------------------------------------------------------------------
+
+	const int version_count = 300;
+
+	holder.store(make_version(0));
+
+	std::atomic<bool> is_done{ false };
+	std::vector<std::thread> readers;
+	std::vector<int> reader_errors(6);
+	std::vector<int> last_versions(reader_errors.size());
+
+	for (std::size_t i = 0; i < reader_errors.size(); ++i)
+	{
+		readers.emplace_back([&holder, &is_done, &reader_errors,
+			&last_versions, i]
+			{
+				int last_version = 0;
+
+				while (true)
+				{
+					const bool is_last_pass = is_done.load();
+					const auto snapshot = holder.load();
+					const int version = read_version(*snapshot);
+
+					// Versions are whole and never go back
+					if (version < last_version)
+					{
+						++reader_errors[i];
+					}
+
+					last_version = version;
+
+					if (is_last_pass)
+					{
+						break;
+					}
+				}
+
+				last_versions[i] = last_version;
+			});
+	}
+
+	for (int version = 1; version <= version_count; ++version)
+	{
+		// The previous version is released here or by the last reader
+		holder.store(make_version(version));
+	}
+
+	is_done = true;
+
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	for (std::size_t i = 0; i < readers.size(); ++i)
+	{
+		const std::string message = " of reader " + std::to_string(i);
+
+		check(!reader_errors[i], "versions" + message);
+		check(last_versions[i] == version_count, "last version" + message);
+	}
+
+	return errors ? 1 : 0;
+}
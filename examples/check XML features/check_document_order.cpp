@@ -0,0 +1,207 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 8 ? 0 : random() % 4;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ "n" };
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+bool is_ancestor_plain(const XMLB::u8Node& ancestor, const XMLB::u8Node& node)
+{
+	for (auto current = node.get_parent(); current;
+		current = current->get_parent())
+	{
+		if (current == &ancestor)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+
+int sign(int value)
+{
+	return value < 0 ? -1 : value > 0 ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	std::mt19937 random{ 35 };
+
+	// Answers of the document are compared with parent chains and positions
+	// in a plain walk. Const methods go first, so they also run while the
+	// order numbers are stale
+	auto check_order = [&](XMLB::u8Document& doc, const std::string& message)
+	{
+		std::vector<XMLB::u8Node*> nodes;
+
+		for (auto& node : doc)
+		{
+			nodes.push_back(&node);
+		}
+
+		check(nodes.size() == doc.size(), "walk of " + message);
+
+		std::vector<std::pair<std::size_t, std::size_t>> pairs;
+
+		for (int i = 0; i < 3000; ++i)
+		{
+			const std::size_t lhs = random() % nodes.size();
+
+			pairs.emplace_back(lhs, i % 10 ? random() % nodes.size() : lhs);
+		}
+
+		int ancestor_errors = 0;
+		int order_errors = 0;
+		int skip_errors = 0;
+
+		auto check_pairs = [&](auto& checked_doc)
+		{
+			for (const auto& [lhs, rhs] : pairs)
+			{
+				const auto& lhs_node = *nodes[lhs];
+				const auto& rhs_node = *nodes[rhs];
+				const int order = lhs < rhs ? -1 : lhs > rhs ? 1 : 0;
+
+				ancestor_errors += checked_doc.is_ancestor_of(lhs_node,
+					rhs_node) != is_ancestor_plain(lhs_node, rhs_node) ? 1 : 0;
+				order_errors += sign(checked_doc.compare_document_order(
+					lhs_node, rhs_node)) != order ? 1 : 0;
+
+				auto it = std::next(checked_doc.begin(), lhs);
+
+				skip_errors += checked_doc.skip_subtree(it) !=
+					std::next(it, lhs_node.size() + 1) ? 1 : 0;
+			}
+		};
+
+		check_pairs(std::as_const(doc));
+		check_pairs(doc);
+
+		check(!ancestor_errors, "is_ancestor_of " + message);
+		check(!order_errors, "compare_document_order " + message);
+		check(!skip_errors, "skip_subtree " + message);
+	};
+
+	for (int round = 0; round < 5; ++round)
+	{
+		const std::string round_message = " in round " +
+			std::to_string(round);
+
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 2000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		//---------------------------------------------------------------------
+		// CHECK 1. Built and copied documents
+		//---------------------------------------------------------------------
+
+		check_order(doc, "of built document" + round_message);
+
+		XMLB::u8Document copy{ doc };
+
+		check_order(copy, "of copy" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 2. Appends to the end and erases keep the answers right
+		//---------------------------------------------------------------------
+
+		for (int i = 0; i < 20; ++i)
+		{
+			auto last = std::prev(doc.end());
+
+			last->add_child(XMLB::u8Node{ "tail" });
+			doc.root().add_child(XMLB::u8Node{ "tail" });
+
+			auto& parent = *std::next(doc.begin(), random() % doc.size());
+
+			if (parent.child_size())
+			{
+				parent.erase_child(std::size_t{ 0 });
+			}
+		}
+
+		check_order(doc, "after appends and erases" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 3. Inserts in the middle and moves of subtrees
+		//---------------------------------------------------------------------
+
+		for (int i = 0; i < 20; ++i)
+		{
+			auto& parent = *std::next(doc.begin(), random() %
+				(doc.size() / 2));
+
+			parent.add_child(XMLB::u8Node{ "middle" }).add_child(
+				XMLB::u8Node{ "middle" });
+		}
+
+		check_order(doc, "after inserts" + round_message);
+
+		for (int i = 0; i < 20; ++i)
+		{
+			auto& lhs = *std::next(doc.begin(), 1 + random() %
+				(doc.size() - 1));
+			auto& rhs = *std::next(doc.begin(), 1 + random() %
+				(doc.size() - 1));
+
+			if (&lhs != &rhs && !is_ancestor_plain(lhs, rhs) &&
+				!is_ancestor_plain(rhs, lhs))
+			{
+				lhs.swap_subtrees(rhs);
+			}
+
+			auto& moved = *std::next(doc.begin(), 1 + random() %
+				(doc.size() - 1));
+			auto& target = *std::next(doc.begin(), random() % doc.size());
+
+			if (&moved != &target && !is_ancestor_plain(moved, target))
+			{
+				target.splice(target.first_level_cbegin(), moved);
+			}
+		}
+
+		check_order(doc, "after moves" + round_message);
+	}
+
+	return errors ? 1 : 0;
+}
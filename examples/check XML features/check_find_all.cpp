@@ -0,0 +1,203 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 7 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ std::string(1, "abcd"[random() % 4]) };
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Descendants of node that end the path, found without find_all. The first
+// names of the path are matched greedily along the ancestors
+void collect(const XMLB::u8Node& node, const std::vector<std::string>& path,
+	std::size_t matched, std::vector<const XMLB::u8Node*>& result)
+{
+	for (auto it = node.first_level_cbegin(); it != node.first_level_cend();
+		++it)
+	{
+		const XMLB::u8Node& child = **it;
+
+		if (matched + 1 == path.size() && child.get_name() == path.back())
+		{
+			result.push_back(&child);
+		}
+
+		const bool is_next = matched + 1 < path.size() &&
+			child.get_name() == path[matched];
+
+		collect(child, path, matched + (is_next ? 1 : 0), result);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename RangeT>
+std::vector<const XMLB::u8Node*> to_vector(const RangeT& range)
+{
+	std::vector<const XMLB::u8Node*> result;
+
+	for (const auto& node : range)
+	{
+		result.push_back(&node);
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Every match is found once, in document order
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 32 };
+
+	const std::vector<std::vector<std::string>> paths
+	{
+		{ "a" }, { "d" }, { "a", "b" }, { "b", "b" }, { "a", "a", "a" },
+		{ "c", "d", "a", "b" }, { "x" }, { "a", "x" }
+	};
+
+	for (int round = 0; round < 10; ++round)
+	{
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "a" });
+
+		for (int budget = 3000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		auto& node = *std::next(doc.begin(), random() % 50);
+
+		for (const auto& path : paths)
+		{
+			const std::string message = "path of " +
+				std::to_string(path.size()) + " names from " + path[0] +
+				" in round " + std::to_string(round);
+
+			std::vector<const XMLB::u8Node*> expected;
+			collect(doc.root(), path, 0, expected);
+
+			check(to_vector(doc.find_all(path)) == expected &&
+				to_vector(std::as_const(doc).find_all(path)) == expected,
+				"document " + message);
+
+			std::vector<const XMLB::u8Node*> node_expected;
+			collect(node, path, 0, node_expected);
+
+			check(to_vector(node.find_all(path)) == node_expected &&
+				to_vector(std::as_const(node).find_all(path)) ==
+				node_expected, "node " + message);
+
+			if (path.size() == 1)
+			{
+				check(to_vector(doc.find_all(path[0])) == expected,
+					"single name " + message);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Iteration resumes where the previous match ended
+	//-------------------------------------------------------------------------
+
+	const std::string xml
+	{
+		"<r>"
+			"<a><a><b/></a><b><a/></b></a>"
+			"<c><a/></c>"
+			"<a/>"
+		"</r>"
+	};
+
+	auto doc = XMLB::load_from(xml.begin(), xml.end());
+	auto range = doc->find_all("a");
+
+	std::vector<const XMLB::u8Node*> expected;
+	collect(doc->root(), { "a" }, 0, expected);
+
+	check(expected.size() == 5, "matches of the fixed document");
+
+	std::vector<const XMLB::u8Node*> resumed;
+
+	// Iterators are copied mid-range and each copy goes on independently
+	for (auto it = range.begin(); it != range.end(); ++it)
+	{
+		auto copy = it;
+
+		resumed.push_back(&*copy++);
+
+		check(copy == range.end() || &*copy != &*it, "copy goes on");
+	}
+
+	check(resumed == expected, "resumed iteration");
+
+	auto first = range.begin();
+	auto second = std::next(first, 2);
+
+	check(std::distance(second, range.end()) == 3 &&
+		std::distance(range.begin(), range.end()) == 5, "restarted ranges");
+
+	// Nodes found by the range can be changed while iterating
+	for (auto& node : doc->find_all("b"))
+	{
+		node.set_value("found");
+	}
+
+	std::size_t found_count = 0;
+
+	for (const auto& node : std::as_const(*doc).find_all("b"))
+	{
+		found_count += node.get_value() == "found" ? 1 : 0;
+	}
+
+	check(found_count == 2, "values of found nodes");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Empty ranges
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document empty_doc;
+
+	check(empty_doc.find_all("a").begin() == empty_doc.find_all("a").end(),
+		"empty document");
+
+	XMLB::u8Node leaf{ "a" };
+
+	check(leaf.find_all("a").begin() == leaf.find_all("a").end(),
+		"node is not its own descendant");
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 7 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ std::string(1, "abcdefgh"[random() % 8]) };
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<const XMLB::u8Node*> find_plain(const XMLB::u8Node& node,
+	const std::vector<std::string>& names)
+{
+	std::vector<const XMLB::u8Node*> result;
+
+	for (const auto& current : node)
+	{
+		if (std::find(names.begin(), names.end(), current.get_name()) !=
+			names.end())
+		{
+			result.push_back(&current);
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename DocT>
+std::vector<const XMLB::u8Node*> find_every(DocT& doc,
+	const std::vector<std::string>& names)
+{
+	std::vector<const XMLB::u8Node*> result;
+
+	for (auto it = doc.find_any(names); it != doc.end();
+		it = doc.find_any(names, std::next(it)))
+	{
+		result.push_back(&*it);
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	const std::vector<std::vector<std::string>> name_lists
+	{
+		{ "a" }, { "b", "d" }, { "h", "c", "h" }, { "a", "b", "c", "d",
+		"e", "f", "g", "h" }, { "x", "c" }, { "x" }, {}
+	};
+
+	std::mt19937 random{ 33 };
+
+	for (int round = 0; round < 10; ++round)
+	{
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 3000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		auto check_names = [&](const std::string& message)
+		{
+			for (const auto& names : name_lists)
+			{
+				const auto expected = find_plain(doc.root(), names);
+				const std::string names_message = message + " for " +
+					std::to_string(names.size()) + " names in round " +
+					std::to_string(round);
+
+				check(find_every(doc, names) == expected, names_message);
+				check(find_every(std::as_const(doc), names) == expected,
+					"const " + names_message);
+			}
+		};
+
+		//---------------------------------------------------------------------
+		// CHECK 1. Every node with any of the names is found in order
+		//---------------------------------------------------------------------
+
+		check_names("without index");
+
+		auto& node = *std::next(doc.begin(), random() % 100);
+		const std::vector<std::string> node_names{ "a", "e" };
+
+		check(find_every(node, node_names) == find_plain(node, node_names),
+			"node without index in round " + std::to_string(round));
+		check(node.find_any(node_names, doc.cbegin()) ==
+			node.find_any(node_names), "offset outside of node");
+
+		//---------------------------------------------------------------------
+		// CHECK 2. Name index gives the same nodes
+		//---------------------------------------------------------------------
+
+		doc.create_name_index();
+
+		check_names("with index");
+		check(find_every(node, node_names) == find_plain(node, node_names),
+			"node with index in round " + std::to_string(round));
+
+		//---------------------------------------------------------------------
+		// CHECK 3. Index follows renames and inserts in the middle
+		//---------------------------------------------------------------------
+
+		for (int i = 0; i < 100; ++i)
+		{
+			auto& renamed = *std::next(doc.begin(), random() % doc.size());
+
+			renamed.set_name(std::string(1, "abcdefgh"[random() % 8]));
+
+			if (i % 10 == 0)
+			{
+				auto& parent = *std::next(doc.begin(), random() %
+					(doc.size() / 2));
+
+				parent.add_child(XMLB::u8Node{ "c" }).add_child(
+					XMLB::u8Node{ "a" });
+			}
+		}
+
+		check_names("after changes");
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <string_view>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	const std::string xml
+	{
+		"<r>"
+			"<other>"
+				"<config><db><host>nested</host></db></config>"
+			"</other>"
+			"<config>"
+				"<cache><host>cache</host></cache>"
+				"<db><port>1</port></db>"
+				"<db><host>second</host></db>"
+			"</config>"
+			"<db><host>top</host></db>"
+			"<config><db><host>late</host></db></config>"
+		"</r>"
+	};
+
+	auto doc = XMLB::load_from(xml.begin(), xml.end());
+	const auto& const_doc = *doc;
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Each name is looked up among children of the previous match
+	//-------------------------------------------------------------------------
+
+	auto port = doc->find_child_path({ "config", "db", "port" });
+
+	check(port != doc->end() && port->get_value() == "1", "path from root");
+
+	auto db = doc->find_child_path({ "config", "db" });
+
+	check(db != doc->end() && db->get_parent() &&
+		db->get_parent()->get_parent() == &doc->root(),
+		"first config and its first db");
+
+	auto top_host = doc->find_child_path({ "db", "host" });
+
+	check(top_host != doc->end() && top_host->get_value() == "top",
+		"child of root");
+
+	auto& config = *doc->find_child_path({ "config" });
+	auto cache_host = config.find_child_path({ "cache", "host" });
+
+	check(cache_host != config.end() && cache_host->get_value() == "cache",
+		"path from node");
+
+	const std::vector<std::string> path{ "db", "host" };
+	auto const_host = const_doc.find_child_path(path);
+
+	check(const_host != const_doc.cend() && const_host->get_value() == "top",
+		"const document and vector of names");
+
+	auto const_port = std::as_const(config).find_child_path(
+		std::vector<std::string_view>{ "db", "port" });
+
+	check(const_port != std::as_const(config).end() &&
+		const_port->get_value() == "1", "const node and views");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Nodes at other depths are not matched
+	//-------------------------------------------------------------------------
+
+	check(doc->find_child_path({ "host" }) == doc->end() &&
+		doc->find("host") != doc->end(), "grandchild is not a child");
+	check(doc->find_child_path({ "config", "host" }) == doc->end(),
+		"host under cache is not a child of config");
+	check(config.find_child_path({ "config" }) == config.end(),
+		"node is not its own child");
+	check(doc->find_child_path({ "other", "db" }) == doc->end(),
+		"level is not skipped");
+
+	auto nested = doc->find_child_path({ "other", "config", "db", "host" });
+
+	check(nested != doc->end() && nested->get_value() == "nested",
+		"same names deeper");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Empty and missing paths
+	//-------------------------------------------------------------------------
+
+	check(doc->find_child_path(std::vector<std::string>{}) == doc->end(),
+		"empty path");
+	check(doc->find_child_path({ "config", "missing" }) == doc->end(),
+		"missing name");
+	check(config.find_child_path({ "db", "port", "x" }) == config.end(),
+		"path longer than tree");
+
+	XMLB::u8Document empty_doc;
+
+	check(empty_doc.find_child_path({ "r" }) == empty_doc.end(),
+		"empty document");
+
+	return errors ? 1 : 0;
+}
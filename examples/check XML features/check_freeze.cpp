@@ -0,0 +1,316 @@
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+std::string random_name(std::mt19937& random)
+{
+	return "n" + std::to_string(random() % 30);
+}
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 7 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ random_name(random) };
+
+		if (random() % 3 == 0)
+		{
+			child.set_value("v" + std::to_string(budget));
+		}
+
+		for (int j = random() % 3; j > 0; --j)
+		{
+			child.set_attribute("a" + std::to_string(j),
+				std::to_string(random() % 100));
+		}
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Positions of nodes in document order, the same in both documents
+using Positions = std::unordered_map<const XMLB::u8Node*, std::ptrdiff_t>;
+
+//-----------------------------------------------------------------------------
+
+bool is_same_node(const XMLB::u8Node& node,
+	const XMLB::Frozen_node<char>& frozen, const Positions& positions,
+	const XMLB::Frozen_node<char>* frozen_first)
+{
+	if (node.get_name() != frozen.get_name() ||
+		node.get_value() != frozen.get_value() ||
+		node.size() != frozen.size() ||
+		node.child_size() != frozen.child_size() ||
+		node.attr_size() != frozen.attr_size())
+	{
+		return false;
+	}
+
+	const auto parent = node.get_parent();
+	const auto frozen_parent = frozen.get_parent();
+
+	if (frozen_parent ? !positions.count(parent) ||
+		positions.at(parent) != frozen_parent - frozen_first :
+		positions.count(parent))
+	{
+		return false;
+	}
+
+	auto attribute = node.attr_cbegin();
+
+	for (auto first = frozen.attr_begin(); first != frozen.attr_end();
+		++first, ++attribute)
+	{
+		if (first->name != attribute->name ||
+			first->value != attribute->value ||
+			frozen.find_attribute(first->name) == frozen.attr_end())
+		{
+			return false;
+		}
+	}
+
+	auto child = node.first_level_cbegin();
+
+	for (auto first = frozen.first_level_begin();
+		first != frozen.first_level_end(); ++first, ++child)
+	{
+		if (positions.at(child->get()) != &*first - frozen_first)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	std::mt19937 random{ 37 };
+
+	for (int round = 0; round < 5; ++round)
+	{
+		const std::string round_message = " in round " +
+			std::to_string(round);
+
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 3000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		//---------------------------------------------------------------------
+		// CHECK 1. Frozen copy has the same nodes in the same order
+		//---------------------------------------------------------------------
+
+		auto frozen = doc.freeze();
+
+		check(frozen->size() == doc.size() && !frozen->is_empty() &&
+			frozen->get_version() == doc.get_version() &&
+			frozen->get_encoding_type() == doc.get_encoding_type(),
+			"document data" + round_message);
+
+		Positions positions;
+
+		for (auto& node : std::as_const(doc))
+		{
+			positions.emplace(&node, static_cast<std::ptrdiff_t>(
+				positions.size()));
+		}
+
+		int node_errors = 0;
+		auto frozen_node = frozen->begin();
+
+		for (const auto& node : std::as_const(doc))
+		{
+			node_errors += is_same_node(node, *frozen_node++, positions,
+				frozen->begin()) ? 0 : 1;
+		}
+
+		check(!node_errors && frozen_node == frozen->end(),
+			"nodes" + round_message);
+		check(frozen->root().get_depth() == 0 &&
+			!frozen->root().get_parent() &&
+			frozen->root().end() == frozen->end(), "root" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 2. find gives the same nodes as in the source document
+		//---------------------------------------------------------------------
+
+		auto position = [&](XMLB::u8Document::const_iterator it)
+		{
+			return it == doc.cend() ? frozen->end() - frozen->begin() :
+				positions.at(&*it);
+		};
+
+		int find_errors = 0;
+
+		for (int i = 0; i < 30; ++i)
+		{
+			const std::string name = "n" + std::to_string(i);
+
+			auto expected = std::as_const(doc).find(name);
+			auto found = frozen->find(name);
+
+			for (; found != frozen->end() && expected != doc.cend();
+				expected = std::as_const(doc).find(name, std::next(expected)),
+				found = frozen->find(name, found + 1))
+			{
+				find_errors += found - frozen->begin() != position(expected);
+			}
+
+			find_errors += found != frozen->end() || expected != doc.cend();
+
+			const std::vector<std::string> path{ name, random_name(random) };
+
+			find_errors += frozen->find(path) - frozen->begin() !=
+				position(std::as_const(doc).find(path));
+		}
+
+		check(!find_errors, "find" + round_message);
+		check(frozen->find("missing") == frozen->end() &&
+			frozen->find({ "n1", "missing" }) == frozen->end(),
+			"missing names" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 3. Changes of the source do not reach the frozen copy
+		//---------------------------------------------------------------------
+
+		const std::string first_name{ frozen->begin()[1].get_name() };
+
+		doc.root().first_level_begin()->get()->set_name("changed");
+		doc.root().add_child(XMLB::u8Node{ "added" });
+		doc.root().erase_child(std::size_t{ 0 });
+
+		check(frozen->begin()[1].get_name() == first_name &&
+			frozen->size() == positions.size() &&
+			frozen->find("added") == frozen->end(),
+			"isolation" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 4. Any number of threads read without locks
+		//---------------------------------------------------------------------
+
+		std::vector<std::thread> threads;
+		std::vector<std::size_t> counts(8);
+
+		for (std::size_t i = 0; i < counts.size(); ++i)
+		{
+			threads.emplace_back([&frozen, &counts, i]
+				{
+					std::size_t count = 0;
+
+					for (auto it = frozen->find("n" + std::to_string(i));
+						it != frozen->end(); it = frozen->find(
+						"n" + std::to_string(i), it + 1))
+					{
+						count += it->size() + it->attr_size();
+					}
+
+					for (const auto& node : *frozen)
+					{
+						count += node.get_value().size();
+					}
+
+					counts[i] = count;
+				});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (std::size_t i = 0; i < counts.size(); ++i)
+		{
+			std::size_t expected = 0;
+
+			for (const auto& node : *frozen)
+			{
+				expected += node.get_value().size();
+
+				if (node.get_name() == "n" + std::to_string(i) &&
+					&node != frozen->begin())
+				{
+					expected += node.size() + node.attr_size();
+				}
+			}
+
+			check(counts[i] == expected, "reader " + std::to_string(i) +
+				round_message);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 5. Empty and parsed documents
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document empty_doc;
+	auto empty_frozen = empty_doc.freeze();
+
+	check(empty_frozen->is_empty() && empty_frozen->size() == 0 &&
+		empty_frozen->find("a") == empty_frozen->end(), "empty document");
+
+	bool is_thrown = false;
+
+	try
+	{
+		(void)empty_frozen->root();
+	}
+	catch (const std::out_of_range&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "root of empty document");
+
+	const std::string xml
+	{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<r x=\"1\"><a y=\"&amp;\">t</a><b/></r>\n"
+	};
+
+	auto parsed = XMLB::load_from(xml.begin(), xml.end());
+	auto parsed_frozen = parsed->freeze();
+	auto a = parsed_frozen->find("a");
+
+	check(a != parsed_frozen->end() && a->get_value() == "t" &&
+		a->find_attribute("y") != a->attr_end() &&
+		a->find_attribute("y")->value ==
+		parsed->find("a")->attr_cbegin()->value &&
+		parsed_frozen->get_encoding_type() == "UTF-8", "parsed document");
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+#include <random>
+#include <string>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+std::string save_incremental(const XMLB::u8Document& doc)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_incremental(doc, sink);
+
+	return std::string(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+// Incremental output must describe the same tree as a full save
+bool is_same_tree(const XMLB::u8Document& doc)
+{
+	const std::string text = save_incremental(doc);
+	auto reloaded = XMLB::load_from(text.begin(), text.end());
+
+	return reloaded && XMLB::save_to_string(*reloaded) ==
+		XMLB::save_to_string(doc);
+}
+
+//-----------------------------------------------------------------------------
+
+std::string generate(std::mt19937& random, int depth, int& budget)
+{
+	static const char* names[] = { "a", "bb", "c", "item", "x" };
+
+	const std::string name = names[random() % 5];
+	std::string xml = "<" + name;
+
+	for (int i = random() % 3; i > 0; --i)
+	{
+		xml += " k" + std::to_string(i) + "=\"" +
+			std::to_string(random() % 100) + "\"";
+	}
+
+	if (depth > 4 || budget <= 0 || random() % 3 == 0)
+	{
+		--budget;
+
+		if (random() % 2)
+		{
+			return xml + (random() % 2 ? "/>" : " />");
+		}
+
+		return xml + ">v" + std::to_string(random() % 100) + "</" + name + ">";
+	}
+
+	xml += ">";
+
+	for (int i = 1 + random() % 4; i > 0; --i, --budget)
+	{
+		xml += random() % 2 ? "\n" : "  ";
+
+		if (random() % 5 == 0)
+		{
+			xml += "<!-- c -->";
+		}
+
+		xml += generate(random, depth + 1, budget);
+	}
+
+	return xml + (random() % 2 ? "\n" : "") + "</" + name + ">";
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	const std::string source
+	{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<!-- head -->\n"
+		"<r>\n"
+		"  <a x=\"1\">  hi  </a>\n"
+		"  <!-- keep me -->\n"
+		"  <b/>\n"
+		"  <c><d>u</d>\n"
+		"     <e k=\"v\" /></c>\n"
+		"</r>\n"
+		"<!-- tail -->\n"
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Unchanged parts are copied from the source
+	//-------------------------------------------------------------------------
+
+	auto doc = XMLB::load_retained(source);
+
+	check(doc && doc->has_retained_source(), "source is retained");
+	check(save_incremental(*doc) == source, "unchanged document");
+
+	doc->find("d")->set_value("U2");
+
+	std::string text = save_incremental(*doc);
+
+	check(text.find("<!-- head -->") != std::string::npos &&
+		text.find("<!-- keep me -->") != std::string::npos &&
+		text.find("<a x=\"1\">  hi  </a>") != std::string::npos,
+		"comments and spaces of unchanged nodes are kept");
+	check(is_same_tree(*doc), "changed value");
+
+	doc->find("a")->set_attribute("x", "2");
+	doc->find("c")->add_child(XMLB::u8Node{ "new", "n" });
+	doc->root().erase_child(XMLB::u8Node::const_iterator{ doc->find("b") });
+	doc->find("e")->set_name("E");
+
+	check(is_same_tree(*doc), "changed attribute, children and name");
+
+	doc->set_version(1.1f);
+
+	check(is_same_tree(*doc) && save_incremental(*doc).find(
+		"<!-- head -->") != std::string::npos, "changed declaration");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Changes through attribute iterators
+	//-------------------------------------------------------------------------
+
+	auto attribute_doc = XMLB::load_retained(
+		std::string{ "<root><a id=\"1\"/><b id=\"2\"/></root>" });
+
+	attribute_doc->create_attribute_index("id");
+	attribute_doc->find("b")->find_attribute("id")->value = "7";
+
+	check(attribute_doc->find_by_attribute("id", "7") !=
+		attribute_doc->end() && attribute_doc->find_by_attribute("id",
+		"2") == attribute_doc->end(), "index sees value set by iterator");
+	check(save_incremental(*attribute_doc).find("id=\"7\"") !=
+		std::string::npos, "value set by iterator is saved");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Copies and structural changes
+	//-------------------------------------------------------------------------
+
+	auto original = XMLB::load_retained(source);
+
+	XMLB::u8Document copy{ *original };
+	copy.find("d")->set_value("zz");
+
+	check(save_incremental(*original) == source, "original of a copy");
+	check(is_same_tree(copy) && save_incremental(copy).find(
+		"<!-- keep me -->") != std::string::npos, "changed copy");
+
+	XMLB::u8Document new_root_copy{ *original };
+	new_root_copy.root(XMLB::u8Node{ "nr", "q" });
+
+	check(is_same_tree(new_root_copy), "replaced root");
+
+	XMLB::u8Document dropped_copy{ *original };
+	dropped_copy.drop_retained_source();
+
+	check(!dropped_copy.has_retained_source() &&
+		save_incremental(dropped_copy) == XMLB::save_to_string(dropped_copy) &&
+		original->has_retained_source(), "dropped source");
+
+	{
+		auto moved = XMLB::load_retained(source);
+		auto& c = *moved->find("c");
+
+		c.splice(c.first_level_cbegin(), *moved->find("a"));
+
+		check(is_same_tree(*moved), "splice");
+	}
+
+	{
+		auto moved = XMLB::load_retained(source);
+		moved->find("a")->swap_subtrees(*moved->find("d"));
+
+		check(is_same_tree(*moved), "swap_subtrees");
+	}
+
+	{
+		auto swapped = XMLB::load_retained(source);
+		swapped->find("a")->swap(*swapped->find("c"));
+
+		check(is_same_tree(*swapped), "swap");
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 4. Random changes of random documents
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 46 };
+
+	for (int round = 0; round < 300; ++round)
+	{
+		int budget = 60;
+
+		const std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" +
+			generate(random, 0, budget) + "\n";
+
+		auto random_doc = XMLB::load_retained(xml);
+
+		if (!random_doc || save_incremental(*random_doc) != xml)
+		{
+			check(false, "unchanged random document " + xml);
+			continue;
+		}
+
+		for (int i = random() % 6; i > 0; --i)
+		{
+			const long size = static_cast<long>(random_doc->size());
+			const long position = random() % size;
+
+			auto node = std::next(random_doc->begin(), position);
+
+			switch (random() % 6)
+			{
+			case 0:
+				node->set_value("nv" + std::to_string(i));
+				break;
+			case 1:
+				node->set_attribute("k0", "z");
+				break;
+			case 2:
+				node->add_child(XMLB::u8Node{ "add", "w" });
+				break;
+			case 3:
+				if (position)
+				{
+					random_doc->root().erase_child(
+						XMLB::u8Node::const_iterator{ node });
+				}
+				break;
+			case 4:
+				node->set_name("ren");
+				break;
+			default:
+				if (node->attr_size())
+				{
+					node->erase_attribute(node->attr_cbegin());
+				}
+				break;
+			}
+		}
+
+		check(is_same_tree(*random_doc), "random changes of " + xml);
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+std::string random_name(std::mt19937& random)
+{
+	return "n" + std::to_string(random() % 40);
+}
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 7 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ random_name(random) };
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<const XMLB::u8Node*> find_plain(const XMLB::u8Node& node,
+	const std::string& name)
+{
+	std::vector<const XMLB::u8Node*> result;
+
+	for (const auto& current : node)
+	{
+		if (current.get_name() == name)
+		{
+			result.push_back(&current);
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename DocT>
+std::vector<const XMLB::u8Node*> find_every(DocT& doc, const std::string& name)
+{
+	std::vector<const XMLB::u8Node*> result;
+
+	for (auto it = doc.find(name); it != doc.end();
+		it = doc.find(name, std::next(it)))
+	{
+		result.push_back(&*it);
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+// Each name of the path is looked up in the subtree of the first node with
+// the previous name, as find() does
+const XMLB::u8Node* find_path_plain(const XMLB::u8Node& node,
+	const std::vector<std::string>& path)
+{
+	const XMLB::u8Node* current = &node;
+
+	for (const auto& name : path)
+	{
+		const auto found = find_plain(*current, name);
+
+		if (found.empty())
+		{
+			return nullptr;
+		}
+
+		current = found.front();
+	}
+
+	return current;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	std::mt19937 random{ 34 };
+
+	auto check_finds = [&](XMLB::u8Document& doc, const std::string& message)
+	{
+		for (int i = 0; i < 45; ++i)
+		{
+			const std::string name = "n" + std::to_string(i);
+			const auto expected = find_plain(doc.root(), name);
+
+			// Const lookups go first, while stale summaries are not rebuilt
+			check(find_every(std::as_const(doc), name) == expected &&
+				find_every(doc, name) == expected, message + " for " + name);
+		}
+
+		for (int i = 0; i < 20; ++i)
+		{
+			const std::vector<std::string> path{ random_name(random),
+				random_name(random), random_name(random) };
+
+			const XMLB::u8Node* expected = find_path_plain(doc.root(), path);
+			auto found = doc.find(path);
+
+			check(found == doc.end() ? !expected : &*found == expected,
+				message + " for path " + path[0] + "/" + path[1] + "/" +
+				path[2]);
+		}
+	};
+
+	for (int round = 0; round < 5; ++round)
+	{
+		const std::string round_message = " in round " +
+			std::to_string(round);
+
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 3000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		//---------------------------------------------------------------------
+		// CHECK 1. Pruned search finds the same nodes as a plain one
+		//---------------------------------------------------------------------
+
+		doc.create_name_summary();
+
+		check(doc.has_name_summary(), "summary is created" + round_message);
+
+		check_finds(doc, "fresh summary" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 2. Renamed nodes are found under their new names
+		//---------------------------------------------------------------------
+
+		for (int i = 0; i < 200; ++i)
+		{
+			auto& node = *std::next(doc.begin(), random() % doc.size());
+
+			node.set_name(random_name(random));
+		}
+
+		// Names that no node had before are added to the summaries too
+		std::next(doc.begin(), random() % doc.size())->set_name("n41");
+
+		check_finds(doc, "after renames" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 3. Tail appends, inserts in the middle and erases
+		//---------------------------------------------------------------------
+
+		doc.root().add_child(XMLB::u8Node{ "n42" }).add_child(
+			XMLB::u8Node{ "n43" });
+
+		check_finds(doc, "after tail append" + round_message);
+
+		for (int i = 0; i < 20; ++i)
+		{
+			auto& parent = *std::next(doc.begin(), random() %
+				(doc.size() / 2));
+
+			parent.add_child(XMLB::u8Node{ "n44" }).add_child(
+				XMLB::u8Node{ random_name(random) });
+
+			auto& erased_parent = *std::next(doc.begin(), random() %
+				(doc.size() / 2));
+
+			if (erased_parent.child_size())
+			{
+				erased_parent.erase_child(std::size_t{ 0 });
+			}
+		}
+
+		check_finds(doc, "after inserts" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 4. Summary together with the name index and after drop
+		//---------------------------------------------------------------------
+
+		doc.create_name_index();
+
+		check_finds(doc, "with index" + round_message);
+
+		doc.drop_name_index();
+		doc.drop_name_summary();
+
+		check(!doc.has_name_summary(), "summary is dropped" + round_message);
+
+		check_finds(doc, "after drop" + round_message);
+	}
+
+	return errors ? 1 : 0;
+}
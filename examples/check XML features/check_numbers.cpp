@@ -0,0 +1,177 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+template<typename CharT, typename T>
+bool is_round_trip(T value)
+{
+	const auto str = XMLB::format_number<CharT>(value);
+
+	T result{};
+
+	return XMLB::parse_number(std::basic_string_view<CharT>{ str }, result) &&
+		(result == value || (result != result && value != value));
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+bool is_parsed(std::string_view str, T expected)
+{
+	T result{};
+
+	return XMLB::parse_number(str, result) && result == expected;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+bool is_rejected(std::string_view str)
+{
+	T result{};
+
+	return !XMLB::parse_number(str, result);
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Random numbers are formatted and parsed back exactly
+	//-------------------------------------------------------------------------
+
+	std::mt19937_64 random{ 1 };
+
+	for (int i = 0; i < 100000; ++i)
+	{
+		const std::uint64_t bits = random();
+
+		double double_value = 0;
+		std::memcpy(&double_value, &bits, sizeof(double_value));
+
+		float float_value = 0;
+		const auto float_bits = static_cast<std::uint32_t>(bits);
+		std::memcpy(&float_value, &float_bits, sizeof(float_value));
+
+		const std::string message = " of bits " + std::to_string(bits);
+
+		check(is_round_trip<char>(bits >> (bits % 64)) &&
+			is_round_trip<wchar_t>(static_cast<std::int64_t>(bits)) &&
+			is_round_trip<char>(static_cast<std::int32_t>(bits)),
+			"integers" + message);
+		check(is_round_trip<char>(double_value) &&
+			is_round_trip<wchar_t>(double_value), "double" + message);
+		check(is_round_trip<char>(float_value) &&
+			is_round_trip<wchar_t>(float_value), "float" + message);
+	}
+
+	check(is_round_trip<char>(std::numeric_limits<std::int64_t>::min()) &&
+		is_round_trip<char>(std::numeric_limits<std::uint64_t>::max()) &&
+		is_round_trip<char>(std::numeric_limits<std::int8_t>::min()) &&
+		is_round_trip<char>(std::numeric_limits<double>::denorm_min()) &&
+		is_round_trip<char>(std::numeric_limits<float>::max()) &&
+		is_round_trip<char>(-std::numeric_limits<double>::infinity()),
+		"limits");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Edge cases of integers
+	//-------------------------------------------------------------------------
+
+	check(is_rejected<std::int64_t>("9223372036854775808") &&
+		is_parsed("-9223372036854775808",
+		std::numeric_limits<std::int64_t>::min()), "int64 bounds");
+	check(is_rejected<std::uint64_t>("18446744073709551616") &&
+		is_parsed("000000000000000000018446744073709551615",
+		std::numeric_limits<std::uint64_t>::max()), "uint64 bounds");
+	check(is_rejected<unsigned char>("256") &&
+		is_parsed<unsigned char>("255", 255), "unsigned char bounds");
+
+	for (const char* str : { "", "-", "+1", " 1", "1 ", "-1", "1.0", "0x10",
+		"12a45678901234567" })
+	{
+		check(is_rejected<std::uint64_t>(str),
+			std::string{ "integer rejects '" } + str + "'");
+	}
+
+	check(is_parsed("true", true) && is_parsed("1", true) &&
+		is_parsed("0", false) && is_rejected<bool>("yes"), "bool");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Edge cases of floating point numbers
+	//-------------------------------------------------------------------------
+
+	check(is_parsed("1.5e3", 1500.0) && is_parsed("-0.25", -0.25) &&
+		is_parsed(".5", 0.5) && is_parsed("5.", 5.0) &&
+		is_parsed("1E-2", 0.01) && is_parsed("-inf",
+		-std::numeric_limits<double>::infinity()), "accepted syntax");
+
+	double nan_value = 0;
+
+	check(XMLB::parse_number(std::string_view{ "nan" }, nan_value) &&
+		std::isnan(nan_value), "nan");
+
+	for (const char* str : { "", "-", "+1", " 1", "1 ", "--1", "1.5x", "1,5",
+		"1.5.", "1e", "e5", "0x1p3", "1e400" })
+	{
+		check(is_rejected<double>(str),
+			std::string{ "double rejects '" } + str + "'");
+	}
+
+	check(is_rejected<float>("1e39") && is_rejected<float>("1e-50") &&
+		is_parsed("1e-40", 1e-40f), "float range");
+
+	//-------------------------------------------------------------------------
+	// CHECK 4. Float helpers
+	//-------------------------------------------------------------------------
+
+	check(XMLB::to_float(std::string_view{ "0.1" }) == 0.1f &&
+		XMLB::to_float(std::string_view{ "abc" }) == 0.f, "to_float");
+
+	check(XMLB::to_string<char>(3.0f) == "3" &&
+		XMLB::to_string<char>(2.5f, 16) == "2.8" &&
+		XMLB::to_string<char>(255.0f, 16) == "ff" &&
+		XMLB::to_string<char>(-10.75f, 2) == "-1010.11", "to_string");
+
+	bool is_thrown = false;
+
+	try
+	{
+		XMLB::to_string<char>(1.0f, 1);
+	}
+	catch (const std::invalid_argument&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "to_string rejects base 1");
+
+	check(XMLB::to_hex_string<char>(3.0f) == "1.8p+1" &&
+		XMLB::to_hex_string<char>(-1.0f) == "-1p+0", "to_hex_string");
+
+	check(XMLB::cut_doc_version<char>(1.f) == "1.0" &&
+		XMLB::cut_doc_version<char>(1.1f) == "1.1", "cut_doc_version");
+
+	return errors ? 1 : 0;
+}
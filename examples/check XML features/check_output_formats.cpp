@@ -0,0 +1,202 @@
+#include <random>
+#include <string>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 6 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ "n" + std::to_string(random() % 20) };
+
+		if (random() % 3 == 0)
+		{
+			child.set_value("v" + std::to_string(budget));
+		}
+		else if (random() % 4 == 0)
+		{
+			child.set_value(static_cast<int>(random() % 1000) - 500);
+		}
+
+		for (int j = random() % 3; j > 0; --j)
+		{
+			child.set_attribute("a" + std::to_string(j),
+				std::to_string(random() % 100));
+		}
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Pretty output without indents, line breaks and spaces in "<tag />"
+std::string minify(const std::string& text)
+{
+	std::string result;
+	bool is_line_start = true;
+
+	for (std::size_t i = 0; i < text.size(); ++i)
+	{
+		if (text[i] == '\t' && is_line_start)
+		{
+			continue;
+		}
+
+		is_line_start = text[i] == '\n';
+
+		if (!is_line_start && text.compare(i, 3, " />") != 0)
+		{
+			result += text[i];
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+// Output with tabs where each indent tab is replaced with spaces
+std::string to_spaces(const std::string& text, std::size_t width)
+{
+	std::string result;
+	bool is_line_start = true;
+
+	for (char symbol : text)
+	{
+		if (symbol == '\t' && is_line_start)
+		{
+			result.append(width, ' ');
+		}
+		else
+		{
+			is_line_start = symbol == '\n';
+			result += symbol;
+		}
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Exact output of a small document
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document small_doc;
+	small_doc.root(XMLB::u8Node{ "r" });
+	small_doc.root().set_attribute("x", "1");
+	small_doc.root().add_child(XMLB::u8Node{ "a", "t" });
+	small_doc.root().add_child(XMLB::u8Node{ "b" });
+	small_doc.root().add_child(XMLB::u8Node{ "c" }).add_child(
+		XMLB::u8Node{ "d" });
+
+	const std::string declaration{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>" };
+
+	check(XMLB::save_to_string<XMLB::Tab_format>(small_doc) == declaration +
+		"\n<r x=\"1\">\n\t<a>t</a>\n\t<b />\n\t<c>\n\t\t<d />\n\t</c>\n"
+		"</r>\n", "tabs");
+	check(XMLB::save_to_string<XMLB::Space_format<2>>(small_doc) ==
+		declaration + "\n<r x=\"1\">\n  <a>t</a>\n  <b />\n  <c>\n"
+		"    <d />\n  </c>\n</r>\n", "two spaces");
+	check(XMLB::save_to_string<XMLB::Minified_format>(small_doc) ==
+		declaration + "<r x=\"1\"><a>t</a><b/><c><d/></c></r>", "minified");
+	check(XMLB::save_to_string(small_doc) ==
+		XMLB::save_to_string<XMLB::Default_format>(small_doc) &&
+		XMLB::save_to_string<XMLB::Default_format>(small_doc) ==
+		XMLB::save_to_string<XMLB::Tab_format>(small_doc), "default format");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Formats differ only in indents, line breaks and single tags
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 44 };
+
+	for (int round = 0; round < 10; ++round)
+	{
+		const std::string round_message = " in round " +
+			std::to_string(round);
+
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 2000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		const std::string tab_text = XMLB::save_to_string(doc);
+		const std::string minified_text =
+			XMLB::save_to_string<XMLB::Minified_format>(doc);
+
+		check(minified_text == minify(tab_text) &&
+			minified_text.find('\n') == std::string::npos,
+			"minified" + round_message);
+		check(XMLB::save_to_string<XMLB::Space_format<1>>(doc) ==
+			to_spaces(tab_text, 1) &&
+			XMLB::save_to_string<XMLB::Space_format<4>>(doc) ==
+			to_spaces(tab_text, 4), "spaces" + round_message);
+
+		XMLB::detail::Decorator<char> decorator;
+		decorator.fill_symbol = ' ';
+
+		XMLB::u8Buffer_sink sink;
+		XMLB::save_to<XMLB::Tab_format>(doc, sink, decorator);
+
+		check(std::string(sink.data(), sink.size()) ==
+			to_spaces(tab_text, 1), "fill symbol of tabs" + round_message);
+
+		// The subtree is saved from its own level in any format
+		const auto& node = *std::next(doc.cbegin(), 1 + random() %
+			(doc.size() - 1));
+
+		XMLB::u8Buffer_sink node_sink;
+		XMLB::save_to<XMLB::Minified_format>(node.cbegin(), node.cend(),
+			node_sink);
+
+		check(minified_text.find(std::string(node_sink.data(),
+			node_sink.size())) != std::string::npos, "subtree" + round_message);
+
+		//---------------------------------------------------------------------
+		// CHECK 3. Output of every format loads back into the same document
+		//---------------------------------------------------------------------
+
+		auto minified_doc = XMLB::load_from(minified_text.begin(),
+			minified_text.end());
+
+		const std::string space_text =
+			XMLB::save_to_string<XMLB::Space_format<3>>(doc);
+		auto space_doc = XMLB::load_from(space_text.begin(),
+			space_text.end());
+
+		check(minified_doc && XMLB::save_to_string(*minified_doc) == tab_text,
+			"minified round trip" + round_message);
+		check(space_doc && XMLB::save_to_string(*space_doc) == tab_text,
+			"spaces round trip" + round_message);
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <random>
+#include <string>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <functional>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 8 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ std::string(1, "abcdefgh"[random() % 8]) };
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Parallel reduce keeps document order
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 17 };
+
+	for (int round = 0; round < 5; ++round)
+	{
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 20000; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		std::string names;
+
+		for (auto it = doc.cbegin(); it != doc.cend(); ++it)
+		{
+			names += it->get_name();
+		}
+
+		for (std::size_t thread_count : { 0, 1, 3, 8 })
+		{
+			const std::string reduced = XMLB::parallel_transform_reduce(
+				std::as_const(doc), std::string{}, std::plus<>{},
+				[](const XMLB::u8Node& node)
+				{
+					return std::string{ node.get_name() };
+				}, thread_count);
+
+			check(reduced == names, "reduce on " +
+				std::to_string(thread_count) + " threads");
+
+			std::atomic<std::size_t> visited_count{ 0 };
+
+			XMLB::parallel_for_each(std::as_const(doc),
+				[&visited_count](const XMLB::u8Node&)
+				{
+					++visited_count;
+				}, thread_count);
+
+			check(visited_count == doc.size(), "visit every node on " +
+				std::to_string(thread_count) + " threads");
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Concurrent changes of indexed documents
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document doc;
+	doc.root(XMLB::u8Node{ "root" });
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		auto& group = doc.root().add_child(XMLB::u8Node{ "g" });
+
+		group.add_attribute(XMLB::u8Node_attribute{ "id",
+			std::to_string(i) });
+		group.add_child(XMLB::u8Node{ "i" }).set_value("x");
+	}
+
+	doc.create_name_index();
+	doc.create_name_summary();
+	doc.create_attribute_index("id", true);
+
+	XMLB::parallel_for_each(doc, [](XMLB::u8Node& node)
+		{
+			if (node.get_name() == "g")
+			{
+				auto id = node.attr_begin();
+
+				id->value += "x";
+
+				node.set_name("h");
+				node.add_attribute(XMLB::u8Node_attribute{ "k", "1" });
+			}
+			else
+			{
+				node.set_value("y");
+			}
+		}, 8);
+
+	std::size_t renamed_count = 0;
+
+	for (auto it = doc.find("h"); it != doc.end();
+		it = doc.find("h", std::next(it)))
+	{
+		++renamed_count;
+	}
+
+	check(renamed_count == 2000, "name index after concurrent renames");
+	check(doc.find("g") == doc.end(), "old names are gone");
+	check(doc.find_by_attribute("id", "5x") != doc.end() &&
+		doc.find_by_attribute("id", "5") == doc.end(),
+		"attribute index after concurrent changes");
+	check(doc.find("i")->get_value() == "y", "values after concurrent changes");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Lookups while other threads rename indexed nodes
+	//-------------------------------------------------------------------------
+
+	std::atomic<std::size_t> found_count{ 0 };
+
+	XMLB::parallel_for_each(doc, [&found_count](XMLB::u8Node& node)
+		{
+			// Each lookup reads only the subtree of its own node
+			if (node.get_name() == "h")
+			{
+				if (node.find("i") != node.end() && 
+					node.find("h") == node.end())
+				{
+					++found_count;
+				}
+
+				node.set_name("g");
+			}
+		}, 8);
+
+	renamed_count = 0;
+
+	for (auto it = doc.find("g"); it != doc.end();
+		it = doc.find("g", std::next(it)))
+	{
+		++renamed_count;
+	}
+
+	check(found_count == 2000, "lookups during concurrent renames");
+	check(renamed_count == 2000 && doc.find("h") == doc.end(),
+		"name index after lookups and renames");
+
+	//-------------------------------------------------------------------------
+	// CHECK 4. Exceptions and empty documents
+	//-------------------------------------------------------------------------
+
+	bool is_thrown = false;
+
+	try
+	{
+		XMLB::parallel_for_each(doc, [](XMLB::u8Node& node)
+			{
+				if (node.get_name() == "i")
+				{
+					throw std::runtime_error{ "stop" };
+				}
+			}, 4);
+	}
+	catch (const std::runtime_error&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "exception is passed to the caller");
+
+	XMLB::u8Document empty_doc;
+	bool is_called = false;
+
+	XMLB::parallel_for_each(empty_doc, [&is_called](XMLB::u8Node&)
+		{
+			is_called = true;
+		});
+
+	check(!is_called, "empty document is not visited");
+	check(XMLB::parallel_transform_reduce(std::as_const(empty_doc), 5,
+		std::plus<>{}, [](const XMLB::u8Node&) { return 1; }) == 5,
+		"reduce of empty document");
+
+	//-------------------------------------------------------------------------
+	// CHECK 5. Nested calls share the pool without waiting for each other
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document inner_doc;
+	inner_doc.root(XMLB::u8Node{ "r" });
+
+	for (int budget = 2000; budget > 0; )
+	{
+		generate(inner_doc.root(), random, 0, budget);
+	}
+
+	const int inner_size = static_cast<int>(inner_doc.size());
+	std::atomic<int> wrong_count{ 0 };
+
+	for (int round = 0; round < 20; ++round)
+	{
+		XMLB::parallel_for_each(std::as_const(inner_doc),
+			[&](const XMLB::u8Node& node)
+			{
+				if (node.get_name() != "a")
+				{
+					return;
+				}
+
+				if (XMLB::parallel_transform_reduce(std::as_const(inner_doc),
+					0, std::plus<>{}, [](const XMLB::u8Node&) { return 1; },
+					3) != inner_size)
+				{
+					++wrong_count;
+				}
+			}, 4);
+	}
+
+	check(!wrong_count, "nested reduce");
+
+	return errors ? 1 : 0;
+}
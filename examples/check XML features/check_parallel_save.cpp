@@ -0,0 +1,149 @@
+#include <random>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+template<typename FormatT>
+std::string save_sequential(const XMLB::u8Document& doc)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_to<FormatT>(doc, sink);
+
+	return std::string(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename FormatT>
+std::string save_parallel(const XMLB::u8Document& doc,
+	std::size_t thread_count)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_to_parallel<FormatT>(doc, sink, thread_count);
+
+	return std::string(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Document& doc, std::mt19937& random, int node_count)
+{
+	doc.root(XMLB::u8Node{ "root" });
+
+	std::vector<XMLB::u8Node*> nodes{ &doc.root() };
+
+	for (int i = 0; i < node_count; ++i)
+	{
+		// Half of the nodes go under the latest ones to grow deep branches
+		auto parent = nodes[random() % 2 ? nodes.size() - 1 - random() %
+			std::min<std::size_t>(nodes.size(), 5) : random() % nodes.size()];
+
+		XMLB::u8Node node{ "n" + std::to_string(random() % 50) };
+
+		if (random() % 3 == 0)
+		{
+			node.add_attribute(XMLB::u8Node_attribute{ "k",
+				std::to_string(i) });
+		}
+
+		if (random() % 2)
+		{
+			node.set_value("v" + std::to_string(i));
+		}
+
+		nodes.push_back(&parent->add_child(std::move(node)));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Parallel output is the same as save_to
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 9 };
+
+	for (int round = 0; round < 30; ++round)
+	{
+		XMLB::u8Document doc;
+
+		if (round)
+		{
+			generate(doc, random, random() % 3000);
+		}
+
+		const std::string expected = save_sequential<XMLB::Default_format>(doc);
+		const std::string expected_minified =
+			save_sequential<XMLB::Minified_format>(doc);
+
+		for (std::size_t thread_count : { 0, 1, 2, 3, 8, 64 })
+		{
+			const std::string message = "round " + std::to_string(round) +
+				" on " + std::to_string(thread_count) + " threads";
+
+			check(save_parallel<XMLB::Default_format>(doc, thread_count) ==
+				expected, message);
+			check(save_parallel<XMLB::Minified_format>(doc, thread_count) ==
+				expected_minified, "minified " + message);
+		}
+
+		if (!round)
+		{
+			continue;
+		}
+
+		// A node is saved the same way as the root of a document with its copy
+		const auto& node = *std::next(doc.cbegin(), random() % doc.size());
+
+		XMLB::u8Document node_doc;
+		node_doc.root(XMLB::u8Node{ node });
+
+		XMLB::u8Buffer_sink expected_sink;
+		XMLB::save_to(node_doc.cbegin(), node_doc.cend(), expected_sink);
+
+		XMLB::u8Buffer_sink node_sink;
+		XMLB::save_to_parallel(node, node_sink, 4);
+
+		check(std::string(node_sink.data(), node_sink.size()) ==
+			std::string(expected_sink.data(), expected_sink.size()),
+			"node of round " + std::to_string(round));
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Very deep documents
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document deep_doc;
+	deep_doc.root(XMLB::u8Node{ "root" });
+
+	XMLB::u8Node* last = &deep_doc.root();
+
+	for (int i = 0; i < 5000; ++i)
+	{
+		last = &last->add_child(XMLB::u8Node{ "n", std::to_string(i) });
+	}
+
+	check(save_parallel<XMLB::Minified_format>(deep_doc, 4) ==
+		save_sequential<XMLB::Minified_format>(deep_doc), "deep document");
+
+	return errors ? 1 : 0;
+}
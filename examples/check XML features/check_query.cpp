@@ -0,0 +1,334 @@
+#include <map>
+#include <set>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+struct Predicate
+{
+	enum class Kind { has_attribute, attribute_equal, position };
+
+	Kind kind;
+	std::string value;
+};
+
+struct Step
+{
+	bool descendant;
+	std::string name;
+	std::vector<Predicate> predicates;
+};
+
+//-----------------------------------------------------------------------------
+
+void collect_subtree(const XMLB::u8Node& node,
+	std::vector<const XMLB::u8Node*>& nodes)
+{
+	nodes.push_back(&node);
+
+	for (auto it = node.first_level_cbegin(); it != node.first_level_cend();
+		++it)
+	{
+		collect_subtree(**it, nodes);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+bool is_matched(const XMLB::u8Node& node, const Predicate& predicate,
+	long position)
+{
+	auto found = node.find_attribute("k");
+
+	switch (predicate.kind)
+	{
+	case Predicate::Kind::has_attribute:
+		return found != node.attr_cend();
+	case Predicate::Kind::attribute_equal:
+		return found != node.attr_cend() && found->value == predicate.value;
+	default:
+		return position == std::stol(predicate.value);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Naive evaluation of the same query, step by step over whole node sets
+std::vector<const XMLB::u8Node*> evaluate(const XMLB::u8Node& start,
+	const std::vector<Step>& steps)
+{
+	std::vector<const XMLB::u8Node*> all_nodes;
+	collect_subtree(start, all_nodes);
+
+	std::map<const XMLB::u8Node*, std::size_t> order;
+
+	for (std::size_t i = 0; i < all_nodes.size(); ++i)
+	{
+		order[all_nodes[i]] = i;
+	}
+
+	std::vector<const XMLB::u8Node*> context{ &start };
+
+	for (const auto& step : steps)
+	{
+		std::set<const XMLB::u8Node*> parents;
+
+		for (auto node : context)
+		{
+			std::vector<const XMLB::u8Node*> subtree{ node };
+
+			if (step.descendant)
+			{
+				subtree.clear();
+				collect_subtree(*node, subtree);
+			}
+
+			parents.insert(subtree.begin(), subtree.end());
+		}
+
+		std::map<std::size_t, const XMLB::u8Node*> result;
+
+		for (auto parent : parents)
+		{
+			std::vector<const XMLB::u8Node*> candidates;
+
+			for (auto it = parent->first_level_cbegin();
+				it != parent->first_level_cend(); ++it)
+			{
+				if (step.name == "*" || (*it)->get_name() == step.name)
+				{
+					candidates.push_back(&**it);
+				}
+			}
+
+			for (const auto& predicate : step.predicates)
+			{
+				std::vector<const XMLB::u8Node*> matched;
+
+				for (std::size_t i = 0; i < candidates.size(); ++i)
+				{
+					if (is_matched(*candidates[i], predicate,
+						static_cast<long>(i + 1)))
+					{
+						matched.push_back(candidates[i]);
+					}
+				}
+
+				candidates = std::move(matched);
+			}
+
+			for (auto candidate : candidates)
+			{
+				result[order[candidate]] = candidate;
+			}
+		}
+
+		context.clear();
+
+		for (const auto& [position, node] : result)
+		{
+			context.push_back(node);
+		}
+	}
+
+	return context;
+}
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth)
+{
+	const int children_count = depth > 4 ? 0 : random() % 4;
+
+	for (int i = 0; i < children_count; ++i)
+	{
+		XMLB::u8Node child{ std::string(1, "abc"[random() % 3]) };
+
+		if (random() % 2)
+		{
+			child.add_attribute(XMLB::u8Node_attribute{ "k",
+				std::to_string(random() % 2) });
+		}
+
+		generate(child, random, depth + 1);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename Range>
+std::vector<std::string> collect_values(const Range& range)
+{
+	std::vector<std::string> values;
+
+	for (const auto& node : range)
+	{
+		values.emplace_back(node.get_value());
+	}
+
+	return values;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Queries over a small catalog
+	//-------------------------------------------------------------------------
+
+	std::string xml
+	{
+		"<catalog>"
+			"<book lang=\"en\"><title>A</title></book>"
+			"<book lang=\"ru\"><title>B</title></book>"
+			"<book lang=\"en\"><title>C</title><x><title>D</title></x></book>"
+		"</catalog>"
+	};
+
+	auto doc = XMLB::load_from(xml.begin(), xml.end());
+	const XMLB::u8Document& const_doc = *doc;
+
+	check(collect_values(XMLB::u8Query::compile(
+		"/catalog/book[@lang='en']/title").execute(*doc)) ==
+		std::vector<std::string>{ "A", "C" }, "attribute predicate");
+
+	check(collect_values(XMLB::u8Query::compile("//title").execute(*doc)) ==
+		std::vector<std::string>{ "A", "B", "C", "D" },
+		"descendant axis in document order");
+
+	check(collect_values(XMLB::u8Query::compile("//book[2]/title").execute(
+		const_doc)) == std::vector<std::string>{ "B" }, "position predicate");
+
+	std::vector<std::string> names;
+
+	for (const auto& node : XMLB::u8Query::compile(
+		"book[ @lang = \"en\" ][2]/*").execute(doc->root()))
+	{
+		names.emplace_back(node.get_name());
+	}
+
+	check(names == std::vector<std::string>{ "title", "x" },
+		"relative query with chained predicates");
+
+	int changed_count = 0;
+
+	for (auto& node : XMLB::u8Query::compile("/catalog/book").execute(*doc))
+	{
+		node.set_value("changed");
+		++changed_count;
+	}
+
+	check(changed_count == 3, "non-const result is writable");
+
+	XMLB::u8Document empty_doc;
+	auto empty_result = XMLB::u8Query::compile("//a").execute(empty_doc);
+
+	check(empty_result.begin() == empty_result.end(), "empty document");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Malformed expressions are rejected
+	//-------------------------------------------------------------------------
+
+	for (const char* expression : { "", "/", "a/", "a[", "a[0]", "a[@]",
+		"a[@b=c]", "a[@b='c]", "a//", "a]" })
+	{
+		bool is_thrown = false;
+
+		try
+		{
+			XMLB::u8Query::compile(expression);
+		}
+		catch (const std::invalid_argument&)
+		{
+			is_thrown = true;
+		}
+
+		check(is_thrown, std::string{ "rejects '" } + expression + "'");
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Random queries against naive evaluation
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 3 };
+
+	for (int tree = 0; tree < 100; ++tree)
+	{
+		XMLB::u8Node root{ "r" };
+		generate(root, random, 0);
+
+		for (int query = 0; query < 20; ++query)
+		{
+			std::vector<Step> steps(1 + random() % 3);
+			std::string expression;
+
+			for (std::size_t i = 0; i < steps.size(); ++i)
+			{
+				Step& step = steps[i];
+
+				step.descendant = random() % 2;
+				step.name = random() % 4 ? std::string(1, "abc"[random() % 3]) :
+					"*";
+
+				expression += step.descendant ? "//" :
+					(i || random() % 2 ? "/" : "");
+				expression += step.name;
+
+				for (int j = random() % 3; j > 0; --j)
+				{
+					Predicate predicate{
+						static_cast<Predicate::Kind>(random() % 3), "k" };
+
+					switch (predicate.kind)
+					{
+					case Predicate::Kind::has_attribute:
+						expression += "[@k]";
+						break;
+					case Predicate::Kind::attribute_equal:
+						predicate.value = std::to_string(random() % 2);
+						expression += "[@k='" + predicate.value + "']";
+						break;
+					default:
+						predicate.value = std::to_string(1 + random() % 3);
+						expression += "[" + predicate.value + "]";
+						break;
+					}
+
+					step.predicates.push_back(predicate);
+				}
+			}
+
+			std::vector<const XMLB::u8Node*> found;
+			const XMLB::u8Node& const_root = root;
+
+			for (const auto& node :
+				XMLB::u8Query::compile(expression).execute(const_root))
+			{
+				found.push_back(&node);
+			}
+
+			check(found == evaluate(root, steps), "query " + expression);
+		}
+	}
+
+	return errors ? 1 : 0;
+}
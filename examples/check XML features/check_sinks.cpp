@@ -0,0 +1,266 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Document& doc, std::mt19937& random, int node_count)
+{
+	doc.root(XMLB::u8Node{ "root" });
+
+	std::vector<XMLB::u8Node*> nodes{ &doc.root() };
+
+	for (int i = 0; i < node_count; ++i)
+	{
+		XMLB::u8Node node{ "n" + std::to_string(random() % 50) };
+
+		if (random() % 3 == 0)
+		{
+			node.set_attribute("k", std::string(random() % 300, 'a'));
+		}
+
+		if (random() % 2)
+		{
+			node.set_value("v" + std::to_string(i));
+		}
+
+		nodes.push_back(&nodes[random() % nodes.size()]->add_child(
+			std::move(node)));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+std::string read_file(const std::string& file_name)
+{
+	std::ifstream file{ file_name, std::ios::binary };
+
+	return std::string{ std::istreambuf_iterator<char>{ file },
+		std::istreambuf_iterator<char>{} };
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	std::mt19937 random{ 41 };
+
+	XMLB::u8Document doc;
+	generate(doc, random, 2000);
+
+	const std::string expected = XMLB::save_to_string(doc);
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Fixed buffer takes exactly the output or throws
+	//-------------------------------------------------------------------------
+
+	std::vector<char> buffer(expected.size());
+	XMLB::u8Fixed_sink exact_sink{ buffer.data(), buffer.size() };
+
+	XMLB::save_to(doc, exact_sink);
+
+	check(exact_sink.size() == exact_sink.capacity() &&
+		std::string(exact_sink.data(), exact_sink.size()) == expected,
+		"buffer of exact size");
+
+	XMLB::u8Fixed_sink small_sink{ buffer.data(), buffer.size() - 1 };
+	bool is_thrown = false;
+
+	try
+	{
+		XMLB::save_to(doc, small_sink);
+	}
+	catch (const std::out_of_range&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown && std::string(small_sink.data(), small_sink.size()) ==
+		expected.substr(0, small_sink.size()), "buffer one symbol smaller");
+
+	char small_buffer[4];
+	XMLB::u8Fixed_sink append_sink{ small_buffer, sizeof(small_buffer) };
+
+	append_sink.append("ab", 2);
+
+	auto is_full = [&append_sink](auto&& append)
+	{
+		try
+		{
+			append(append_sink);
+		}
+		catch (const std::out_of_range&)
+		{
+			return append_sink.size() == 2;
+		}
+
+		return false;
+	};
+
+	check(is_full([](auto& sink) { sink.append("xyz", 3); }) &&
+		is_full([](auto& sink) { sink.append('x', 3); }) &&
+		std::string(append_sink.data(), 2) == "ab", "overflow writes nothing");
+
+	append_sink.append('c');
+	append_sink.append('d', 1);
+
+	check(std::string(append_sink.data(), append_sink.size()) == "abcd" &&
+		is_full([](auto& sink) { sink.append('x'); }) == false,
+		"buffer filled to the end");
+
+#if defined(__unix__) || defined(__APPLE__)
+	//-------------------------------------------------------------------------
+	// CHECK 2. File descriptor with buffers smaller and larger than writes
+	//-------------------------------------------------------------------------
+
+	const std::string file_name{ "check_sinks.xml" };
+
+	for (std::size_t buffer_size : { 1, 7, 64, 4096, 256 * 1024 })
+	{
+		const int fd = ::open(file_name.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		{
+			XMLB::u8Fd_sink sink{ fd, buffer_size };
+
+			XMLB::save_to(doc, sink);
+
+			// Pieces larger than the buffer go with it in one writev call
+			sink.append('\n');
+			sink.append(expected.data(), expected.size());
+			sink.append('-', 10000);
+		}
+
+		::close(fd);
+
+		check(read_file(file_name) == expected + "\n" + expected +
+			std::string(10000, '-'), "buffer of " +
+			std::to_string(buffer_size) + " bytes");
+	}
+
+	const std::u16string wide_text{ u"<a>Ж</a>" };
+
+	{
+		const int fd = ::open(file_name.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		{
+			XMLB::u16Fd_sink sink{ fd, 5 };
+
+			sink.append(wide_text.data(), wide_text.size());
+			sink.append(u'x', 3);
+		}
+
+		::close(fd);
+
+		const std::u16string expected_wide = wide_text + u"xxx";
+
+		check(read_file(file_name) == std::string(
+			reinterpret_cast<const char*>(expected_wide.data()),
+			expected_wide.size() * sizeof(char16_t)), "char16_t symbols");
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Copies from another file
+	//-------------------------------------------------------------------------
+
+	const std::string source_name{ "check_sinks_source.xml" };
+
+	{
+		std::ofstream source{ source_name, std::ios::binary };
+		source << expected;
+	}
+
+	const int source_fd = ::open(source_name.c_str(), O_RDONLY);
+
+	// O_APPEND makes the kernel refuse some of the copy calls, so the
+	// copy goes through the buffer of the sink
+	for (int flags : { O_TRUNC, O_TRUNC | O_APPEND })
+	{
+		const int fd = ::open(file_name.c_str(),
+			O_WRONLY | O_CREAT | flags, 0644);
+
+		if (flags & O_APPEND)
+		{
+			::ftruncate(fd, 0);
+		}
+
+		{
+			XMLB::u8Fd_sink sink{ fd, 16 };
+
+			sink.append("<", 1);
+			sink.copy_from(source_fd, 10, 5000);
+			sink.append(">", 1);
+			sink.copy_from(source_fd, 0, expected.size());
+			sink.copy_from(source_fd, 3, 0);
+		}
+
+		::close(fd);
+
+		check(read_file(file_name) == "<" + expected.substr(10, 5000) +
+			">" + expected, "copy with flags " + std::to_string(flags));
+	}
+
+	is_thrown = false;
+
+	try
+	{
+		XMLB::u8Fd_sink sink{ source_fd, 16 };
+
+		sink.copy_from(source_fd, expected.size() - 2, 10);
+	}
+	catch (const std::system_error&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "copy past the end of file");
+
+	is_thrown = false;
+
+	try
+	{
+		XMLB::u8Fd_sink sink{ source_fd, 16 };
+
+		sink.append(expected.data(), expected.size());
+		sink.flush();
+	}
+	catch (const std::system_error&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "write to read only descriptor");
+
+	::close(source_fd);
+
+	std::remove(file_name.c_str());
+	std::remove(source_name.c_str());
+#endif
+
+	return errors ? 1 : 0;
+}
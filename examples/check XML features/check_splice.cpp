@@ -0,0 +1,309 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+std::size_t get_depth(const XMLB::u8Node& node)
+{
+	std::size_t depth = 0;
+
+	for (auto parent = node.get_parent(); parent; parent = parent->get_parent())
+	{
+		++depth;
+	}
+
+	return depth;
+}
+
+//-----------------------------------------------------------------------------
+
+void collect_descendants(const XMLB::u8Node& node,
+	std::vector<const XMLB::u8Node*>& nodes)
+{
+	for (auto it = node.first_level_cbegin(); it != node.first_level_cend();
+		++it)
+	{
+		nodes.push_back(&**it);
+		collect_descendants(**it, nodes);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Iterators, offsets and sizes must agree with the lists of children
+bool is_consistent(const XMLB::u8Node& node)
+{
+	std::vector<const XMLB::u8Node*> descendants;
+	collect_descendants(node, descendants);
+
+	if (node.size() != descendants.size())
+	{
+		return false;
+	}
+
+	const std::size_t depth = get_depth(node);
+	std::size_t i = 0;
+
+	for (auto it = node.cbegin(); it != node.cend(); ++it, ++i)
+	{
+		if (i == descendants.size() || &*it != descendants[i] ||
+			it.get_offset() + depth + 1 != get_depth(*it))
+		{
+			return false;
+		}
+	}
+
+	auto it = node.cend();
+
+	for (i = descendants.size(); i > 0; --i)
+	{
+		if (&*--it != descendants[i - 1])
+		{
+			return false;
+		}
+	}
+
+	return std::distance(node.preorder_cbegin(),
+		node.preorder_cend()) == static_cast<long>(descendants.size());
+}
+
+//-----------------------------------------------------------------------------
+
+bool is_tree_consistent(const XMLB::u8Node& top)
+{
+	std::vector<const XMLB::u8Node*> descendants;
+	collect_descendants(top, descendants);
+
+	bool result = is_consistent(top);
+
+	for (auto node : descendants)
+	{
+		result = result && is_consistent(*node);
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<XMLB::u8Node*> collect_tree(XMLB::u8Node& top)
+{
+	std::vector<const XMLB::u8Node*> descendants;
+	collect_descendants(top, descendants);
+
+	std::vector<XMLB::u8Node*> nodes{ &top };
+
+	for (auto node : descendants)
+	{
+		nodes.push_back(const_cast<XMLB::u8Node*>(node));
+	}
+
+	return nodes;
+}
+
+//-----------------------------------------------------------------------------
+
+std::string to_string(const XMLB::u8Document& doc)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_to<XMLB::Minified_format>(doc.cbegin(), doc.cend(), sink);
+
+	return std::string(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Splice and swap between two documents
+	//-------------------------------------------------------------------------
+
+	std::string first_xml{ "<a><b><c/><d/></b><e/></a>" };
+	std::string second_xml{ "<x><y><z/></y></x>" };
+
+	auto first_doc = XMLB::load_from(first_xml.begin(), first_xml.end());
+	auto second_doc = XMLB::load_from(second_xml.begin(), second_xml.end());
+
+	auto& b = *first_doc->find("b");
+	auto& y = *second_doc->find("y");
+
+	second_doc->root().splice(second_doc->root().first_level_begin(), b);
+
+	check(to_string(*first_doc) == "<a><e/></a>" &&
+		to_string(*second_doc) == "<x><b><c/><d/></b><y><z/></y></x>",
+		"splice to other document");
+
+	y.swap_subtrees(*second_doc->find("d"));
+
+	check(to_string(*second_doc) == "<x><b><c/><y><z/></y></b><d/></x>",
+		"swap subtrees inside document");
+
+	first_doc->find("e")->swap_subtrees(*second_doc->find("c"));
+
+	check(to_string(*first_doc) == "<a><c/></a>" &&
+		to_string(*second_doc) == "<x><b><e/><y><z/></y></b><d/></x>",
+		"swap subtrees between documents");
+
+	check(is_tree_consistent(first_doc->root()) &&
+		is_tree_consistent(second_doc->root()), "iterators after moves");
+
+	bool is_thrown = false;
+
+	try
+	{
+		y.splice(y.first_level_begin(), *second_doc->find("b"));
+	}
+	catch (const std::invalid_argument&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "splice into own subtree is rejected");
+
+	is_thrown = false;
+
+	try
+	{
+		second_doc->find("b")->swap_subtrees(y);
+	}
+	catch (const std::invalid_argument&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown, "swap with descendant is rejected");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Moves keep unique attribute values
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document unique_doc;
+	unique_doc.root(XMLB::u8Node{ "root" });
+	unique_doc.root().add_child(XMLB::u8Node{ "n" }).add_attribute(
+		XMLB::u8Node_attribute{ "id", "1" });
+	unique_doc.create_attribute_index("id", true);
+
+	XMLB::u8Node loose{ "loose" };
+	loose.add_child(XMLB::u8Node{ "n" }).add_attribute(
+		XMLB::u8Node_attribute{ "id", "1" });
+
+	is_thrown = false;
+
+	try
+	{
+		unique_doc.root().splice(unique_doc.root().first_level_end(),
+			*loose.begin());
+	}
+	catch (const std::invalid_argument&)
+	{
+		is_thrown = true;
+	}
+
+	check(is_thrown && loose.child_size() == 1 &&
+		unique_doc.root().child_size() == 1, "duplicate value is rejected");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Random moves keep every iterator consistent
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 7 };
+
+	for (int round = 0; round < 30; ++round)
+	{
+		XMLB::u8Document first;
+		XMLB::u8Document second;
+		XMLB::u8Node detached{ "detached" };
+
+		first.root(XMLB::u8Node{ "first" });
+		second.root(XMLB::u8Node{ "second" });
+
+		if (round % 2)
+		{
+			first.create_name_index();
+			second.create_attribute_index("id");
+		}
+
+		XMLB::u8Node* tops[] = { &first.root(), &second.root(), &detached };
+
+		for (int i = 0; i < 50; ++i)
+		{
+			auto nodes = collect_tree(*tops[random() % 3]);
+
+			nodes[random() % nodes.size()]->add_child(
+				XMLB::u8Node{ "n" + std::to_string(random() % 6) });
+		}
+
+		for (int step = 0; step < 200; ++step)
+		{
+			auto first_nodes = collect_tree(*tops[random() % 3]);
+			auto second_nodes = collect_tree(*tops[random() % 3]);
+
+			if (first_nodes.size() < 2 || second_nodes.size() < 2)
+			{
+				continue;
+			}
+
+			auto& node = *first_nodes[1 + random() % (first_nodes.size() - 1)];
+			auto& target = *second_nodes[random() % second_nodes.size()];
+			auto& other = *second_nodes[1 + random() %
+				(second_nodes.size() - 1)];
+
+			try
+			{
+				if (random() % 2)
+				{
+					auto position = target.first_level_begin();
+					std::advance(position, random() %
+						(target.child_size() + 1));
+
+					target.splice(position, node);
+				}
+				else
+				{
+					node.swap_subtrees(other);
+				}
+			}
+			catch (const std::invalid_argument&)
+			{
+				// Moves into own subtree are rejected
+			}
+
+			const bool is_valid = is_tree_consistent(*tops[0]) &&
+				is_tree_consistent(*tops[1]) && is_tree_consistent(*tops[2]);
+
+			auto reloaded_xml = to_string(first);
+			auto reloaded = XMLB::load_from(reloaded_xml.begin(),
+				reloaded_xml.end());
+
+			check(is_valid && to_string(*reloaded) == reloaded_xml,
+				"random moves, round " + std::to_string(round) + " step " +
+				std::to_string(step));
+
+			if (errors)
+			{
+				return 1;
+			}
+		}
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+void generate(XMLB::u8Node& node, std::mt19937& random, int depth,
+	int& budget)
+{
+	const int children_count = depth > 6 ? 0 : random() % 5;
+
+	for (int i = 0; i < children_count && budget > 0; ++i, --budget)
+	{
+		XMLB::u8Node child{ "n" + std::to_string(random() % 20) };
+
+		// Values are written as is, so symbols for escaping are counted too
+		switch (random() % 5)
+		{
+		case 0:
+			child.set_value("a&b<c>\"d\"");
+			break;
+		case 1:
+			child.set_value(static_cast<long long>(random()) - 1000000000LL);
+			break;
+		case 2:
+			child.set_value(random() % 1000 / 7.0);
+			break;
+		case 3:
+			child.set_value(random() % 2 == 0);
+			break;
+		default:
+			break;
+		}
+
+		for (int j = random() % 3; j > 0; --j)
+		{
+			child.set_attribute("a" + std::to_string(j),
+				std::string(random() % 4, '&'));
+		}
+
+		generate(child, random, depth + 1, budget);
+		node.add_child(std::move(child));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename FormatT, typename CharT, typename DecorT>
+std::basic_string<CharT> save_with(const XMLB::Document<CharT>& doc,
+	const DecorT& decorator)
+{
+	XMLB::Buffer_sink<CharT> sink;
+	XMLB::save_to<FormatT>(doc, sink, decorator);
+
+	return std::basic_string<CharT>(sink.data(), sink.size());
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename FormatT, typename CharT>
+bool is_exact(const XMLB::Document<CharT>& doc)
+{
+	XMLB::detail::Decorator<CharT> decorator;
+	decorator.fill_symbol = '.';
+	decorator.white_space_symbol = '_';
+	decorator.line_break_symbol = '|';
+
+	const std::size_t count = XMLB::symbols_count<FormatT>(doc);
+
+	return XMLB::save_to_string<FormatT>(doc).size() == count &&
+		save_with<FormatT>(doc, decorator).size() == count;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename CharT>
+bool is_exact_in_all_formats(const XMLB::Document<CharT>& doc)
+{
+	return is_exact<XMLB::Tab_format>(doc) &&
+		is_exact<XMLB::Minified_format>(doc) &&
+		is_exact<XMLB::Space_format<1>>(doc) &&
+		is_exact<XMLB::Space_format<4>>(doc) &&
+		is_exact<XMLB::Output_format<3, false, true>>(doc) &&
+		is_exact<XMLB::Output_format<2, true, false>>(doc);
+}
+
+//-----------------------------------------------------------------------------
+
+std::string read_file(const std::string& file_name)
+{
+	std::ifstream file{ file_name, std::ios::binary };
+
+	return std::string{ std::istreambuf_iterator<char>{ file },
+		std::istreambuf_iterator<char>{} };
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	std::mt19937 random{ 42 };
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Count matches the output in every format
+	//-------------------------------------------------------------------------
+
+	for (int round = 0; round < 10; ++round)
+	{
+		const std::string round_message = " in round " +
+			std::to_string(round);
+
+		XMLB::u8Document doc{ round % 2 ? 1.1f : 1.f,
+			round % 2 ? "windows-1251" : "UTF-8" };
+		doc.root(XMLB::u8Node{ "r" });
+
+		for (int budget = 1000 + round * 300; budget > 0; )
+		{
+			generate(doc.root(), random, 0, budget);
+		}
+
+		check(is_exact_in_all_formats(doc), "document" + round_message);
+
+		// Old overloads with flags give the same counts as the formats
+		check(XMLB::symbols_count(doc) ==
+			XMLB::symbols_count<XMLB::Tab_format>(doc) &&
+			XMLB::symbols_count(doc, false, true) ==
+			XMLB::symbols_count<XMLB::Output_format<0, false, true>>(doc),
+			"overloads with flags" + round_message);
+
+		const auto& node = *std::next(doc.cbegin(), 1 + random() %
+			(doc.size() - 1));
+
+		XMLB::u8Buffer_sink node_sink;
+		XMLB::save_to<XMLB::Space_format<2>>(node.cbegin(), node.cend(),
+			node_sink);
+
+		check(XMLB::symbols_count<XMLB::Space_format<2>>(node) ==
+			node_sink.size() && XMLB::symbols_count<XMLB::Space_format<2>>(
+			node.cbegin(), node.cend()) == node_sink.size(),
+			"subtree" + round_message);
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Small, empty and char16_t documents
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document empty_doc;
+
+	check(is_exact_in_all_formats(empty_doc), "empty document");
+
+	XMLB::u8Document single_doc;
+	single_doc.root(XMLB::u8Node{ "single" });
+
+	check(is_exact_in_all_formats(single_doc), "single tag");
+
+	std::u16string u16_xml{ u"<r x=\"Ж\"><a>б</a><b/><c><d y=\"\"/></c></r>" };
+	auto u16_doc = XMLB::load_from(u16_xml.begin(), u16_xml.end());
+
+	check(is_exact_in_all_formats(*u16_doc), "char16_t document");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. File gets exactly the output of save_to_string
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document doc;
+	doc.root(XMLB::u8Node{ "r" });
+
+	for (int budget = 5000; budget > 0; )
+	{
+		generate(doc.root(), random, 0, budget);
+	}
+
+	const std::string file_name{ "check_symbols_count.xml" };
+
+	// The longer output goes first, so the shorter one must truncate it
+	XMLB::save_to_file<XMLB::Space_format<4>>(doc, file_name);
+
+	check(read_file(file_name) ==
+		XMLB::save_to_string<XMLB::Space_format<4>>(doc), "spaces in file");
+
+	XMLB::save_to_file<XMLB::Minified_format>(doc, file_name);
+
+	check(read_file(file_name) ==
+		XMLB::save_to_string<XMLB::Minified_format>(doc), "minified file");
+
+	XMLB::save_to_file(doc, file_name);
+
+	check(read_file(file_name) == XMLB::save_to_string(doc), "default file");
+
+	XMLB::save_to_file(*u16_doc, file_name);
+
+	const std::u16string u16_text = XMLB::save_to_string(*u16_doc);
+
+	check(read_file(file_name) == std::string(
+		reinterpret_cast<const char*>(u16_text.data()),
+		u16_text.size() * sizeof(char16_t)), "char16_t file");
+
+	std::remove(file_name.c_str());
+
+	return errors ? 1 : 0;
+}
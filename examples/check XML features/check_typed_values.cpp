@@ -0,0 +1,200 @@
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Typed values are saved as their text
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Document typed_doc;
+	typed_doc.root(XMLB::u8Node{ "r" });
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		auto& node = typed_doc.root().add_child(XMLB::u8Node{ "v" });
+
+		switch (i % 4)
+		{
+		case 0:
+			node.set_value(i * 1000000007LL);
+			break;
+		case 1:
+			node.set_value(i * 0.1);
+			break;
+		case 2:
+			node.set_value(i % 3 == 0);
+			break;
+		default:
+			node.set_value(std::to_string(i));
+			break;
+		}
+	}
+
+	const std::string typed_text = XMLB::save_to_string(typed_doc);
+
+	XMLB::u8Document text_doc;
+	text_doc.root(XMLB::u8Node{ "r" });
+
+	for (auto it = typed_doc.root().first_level_cbegin();
+		it != typed_doc.root().first_level_cend(); ++it)
+	{
+		text_doc.root().add_child(XMLB::u8Node{ "v",
+			std::string{ (*it)->get_value() } });
+	}
+
+	check(typed_text == XMLB::save_to_string(text_doc),
+		"same output as text values");
+	check(XMLB::symbols_count<XMLB::Default_format>(typed_doc) ==
+		typed_text.size(), "exact symbols count");
+	check(XMLB::save_to_string(XMLB::u8Document{ typed_doc }) == typed_text,
+		"copy keeps typed values");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Typed reads convert without text where possible
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Node node{ "a" };
+
+	node.set_value(42);
+
+	check(node.get_value_as<int>() == 42 &&
+		node.get_value_as<double>() == 42.0 &&
+		node.get_value_as<unsigned char>(7) == 42, "integer value");
+
+	node.set_value(300);
+
+	check(node.get_value_as<unsigned char>(7) == 7,
+		"integer out of range of target type");
+
+	node.set_value(-1);
+
+	check(node.get_value_as<unsigned>(5) == 5 && node.get_value() == "-1",
+		"negative value to unsigned");
+
+	node.set_value(1.5);
+
+	check(node.get_value_as<double>() == 1.5 &&
+		node.get_value_as<float>() == 1.5f &&
+		node.get_value_as<int>(3) == 3, "fractional value");
+
+	node.set_value(2.0);
+
+	check(node.get_value_as<int>() == 2, "whole double to integer");
+
+	node.set_value(false);
+
+	check(!node.get_value_as<bool>() && node.get_value() == "false" &&
+		node.get_value_as<int>(9) == 9, "bool value");
+
+	node.set_value(std::numeric_limits<std::uint64_t>::max());
+
+	check(node.get_value() == "18446744073709551615" &&
+		node.get_value_as<std::uint64_t>() ==
+		std::numeric_limits<std::uint64_t>::max(), "uint64 limit");
+
+	node.set_value(0.1f);
+
+	check(node.get_value() == "0.1", "float text");
+
+	XMLB::u8Node zero{ "z", "-0" };
+	const double negative_zero = zero.get_value_as<double>();
+
+	check(zero.get_value_as<int>() == 0 && negative_zero == 0 &&
+		std::signbit(negative_zero), "parsed text value");
+
+	XMLB::u8Node text{ "q", "12" };
+
+	check(text.get_value_as<int>() == 12 && text.get_value_as<long>() == 12,
+		"cached text value");
+
+	text.set_value(std::string{ "x" });
+
+	check(text.get_value_as<int>(1) == 1, "new text value");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Incremental save and concurrent readers
+	//-------------------------------------------------------------------------
+
+	const std::string source
+	{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<r>\n"
+		"\t<a>1</a>\n"
+		"\t<b>2</b>\n"
+		"</r>\n"
+	};
+
+	auto retained_doc = XMLB::load_retained(source);
+	retained_doc->find("a")->set_value(77);
+
+	XMLB::u8Buffer_sink sink;
+	XMLB::save_incremental(*retained_doc, sink);
+
+	check(std::string(sink.data(), sink.size()) ==
+		XMLB::save_to_string(*retained_doc), "typed value in incremental save");
+
+	XMLB::u8Document shared_doc;
+	shared_doc.root(XMLB::u8Node{ "r" });
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		shared_doc.root().add_child(XMLB::u8Node{ "x" }).set_value(i * 1.25);
+	}
+
+	// Text of typed values is made on the first read from any thread
+	const XMLB::u8Document& const_doc = shared_doc;
+
+	std::vector<std::thread> threads;
+	std::vector<std::size_t> sums(8);
+
+	for (std::size_t i = 0; i < sums.size(); ++i)
+	{
+		threads.emplace_back([&const_doc, &sums, i]
+			{
+				std::size_t sum = 0;
+
+				for (auto it = const_doc.root().first_level_cbegin();
+					it != const_doc.root().first_level_cend(); ++it)
+				{
+					sum += (*it)->get_value().size();
+					sum += static_cast<std::size_t>(
+						(*it)->get_value_as<double>());
+				}
+
+				sums[i] = sum;
+			});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (std::size_t i = 1; i < sums.size(); ++i)
+	{
+		check(sums[i] == sums[0], "reader " + std::to_string(i));
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+#include <tuple>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+bool is_invalid_argument(const std::function<void()>& func)
+{
+	try
+	{
+		func();
+	}
+	catch (const std::invalid_argument&)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Template without holes is the same as save_to
+	//-------------------------------------------------------------------------
+
+	std::string xml{ "<a x=\"1\"><b>t</b><c/><d><e q=\"2\"/></d></a>" };
+	auto doc = XMLB::load_from(xml.begin(), xml.end());
+
+	auto plain = XMLB::u8Xml_template::compile(*doc);
+
+	check(plain.hole_size() == 0, "no holes");
+	check(plain.render_to_string() == XMLB::save_to_string(*doc),
+		"default format");
+
+	auto minified =
+		XMLB::Xml_template<char, XMLB::Minified_format>::compile(*doc);
+
+	check(minified.render_to_string() ==
+		XMLB::save_to_string<XMLB::Minified_format>(*doc), "minified format");
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Holes and repeated sections
+	//-------------------------------------------------------------------------
+
+	auto users_template = XMLB::u8Xml_template::compile(std::string_view{
+		"<users count=\"{{count}}\">"
+			"<title>Hi {{who}}! {{who}}</title>"
+			"<user xmlb:repeat=\"users\" id=\"{{id}}\">"
+				"<name>{{name}}</name>"
+				"<tag xmlb:repeat=\"tags\">{{t}}</tag>"
+			"</user>"
+			"<end/>"
+		"</users>" });
+
+	check(users_template.hole_size() == 3 &&
+		users_template.get_hole_name(0) == "count" &&
+		users_template.get_hole_name(1) == "who" &&
+		users_template.get_hole_name(2) == "users", "hole names");
+
+	std::vector<std::tuple<int, std::string, std::vector<std::string>>> users
+	{
+		{ 1, "Tom & \"J\"", { "a", "<b>" } },
+		{ 2, "Ann", {} }
+	};
+
+	// The same document built from nodes with already escaped values
+	XMLB::u8Document expected;
+	expected.root(XMLB::u8Node{ "users" });
+
+	auto& root = expected.root();
+	root.set_attribute("count", "2");
+	root.add_child(XMLB::u8Node{ "title", "Hi &lt;me&gt;! &lt;me&gt;" });
+
+	auto& first_user = root.add_child(XMLB::u8Node{ "user" });
+	first_user.set_attribute("id", "1");
+	first_user.add_child(XMLB::u8Node{ "name", "Tom &amp; \"J\"" });
+	first_user.add_child(XMLB::u8Node{ "tag", "a" });
+	first_user.add_child(XMLB::u8Node{ "tag", "&lt;b&gt;" });
+
+	auto& second_user = root.add_child(XMLB::u8Node{ "user" });
+	second_user.set_attribute("id", "2");
+	second_user.add_child(XMLB::u8Node{ "name", "Ann" });
+
+	root.add_child(XMLB::u8Node{ "end" });
+
+	check(users_template.render_to_string(users.size(), "<me>", users) ==
+		XMLB::save_to_string(expected), "rendered sections");
+
+	auto values_template = XMLB::u8Xml_template::compile(std::string_view{
+		"<a v=\"{{v}}\" w=\"{{b}}\" f=\"{{f}}\">{{c}}</a>" });
+
+	check(values_template.render_to_string(std::string{ "a\"b" }, true, 1.5,
+		'x').find("v=\"a&quot;b\" w=\"true\" f=\"1.5\">x</a>") !=
+		std::string::npos, "escaping and formatting of values");
+
+	XMLB::u8Node node{ "p", "{{v}}" };
+
+	check(XMLB::u8Xml_template::compile(node).render_to_string(42) ==
+		"<p>42</p>\n", "template from node");
+
+	auto wide_template = XMLB::wXml_template::compile(
+		std::wstring_view{ L"<a>{{x}}</a>" });
+
+	check(wide_template.render_to_string(std::wstring{ L"q" }).find(
+		L"<a>q</a>") != std::wstring::npos, "wide template");
+
+	std::vector<int> ids{ 1, 2, 3 };
+	XMLB::u8Buffer_sink sink;
+
+	XMLB::u8Xml_template::compile(std::string_view{
+		"<r><i xmlb:repeat=\"ids\">{{id}}</i></r>" }).render(sink, ids);
+
+	check(std::string(sink.data(), sink.size()).find(
+		"<i>1</i>\n\t<i>2</i>\n\t<i>3</i>") != std::string::npos,
+		"section of plain values");
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Wrong templates and arguments are rejected
+	//-------------------------------------------------------------------------
+
+	check(is_invalid_argument([&]
+		{
+			users_template.render_to_string(1, "x");
+		}), "too few arguments");
+	check(is_invalid_argument([&]
+		{
+			users_template.render_to_string(1, "x", 5);
+		}), "value instead of section");
+	check(is_invalid_argument([]
+		{
+			XMLB::u8Xml_template::compile(std::string_view{ "<a>{{x</a>" });
+		}), "unclosed hole");
+	check(is_invalid_argument([]
+		{
+			XMLB::u8Xml_template::compile(std::string_view{
+				"<a x=\"{{s}}\"><b xmlb:repeat=\"s\"/></a>" });
+		}), "same name for hole and section");
+	check(is_invalid_argument([]
+		{
+			XMLB::u8Xml_template::compile(std::string_view{ "<a" });
+		}), "malformed XML");
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <functional>
+
+#include "XMLB/XMLB.h"
+
+//-----------------------------------------------------------------------------
+
+template<typename WriterT>
+void write_node(const XMLB::u8Node& node, WriterT& writer)
+{
+	writer.start_element(node.get_name());
+
+	for (auto it = node.attr_cbegin(); it != node.attr_cend(); ++it)
+	{
+		writer.attribute(it->name, it->value);
+	}
+
+	if (!node.child_size())
+	{
+		writer.text(node.get_value());
+	}
+
+	for (auto it = node.first_level_cbegin(); it != node.first_level_cend();
+		++it)
+	{
+		write_node(**it, writer);
+	}
+
+	writer.end_element();
+}
+
+//-----------------------------------------------------------------------------
+
+// The writer must produce the same text as save_to for the same tree
+template<typename FormatT>
+bool is_same_as_save_to(const XMLB::u8Document& doc)
+{
+	XMLB::u8Buffer_sink sink;
+	XMLB::Xml_writer<char, XMLB::u8Buffer_sink, FormatT> writer{ sink };
+
+	writer.start_document();
+	write_node(*doc.cbegin(), writer);
+	writer.end_document();
+
+	return std::string(sink.data(), sink.size()) ==
+		XMLB::save_to_string<FormatT>(doc);
+}
+
+//-----------------------------------------------------------------------------
+
+bool is_logic_error(const std::function<void()>& func)
+{
+	try
+	{
+		func();
+	}
+	catch (const std::logic_error&)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	int errors = 0;
+
+	auto check = [&errors](bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << message << std::endl;
+			++errors;
+		}
+	};
+
+	//-------------------------------------------------------------------------
+	// CHECK 1. Writer output is the same as save_to
+	//-------------------------------------------------------------------------
+
+	std::mt19937 random{ 13 };
+
+	for (int round = 0; round < 30; ++round)
+	{
+		XMLB::u8Document doc;
+		doc.root(XMLB::u8Node{ "root" });
+
+		std::vector<XMLB::u8Node*> nodes{ &doc.root() };
+
+		for (int i = random() % 600; i > 0; --i)
+		{
+			XMLB::u8Node node{ "n" + std::to_string(random() % 50) };
+
+			if (random() % 3 == 0)
+			{
+				node.add_attribute(XMLB::u8Node_attribute{ "k",
+					std::to_string(i) });
+			}
+
+			if (random() % 2)
+			{
+				node.set_value("v" + std::to_string(i));
+			}
+
+			nodes.push_back(&nodes[random() % nodes.size()]->add_child(
+				std::move(node)));
+		}
+
+		const std::string message = "round " + std::to_string(round);
+
+		check(is_same_as_save_to<XMLB::Default_format>(doc), message);
+		check(is_same_as_save_to<XMLB::Minified_format>(doc),
+			"minified " + message);
+		check(is_same_as_save_to<XMLB::Space_format<3>>(doc),
+			"spaces " + message);
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 2. Escaping, indents and other symbol types
+	//-------------------------------------------------------------------------
+
+	{
+		XMLB::u8Buffer_sink sink;
+		XMLB::Xml_writer<char, XMLB::u8Buffer_sink> writer{ sink };
+
+		writer.start_element("a");
+		writer.attribute("q", "x\"<&>'y");
+		writer.text("1 < 2 && 3 > \"2\"");
+		writer.text(" more");
+		writer.end_document();
+
+		check(std::string(sink.data(), sink.size()) ==
+			"<a q=\"x&quot;&lt;&amp;&gt;'y\">"
+			"1 &lt; 2 &amp;&amp; 3 &gt; \"2\" more</a>\n", "escaping");
+	}
+
+	{
+		XMLB::u8Buffer_sink sink;
+		XMLB::Xml_writer<char, XMLB::u8Buffer_sink> writer{ sink };
+
+		writer.start_element("r");
+		writer.start_element("c");
+		writer.end_element();
+		writer.start_element("d");
+		writer.start_element("e");
+
+		check(writer.depth() == 3, "depth of open tags");
+
+		writer.end_document();
+
+		check(writer.depth() == 0, "end_document closes all tags");
+		check(std::string(sink.data(), sink.size()) ==
+			"<r>\n\t<c />\n\t<d>\n\t\t<e />\n\t</d>\n</r>\n", "indents");
+	}
+
+	{
+		XMLB::u16Buffer_sink sink;
+		XMLB::Xml_writer<char16_t, XMLB::u16Buffer_sink> writer{ sink };
+
+		writer.start_document();
+		writer.start_element(u"a");
+		writer.text(u"x&y");
+		writer.end_document();
+
+		check(std::u16string(sink.data(), sink.size()) ==
+			u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<a>x&amp;y</a>\n",
+			"char16_t writer");
+	}
+
+	//-------------------------------------------------------------------------
+	// CHECK 3. Calls out of order are rejected
+	//-------------------------------------------------------------------------
+
+	XMLB::u8Buffer_sink sink;
+	XMLB::Xml_writer<char, XMLB::u8Buffer_sink> writer{ sink };
+
+	check(is_logic_error([&] { writer.end_element(); }),
+		"end_element without open tag");
+	check(is_logic_error([&] { writer.attribute("a", "b"); }),
+		"attribute without open tag");
+	check(is_logic_error([&] { writer.text("x"); }),
+		"text without open tag");
+
+	writer.start_element("r");
+	writer.text("v");
+
+	check(is_logic_error([&] { writer.start_element("c"); }),
+		"child after text");
+	check(is_logic_error([&] { writer.attribute("a", "b"); }),
+		"attribute after text");
+
+	writer.end_element();
+
+	check(is_logic_error([&] { writer.start_element("second"); }),
+		"second root");
+	check(is_logic_error([&] { writer.start_document(); }),
+		"declaration after root");
+
+	XMLB::u8Buffer_sink mixed_sink;
+	XMLB::Xml_writer<char, XMLB::u8Buffer_sink> mixed_writer{ mixed_sink };
+
+	mixed_writer.start_element("r");
+	mixed_writer.start_element("c");
+	mixed_writer.end_element();
+
+	check(is_logic_error([&] { mixed_writer.text("x"); }),
+		"text after child");
+
+	XMLB::u8Buffer_sink declared_sink;
+	XMLB::Xml_writer<char, XMLB::u8Buffer_sink> declared_writer{
+		declared_sink };
+
+	declared_writer.start_document();
+
+	check(is_logic_error([&] { declared_writer.start_document(); }),
+		"second declaration");
+	check(is_logic_error([&] { declared_writer.text("x"); }),
+		"text after declaration");
+
+	declared_writer.start_element("r");
+	declared_writer.end_document();
+
+	check(std::string(declared_sink.data(), declared_sink.size()) ==
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<r />\n",
+		"one declaration");
+
+	return errors ? 1 : 0;
+}
@@ -29,7 +29,15 @@
 
 #include "XMLB/detail/XMLB_fwd.h"
 #include "XMLB/XMLB_Node.h"
+#include "XMLB/XMLB_Output_format.h"
 #include "XMLB/XMLB_Document.h"
+#include "XMLB/XMLB_Query.h"
+#include "XMLB/XMLB_Parallel.h"
+#include "XMLB/XMLB_Xml_writer.h"
+#include "XMLB/XMLB_Xml_template.h"
+#include "XMLB/XMLB_Incremental.h"
+#include "XMLB/XMLB_Binary.h"
+#include "XMLB/XMLB_Document_holder.h"
 #include "XMLB/XMLB_utility.h"
 #include "XMLB_Code_converter.h"
 #include "XMLB/detail/XMLB_Diagnostic_iterator.h"
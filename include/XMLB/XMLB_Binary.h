@@ -0,0 +1,716 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_BINARY_H
+#define XMLB_BINARY_H
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <string_view>
+#include <type_traits>
+#include <functional>
+
+#include "XMLB_Node.h"
+#include "XMLB_Sink.h"
+#include "XMLB_Document.h"
+#include "XMLB_Incremental.h"
+#include "XMLB/detail/XMLB_Node_value.h"
+
+
+
+namespace XMLB { namespace detail {
+
+	//*************************************************************************
+	//							BINARY SNAPSHOT FORMAT
+	//*************************************************************************
+	//
+	// Все числа записываются в порядке байт little-endian:
+	//
+	//	заголовок(kBinary_header_size байт):
+	//		char[4]	сигнатура "XMLB"
+	//		u8		версия формата(kBinary_format_version)
+	//		u8		размер символа(sizeof(CharT))
+	//		u16		зарезервировано(0)
+	//		u32		биты версии документа(float)
+	//		u32		индекс строки кодировки
+	//		u32		количество строк
+	//		u32		количество узлов
+	//		u32		количество атрибутов
+	//		u64		количество символов всех строк
+	//	u32[количество строк]			длины строк в символах
+	//	CharT[количество символов]		строки подряд, без разделителей
+	//	u32[4 * количество узлов]		узлы в порядке документа: глубина, 
+	//									индекс имени, индекс значения, 
+	//									количество атрибутов
+	//	u32[2 * количество атрибутов]	атрибуты узлов по порядку: индекс 
+	//									имени, индекс значения
+	//
+	//*************************************************************************
+
+	inline constexpr char kBinary_magic[4] = { 'X', 'M', 'L', 'B' };
+	inline constexpr std::uint8_t kBinary_format_version = 1;
+	inline constexpr std::size_t kBinary_header_size = 36;
+	inline constexpr std::size_t kBinary_node_fields = 4;
+	inline constexpr std::size_t kBinary_attribute_fields = 2;
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Перевести беззнаковое число в порядок байт little-endian и 
+	* обратно
+	**************************************************************************/
+	template<typename T>
+	inline T swap_to_little_endian(T value) noexcept
+	{
+		static_assert(std::is_unsigned_v<T>);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+	|| defined(_WIN32)
+		return value;
+#else
+		T result = 0;
+
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			result = static_cast<T>((result << 8) | (value & 0xFF));
+			value = static_cast<T>(value >> 8);
+		}
+
+		return result;
+#endif
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Беззнаковый тип того же размера, что и символ
+	**************************************************************************/
+	template<typename CharT>
+	using binary_symbol_t = std::conditional_t<sizeof(CharT) == 1, 
+		std::uint8_t, std::conditional_t<sizeof(CharT) == 2, 
+		std::uint16_t, std::conditional_t<sizeof(CharT) == 4, 
+		std::uint32_t, std::uint64_t>>>;
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать массив беззнаковых чисел или символов в байтовый
+	* приёмник
+	**************************************************************************/
+	template<typename T, typename SinkT>
+	inline void write_binary(SinkT& sink, const T* data, std::size_t count)
+	{
+		if (!count)
+		{
+			return;
+		}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+	|| defined(_WIN32)
+		sink.append(reinterpret_cast<const char*>(data), 
+			count * sizeof(T));
+#else
+		using unsigned_type = binary_symbol_t<T>;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			unsigned_type value;
+			std::memcpy(&value, data + i, sizeof(value));
+
+			value = swap_to_little_endian(value);
+
+			sink.append(reinterpret_cast<const char*>(&value), 
+				sizeof(value));
+		}
+#endif
+	}
+
+	//*************************************************************************
+
+	template<typename T, typename SinkT>
+	inline void write_binary(SinkT& sink, T value)
+	{
+		write_binary(sink, &value, 1);
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Прочитать беззнаковое число little-endian из памяти
+	**************************************************************************/
+	template<typename T>
+	inline T read_binary(const char* data) noexcept
+	{
+		T result;
+		std::memcpy(&result, data, sizeof(result));
+
+		return swap_to_little_endian(result);
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Перевести размер в 32 битное число для записи
+	*
+	* @throw std::length_error - если размер не помещается в 32 бита
+	**************************************************************************/
+	inline std::uint32_t to_binary_size(std::size_t size)
+	{
+		if (size > std::numeric_limits<std::uint32_t>::max())
+		{
+			throw std::length_error{ 
+				"Document is too large for the binary format!" };
+		}
+
+		return static_cast<std::uint32_t>(size);
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Таблица строк без повторов для двоичного формата
+	*
+	* @ingroup secondary
+	*
+	* @details Строки не копируются - таблица хранит представления строк
+	* документа, поэтому документ нельзя менять, пока таблица существует.
+	* Индексы строк лежат в открытой хеш таблице без выделения памяти на
+	* каждую строку
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Binary_string_table final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+
+
+
+		/**********************************************************************
+		* @brief Подготовить таблицу к количеству строк без перестроения
+		**********************************************************************/
+		void reserve(std::size_t count)
+		{
+			m_strings.reserve(count);
+			m_hashes.reserve(count);
+
+			if (count * 2 > m_slots.size())
+			{
+				rehash(count * 2);
+			}
+		}
+
+		//*********************************************************************
+
+		/**********************************************************************
+		* @brief Получить индекс строки, добавив её, если её ещё нет
+		**********************************************************************/
+		std::uint32_t add(string_wrapper str)
+		{
+			if ((m_strings.size() + 1) * 2 > m_slots.size())
+			{
+				rehash(m_slots.size() * 2);
+			}
+
+			const std::size_t hash = std::hash<string_wrapper>{}(str);
+			const std::size_t mask = m_slots.size() - 1;
+
+			std::size_t slot = hash & mask;
+
+			//В ячейке хранится индекс строки + 1, ноль - пустая ячейка
+			for (; m_slots[slot]; slot = (slot + 1) & mask)
+			{
+				const std::uint32_t index = m_slots[slot] - 1;
+
+				if (m_hashes[index] == hash && m_strings[index] == str)
+				{
+					return index;
+				}
+			}
+
+			to_binary_size(m_strings.size() + 1);
+
+			const auto result = static_cast<std::uint32_t>(m_strings.size());
+
+			m_strings.push_back(str);
+			m_hashes.push_back(hash);
+			m_slots[slot] = result + 1;
+			m_symbols += str.size();
+
+			return result;
+		}
+
+		//*********************************************************************
+
+		/**********************************************************************
+		* @brief Записать длины строк и сами строки в приёмник
+		**********************************************************************/
+		template<typename SinkT>
+		void write(SinkT& sink) const
+		{
+			std::vector<std::uint32_t> lengths;
+			lengths.reserve(m_strings.size());
+
+			for (const auto& str : m_strings)
+			{
+				lengths.push_back(to_binary_size(str.size()));
+			}
+
+			write_binary(sink, lengths.data(), lengths.size());
+
+			for (const auto& str : m_strings)
+			{
+				write_binary(sink, str.data(), str.size());
+			}
+		}
+
+		//*********************************************************************
+
+		std::size_t size() const noexcept
+		{
+			return m_strings.size();
+		}
+
+		std::uint64_t symbols() const noexcept
+		{
+			return m_symbols;
+		}
+
+	private:
+		void rehash(std::size_t count)
+		{
+			std::size_t capacity = 16;
+
+			while (capacity < count)
+			{
+				capacity *= 2;
+			}
+
+			m_slots.assign(capacity, 0);
+
+			const std::size_t mask = capacity - 1;
+
+			for (std::size_t i = 0; i < m_strings.size(); ++i)
+			{
+				std::size_t slot = m_hashes[i] & mask;
+
+				while (m_slots[slot])
+				{
+					slot = (slot + 1) & mask;
+				}
+
+				m_slots[slot] = static_cast<std::uint32_t>(i + 1);
+			}
+		}
+
+		std::vector<std::uint32_t> m_slots;
+		std::vector<string_wrapper> m_strings;
+		std::vector<std::size_t> m_hashes;
+		std::uint64_t m_symbols = 0;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Прочитать XML документ из двоичного снимка
+	*
+	* @details Все размеры и индексы проверяются до обращения к данным. Узлы
+	* связываются через Node_builder в порядке документа, поэтому каждый
+	* узел сразу получает глубину и количество узлов
+	*
+	* @return документ или nullptr, если данные повреждены
+	**************************************************************************/
+	template<typename CharT>
+	inline typename Document<CharT>::Ptr read_binary_document(
+		const char* data, std::size_t size)
+	{
+		using document_type = Document<CharT>;
+		using node_type = Node<CharT>;
+		using node_pointer = typename node_type::Ptr;
+		using string_type = typename node_type::string_type;
+		using string_wrapper = typename node_type::string_wrapper;
+		using attribute_type = typename node_type::attribute_type;
+
+		if (!data || size < kBinary_header_size ||
+			std::memcmp(data, kBinary_magic, sizeof(kBinary_magic)) != 0 ||
+			read_binary<std::uint8_t>(data + 4) != kBinary_format_version ||
+			read_binary<std::uint8_t>(data + 5) != sizeof(CharT))
+		{
+			return nullptr;
+		}
+
+		const auto version_bits = read_binary<std::uint32_t>(data + 8);
+		const auto encoding_index = read_binary<std::uint32_t>(data + 12);
+		const std::uint64_t string_count = 
+			read_binary<std::uint32_t>(data + 16);
+		const std::uint64_t node_count = 
+			read_binary<std::uint32_t>(data + 20);
+		const std::uint64_t attribute_count = 
+			read_binary<std::uint32_t>(data + 24);
+		const auto symbol_count = read_binary<std::uint64_t>(data + 28);
+
+		//Размеры секций: 32 битные счётчики не переполняют 64 битную сумму,
+		//количество символов проверяется отдельно
+		const std::uint64_t rest = size - kBinary_header_size;
+		const std::uint64_t fixed_bytes = string_count * 4 + 
+			node_count * kBinary_node_fields * 4 + 
+			attribute_count * kBinary_attribute_fields * 4;
+
+		if (encoding_index >= string_count || fixed_bytes > rest ||
+			symbol_count > (rest - fixed_bytes) / sizeof(CharT) ||
+			fixed_bytes + symbol_count * sizeof(CharT) != rest)
+		{
+			return nullptr;
+		}
+
+		const char* lengths = data + kBinary_header_size;
+		const char* symbols = lengths + string_count * 4;
+		const char* nodes = symbols + symbol_count * sizeof(CharT);
+		const char* attributes = nodes + node_count * kBinary_node_fields * 4;
+
+		//Строки однобайтовых символов читаются прямо из данных, остальные -
+		//из выровненной копии
+		string_type aligned_symbols;
+		const CharT* first_symbol = nullptr;
+
+		if constexpr (sizeof(CharT) == 1)
+		{
+			first_symbol = reinterpret_cast<const CharT*>(symbols);
+		}
+		else
+		{
+			aligned_symbols.resize(static_cast<std::size_t>(symbol_count));
+
+			for (std::size_t i = 0; i < aligned_symbols.size(); ++i)
+			{
+				aligned_symbols[i] = static_cast<CharT>(
+					read_binary<binary_symbol_t<CharT>>(
+						symbols + i * sizeof(CharT)));
+			}
+
+			first_symbol = aligned_symbols.data();
+		}
+
+		std::vector<string_wrapper> strings;
+		strings.reserve(static_cast<std::size_t>(string_count));
+
+		std::uint64_t position = 0;
+
+		for (std::size_t i = 0; i < string_count; ++i)
+		{
+			const std::uint64_t length = 
+				read_binary<std::uint32_t>(lengths + i * 4);
+
+			if (length > symbol_count - position)
+			{
+				return nullptr;
+			}
+
+			strings.emplace_back(first_symbol + position, 
+				static_cast<std::size_t>(length));
+
+			position += length;
+		}
+
+		if (position != symbol_count)
+		{
+			return nullptr;
+		}
+
+		float version;
+		std::memcpy(&version, &version_bits, sizeof(version));
+
+		auto result = std::make_unique<document_type>(version, 
+			string_type{ strings[encoding_index] });
+
+		if (!node_count)
+		{
+			return result;
+		}
+
+		node_pointer root{ nullptr };
+		std::uint64_t attribute_position = 0;
+		std::uint32_t previous_depth = 0;
+
+		//Объявлен после корня, чтобы при ошибке завершиться до удаления
+		//корня
+		std::unique_ptr<Node_builder<node_type>> builder;
+
+		for (std::size_t i = 0; i < node_count; ++i)
+		{
+			const char* fields = nodes + i * kBinary_node_fields * 4;
+
+			const auto depth = read_binary<std::uint32_t>(fields);
+			const auto name_index = read_binary<std::uint32_t>(fields + 4);
+			const auto value_index = read_binary<std::uint32_t>(fields + 8);
+			const std::uint64_t node_attributes = 
+				read_binary<std::uint32_t>(fields + 12);
+
+			//Первый узел - корень, остальные спускаются не больше чем на
+			//уровень ниже предыдущего узла
+			const bool is_depth_valid = i ? 
+				depth && depth <= previous_depth + 1 : !depth;
+
+			if (!is_depth_valid || name_index >= string_count || 
+				value_index >= string_count || 
+				node_attributes > attribute_count - attribute_position)
+			{
+				return nullptr;
+			}
+
+			auto node = std::make_unique<node_type>(
+				string_type{ strings[name_index] }, 
+				string_type{ strings[value_index] });
+
+			for (std::uint64_t j = 0; j < node_attributes; ++j)
+			{
+				const char* attribute = attributes + 
+					(attribute_position + j) * kBinary_attribute_fields * 4;
+
+				const auto attribute_name = 
+					read_binary<std::uint32_t>(attribute);
+				const auto attribute_value = 
+					read_binary<std::uint32_t>(attribute + 4);
+
+				if (attribute_name >= string_count || 
+					attribute_value >= string_count)
+				{
+					return nullptr;
+				}
+
+				node->add_attribute(attribute_type{ 
+					string_type{ strings[attribute_name] },
+					string_type{ strings[attribute_value] } });
+			}
+
+			attribute_position += node_attributes;
+			previous_depth = depth;
+
+			if (!i)
+			{
+				root = std::move(node);
+				builder = std::make_unique<Node_builder<node_type>>(*root);
+
+				continue;
+			}
+
+			while (builder->level() >= depth)
+			{
+				builder->close();
+			}
+
+			builder->open(std::move(node));
+		}
+
+		if (attribute_position != attribute_count)
+		{
+			return nullptr;
+		}
+
+		builder.reset();
+
+		result->root(std::move(root));
+
+		return result;
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+
+
+namespace XMLB
+{
+
+	/// @name Функции двоичного снимка
+	/// @{
+	/**************************************************************************
+	* @brief Записать XML документ в приёмник в двоичном формате
+	* 
+	* @ingroup general
+	* 
+	* @details Формат версионный и не зависит от порядка байт машины. Имена,
+	* значения и атрибуты хранятся в общей таблице строк без повторов, а 
+	* структура - плоскими массивами индексов в порядке документа. 
+	* Типизированные значения записываются текстом, как в save_to. Снимок
+	* читается load_binary с тем же типом символов
+	* 
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип байтового приёмника(Buffer_sink<char>, 
+	* Fd_sink<char> и т.п.)
+	*
+	* @param document - XML Документа
+	* @param sink - приёмник, в который будут заноситься данные
+	*
+	* @throw std::length_error - если количество строк, узлов, атрибутов или
+	* длина строки не помещаются в 32 бита
+	**************************************************************************/
+	template<typename CharT, typename SinkT,
+		std::enable_if_t<detail::is_sink_to_symbol_v<SinkT, char>,
+		std::nullptr_t> = nullptr>
+	inline void save_binary(const Document<CharT>& document, SinkT& sink)
+	{
+		using node_type = Node<CharT>;
+
+		detail::Binary_string_table<CharT> strings;
+
+		std::vector<std::uint32_t> nodes;
+		std::vector<std::uint32_t> attributes;
+
+		const float version = document.get_version();
+		std::uint32_t version_bits;
+		std::memcpy(&version_bits, &version, sizeof(version_bits));
+
+		const std::uint32_t encoding = 
+			strings.add(document.get_encoding_type());
+
+		if (!document.is_empty())
+		{
+			nodes.reserve(document.size() * detail::kBinary_node_fields);
+			strings.reserve(document.size());
+
+			for (auto first = document.cbegin(), last = document.cend(); 
+				first != last; ++first)
+			{
+				const node_type& node = *first;
+
+				nodes.push_back(first.get_offset());
+				nodes.push_back(strings.add(node.get_name()));
+				nodes.push_back(strings.add(
+					detail::Value_access<CharT>::get(node).get_text()));
+				nodes.push_back(detail::to_binary_size(node.attr_size()));
+
+				for (auto attr = node.attr_cbegin(), 
+					attr_last = node.attr_cend(); attr != attr_last; ++attr)
+				{
+					attributes.push_back(strings.add(attr->name));
+					attributes.push_back(strings.add(attr->value));
+				}
+			}
+		}
+
+		const char header[] = { detail::kBinary_magic[0], 
+			detail::kBinary_magic[1], detail::kBinary_magic[2], 
+			detail::kBinary_magic[3], 
+			static_cast<char>(detail::kBinary_format_version),
+			static_cast<char>(sizeof(CharT)), 0, 0 };
+
+		sink.append(header, sizeof(header));
+
+		detail::write_binary(sink, version_bits);
+		detail::write_binary(sink, encoding);
+		detail::write_binary(sink, detail::to_binary_size(strings.size()));
+		detail::write_binary(sink, detail::to_binary_size(
+			nodes.size() / detail::kBinary_node_fields));
+		detail::write_binary(sink, detail::to_binary_size(
+			attributes.size() / detail::kBinary_attribute_fields));
+		detail::write_binary(sink, strings.symbols());
+
+		strings.write(sink);
+
+		detail::write_binary(sink, nodes.data(), nodes.size());
+		detail::write_binary(sink, attributes.data(), attributes.size());
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Прочитать XML документ из двоичного снимка в памяти
+	* 
+	* @ingroup general
+	* 
+	* @details Данные не разбираются как текст: размеры секций и индексы
+	* проверяются, после чего узлы создаются прямо из таблицы строк
+	* 
+	* @tparam CharT - тип символов, с которым снимок был записан
+	*
+	* @param data - данные, записанные save_binary
+	*
+	* @return в случае успешного завершения функции - документ с XML узлами. В
+	* противном случае(другая версия формата, другой размер символов, 
+	* повреждённые данные), документ со значением nullptr
+	**************************************************************************/
+	template<typename CharT = char>
+	[[nodiscard]] inline typename Document<CharT>::Ptr load_binary(
+		std::string_view data)
+	{
+		return detail::read_binary_document<CharT>(data.data(), data.size());
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Прочитать XML документ из файла с двоичным снимком
+	* 
+	* @ingroup general
+	* 
+	* @details Файл отображается в память через mmap и освобождается после
+	* чтения
+	* 
+	* @tparam CharT - тип символов, с которым снимок был записан
+	*
+	* @param path - путь к файлу
+	*
+	* @return в случае успешного завершения функции - документ с XML узлами. В
+	* противном случае, документ со значением nullptr
+	*
+	* @throw std::system_error - если файл не удалось открыть или отобразить
+	**************************************************************************/
+	template<typename CharT = char>
+	[[nodiscard]] inline typename Document<CharT>::Ptr load_binary_file(
+		const std::filesystem::path& path)
+	{
+		const detail::Retained_source<char> source{ path };
+
+		return detail::read_binary_document<CharT>(source.data(), 
+			source.size());
+	}
+
+	//*************************************************************************
+	/// @}
+
+} // namespace XMLB
+
+#endif // !XMLB_BINARY_H
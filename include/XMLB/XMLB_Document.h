@@ -28,11 +28,18 @@
 #define XMLB_DOCUMENT_H
 
 #include <stack>
+#include <vector>
 #include <memory>
+#include <utility>
 #include <stdexcept>
+#include <filesystem>
+#include <system_error>
 
 #include "XMLB_Node.h"
-#include "XMLB_Utility.h"
+#include "XMLB_Frozen_document.h"
+#include "XMLB_Sink.h"
+#include "XMLB_Output_format.h"
+#include "XMLB_utility.h"
 #include "XMLB/detail/XMLB_Decorator.h"
 #include "XMLB/detail/parser/XMLB_Parser_states.h"
 #include "XMLB/detail/parser/XMLB_Parser_functors.h"
@@ -41,6 +48,13 @@
 #include "XMLB/detail/traits/XMLB_Type_special_general_traits.h"
 #include "XMLB/detail/utilities/XMLB_sup_functions.h"
 
+#ifdef XMLB_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#else
+#include <fstream>
+#endif
+
 
 
 namespace XMLB
@@ -76,6 +90,9 @@ namespace XMLB
 		using iterator = typename Node<symbol_type>::iterator;
 		using const_iterator = typename Node<symbol_type>::const_iterator;
 
+		using find_range = typename Node<symbol_type>::find_range;
+		using find_const_range = typename Node<symbol_type>::find_const_range;
+
 
 
 		/// @name Конструкторы, деструктор
@@ -343,7 +360,7 @@ namespace XMLB
 			const_iterator offset = const_iterator{ nullptr }) const
 		{
 			return is_empty() ? cend() :
-				m_parent->begin()->find(container, offset);
+				std::as_const(*m_parent->begin()).find(container, offset);
 		}
 
 		//*********************************************************************
@@ -382,7 +399,7 @@ namespace XMLB
 				const_iterator offset = const_iterator{ nullptr }) const
 		{
 			return is_empty() ? cend() :
-				m_parent->begin()->find(container, offset);
+				std::as_const(*m_parent->begin()).find(container, offset);
 		}
 
 		//*********************************************************************
@@ -429,737 +446,2261 @@ namespace XMLB
 				const_iterator offset = const_iterator{ nullptr }) const
 		{
 			return is_empty() ? cend() :
-				m_parent->begin()->find(container, offset);
+				std::as_const(*m_parent->begin()).find(container, offset);
 		}
 
 		//*********************************************************************
-		/// @}
 
 
 
-		/// @name Вспомагательные методы
-		/// @{
 		/**********************************************************************
-		* @brief Удалить все узлы, включая root узел
+		* @brief Найти узел по пути из имён дочерних узлов
+		*
+		* @details Первое имя ищется среди дочерних узлов root узла, каждое
+		* следующее - только среди дочерних узлов найденного узла. Подробнее
+		* в Node::find_child_path()
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return итератор на узел - если он был найден. В противном случае
+		* возвращает итератор указывающий на end()
 		**********************************************************************/
-		void clear() noexcept;
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-		/**********************************************************************
-		* @brief Получить количество узлов, включая root узел
-		* 
-		* @return количество узлов
-		**********************************************************************/
-		size_type size() const noexcept;
+			detail::is_has_begin_and_end_v<ContT>&&
 
-		/**********************************************************************
-		* @brief Проверить, пустой ли документа
-		* 
-		* @return true - если нет ниодного узла, включая root узла. В противном
-		* случае false
-		**********************************************************************/
-		bool is_empty() const noexcept;
-		operator bool() const noexcept;
+			detail::is_has_value_type_v<ContT> &&
 
-		/**********************************************************************
-		* @brief Обменять данные
-		*
-		* @param doc - правый Document
-		**********************************************************************/
-		void swap(Document& doc) noexcept;
-		/// @}
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	private:
-		std::unique_ptr<node_type> m_parent;
-		string_type m_encoding_type;
-		float m_version;
-	};
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	//*************************************************************************
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
+			std::nullptr_t> = nullptr>
+		iterator find_child_path(const ContT& container)
+		{
+			return is_empty() ? end() :
+				m_parent->begin()->find_child_path(container);
+		}
 
-	//*************************************************************************
-	//							DOCUMENT IMPLEMENTATION
-	//*************************************************************************
+		//*********************************************************************
 
-	template<typename CharT>
-	inline Document<CharT>::Document(float version,
-		const string_type& encoding_type)
-		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
-			typename node_type::string_type{}) },
-		m_encoding_type{ encoding_type },
-		m_version{ version }
-	{
 
-	}
 
-	//*************************************************************************
+		/**********************************************************************
+		* @brief Найти узел по пути из имён дочерних узлов
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return константный итератор на узел - если он был найден. 
+		* В противном случае возвращает константный итератор указывающий 
+		* на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	template<typename CharT>
-	inline Document<CharT>::Document(float version,
-		string_type&& encoding_type)
-		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
-			typename node_type::string_type{}) },
-		m_encoding_type{ std::move(encoding_type) },
-		m_version{ version }
-	{
-	}
+			detail::is_has_begin_and_end_v<ContT>&&
 
-	//*************************************************************************
+			detail::is_has_value_type_v<ContT> &&
 
-	template<typename CharT>
-	inline Document<CharT>::Document(const Document& doc)
-		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
-			*doc.m_parent) },
-		m_encoding_type{ doc.m_encoding_type },
-		m_version{ doc.m_version }
-	{
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	}
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	//*************************************************************************
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-	template<typename CharT>
-	inline Document<CharT>& Document<CharT>::operator=(const Document& doc)
-	{
-		if (this != &doc)
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		const_iterator find_child_path(const ContT& container) const
 		{
-			*this = Document{ doc };
+			return is_empty() ? cend() :
+				std::as_const(*m_parent->begin()).find_child_path(container);
 		}
 
-		return *this;
-	}
-
-	//*************************************************************************
-
-	template<typename CharT>
-	inline Document<CharT>::Document(Document&& doc) noexcept
-		:m_parent{ std::move(doc.m_parent) },
-		m_encoding_type{ std::move(doc.m_encoding_type) },
-		m_version{ std::move(doc.m_version) }
-	{
+		//*********************************************************************
 
-	}
 
-	//*************************************************************************
 
-	template<typename CharT>
-	inline Document<CharT>& Document<CharT>::operator=(Document&& doc) noexcept
-	{
-		if (this != &doc)
+		/**********************************************************************
+		* @brief Найти все узлы с именем
+		*
+		* @details Подробнее в Node::find_all()
+		*
+		* @param name - имя узлов
+		*
+		* @return ленивый диапазон найденных узлов в порядке документа
+		**********************************************************************/
+		find_range find_all(string_wrapper name)
 		{
-			swap(doc);
+			return is_empty() ? find_range{ nullptr, nullptr } :
+				m_parent->begin()->find_all(name);
 		}
 
-		return *this;
-	}
-
-	//*************************************************************************
+		//*********************************************************************
 
-	template<typename CharT>
-	inline void Document<CharT>::root(const node_type& node)
-	{
-		if (m_parent->child_size())
+		find_const_range find_all(string_wrapper name) const
 		{
-			m_parent->erase_child(0);
+			return is_empty() ? find_const_range{ nullptr, nullptr } :
+				std::as_const(*m_parent->begin()).find_all(name);
 		}
 
-		m_parent->add_child(node);
-	}
+		//*********************************************************************
 
-	//*************************************************************************
 
-	template<typename CharT>
-	inline void Document<CharT>::root(node_type&& node)
-	{
-		if (m_parent->child_size())
-		{
-			m_parent->erase_child(0);
-		}
 
-		m_parent->add_child(std::move(node));
-	}
+		/**********************************************************************
+		* @brief Найти все узлы по пути из имён
+		*
+		* @details Подробнее в Node::find_all()
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return ленивый диапазон найденных узлов в порядке документа
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	//*************************************************************************
+			detail::is_has_begin_and_end_v<ContT>&&
 
-	template<typename CharT>
-	inline void Document<CharT>::root(node_pointer node)
-	{
-		if (m_parent->child_size())
-		{
-			m_parent->erase_child(0);
-		}
+			detail::is_has_value_type_v<ContT> &&
 
-		m_parent->add_child(std::move(node));
-	}
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	//*************************************************************************
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	template<typename CharT>
-	inline typename Document<CharT>::node_type& Document<CharT>::root() &
-	{
-		if (is_empty())
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		find_range find_all(const ContT& container)
 		{
-			throw std::out_of_range{
-				"The document is empty! Can't get root node"};
+			return is_empty() ? find_range{ nullptr, nullptr } :
+				m_parent->begin()->find_all(container);
 		}
 
-		return *m_parent->begin();
-	}
+		//*********************************************************************
 
-	//*************************************************************************
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	template<typename CharT>
-	inline const typename Document<CharT>::node_type& Document<CharT>::root() 
-		const &
-	{
-		if (is_empty())
-		{
-			throw std::out_of_range{
-				"The document is empty! Can't get root node" };
-		}
+			detail::is_has_begin_and_end_v<ContT>&&
 
-		return m_parent->begin();
-	}
+			detail::is_has_value_type_v<ContT> &&
 
-	//*************************************************************************
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	template<typename CharT>
-	inline void Document<CharT>::set_version(float version) noexcept
-	{
-		m_version = version;
-	}
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	//*************************************************************************
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-	template<typename CharT>
-	inline float Document<CharT>::get_version() const noexcept
-	{
-		return m_version;
-	}
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
-	//*************************************************************************
+			std::nullptr_t> = nullptr>
+		find_const_range find_all(const ContT& container) const
+		{
+			return is_empty() ? find_const_range{ nullptr, nullptr } :
+				std::as_const(*m_parent->begin()).find_all(container);
+		}
 
-	template<typename CharT>
-	inline void Document<CharT>::set_encoding_type(
-		const string_type& encoding_type)
-	{
-		m_encoding_type = encoding_type;
-	}
+		//*********************************************************************
 
-	//*************************************************************************
 
-	template<typename CharT>
+
+		/**********************************************************************
+		* @brief Найти первый узел с любым из имён
+		*
+		* @details Подробнее в Node::find_any()
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов
+		* @param offset - итератор, с которого начать искать
+		*
+		* @return итератор на узел - если он был найден. В противном случае
+		* возвращает итератор указывающий на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+
+			detail::is_has_begin_and_end_v<ContT>&&
+
+			detail::is_has_value_type_v<ContT> &&
+
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		iterator find_any(const ContT& container,
+			const_iterator offset = const_iterator{ nullptr })
+		{
+			return is_empty() ? end() :
+				m_parent->begin()->find_any(container, offset);
+		}
+
+		//*********************************************************************
+
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+
+			detail::is_has_begin_and_end_v<ContT>&&
+
+			detail::is_has_value_type_v<ContT> &&
+
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		const_iterator find_any(const ContT& container,
+			const_iterator offset = const_iterator{ nullptr }) const
+		{
+			return is_empty() ? cend() :
+				std::as_const(*m_parent->begin()).find_any(container, offset);
+		}
+
+		//*********************************************************************
+		/// @}
+
+
+
+		/// @name Методы для работы с индексами
+		/// @{
+		/**********************************************************************
+		* @brief Создать индекс узлов по имени
+		*
+		* @details После создания find() по имени, find() со смещением и
+		* поиск по списку вложенных имён не обходят узлы, а ищут их в
+		* индексе. Индекс обновляется при добавлении узлов в конец документа,
+		* удалении узлов и смене имени. Добавление узлов в середину документа
+		* или обмен узлами делают индекс устаревшим - он будет перестроен 
+		* целиком, за O(n), при следующем неконстантном find(). Поэтому 
+		* вставки в середину лучше делать подряд, между поисками. 
+		* Константный find() по устаревшему индексу обходит узлы, как и без
+		* индекса.
+		**********************************************************************/
+		void create_name_index();
+
+		/**********************************************************************
+		* @brief Удалить индекс узлов по имени
+		**********************************************************************/
+		void drop_name_index() noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, создан ли индекс узлов по имени
+		*
+		* @return true - если индекс создан
+		**********************************************************************/
+		bool has_name_index() const noexcept;
+
+		/**********************************************************************
+		* @brief Создать сводку имён поддеревьев
+		*
+		* @details Лёгкая замена индекса по имени: для каждого узла хранится
+		* 64-битный фильтр имён его поддерева(8 байт на узел). find() по 
+		* имени и по списку вложенных имён пропускает поддеревья, в которых
+		* искомого имени точно нет. Сводка обновляется и устаревает так же,
+		* как индекс по имени. Если создан и индекс, поиск идёт по индексу
+		**********************************************************************/
+		void create_name_summary();
+
+		/**********************************************************************
+		* @brief Удалить сводку имён поддеревьев
+		**********************************************************************/
+		void drop_name_summary() noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, создана ли сводка имён поддеревьев
+		*
+		* @return true - если сводка создана
+		**********************************************************************/
+		bool has_name_summary() const noexcept;
+
+		/**********************************************************************
+		* @brief Создать индекс узлов по значению атрибута
+		*
+		* @details После создания find_by_attribute() по этому атрибуту
+		* находит узел по значению без обхода узлов. Индекс обновляется при
+		* добавлении и удалении узлов, а также при изменении атрибутов через
+		* add_attribute(), set_attribute() и erase_attribute(). Изменение
+		* значения атрибута напрямую через итератор атрибута индекс не 
+		* обновляет. Если индекс с таким атрибутом уже есть, он заменяется
+		*
+		* @param attribute_name - название атрибута
+		* @param unique - запретить узлам иметь одинаковое значение 
+		* атрибута. Добавление узла или атрибута, которое нарушает это, 
+		* бросает std::invalid_argument и ничего не меняет
+		*
+		* @throw std::invalid_argument - если unique = true, а в документе 
+		* уже есть узлы с одинаковым значением атрибута
+		**********************************************************************/
+		void create_attribute_index(const string_type& attribute_name, 
+			bool unique = false);
+
+		/**********************************************************************
+		* @brief Удалить индекс узлов по значению атрибута
+		*
+		* @param attribute_name - название атрибута
+		**********************************************************************/
+		void drop_attribute_index(const string_type& attribute_name) noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, создан ли индекс узлов по значению атрибута
+		*
+		* @param attribute_name - название атрибута
+		*
+		* @return true - если индекс создан
+		**********************************************************************/
+		bool has_attribute_index(const string_type& attribute_name) const 
+			noexcept;
+
+		/**********************************************************************
+		* @brief Найти узел по значению атрибута
+		*
+		* @details Если для атрибута создан индекс, узел ищется в индексе, в
+		* противном случае - обходом всех узлов, включая root узел. Если 
+		* подходят несколько узлов, возвращается первый в порядке документа
+		*
+		* @param attribute_name - название атрибута
+		* @param value - значение атрибута
+		*
+		* @return итератор на узел - если он был найден. В противном случае
+		* возвращает итератор указывающий на end()
+		**********************************************************************/
+		iterator find_by_attribute(const string_type& attribute_name,
+			const string_type& value);
+
+		/**********************************************************************
+		* @brief Найти узел по значению атрибута
+		*
+		* @param attribute_name - название атрибута
+		* @param value - значение атрибута
+		*
+		* @return константный итератор на узел - если он был найден. В 
+		* противном случае возвращает константный итератор указывающий на 
+		* end()
+		**********************************************************************/
+		const_iterator find_by_attribute(const string_type& attribute_name,
+			const string_type& value) const;
+
+		/**********************************************************************
+		* @brief Проверить, хранит ли документ исходный текст для 
+		* save_incremental
+		*
+		* @details Исходный текст сохраняют load_retained и 
+		* load_retained_file, если структура текста совпала с деревом
+		*
+		* @return true - если исходный текст хранится
+		**********************************************************************/
+		bool has_retained_source() const noexcept;
+
+		/**********************************************************************
+		* @brief Освободить исходный текст и карту участков узлов
+		**********************************************************************/
+		void drop_retained_source() noexcept;
+		/// @}
+
+
+
+		/// @name Методы порядка документа
+		/// @{
+		/**********************************************************************
+		* @brief Проверить, находится ли узел в поддереве другого узла
+		*
+		* @details Неконстантные методы этой группы назначают узлам 
+		* порядковые номера, если они устарели, и дальше отвечают за O(1).
+		* Последний узел поддерева каждый узел знает всегда. Номера 
+		* поддерживаются при добавлении узлов в конец документа и удалении
+		* узлов, а добавление в середину документа делает их устаревшими до
+		* следующего вызова. Константные методы пользуются номерами, только
+		* если они действительны, иначе поднимаются по родителям. Оба узла
+		* должны быть из этого документа
+		*
+		* @param ancestor - предполагаемый предок
+		* @param node - проверяемый узел
+		*
+		* @return true - если ancestor является предком node
+		**********************************************************************/
+		bool is_ancestor_of(const node_type& ancestor, const node_type& node);
+		bool is_ancestor_of(const node_type& ancestor, const node_type& node)
+			const noexcept;
+
+		/**********************************************************************
+		* @brief Сравнить положение узлов в порядке документа
+		*
+		* @param lhs - левый узел
+		* @param rhs - правый узел
+		*
+		* @return отрицательное число - если lhs идёт раньше rhs, 0 - если 
+		* это один узел, положительное число - если lhs идёт позже rhs
+		**********************************************************************/
+		int compare_document_order(const node_type& lhs, 
+			const node_type& rhs);
+		int compare_document_order(const node_type& lhs, 
+			const node_type& rhs) const noexcept;
+
+		/**********************************************************************
+		* @brief Пропустить поддерево узла
+		*
+		* @param node - итератор на узел
+		*
+		* @return итератор на первый узел после поддерева node в порядке
+		* документа
+		**********************************************************************/
+		iterator skip_subtree(const_iterator node) noexcept;
+		const_iterator skip_subtree(const_iterator node) const noexcept;
+		/// @}
+
+
+
+		/// @name Вспомагательные методы
+		/// @{
+		/**********************************************************************
+		* @brief Удалить все узлы, включая root узел
+		**********************************************************************/
+		void clear() noexcept;
+
+		/**********************************************************************
+		* @brief Получить количество узлов, включая root узел
+		* 
+		* @return количество узлов
+		**********************************************************************/
+		size_type size() const noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, пустой ли документа
+		* 
+		* @return true - если нет ниодного узла, включая root узла. В противном
+		* случае false
+		**********************************************************************/
+		bool is_empty() const noexcept;
+		operator bool() const noexcept;
+
+		/**********************************************************************
+		* @brief Обменять данные
+		*
+		* @param doc - правый Document
+		**********************************************************************/
+		void swap(Document& doc) noexcept;
+
+		/**********************************************************************
+		* @brief Создать неизменяемую копию документа
+		*
+		* @details Копия хранит узлы, атрибуты и строки в трёх непрерывных
+		* буферах, не имеет изменяемых членов и кешей, поэтому её можно
+		* без блокировок читать из любого количества потоков. Изменения 
+		* документа после вызова на копию не влияют
+		*
+		* @return неизменяемая копия документа
+		**********************************************************************/
+		std::shared_ptr<const Frozen_document<symbol_type>> freeze() const;
+		/// @}
+
+	private:
+		typename node_type::tree_node* find_attribute_node(
+			const string_type& attribute_name, const string_type& value,
+			bool is_update) const;
+
+		bool update_order();
+		bool is_order_valid() const noexcept;
+		typename node_type::tree_node* find_subtree_end(const_iterator node)
+			const noexcept;
+
+		/**********************************************************************
+		* @brief Получить общие данные документа, создав их при 
+		* необходимости. Все узлы получают на них ссылку
+		**********************************************************************/
+		detail::Node_context<node_type>& get_context();
+
+		/**********************************************************************
+		* @brief Удалить общие данные документа, если в них ничего не 
+		* осталось
+		**********************************************************************/
+		void release_context() noexcept;
+
+		/**********************************************************************
+		* @brief Запомнить исходный текст, из которого загружен документ
+		*
+		* @tparam DecorT - тип декоратора
+		* @param source - исходный текст
+		* @param decorator - декоратор, с которым текст был прочитан
+		*
+		* @return true - если структура текста совпала с деревом
+		**********************************************************************/
+		template<typename DecorT>
+		bool retain_source(
+			std::shared_ptr<const detail::Retained_source<symbol_type>> source,
+			const DecorT& decorator);
+
+		const detail::Source_map<node_type>* get_source_map() const noexcept;
+
+		template<typename T>
+		friend class Query;
+
+		template<typename T>
+		friend class detail::Source_access;
+
+	private:
+		std::unique_ptr<node_type> m_parent;
+		string_type m_encoding_type;
+		float m_version;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							DOCUMENT IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>::Document(float version,
+		const string_type& encoding_type)
+		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
+			typename node_type::string_type{}) },
+		m_encoding_type{ encoding_type },
+		m_version{ version }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>::Document(float version,
+		string_type&& encoding_type)
+		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
+			typename node_type::string_type{}) },
+		m_encoding_type{ std::move(encoding_type) },
+		m_version{ version }
+	{
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>::Document(const Document& doc)
+		:m_parent{ std::make_unique<typename Document<CharT>::node_type>(
+			*doc.m_parent) },
+		m_encoding_type{ doc.m_encoding_type },
+		m_version{ doc.m_version }
+	{
+		if (doc.m_parent->m_context)
+		{
+			get_context().assign_indexes(*doc.m_parent->m_context,
+				&m_parent->m_tree_node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>& Document<CharT>::operator=(const Document& doc)
+	{
+		if (this != &doc)
+		{
+			*this = Document{ doc };
+		}
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>::Document(Document&& doc) noexcept
+		:m_parent{ std::move(doc.m_parent) },
+		m_encoding_type{ std::move(doc.m_encoding_type) },
+		m_version{ std::move(doc.m_version) }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>& Document<CharT>::operator=(Document&& doc) noexcept
+	{
+		if (this != &doc)
+		{
+			swap(doc);
+		}
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::root(const node_type& node)
+	{
+		if (m_parent->child_size())
+		{
+			m_parent->erase_child(0);
+		}
+
+		m_parent->add_child(node);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::root(node_type&& node)
+	{
+		if (m_parent->child_size())
+		{
+			m_parent->erase_child(0);
+		}
+
+		m_parent->add_child(std::move(node));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::root(node_pointer node)
+	{
+		if (m_parent->child_size())
+		{
+			m_parent->erase_child(0);
+		}
+
+		m_parent->add_child(std::move(node));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::node_type& Document<CharT>::root() &
+	{
+		if (is_empty())
+		{
+			throw std::out_of_range{
+				"The document is empty! Can't get root node"};
+		}
+
+		return *m_parent->begin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Document<CharT>::node_type& Document<CharT>::root() 
+		const &
+	{
+		if (is_empty())
+		{
+			throw std::out_of_range{
+				"The document is empty! Can't get root node" };
+		}
+
+		return *m_parent->cbegin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::set_version(float version) noexcept
+	{
+		m_version = version;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline float Document<CharT>::get_version() const noexcept
+	{
+		return m_version;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::set_encoding_type(
+		const string_type& encoding_type)
+	{
+		m_encoding_type = encoding_type;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
 	inline void Document<CharT>::set_encoding_type(string_type&& encoding_type)
 		noexcept
 	{
-		m_encoding_type = std::move(encoding_type);
+		m_encoding_type = std::move(encoding_type);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::string_wrapper 
+		Document<CharT>::get_encoding_type() const noexcept
+	{
+		return string_wrapper{ m_encoding_type };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::iterator Document<CharT>::begin() noexcept
+	{
+		return m_parent->begin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::iterator Document<CharT>::end() noexcept
+	{
+		return m_parent->end();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::const_iterator Document<CharT>::begin() 
+		const noexcept
+	{
+		return m_parent->cbegin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::const_iterator Document<CharT>::end() 
+		const noexcept
+	{
+		return m_parent->cend();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::const_iterator Document<CharT>::cbegin() 
+		const noexcept
+	{
+		return m_parent->cbegin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::const_iterator Document<CharT>::cend()
+		const noexcept
+	{
+		return m_parent->cend();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::create_name_index()
+	{
+		get_context().create_name_index(&m_parent->m_tree_node);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::drop_name_index() noexcept
+	{
+		if (m_parent->m_context)
+		{
+			m_parent->m_context->drop_name_index();
+
+			release_context();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::has_name_index() const noexcept
+	{
+		return m_parent->m_context && m_parent->m_context->has_name_index();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::create_name_summary()
+	{
+		get_context().create_name_summary(&m_parent->m_tree_node);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::drop_name_summary() noexcept
+	{
+		if (m_parent->m_context)
+		{
+			m_parent->m_context->drop_name_summary();
+
+			release_context();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::has_name_summary() const noexcept
+	{
+		return m_parent->m_context && 
+			m_parent->m_context->has_name_summary();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::create_attribute_index(
+		const string_type& attribute_name, bool unique)
+	{
+		try
+		{
+			get_context().create_attribute_index(&m_parent->m_tree_node, 
+				attribute_name, unique);
+		}
+		catch (...)
+		{
+			release_context();
+
+			throw;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::drop_attribute_index(
+		const string_type& attribute_name) noexcept
+	{
+		if (m_parent->m_context)
+		{
+			m_parent->m_context->drop_attribute_index(attribute_name);
+
+			release_context();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::has_attribute_index(
+		const string_type& attribute_name) const noexcept
+	{
+		return m_parent->m_context && 
+			m_parent->m_context->has_attribute_index(attribute_name);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::has_retained_source() const noexcept
+	{
+		return m_parent->m_context && m_parent->m_context->has_source_map();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::drop_retained_source() noexcept
+	{
+		if (m_parent->m_context)
+		{
+			m_parent->m_context->drop_source_map();
+
+			release_context();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::iterator 
+		Document<CharT>::find_by_attribute(const string_type& attribute_name,
+		const string_type& value)
+	{
+		auto result = find_attribute_node(attribute_name, value, true);
+
+		return result ? iterator{ result } : end();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::const_iterator 
+		Document<CharT>::find_by_attribute(const string_type& attribute_name,
+		const string_type& value) const
+	{
+		auto result = find_attribute_node(attribute_name, value, false);
+
+		return result ? const_iterator{ result } : cend();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::node_type::tree_node* 
+		Document<CharT>::find_attribute_node(const string_type& attribute_name,
+		const string_type& value, bool is_update) const
+	{
+		auto context = m_parent->m_context.get();
+
+		if (context && is_update)
+		{
+			context->update(&m_parent->m_tree_node);
+		}
+
+		auto index = context ? 
+			context->get_attribute_index(attribute_name) : nullptr;
+
+		if (index)
+		{
+			auto nodes = index->find(value);
+
+			if (!nodes)
+			{
+				return nullptr;
+			}
+
+			if (nodes->size() == 1)
+			{
+				return nodes->front();
+			}
+
+			//Из нескольких узлов первый в порядке документа выбирается по
+			//порядковым номерам, если они действительны
+			if (context->is_order_valid())
+			{
+				return *std::min_element(nodes->begin(), nodes->end(),
+					[](auto&& lhs, auto&& rhs)
+					{
+						return lhs->order < rhs->order;
+					});
+			}
+		}
+
+		for (auto first = m_parent->cbegin(), last = m_parent->cend();
+			first != last; ++first)
+		{
+			auto attribute = first->find_attribute(attribute_name);
+
+			if (attribute != first->attr_cend() && attribute->value == value)
+			{
+				return &first->m_tree_node;
+			}
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::is_ancestor_of(const node_type& ancestor,
+		const node_type& node)
+	{
+		update_order();
+
+		return std::as_const(*this).is_ancestor_of(ancestor, node);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::is_ancestor_of(const node_type& ancestor,
+		const node_type& node) const noexcept
+	{
+		auto&& lhs = ancestor.m_tree_node;
+		auto&& rhs = node.m_tree_node;
+
+		if (is_order_valid())
+		{
+			return lhs.order < rhs.order && rhs.order <= lhs.last->order;
+		}
+
+		for (auto current = rhs.parent; current; current = current->parent)
+		{
+			if (current == &lhs)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline int Document<CharT>::compare_document_order(const node_type& lhs,
+		const node_type& rhs)
+	{
+		update_order();
+
+		return std::as_const(*this).compare_document_order(lhs, rhs);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline int Document<CharT>::compare_document_order(const node_type& lhs,
+		const node_type& rhs) const noexcept
+	{
+		using tree_node = typename node_type::tree_node;
+
+		if (&lhs == &rhs)
+		{
+			return 0;
+		}
+
+		if (is_order_valid())
+		{
+			return lhs.m_tree_node.order < rhs.m_tree_node.order ? -1 : 1;
+		}
+
+		const tree_node* lhs_node = &lhs.m_tree_node;
+		const tree_node* rhs_node = &rhs.m_tree_node;
+
+		//Глубина узлов хранится относительно соседей, поэтому считаем её
+		//подъёмом по родителям
+		const auto find_depth = [](const tree_node* node) noexcept
+		{
+			std::size_t result = 0;
+
+			for (; node->parent; node = node->parent)
+			{
+				++result;
+			}
+
+			return result;
+		};
+
+		std::size_t lhs_depth = find_depth(lhs_node);
+		std::size_t rhs_depth = find_depth(rhs_node);
+		const bool is_lhs_deeper = lhs_depth > rhs_depth;
+
+		//Поднимаем более глубокий узел на глубину другого. Если встретили
+		//другой узел, то он предок и идёт раньше
+		for (; lhs_depth > rhs_depth; --lhs_depth)
+		{
+			lhs_node = lhs_node->parent;
+		}
+
+		for (; rhs_depth > lhs_depth; --rhs_depth)
+		{
+			rhs_node = rhs_node->parent;
+		}
+
+		if (lhs_node == rhs_node)
+		{
+			return is_lhs_deeper ? 1 : -1;
+		}
+
+		while (lhs_node && rhs_node && lhs_node->parent != rhs_node->parent)
+		{
+			lhs_node = lhs_node->parent;
+			rhs_node = rhs_node->parent;
+		}
+
+		if (!lhs_node || !rhs_node || !lhs_node->parent)
+		{
+			return 0;
+		}
+
+		//Узлы стали братьями - их порядок задаёт список дочерних узлов 
+		//общего родителя
+		for (auto&& child : lhs_node->parent->element->m_childs)
+		{
+			if (&child->m_tree_node == lhs_node)
+			{
+				return -1;
+			}
+
+			if (&child->m_tree_node == rhs_node)
+			{
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::iterator Document<CharT>::skip_subtree(
+		const_iterator node) noexcept
+	{
+		return iterator{ find_subtree_end(node) };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Document<CharT>::string_wrapper 
-		Document<CharT>::get_encoding_type() const noexcept
+	inline typename Document<CharT>::const_iterator 
+		Document<CharT>::skip_subtree(const_iterator node) const noexcept
 	{
-		return string_wrapper{ m_encoding_type };
+		return const_iterator{ find_subtree_end(node) };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Document<CharT>::iterator Document<CharT>::begin() noexcept
+	inline typename Document<CharT>::node_type::tree_node* 
+		Document<CharT>::find_subtree_end(const_iterator node) const noexcept
 	{
-		return m_parent->begin();
+		return node->find_last_tree_node()->next;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::update_order()
+	{
+		get_context().require_order();
+		m_parent->m_context->update(&m_parent->m_tree_node);
+
+		return m_parent->m_context->is_order_valid();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::is_order_valid() const noexcept
+	{
+		return m_parent->m_context && m_parent->m_context->is_order_valid();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline detail::Node_context<typename Document<CharT>::node_type>& 
+		Document<CharT>::get_context()
+	{
+		if (!m_parent->m_context)
+		{
+			m_parent->m_context = 
+				std::make_unique<detail::Node_context<node_type>>();
+
+			node_type::share_context(&m_parent->m_tree_node, 
+				m_parent->find_last_tree_node(), m_parent->m_context.get());
+		}
+
+		return *m_parent->m_context;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::release_context() noexcept
+	{
+		if (m_parent->m_context && m_parent->m_context->is_empty())
+		{
+			m_parent->m_context.reset();
+
+			node_type::share_context(&m_parent->m_tree_node, 
+				m_parent->find_last_tree_node(), nullptr);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename DecorT>
+	inline bool Document<CharT>::retain_source(
+		std::shared_ptr<const detail::Retained_source<symbol_type>> source,
+		const DecorT& decorator)
+	{
+		const bool result = get_context().create_source_map(
+			&m_parent->m_tree_node, std::move(source), decorator, m_version,
+			m_encoding_type);
+
+		release_context();
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const detail::Source_map<typename Document<CharT>::node_type>* 
+		Document<CharT>::get_source_map() const noexcept
+	{
+		return m_parent->m_context ? 
+			m_parent->m_context->get_source_map() : nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline std::shared_ptr<const Frozen_document<CharT>> 
+		Document<CharT>::freeze() const
+	{
+		return std::make_shared<const Frozen_document<symbol_type>>(
+			is_empty() ? nullptr : &*cbegin(), m_version, m_encoding_type);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::clear() noexcept
+	{
+		if (m_parent->child_size())
+		{
+			m_parent->erase_child(0);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document<CharT>::size_type 
+		Document<CharT>::size() const noexcept
+	{
+		return m_parent->size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Document<CharT>::is_empty() const noexcept
+	{
+		return m_parent->child_size() ? false : true;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document<CharT>::operator bool() const noexcept
+	{
+		return is_empty();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Document<CharT>::swap(Document& doc) noexcept
+	{
+		using std::swap;
+
+		swap(m_parent, doc.m_parent);
+		swap(m_encoding_type, doc.m_encoding_type);
+		swap(m_version, doc.m_version);
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						SUPPORT FUNCTIONS FOR DOCUMENT
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Проверить на валидность XML узлы
+	* 
+	* @ingroup general
+	*
+	* @param first - начало XML последовательности
+	* @param last - конец XML последовательности
+	*
+	* @return диагностический итератор, который преобразуется в true, если была
+	* найдена ошибка и false если ошибок не было найдено
+	**************************************************************************/
+	template<typename IterT, typename IterU = IterT>
+	inline decltype(auto) is_correct(IterT first, IterU last)
+	{
+		using diagnostic_iterator =
+			detail::Diagnostic_iterator<decltype(last)>;
+
+		decltype(last) first_it = first;
+
+		diagnostic_iterator result;
+
+		for (; first_it != last; ++first_it)
+		{
+			if (!is_correct(*first_it))
+			{
+				result = diagnostic_iterator{ first_it, true };
+
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Проверить на валидность XML документ
+	* 
+	* @ingroup general
+	*
+	* @param document - XML документ
+	*
+	* @return диагностический итератор, который преобразуется в true, если была
+	* найдена ошибка и false если ошибок не было найдено
+	**************************************************************************/
+	template<typename DocT>
+	inline decltype(auto) is_correct(DocT&& document)
+	{
+		using diagnostic_iterator =
+			detail::Diagnostic_iterator<decltype(document.end())>;
+
+		diagnostic_iterator result =
+			is_correct(document.begin(), document.end());
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool operator==(const Document<CharT>& lhs,
+		const Document<CharT>& rhs)
+	{
+		bool result = true;
+
+		if (lhs.get_version() != rhs.get_version() ||
+			lhs.get_general_node() != rhs.get_general_node())
+		{
+			result = false;
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool operator!=(const Document<CharT>& lhs,
+		const Document<CharT>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Обменять данные двух Document
+	*
+	* @tparam CharT - тип символов
+	*
+	* @param lhs - первый Document
+	* @param rhs - второй Document
+	**************************************************************************/
+	template<typename CharT>
+	inline void swap(Document<CharT>& lhs, Document<CharT>& rhs) noexcept
+	{
+		lhs.swap(rhs);
 	}
 
 	//*************************************************************************
 
+} // namespace XMLB
+
+
+
+namespace XMLB { namespace detail {
+
+	//*************************************************************************
+	//				SUPPORT FUNCTIONS FOR SAVE AND LOAD FUNCTIONS
+	//*************************************************************************
+
 	template<typename CharT>
-	inline typename Document<CharT>::iterator Document<CharT>::end() noexcept
-	{
-		return m_parent->end();
-	}
+	using default_decorator = Decorator<CharT>;
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Document<CharT>::const_iterator Document<CharT>::begin() 
-		const noexcept
-	{
-		return m_parent->cbegin();
-	}
+	using default_data_controller = Parser_data_controller<CharT>;
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline typename Document<CharT>::const_iterator Document<CharT>::end() 
-		const noexcept
-	{
-		return m_parent->cend();
-	}
+	template<typename CharT, typename DecorT, typename DataT>
+	using default_parser = Parser<CharT, DecorT, DataT>;
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline typename Document<CharT>::const_iterator Document<CharT>::cbegin() 
-		const noexcept
+	template<typename ParserT>
+	inline ParserT create_default_parser()
 	{
-		return m_parent->cbegin();
-	}
+		unsigned int default_functor_count = 11;
 
-	//*************************************************************************
+		ParserT parser{ default_functor_count };
 
-	template<typename CharT>
-	inline typename Document<CharT>::const_iterator Document<CharT>::cend()
-		const noexcept
-	{
-		return m_parent->cend();
+		parser.add_functor(Start_state{}, Start_functor{});
+		parser.add_functor(Open_tag_state{}, Open_tag_functor{});
+		parser.add_functor(Close_tag_state{}, Close_tag_functor{});
+		parser.add_functor(Last_tag_state{}, Last_tag_functor{});
+		parser.add_functor(Single_tag_state{}, Single_tag_functor{});
+		parser.add_functor(Name_tag_state{}, Name_tag_functor{});
+		parser.add_functor(Value_tag_state{}, Value_tag_functor{});
+		parser.add_functor(Attribute_name_state{}, Attribute_name_functor{});
+		parser.add_functor(Attribute_value_state{}, Attribute_value_functor{});
+		parser.add_functor(Comment_state{}, Comment_functor{});
+		parser.add_functor(Document_info_state{}, Document_info_functor{});
+
+		return parser;
 	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline void Document<CharT>::clear() noexcept
+	template<typename StringT, typename ContainerT, std::enable_if_t<
+		std::is_same_v<std::decay_t<StringT>, 
+		std::basic_string<value_type_t<std::decay_t<StringT>>>> &&
+
+		std::is_same_v<value_type_t<std::decay_t<ContainerT>>, 
+		std::basic_string<universal_value_type_t<std::decay_t<ContainerT>>>>,
+
+		std::nullptr_t> = nullptr>
+	inline decltype(auto) create_node(StringT&& name, StringT&& value,
+		ContainerT&& attribute_names, ContainerT&& attribute_values)
 	{
-		if (m_parent->child_size())
+		using symbol_type = std::decay_t<typename StringT::value_type>;
+		using node_type = Node<symbol_type>;
+		using node_pointer = typename Node<symbol_type>::Ptr;
+		using node_attribute = typename Node<symbol_type>::attribute_type;
+		using string_type = typename Node<symbol_type>::string_type;
+
+		node_pointer result = std::make_unique<node_type>(name, value);
+
+		auto attr_names_beg = attribute_names.begin();
+		auto attr_names_end = attribute_names.end();
+
+		auto attr_values_beg = attribute_values.begin();
+		auto attr_values_end = attribute_values.end();
+
+		for (; attr_names_beg != attr_names_end &&
+			attr_values_beg != attr_values_end;
+			++attr_names_beg, ++attr_values_beg)
 		{
-			m_parent->erase_child(0);
+			result->add_attribute(node_attribute{
+					std::move(*attr_names_beg), std::move(*attr_values_beg) });
 		}
+
+		return result;
 	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline typename Document<CharT>::size_type 
-		Document<CharT>::size() const noexcept
+	template<typename StringT, typename ContainerT, 
+		std::enable_if_t<
+		std::is_same_v<std::decay_t<StringT>,
+		std::basic_string_view<value_type_t<std::decay_t<StringT>>>>&&
+
+		std::is_same_v<value_type_t<std::decay_t<ContainerT>>,
+		std::basic_string_view<
+		universal_value_type_t<std::decay_t<ContainerT>>>>,
+		
+		std::nullptr_t> = nullptr>
+	inline decltype(auto) create_node(StringT&& name, StringT&& value,
+		ContainerT&& attribute_names, ContainerT&& attribute_values)
 	{
-		return m_parent->size();
-	}
+		using symbol_type = std::decay_t<typename StringT::value_type>;
+		using node_type = Node<symbol_type>;
+		using node_pointer = typename Node<symbol_type>::Ptr;
+		using node_attribute = typename Node<symbol_type>::attribute_type;
+		using string_type = typename Node<symbol_type>::string_type;
 
-	//*************************************************************************
+		node_pointer result = std::make_unique<node_type>(
+			string_type{ name }, string_type{ value });
 
-	template<typename CharT>
-	inline bool Document<CharT>::is_empty() const noexcept
-	{
-		return m_parent->child_size() ? false : true;
-	}
+		auto attr_names_beg = attribute_names.begin();
+		auto attr_names_end = attribute_names.end();
 
-	//*************************************************************************
+		auto attr_values_beg = attribute_values.begin();
+		auto attr_values_end = attribute_values.end();
 
-	template<typename CharT>
-	inline Document<CharT>::operator bool() const noexcept
-	{
-		return is_empty();
+		for (; attr_names_beg != attr_names_end &&
+			attr_values_beg != attr_values_end;
+			++attr_names_beg, ++attr_values_beg)
+		{
+			result->add_attribute(node_attribute{
+					string_type{ *attr_names_beg }, 
+					string_type{ *attr_values_beg} });
+		}
+
+		return result;
 	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline void Document<CharT>::swap(Document& doc) noexcept
+	template<typename ContainerT>
+	inline decltype(auto) create_root_node_from_container(
+		ContainerT&& container)
 	{
-		using std::swap;
+		using tag_container_type =
+			typename std::decay_t<ContainerT>::value_type;
+		using symbol_type = symbol_type_t<tag_container_type>;
 
-		swap(m_parent, doc.m_parent);
-		swap(m_encoding_type, doc.m_encoding_type);
-		swap(m_version, doc.m_version);
-	}
+		using iterator_type =
+			iterator_t<typename std::decay_t<ContainerT>::value_type::
+			child_container_type>;
 
-	//*************************************************************************
+		using node_type = Node<symbol_type>;
+		using node_pointer = typename Node<symbol_type>::Ptr;
+		using tag_type = Tag_range<iterator_type, node_type*>;
 
+		node_pointer result{ nullptr };
 
+		if (container.size())
+		{
+			auto&& source_root_tag = container.top();
+
+			result = create_node(
+				std::move(source_root_tag.name),
+				std::move(source_root_tag.value),
+				source_root_tag.attribute_names,
+				source_root_tag.attribute_values);
+
+			//Узлы строятся сверху вниз в порядке документа, поэтому каждый
+			//узел сразу получает свою глубину и связывается с предыдущим
+			//узлом без поиска последнего дочернего узла
+			Node_builder<node_type> builder{ *result };
+
+			std::stack<tag_type> tag_nodes;
+
+			tag_nodes.push(tag_type{
+				source_root_tag.childs.begin(),
+				source_root_tag.childs.end(),
+				result.get() });
+
+			while (tag_nodes.size())
+			{
+				if (tag_nodes.top().first == tag_nodes.top().last)
+				{
+					tag_nodes.pop();
+					builder.close();
+
+					continue;
+				}
+
+				auto&& tag = *tag_nodes.top().first;
+
+				++tag_nodes.top().first;
+
+				node_type& tag_node = builder.open(create_node(
+					std::move(tag.name),
+					std::move(tag.value),
+					tag.attribute_names,
+					tag.attribute_values));
+
+				if (tag.childs.size())
+				{
+					tag_nodes.push(tag_type{ tag.childs.begin(),
+						tag.childs.end(), &tag_node });
+				}
+				else
+				{
+					builder.close();
+				}
+			}
+
+			builder.finish();
+		}
+
+		return result;
+	}
 
-	//*************************************************************************
-	//						SUPPORT FUNCTIONS FOR DOCUMENT
 	//*************************************************************************
 
-	/**************************************************************************
-	* @brief Проверить на валидность XML узлы
-	* 
-	* @ingroup general
-	*
-	* @param first - начало XML последовательности
-	* @param last - конец XML последовательности
-	*
-	* @return диагностический итератор, который преобразуется в true, если была
-	* найдена ошибка и false если ошибок не было найдено
-	**************************************************************************/
-	template<typename IterT, typename IterU = IterT>
-	inline decltype(auto) is_correct(IterT first, IterU last)
+	template<typename ContainerT>
+	inline decltype(auto) create_doc_from_info(ContainerT&& doc_info)
 	{
-		using diagnostic_iterator =
-			detail::Diagnostic_iterator<decltype(last)>;
+		using tag_container_type =
+			typename std::decay_t<ContainerT>::value_type;
+		using symbol_type = symbol_type_t<tag_container_type>;
+		using document_type = Document<symbol_type>;
+		using document_pointer = typename Document<symbol_type>::Ptr;
 
-		decltype(last) first_it = first;
+		using string_type = typename Document<symbol_type>::string_type;
 
-		diagnostic_iterator result;
+		document_pointer result{ nullptr };
 
-		for (; first_it != last; ++first_it)
+		if (doc_info.size())
 		{
-			if (!is_correct(*first_it))
+			static constexpr unsigned int only_doc_version = 1;
+			static constexpr unsigned int doc_version_and_encoding = 2;
+
+			//Версия, которую не удалось разобрать, считается версией 1.0
+			static constexpr float kDefault_version = 1.f;
+
+			auto&& source_doc_info = doc_info.top();
+
+			if (source_doc_info.attribute_names.size() ==
+				only_doc_version)
 			{
-				result = diagnostic_iterator{ first_it, true };
+				float doc_version = kDefault_version;
 
-				break;
+				parse_number<float, symbol_type>(
+					*source_doc_info.attribute_values.begin(), doc_version);
+
+				result = std::move(
+					std::make_unique<document_type>(doc_version));
+			}
+			else if (source_doc_info.attribute_names.size() ==
+				doc_version_and_encoding)
+			{
+				float doc_version = kDefault_version;
+
+				parse_number<float, symbol_type>(
+					*source_doc_info.attribute_values.begin(), doc_version);
+
+				auto&& doc_encoding =
+					*(++source_doc_info.attribute_values.begin());
+
+				//Вот тут нужно убрать string_type. Нужно выбрать лучший
+				//лучший вариант решения
+				result = std::move(std::make_unique<document_type>(
+					doc_version, string_type(std::move(doc_encoding))));
 			}
 		}
 
+		if (!result)
+		{
+			result = std::move(std::make_unique<document_type>());
+		}
+
 		return result;
 	}
 
 	//*************************************************************************
 
-
-
 	/**************************************************************************
-	* @brief Проверить на валидность XML документ
-	* 
-	* @ingroup general
+	* @brief Записать в приёмник строку
+	**************************************************************************/
+	template<typename SinkT, typename CharT>
+	inline void write_to_sink(SinkT& sink, std::basic_string_view<CharT> str)
+	{
+		sink.append(str.data(), str.size());
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать в приёмник строку, заменив спецсимволы XML сущностями
 	*
-	* @param document - XML документ
+	* @details Текст между спецсимволами дописывается одним куском. В 
+	* значении атрибута экранируется ещё и символ кавычки декоратора
 	*
-	* @return диагностический итератор, который преобразуется в true, если была
-	* найдена ошибка и false если ошибок не было найдено
+	* @param sink - приёмник
+	* @param str - строка
+	* @param is_attribute - строка является значением атрибута
+	* @param decorator - декоратор
 	**************************************************************************/
-	template<typename DocT>
-	inline decltype(auto) is_correct(DocT&& document)
+	template<typename SinkT, typename CharT, typename DecorT>
+	inline void write_escaped(SinkT& sink, std::basic_string_view<CharT> str,
+		bool is_attribute, const DecorT& decorator)
 	{
-		using diagnostic_iterator =
-			detail::Diagnostic_iterator<decltype(document.end())>;
+		const CharT kQuote = decorator.close_attribute_symbol;
 
-		diagnostic_iterator result =
-			is_correct(document.begin(), document.end());
+		const CharT* first = str.data();
+		const CharT* last = first + str.size();
 
-		return result;
+		for (const CharT* current = first; current != last; ++current)
+		{
+			const char* entity = nullptr;
+
+			switch (*current)
+			{
+			case '&': entity = "&amp;"; break;
+			case '<': entity = "&lt;"; break;
+			case '>': entity = "&gt;"; break;
+			default:
+				if (is_attribute && *current == kQuote)
+				{
+					entity = kQuote == '\'' ? "&apos;" : "&quot;";
+				}
+				break;
+			}
+
+			if (entity)
+			{
+				sink.append(first, static_cast<std::size_t>(current - first));
+
+				for (; *entity; ++entity)
+				{
+					sink.append(static_cast<CharT>(*entity));
+				}
+
+				first = current + 1;
+			}
+		}
+
+		sink.append(first, static_cast<std::size_t>(last - first));
 	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline bool operator==(const Document<CharT>& lhs,
-		const Document<CharT>& rhs)
+	/**************************************************************************
+	* @brief Записать в приёмник строку объявления XML документа
+	*
+	* @tparam FormatT - формат вывода
+	* @param version - версия XML документа
+	* @param encoding_type - кодировка XML документа
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_declaration(float version, 
+		std::basic_string_view<CharT> encoding_type,
+		SinkT& sink, const DecorT& decorator)
 	{
-		bool result = true;
+		using symbol_type = CharT;
+		using string_wrapper = std::basic_string_view<symbol_type>;
 
-		if (lhs.get_version() != rhs.get_version() ||
-			lhs.get_general_node() != rhs.get_general_node())
+		const auto write = [&sink](string_wrapper str)
 		{
-			result = false;
+			write_to_sink(sink, str);
+		};
+
+		sink.append(decorator.open_tag_symbol);
+		sink.append(decorator.doc_info_symbol);
+		write(to_string<symbol_type>('x', 'm', 'l'));
+
+		sink.append(decorator.white_space_symbol);
+		write(to_string<symbol_type>('v', 'e', 'r', 's', 'i', 'o', 'n'));
+		sink.append(decorator.equal_attribute_symbol);
+		sink.append(decorator.open_attribute_symbol);
+		write(cut_doc_version<symbol_type>(version));
+		sink.append(decorator.close_attribute_symbol);
+
+		sink.append(decorator.white_space_symbol);
+		write(to_string<symbol_type>('e', 'n', 'c', 'o', 'd', 'i', 'n', 'g'));
+		sink.append(decorator.equal_attribute_symbol);
+		sink.append(decorator.open_attribute_symbol);
+		write(encoding_type);
+		sink.append(decorator.close_attribute_symbol);
+
+		sink.append(decorator.doc_info_last_symbol);
+		sink.append(decorator.close_tag_symbol);
+
+		if constexpr (FormatT::is_pretty)
+		{
+			sink.append(decorator.line_break_symbol);
 		}
-
-		return result;
 	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline bool operator!=(const Document<CharT>& lhs,
-		const Document<CharT>& rhs)
+	/**************************************************************************
+	* @brief Записать в приёмник строку объявления XML документа
+	*
+	* @tparam FormatT - формат вывода
+	* @param document - XML документ
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_declaration(const Document<CharT>& document,
+		SinkT& sink, const DecorT& decorator)
 	{
-		return !(lhs == rhs);
+		write_declaration<FormatT, CharT>(document.get_version(), 
+			document.get_encoding_type(), sink, decorator);
 	}
 
 	//*************************************************************************
 
-
-
 	/**************************************************************************
-	* @brief Обменять данные двух Document
-	*
-	* @tparam CharT - тип символов
+	* @brief Записать в приёмник отступ перед тегом
 	*
-	* @param lhs - первый Document
-	* @param rhs - второй Document
+	* @tparam FormatT - формат вывода
+	* @param offset - уровень вложенности тега
+	* @param sink - приёмник
+	* @param decorator - декоратор
 	**************************************************************************/
-	template<typename CharT>
-	inline void swap(Document<CharT>& lhs, Document<CharT>& rhs) noexcept
+	template<typename FormatT, typename SinkT, typename DecorT>
+	inline void write_indent(std::size_t offset, SinkT& sink,
+		const DecorT& decorator)
 	{
-		lhs.swap(rhs);
+		if constexpr (FormatT::indent_width == 0)
+		{
+			return;
+		}
+		else if constexpr (FormatT::is_space_indent)
+		{
+			sink.append(decorator.white_space_symbol, 
+				offset * FormatT::indent_width);
+		}
+		else
+		{
+			sink.append(decorator.fill_symbol,
+				offset * FormatT::indent_width);
+		}
 	}
 
 	//*************************************************************************
 
-} // namespace XMLB
+	/**************************************************************************
+	* @brief Записать в приёмник открывающий тег XML узла с атрибутами, а для
+	* узла без потомков - ещё значение и закрытие тега. Без отступа и 
+	* перевода строки
+	*
+	* @tparam FormatT - формат вывода
+	* @param node - XML узел
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_element_start(const Node<CharT>& node, SinkT& sink,
+		const DecorT& decorator)
+	{
+		const bool has_childs = node.child_size() != 0;
 
+		sink.append(decorator.open_tag_symbol);
+		write_to_sink(sink, node.get_name());
 
+		for (auto at_it = node.attr_begin(), at_end = node.attr_end();
+			at_it != at_end;
+			++at_it)
+		{
+			sink.append(decorator.white_space_symbol);
+			write_to_sink(sink, std::basic_string_view<CharT>{ at_it->name });
+			sink.append(decorator.equal_attribute_symbol);
+			sink.append(decorator.open_attribute_symbol);
+			write_to_sink(sink, std::basic_string_view<CharT>{ at_it->value });
+			sink.append(decorator.close_attribute_symbol);
+		}
 
-namespace XMLB { namespace detail {
+		//Число в значении записывается сразу в приёмник, без перевода в 
+		//текст узла
+		auto&& value = Value_access<CharT>::get(node);
 
-	//*************************************************************************
-	//				SUPPORT FUNCTIONS FOR SAVE AND LOAD FUNCTIONS
-	//*************************************************************************
+		//Если у XML тега нет дочерних узлов и есть значение, то
+		//записываем это значение и доп. символы по шаблону
+		if (!has_childs && !value.empty())
+		{
+			sink.append(decorator.close_tag_symbol);
+			value.write(sink);
+			sink.append(decorator.open_tag_symbol);
+			sink.append(decorator.last_tag_symbol);
+			write_to_sink(sink, node.get_name());
+			sink.append(decorator.close_tag_symbol);
+		}
+		//Если у XML тега нет дочерних узлов и нет значения, то
+		//записываем доп. символы по шаблону одиночного XML тега
+		else if (!has_childs)
+		{
+			if constexpr (FormatT::is_pretty)
+			{
+				sink.append(decorator.white_space_symbol);
+			}
 
-	template<typename CharT>
-	using default_decorator = Decorator<CharT>;
+			sink.append(decorator.single_tag_symbol);
+			sink.append(decorator.close_tag_symbol);
+		}
+		else
+		{
+			sink.append(decorator.close_tag_symbol);
+		}
+	}
 
 	//*************************************************************************
 
-	template<typename CharT>
-	using default_data_controller = Parser_data_controller<CharT>;
+	/**************************************************************************
+	* @brief Записать в приёмник завершающий тег XML узла. Без отступа и 
+	* перевода строки
+	*
+	* @param node - XML узел
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename CharT, typename SinkT, typename DecorT>
+	inline void write_element_end(const Node<CharT>& node, SinkT& sink,
+		const DecorT& decorator)
+	{
+		sink.append(decorator.open_tag_symbol);
+		sink.append(decorator.last_tag_symbol);
+		write_to_sink(sink, node.get_name());
+		sink.append(decorator.close_tag_symbol);
+	}
 
 	//*************************************************************************
 
-	template<typename CharT, typename DecorT, typename DataT>
-	using default_parser = Parser<CharT, DecorT, DataT>;
+	/**************************************************************************
+	* @brief Записать в приёмник строку XML узла: открывающий тег с 
+	* атрибутами, а для узла без потомков - ещё значение и закрытие тега
+	*
+	* @tparam FormatT - формат вывода
+	* @param node - XML узел
+	* @param offset - уровень вложенности тега
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_open_tag(const Node<CharT>& node, std::size_t offset,
+		SinkT& sink, const DecorT& decorator)
+	{
+		write_indent<FormatT>(offset, sink, decorator);
+		write_element_start<FormatT>(node, sink, decorator);
+
+		if constexpr (FormatT::is_pretty)
+		{
+			sink.append(decorator.line_break_symbol);
+		}
+	}
 
 	//*************************************************************************
 
-	template<typename ParserT>
-	inline ParserT create_default_parser()
+	/**************************************************************************
+	* @brief Записать в приёмник строку закрывающего тега XML узла
+	*
+	* @tparam FormatT - формат вывода
+	* @param node - XML узел
+	* @param offset - уровень вложенности тега
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_close_tag(const Node<CharT>& node, std::size_t offset,
+		SinkT& sink, const DecorT& decorator)
 	{
-		unsigned int default_functor_count = 11;
-
-		ParserT parser{ default_functor_count };
-
-		parser.add_functor(Start_state{}, Start_functor{});
-		parser.add_functor(Open_tag_state{}, Open_tag_functor{});
-		parser.add_functor(Close_tag_state{}, Close_tag_functor{});
-		parser.add_functor(Last_tag_state{}, Last_tag_functor{});
-		parser.add_functor(Single_tag_state{}, Single_tag_functor{});
-		parser.add_functor(Name_tag_state{}, Name_tag_functor{});
-		parser.add_functor(Value_tag_state{}, Value_tag_functor{});
-		parser.add_functor(Attribute_name_state{}, Attribute_name_functor{});
-		parser.add_functor(Attribute_value_state{}, Attribute_value_functor{});
-		parser.add_functor(Comment_state{}, Comment_functor{});
-		parser.add_functor(Document_info_state{}, Document_info_functor{});
+		write_indent<FormatT>(offset, sink, decorator);
+		write_element_end(node, sink, decorator);
 
-		return parser;
+		if constexpr (FormatT::is_pretty)
+		{
+			sink.append(decorator.line_break_symbol);
+		}
 	}
 
 	//*************************************************************************
 
-	template<typename StringT, typename ContainerT, std::enable_if_t<
-		std::is_same_v<std::decay_t<StringT>, 
-		std::basic_string<value_type_t<std::decay_t<StringT>>>> &&
+	/**************************************************************************
+	* @brief Записать в приёмник последовательность XML узлов
+	*
+	* @tparam FormatT - формат вывода
+	* @param first - начальный итератора на XML узел
+	* @param last - конечный итератор на XML узел
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	* @param base_offset - уровень вложенности первого узла
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void save_to_sink(Node_const_iterator<Node<CharT>> first,
+		Node_const_iterator<Node<CharT>> last, SinkT& sink,
+		const DecorT& decorator, std::size_t base_offset)
+	{
+		using const_iterator = Node_const_iterator<Node<CharT>>;
 
-		std::is_same_v<value_type_t<std::decay_t<ContainerT>>, 
-		std::basic_string<universal_value_type_t<std::decay_t<ContainerT>>>>,
+		//Контейнер итераторова, чтобы правильно закрывать теги с потомками
+		std::stack<const_iterator, std::vector<const_iterator>> node_groups;
 
-		std::nullptr_t> = nullptr>
-	inline decltype(auto) create_node(StringT&& name, StringT&& value,
-		ContainerT&& attribute_names, ContainerT&& attribute_values)
-	{
-		using symbol_type = std::decay_t<typename StringT::value_type>;
-		using node_type = Node<symbol_type>;
-		using node_pointer = typename Node<symbol_type>::Ptr;
-		using node_attribute = typename Node<symbol_type>::attribute_type;
-		using string_type = typename Node<symbol_type>::string_type;
+		for (; first != last; ++first)
+		{
+			//Если текущее значение табуляции не больше, чем у последнего
+			//добавленного в стэк итератора, то закрываем его тег
+			while (!node_groups.empty() &&
+				first.get_offset() <= node_groups.top().get_offset())
+			{
+				write_close_tag<FormatT>(*node_groups.top(), 
+					base_offset + node_groups.top().get_offset(), 
+					sink, decorator);
 
-		node_pointer result = std::make_unique<node_type>(name, value);
+				node_groups.pop();
+			}
 
-		auto attr_names_beg = attribute_names.begin();
-		auto attr_names_end = attribute_names.end();
+			//Если у текущего тега есть под-теги, то добавляем его
+			//в стек в качестве итератора-группы
+			if (first->child_size())
+			{
+				node_groups.push(first);
+			}
 
-		auto attr_values_beg = attribute_values.begin();
-		auto attr_values_end = attribute_values.end();
+			write_open_tag<FormatT>(*first, 
+				base_offset + first.get_offset(), sink, decorator);
+		}
 
-		for (; attr_names_beg != attr_names_end &&
-			attr_values_beg != attr_values_end;
-			++attr_names_beg, ++attr_values_beg)
+		//Если остались ещё незакрытые теги, то заносим их закрытие
+		while (!node_groups.empty())
 		{
-			result->add_attribute(node_attribute{
-					std::move(*attr_names_beg), std::move(*attr_values_beg) });
-		}
+			write_close_tag<FormatT>(*node_groups.top(),
+				base_offset + node_groups.top().get_offset(),
+				sink, decorator);
 
-		return result;
+			node_groups.pop();
+		}
 	}
 
 	//*************************************************************************
 
-	template<typename StringT, typename ContainerT, 
-		std::enable_if_t<
-		std::is_same_v<std::decay_t<StringT>,
-		std::basic_string_view<value_type_t<std::decay_t<StringT>>>>&&
-
-		std::is_same_v<value_type_t<std::decay_t<ContainerT>>,
-		std::basic_string_view<
-		universal_value_type_t<std::decay_t<ContainerT>>>>,
-		
-		std::nullptr_t> = nullptr>
-	inline decltype(auto) create_node(StringT&& name, StringT&& value,
-		ContainerT&& attribute_names, ContainerT&& attribute_values)
-	{
-		using symbol_type = std::decay_t<typename StringT::value_type>;
-		using node_type = Node<symbol_type>;
-		using node_pointer = typename Node<symbol_type>::Ptr;
-		using node_attribute = typename Node<symbol_type>::attribute_type;
-		using string_type = typename Node<symbol_type>::string_type;
-
-		node_pointer result = std::make_unique<node_type>(
-			string_type{ name }, string_type{ value });
-
-		auto attr_names_beg = attribute_names.begin();
-		auto attr_names_end = attribute_names.end();
+}} // namespace XMLB::detail
 
-		auto attr_values_beg = attribute_values.begin();
-		auto attr_values_end = attribute_values.end();
 
-		for (; attr_names_beg != attr_names_end &&
-			attr_values_beg != attr_values_end;
-			++attr_names_beg, ++attr_values_beg)
-		{
-			result->add_attribute(node_attribute{
-					string_type{ *attr_names_beg }, 
-					string_type{ *attr_values_beg} });
-		}
 
-		return result;
-	}
+namespace XMLB
+{
 
 	//*************************************************************************
+	//						SAVE AND LOAD FUNCTIONS
+	//*************************************************************************
 
-	template<typename ContainerT>
-	inline decltype(auto) create_root_node_from_container(
-		ContainerT&& container)
-	{
-		using tag_container_type =
-			typename std::decay_t<ContainerT>::value_type;
-		using symbol_type = symbol_type_t<tag_container_type>;
-
-		using iterator_type =
-			iterator_t<typename std::decay_t<ContainerT>::value_type::
-			child_container_type>;
+	/// @name Функции сохранения
+	/// @{
+	/**************************************************************************
+	* @brief Записать данные из последовательности XML узлов в приёмник
+	* 
+	* @ingroup general
+	* 
+	* @details Символы дописываются в приёмник напрямую, без промежуточных
+	* строк для каждого XML узла. Значения узлов и атрибутов записываются
+	* как есть, без экранирования, - в отличие от Xml_writer. Данная 
+	* функция не проверяет последовательность на корректность!
+	* 
+	* @tparam FormatT - формат вывода(Output_format), например 
+	* save_to<Minified_format>(first, last, sink)
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника (Buffer_sink, Fixed_sink, Fd_sink или
+	* любой тип с методами append(symbol), append(symbol, count) и
+	* append(data, size))
+	* @tparam DecorT - тип декоратора
+	* 
+	* @param first - начальный итератора на XML узел
+	* @param last - конечный итератор на XML узел
+	* @param sink - приёмник, в который будут заноситься данные
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT, 
+		typename SinkT, typename DecorT = detail::default_decorator<CharT>,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT> &&
+		detail::is_sink_to_symbol_v<SinkT, CharT>,
+		std::nullptr_t> = nullptr>
+	inline void save_to(detail::Node_const_iterator<Node<CharT>> first,
+		detail::Node_const_iterator<Node<CharT>> last,
+		SinkT& sink,
+		const DecorT& decorator = DecorT{})
+	{
+		detail::save_to_sink<FormatT>(first, last, sink, decorator, 0);
+	}
 
-		using node_type = Node<symbol_type>;
-		using node_pointer = typename Node<symbol_type>::Ptr;
-		using tag_type = Tag_range<iterator_type, node_pointer>;
+	//*************************************************************************
 
-		using std::swap;
 
-		node_pointer result{ nullptr };
 
-		if (container.size())
-		{
-			auto&& source_root_tag = container.top();
+	/**************************************************************************
+	* @brief Записать данные из XML документа в приёмник
+	* 
+	* @ingroup general
+	* 
+	* @details Символы дописываются в приёмник напрямую, без промежуточных
+	* строк для каждого XML узла. Значения узлов и атрибутов записываются
+	* как есть, без экранирования, - в отличие от Xml_writer. Данная 
+	* функция не проверяет документ на корректность!
+	* 
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника
+	* @tparam DecorT - тип декоратора
+	*
+	* @param document - XML Документа
+	* @param sink - приёмник, в который будут заноситься данные
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT, 
+		typename SinkT, typename DecorT = detail::default_decorator<CharT>,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT> &&
+		detail::is_sink_to_symbol_v<SinkT, CharT>,
+		std::nullptr_t> = nullptr>
+	inline void save_to(const Document<CharT>& document, SinkT& sink,
+		const DecorT& decorator = DecorT{})
+	{
+		detail::write_declaration<FormatT>(document, sink, decorator);
 
-			std::stack<tag_type> tag_nodes;
+		detail::save_to_sink<FormatT>(document.cbegin(), document.cend(), 
+			sink, decorator, 0);
+	}
 
-			node_pointer tag_node = create_node(
-				std::move(source_root_tag.name),
-				std::move(source_root_tag.value),
-				source_root_tag.attribute_names,
-				source_root_tag.attribute_values);
+	//*************************************************************************
 
-			tag_nodes.push(tag_type{
-				source_root_tag.childs.begin(),
-				source_root_tag.childs.end(),
-				std::move(tag_node) });
 
-			auto first = tag_nodes.top().first;
-			auto last = tag_nodes.top().last;
 
-			while (first != last)
-			{
-				node_pointer temp_tag = create_node(
-					std::move((*first).name),
-					std::move((*first).value),
-					(*first).attribute_names,
-					(*first).attribute_values);
+	/**************************************************************************
+	* @brief Сохранить XML документ в строку
+	* 
+	* @ingroup general
+	* 
+	* @details Размер результата вычисляется заранее через symbols_count, 
+	* поэтому память под строку выделяется один раз
+	* 
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	*
+	* @param document - XML Документа
+	*
+	* @return строку с XML документом
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT>,
+		std::nullptr_t> = nullptr>
+	inline std::basic_string<CharT> save_to_string(
+		const Document<CharT>& document)
+	{
+		Buffer_sink<CharT> sink{ symbols_count<FormatT>(document) };
 
-				if ((*first).childs.size())
-				{
-					tag_nodes.top().first = first;
+		save_to<FormatT>(document, sink);
 
-					tag_nodes.push(tag_type{ (*first).childs.begin(),
-						(*first).childs.end(), std::move(temp_tag) });
+		return sink.release();
+	}
 
-					first = tag_nodes.top().first;
-					last = tag_nodes.top().last;
-				}
-				else
-				{
-					tag_nodes.top().node->add_child(std::move(temp_tag));
+	//*************************************************************************
 
-					++first;
-				}
 
-				while (first == last && tag_nodes.size() > 1)
-				{
-					auto temp = std::move(tag_nodes.top().node);
-					tag_nodes.pop();
-					tag_nodes.top().node->add_child(std::move(temp));
 
-					++tag_nodes.top().first;
+	/**************************************************************************
+	* @brief Сохранить XML документ в файл
+	* 
+	* @ingroup general
+	* 
+	* @details Символы записываются в файл как есть, без перекодирования. 
+	* Размер файла вычисляется заранее через symbols_count. На POSIX 
+	* системах файл сразу получает итоговый размер через ftruncate и 
+	* заполняется через mmap за один проход
+	* 
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	*
+	* @param document - XML Документа
+	* @param path - путь к файлу. Существующий файл перезаписывается
+	*
+	* @throw std::system_error - если не удалось создать или записать файл
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT>,
+		std::nullptr_t> = nullptr>
+	inline void save_to_file(const Document<CharT>& document,
+		const std::filesystem::path& path)
+	{
+		const std::size_t count = symbols_count<FormatT>(document);
+		const std::size_t bytes = count * sizeof(CharT);
 
-					first = tag_nodes.top().first;
-					last = tag_nodes.top().last;
-				}
-			}
+#ifdef XMLB_POSIX
+		const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
 
-			swap(result, tag_nodes.top().node);
+		if (fd < 0)
+		{
+			throw std::system_error{ errno, std::generic_category(),
+				"Can't open the file!" };
 		}
 
-		return result;
-	}
-
-	//*************************************************************************
-
-	template<typename ContainerT>
-	inline decltype(auto) create_doc_from_info(ContainerT&& doc_info)
-	{
-		using tag_container_type =
-			typename std::decay_t<ContainerT>::value_type;
-		using symbol_type = symbol_type_t<tag_container_type>;
-		using document_type = Document<symbol_type>;
-		using document_pointer = typename Document<symbol_type>::Ptr;
-
-		using string_type = typename Document<symbol_type>::string_type;
+		void* memory = MAP_FAILED;
 
-		document_pointer result{ nullptr };
+		if (::ftruncate(fd, static_cast<::off_t>(bytes)) == 0)
+		{
+			memory = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, 
+				MAP_SHARED, fd, 0);
+		}
 
-		if (doc_info.size())
+		if (memory == MAP_FAILED)
 		{
-			static constexpr unsigned int only_doc_version = 1;
-			static constexpr unsigned int doc_version_and_encoding = 2;
+			const int error = errno;
 
-			auto&& source_doc_info = doc_info.top();
+			::close(fd);
 
-			if (source_doc_info.attribute_names.size() ==
-				only_doc_version)
-			{
-				auto doc_version = to_float<symbol_type>(
-					*source_doc_info.attribute_values.begin());
+			throw std::system_error{ error, std::generic_category(),
+				"Can't map the file!" };
+		}
 
-				result = std::move(
-					std::make_unique<document_type>(doc_version));
-			}
-			else if (source_doc_info.attribute_names.size() ==
-				doc_version_and_encoding)
-			{
-				auto doc_version = to_float<symbol_type>(
-					*source_doc_info.attribute_values.begin());
+		try
+		{
+			Fixed_sink<CharT> sink{ static_cast<CharT*>(memory), count };
 
-				auto&& doc_encoding =
-					*(++source_doc_info.attribute_values.begin());
+			save_to<FormatT>(document, sink);
+		}
+		catch (...)
+		{
+			::munmap(memory, bytes);
+			::close(fd);
 
-				//Вот тут нужно убрать string_type. Нужно выбрать лучший
-				//лучший вариант решения
-				result = std::move(std::make_unique<document_type>(
-					doc_version, string_type(std::move(doc_encoding))));
-			}
+			throw;
 		}
 
-		if (!result)
+		::munmap(memory, bytes);
+
+		if (::close(fd) != 0)
 		{
-			result = std::move(std::make_unique<document_type>());
+			throw std::system_error{ errno, std::generic_category(),
+				"Can't write the file!" };
 		}
+#else
+		const auto data = save_to_string<FormatT>(document);
 
-		return result;
-	}
+		std::ofstream file{ path, std::ios_base::binary | 
+			std::ios_base::trunc };
 
-}} // namespace XMLB::detail
+		file.write(reinterpret_cast<const char*>(data.data()), 
+			static_cast<std::streamsize>(bytes));
 
+		if (!file.flush())
+		{
+			throw std::system_error{ 
+				std::make_error_code(std::errc::io_error),
+				"Can't write the file!" };
+		}
+#endif // XMLB_POSIX
+	}
 
+	//*************************************************************************
 
-namespace XMLB
-{
 
-	//*************************************************************************
-	//						SAVE AND LOAD FUNCTIONS
-	//*************************************************************************
 
-	/// @name Функции сохранения
-	/// @{
 	/**************************************************************************
 	* @brief Скопировать данные из последовательности XML узлов в буфер
 	* 
@@ -1171,10 +2712,11 @@ namespace XMLB
 	* @internal
 	* @details Данная функция для случаев, когда IterT - итератор с любой
 	* категорией или указатель и value_type итератора или указателя IterT -
-	* простой символьный тип. Данная функция не проверяет корректность XML
-	* узлов
+	* простой символьный тип. Данные пишутся через detail::Iterator_sink.
+	* Данная функция не проверяет корректность XML узлов
 	* @endinternal
 	* 
+	* @tparam FormatT - формат вывода(Output_format)
 	* @tparam CharT - тип символов
 	* @tparam IterT - тип выходного(буфера) итератора
 	* @tparam DecorT - тип декоратора
@@ -1182,17 +2724,16 @@ namespace XMLB
 	* @param first - начальный итератора на XML узел
 	* @param last - конечный итератор на XML узел
 	* @param out - итератор, в который будут заноситься данные
-	* 
-	* @todo Нужно оптимизировать данную функцию
 	**************************************************************************/
-	template<typename CharT, typename IterT,
-		typename DecorT = detail::default_decorator<CharT>,
+	template<typename FormatT = Default_format, typename CharT, 
+		typename IterT, typename DecorT = detail::default_decorator<CharT>,
 		std::enable_if_t<
+		detail::is_output_format_v<FormatT> && (
 		detail::is_back_inserter_iterator_to_symbol_v<IterT, CharT> ||
 
 		detail::is_output_iterator_to_symbol_v<IterT, CharT> ||
 
-		detail::is_input_derived_iterator_or_pointer_to_symbol_v<IterT, CharT>,
+		detail::is_input_derived_iterator_or_pointer_to_symbol_v<IterT, CharT>),
 
 		std::nullptr_t> = nullptr>
 	inline void save_to(detail::Node_const_iterator<Node<CharT>> first,
@@ -1200,141 +2741,9 @@ namespace XMLB
 		IterT out,
 		const DecorT& decorator = DecorT{})
 	{
-		if (first == last)
-		{
-			return;
-		}
-
-		using symbol_type = CharT;
-		using string_type = typename Node<symbol_type>::string_type;
-		using string_wrapper = typename Node<symbol_type>::string_wrapper;
-		using const_iterator = typename Node<symbol_type>::const_iterator;
-
-		const auto kFill = decorator.fill_symbol;
-		const auto kSpace = decorator.white_space_symbol;
-		const auto kOpen_tag = decorator.open_tag_symbol;
-		const auto kClose_tag = decorator.close_tag_symbol;
-		const auto kSingle_tag = decorator.single_tag_symbol;
-		const auto kLast_tag = decorator.last_tag_symbol;
-		const auto kOpen_attr = decorator.open_attribute_symbol;
-		const auto kClose_attr = decorator.close_attribute_symbol;
-		const auto kEqual_attr = decorator.equal_attribute_symbol;
-		const auto kLine_break = decorator.line_break_symbol;
-
-		//Контейнер итераторова, чтобы правильно закрывать теги с потомками
-		std::stack<const_iterator> node_groups;
-
-		for (; first != last; ++first)
-		{
-			//Проверяем, пустой ли стэк с итераторома-группами
-			if (!node_groups.empty())
-			{
-				//Если текущее значение табуляции равно с последним
-				//добавленным в стэк итератором, то заносим в файл
-				//закрытие предыдущего тега
-				while (first.get_offset() <= node_groups.top().get_offset())
-				{
-					//Записываем нужное количество табов для тега
-					detail::copy_symbol_n(kFill,
-						node_groups.top().get_offset(), out);
-
-					*out = kOpen_tag; ++out;
-					*out = kLast_tag; ++out;
-					detail::copy_symbol_from_container(
-						string_wrapper{ node_groups.top()->get_name() }, out);
-					*out = kClose_tag; ++out;
-					*out = kLine_break; ++out;
-
-					node_groups.pop();
-				}
-			}
-
-			//Если у текущего тега есть под-теги, то добавляем его
-			//в стек в качестве итератора-группы
-			if (first->child_size())
-			{
-				node_groups.push(first);
-			}
-
-			//Устанавливаем нужное количество табов для тега
-			detail::copy_symbol_n(kFill, first.get_offset(), out);
-
-			//Заносим в файл сам тег и его информацию
-			*out = kOpen_tag; ++out;
-			detail::copy_symbol_from_container(
-				string_wrapper{ first->get_name() }, out);
-
-			//Если у XML тега есть аттрибуты, то записываем в файл
-			//их имена и значения
-			if (first->attr_size())
-			{
-				for (auto at_it = first->attr_begin(),
-					at_end = first->attr_end();
-					at_it != at_end;
-					++at_it)
-				{
-					*out = kSpace; ++out;
-
-					detail::copy_symbol_from_container(
-						string_wrapper{ at_it->name }, out);
-					*out = kEqual_attr; ++out;
-
-					*out = kOpen_attr; ++out;
-					detail::copy_symbol_from_container(
-						string_wrapper{ at_it->value }, out);
-					*out = kClose_attr; ++out;
-				}
-			}
-
-			//Если у XML тега нет дочерних узлов и есть значение, то
-			//записываем это значение и доп. символы по шаблону
-			if (!first->child_size() && first->get_value().size())
-			{
-				*out = kClose_tag; ++out;
-				detail::copy_symbol_from_container(
-					string_wrapper{ first->get_value() }, out);
-
-				*out = kOpen_tag; ++out;
-				*out = kLast_tag; ++out;
-
-				detail::copy_symbol_from_container(
-					string_wrapper{ first->get_name() }, out);
-				*out = kClose_tag; ++out;
-			}
-			//Если у XML тега нет дочерних узлов и нет значения, то
-			//записываем доп. символы по шаблону одиночного XML тега
-			else if (!first->child_size())
-			{
-				*out = kSpace; ++out;
-				*out = kSingle_tag; ++out;
-				*out = kClose_tag; ++out;
-			}
-			//В противном случае, просто записываем в файл символ
-			//закрытия XML тега
-			else
-			{
-				*out = kClose_tag; ++out;
-			}
-
-			*out = kLine_break; ++out;
-		}
-
-		//Если остались ещё незакрытые теги, то заносим в файл их закрытие
-		while (!node_groups.empty())
-		{
-			//Записываем нужное количество табов для тега
-			detail::copy_symbol_n(kFill,
-				node_groups.top().get_offset(), out);
+		detail::Iterator_sink<IterT, CharT> sink{ std::move(out) };
 
-			*out = kOpen_tag; ++out;
-			*out = kLast_tag; ++out;
-			detail::copy_symbol_from_container(
-				string_wrapper{ node_groups.top()->get_name() }, out);
-			*out = kClose_tag; ++out;
-			*out = kLine_break; ++out;
-
-			node_groups.pop();
-		}
+		save_to<FormatT>(first, last, sink, decorator);
 	}
 
 	//*************************************************************************
@@ -1352,78 +2761,35 @@ namespace XMLB
 	* @internal
 	* @details Данная функция для случаев, когда IterT - итератор с любой
 	* категорией или указатель и value_type итератора или указателя IterT -
-	* простой символьный тип. Данная функция не проверяет корректность XML
-	* документа
+	* простой символьный тип. Данные пишутся через detail::Iterator_sink.
+	* Данная функция не проверяет корректность XML документа
 	* @endinternal
 	* 
+	* @tparam FormatT - формат вывода(Output_format)
 	* @tparam CharT - тип символов
 	* @tparam IterT - тип выходного(буфера) итератора
 	* @tparam DecorT - тип декоратора
 	*
 	* @param document - XML Документа
 	* @param out - итератор, в который будут заноситься данные
-	* 
-	* @todo Нужно оптимизировать данную функцию
 	**************************************************************************/
-	template<typename CharT, typename IterT,
-		typename DecorT = detail::default_decorator<CharT>,
+	template<typename FormatT = Default_format, typename CharT, 
+		typename IterT, typename DecorT = detail::default_decorator<CharT>,
 		std::enable_if_t<
+		detail::is_output_format_v<FormatT> && (
 		detail::is_back_inserter_iterator_to_symbol_v<IterT, CharT> ||
 
 		detail::is_output_iterator_to_symbol_v<IterT, CharT> ||
 
-		detail::is_input_derived_iterator_or_pointer_to_symbol_v<IterT, CharT>,
+		detail::is_input_derived_iterator_or_pointer_to_symbol_v<IterT, CharT>),
 
 		std::nullptr_t> = nullptr>
 	inline void save_to(const Document<CharT>& document, IterT out,
 		const DecorT& decorator = DecorT{})
 	{
-		using std::begin;
-		using std::end;
+		detail::Iterator_sink<IterT, CharT> sink{ std::move(out) };
 
-		using symbol_type = CharT;
-		using string_type = typename Node<symbol_type>::string_type;
-		using string_wrapper = typename Node<symbol_type>::string_wrapper;
-
-		const auto kSpace = decorator.white_space_symbol;
-		const auto kOpen_tag = decorator.open_tag_symbol;
-		const auto kClose_tag = decorator.close_tag_symbol;
-		const auto kOpen_attr = decorator.open_attribute_symbol;
-		const auto kClose_attr = decorator.close_attribute_symbol;
-		const auto kEqual_attr = decorator.equal_attribute_symbol;
-		const auto kLine_break = decorator.line_break_symbol;
-		const auto kDoc_info = decorator.doc_info_symbol;
-		const auto kDoc_last_info = decorator.doc_info_last_symbol;
-
-		*out = kOpen_tag; ++out;
-		*out = kDoc_info; ++out;
-		detail::copy_symbol_from_container(
-			detail::to_string<symbol_type>('x','m','l'), out);
-
-		*out = kSpace; ++out;
-		detail::copy_symbol_from_container(
-			detail::to_string<symbol_type>('v', 'e', 'r', 's', 'i', 'o', 'n'), 
-			out);
-		*out = kEqual_attr; ++out;
-		*out = kOpen_attr; ++out;
-		detail::copy_symbol_from_container(
-			cut_doc_version<symbol_type>(document.get_version()), out);
-		*out = kClose_attr; ++out;
-
-		*out = kSpace; ++out;
-		detail::copy_symbol_from_container(
-			detail::to_string<symbol_type>(
-				'e', 'n', 'c', 'o', 'd', 'i', 'n', 'g'), out);
-		*out = kEqual_attr; ++out;
-		*out = kOpen_attr; ++out;
-		detail::copy_symbol_from_container(document.get_encoding_type(), out);
-		*out = kClose_attr; ++out;
-
-		*out = kDoc_last_info; ++out;
-		*out = kClose_tag; ++out;
-		*out = kLine_break; ++out;
-
-		save_to(begin(document), end(document), out, decorator);
+		save_to<FormatT>(document, sink, decorator);
 	}
 
 	//*************************************************************************
@@ -0,0 +1,174 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_DOCUMENT_HOLDER_H
+#define XMLB_DOCUMENT_HOLDER_H
+
+#include <memory>
+#include <atomic>
+#include <utility>
+
+#include "XMLB_Document.h"
+#include "XMLB_Frozen_document.h"
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Хранилище текущей версии документа для перезагрузки на лету
+	*
+	* @ingroup general
+	*
+	* @details Читатели получают неизменяемый снимок документа одной 
+	* атомарной загрузкой указателя и дальше работают с ним без 
+	* синхронизации, сколько угодно долго. Писатель разбирает и замораживает
+	* новый документ вне хранилища, а затем одной атомарной записью 
+	* подменяет текущую версию - читатели разбор не ждут. Старая версия
+	* освобождается, когда её отпустит последний читатель. Освобождение 
+	* замороженного документа - это освобождение трёх буферов, поэтому оно
+	* не заметно даже в потоке обработки запроса.
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Document_holder final
+	{
+	public:
+		using symbol_type = CharT;
+		using document_type = Document<symbol_type>;
+		using snapshot_type = Frozen_document<symbol_type>;
+		using snapshot_pointer = std::shared_ptr<const snapshot_type>;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		Document_holder() = default;
+
+		/**********************************************************************
+		* @param snapshot - начальная версия документа
+		**********************************************************************/
+		explicit Document_holder(snapshot_pointer snapshot) noexcept;
+
+		Document_holder(const Document_holder&) = delete;
+		Document_holder& operator=(const Document_holder&) = delete;
+		/// @}
+
+
+
+		/// @name Методы чтения
+		/// @{
+		/**********************************************************************
+		* @brief Получить текущую версию документа
+		*
+		* @return снимок документа или nullptr, если документа ещё нет. 
+		* Снимок остаётся действительным, пока на него есть указатель, даже
+		* после публикации новой версии
+		**********************************************************************/
+		snapshot_pointer load() const noexcept;
+		/// @}
+
+
+
+		/// @name Методы публикации
+		/// @{
+		/**********************************************************************
+		* @brief Опубликовать новую версию документа
+		*
+		* @param snapshot - новая версия документа
+		*
+		* @return предыдущая версия документа
+		**********************************************************************/
+		snapshot_pointer store(snapshot_pointer snapshot) noexcept;
+
+		/**********************************************************************
+		* @brief Заморозить документ и опубликовать его как новую версию
+		*
+		* @details Заморозка выполняется до публикации, читатели её не ждут
+		*
+		* @param doc - новая версия документа
+		*
+		* @return предыдущая версия документа
+		**********************************************************************/
+		snapshot_pointer store(const document_type& doc);
+		/// @}
+
+	private:
+		snapshot_pointer m_snapshot;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						DOCUMENT_HOLDER IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Document_holder<CharT>::Document_holder(snapshot_pointer snapshot) 
+		noexcept
+		:m_snapshot{ std::move(snapshot) }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document_holder<CharT>::snapshot_pointer 
+		Document_holder<CharT>::load() const noexcept
+	{
+		return std::atomic_load_explicit(&m_snapshot, 
+			std::memory_order_acquire);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document_holder<CharT>::snapshot_pointer 
+		Document_holder<CharT>::store(snapshot_pointer snapshot) noexcept
+	{
+		return std::atomic_exchange_explicit(&m_snapshot, std::move(snapshot),
+			std::memory_order_acq_rel);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Document_holder<CharT>::snapshot_pointer 
+		Document_holder<CharT>::store(const document_type& doc)
+	{
+		return store(doc.freeze());
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_DOCUMENT_HOLDER_H
@@ -0,0 +1,812 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_FROZEN_DOCUMENT_H
+#define XMLB_FROZEN_DOCUMENT_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <string_view>
+#include <initializer_list>
+
+#include "XMLB_Node.h"
+
+
+
+namespace XMLB
+{
+	template<typename CharT>
+	class Frozen_document;
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Атрибут замороженного документа
+	*
+	* @ingroup general
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	struct Frozen_attribute final
+	{
+		std::basic_string_view<CharT> name;		///<Имя атрибута
+		std::basic_string_view<CharT> value;	///<Значение атрибута
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Узел замороженного документа
+	*
+	* @ingroup general
+	*
+	* @details Узлы лежат в одном массиве в порядке документа, поэтому 
+	* потомки узла - это следующие за ним size() элементов массива, а его
+	* итераторы - обычные указатели. Строки узлов и атрибутов лежат в общем
+	* буфере документа. У узла нет изменяемых полей и кешей.
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Frozen_node final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using attribute_type = Frozen_attribute<symbol_type>;
+		using size_type = std::size_t;
+
+		using iterator = const Frozen_node*;
+		using const_iterator = const Frozen_node*;
+		using attr_const_iterator = const attribute_type*;
+
+
+
+		/**********************************************************************
+		* @brief Итератор по дочерним узлам
+		**********************************************************************/
+		class first_level_const_iterator final
+		{
+		public:
+			using value_type = const Frozen_node;
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using reference = value_type&;
+			using pointer = value_type*;
+
+			explicit first_level_const_iterator(pointer ptr = nullptr) 
+				noexcept;
+
+			bool operator==(const first_level_const_iterator& iter) const 
+				noexcept;
+			bool operator!=(const first_level_const_iterator& iter) const 
+				noexcept;
+
+			reference operator*() const noexcept;
+			pointer operator->() const noexcept;
+
+			first_level_const_iterator& operator++() noexcept;
+			first_level_const_iterator operator++(int) noexcept;
+
+		private:
+			pointer m_ptr;
+		};
+
+
+
+		/// @name Методы доступа к данным узла
+		/// @{
+		string_wrapper get_name() const noexcept;
+		string_wrapper get_value() const noexcept;
+
+		/**********************************************************************
+		* @brief Получить родителя узла
+		*
+		* @return указатель на родителя или nullptr, если это root узел
+		**********************************************************************/
+		const Frozen_node* get_parent() const noexcept;
+
+		/**********************************************************************
+		* @brief Получить глубину узла, у root узла она равна 0
+		**********************************************************************/
+		size_type get_depth() const noexcept;
+		/// @}
+
+
+
+		/// @name Методы доступа к атрибутам
+		/// @{
+		attr_const_iterator attr_begin() const noexcept;
+		attr_const_iterator attr_end() const noexcept;
+		size_type attr_size() const noexcept;
+
+		/**********************************************************************
+		* @brief Найти атрибут по имени
+		*
+		* @param attribute_name - имя атрибута
+		*
+		* @return итератор на атрибут или attr_end(), если его нет
+		**********************************************************************/
+		attr_const_iterator find_attribute(string_wrapper attribute_name) 
+			const noexcept;
+		/// @}
+
+
+
+		/// @name Методы доступа итераторами
+		/// @{
+		/**********************************************************************
+		* @brief Итераторы по всем потомкам узла в порядке документа
+		**********************************************************************/
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+
+		first_level_const_iterator first_level_begin() const noexcept;
+		first_level_const_iterator first_level_end() const noexcept;
+
+		/**********************************************************************
+		* @brief Получить количество всех потомков узла
+		**********************************************************************/
+		size_type size() const noexcept;
+		size_type child_size() const noexcept;
+		/// @}
+
+
+
+		/// @name Методы поиска
+		/// @{
+		/**********************************************************************
+		* @brief Найти узел среди потомков
+		*
+		* @param name - имя узла
+		* @param offset - итератор, с которого начать искать. nullptr - 
+		* с begin()
+		*
+		* @return итератор на узел или end(), если он не найден
+		**********************************************************************/
+		const_iterator find(string_wrapper name, 
+			const_iterator offset = nullptr) const noexcept;
+
+		/**********************************************************************
+		* @brief Найти узел по списку вложенных имён
+		*
+		* @details Как и Node::find(): каждое следующее имя ищется среди 
+		* потомков узла, найденного по предыдущему
+		*
+		* @tparam ContT - тип контейнера строко-подобных имён
+		* @param container - список имён узлов
+		*
+		* @return итератор на узел или end(), если он не найден
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+			!std::is_convertible_v<const ContT&, string_wrapper>,
+			std::nullptr_t> = nullptr>
+		const_iterator find(const ContT& container) const;
+		/// @}
+
+	private:
+		friend class Frozen_document<symbol_type>;
+
+		Frozen_node() = default;
+
+	private:
+		string_wrapper m_name;
+		string_wrapper m_value;
+		const attribute_type* m_attr_first = nullptr;
+		const attribute_type* m_attr_last = nullptr;
+		const Frozen_node* m_parent = nullptr;
+		size_type m_size = 0;
+		size_type m_child_size = 0;
+		size_type m_depth = 0;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Неизменяемая компактная копия документа
+	*
+	* @ingroup general
+	*
+	* @details Создаётся через Document::freeze(). Все узлы лежат в одном
+	* массиве, атрибуты - во втором, строки - в одном буфере. У документа и
+	* его узлов нет изменяемых членов и ленивых кешей, поэтому любое 
+	* количество потоков может одновременно искать и обходить его без
+	* блокировок. Копирование запрещено, так как узлы ссылаются на буферы
+	* документа - документ передаётся через std::shared_ptr<const ...>.
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Frozen_document final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using node_type = Frozen_node<symbol_type>;
+		using attribute_type = Frozen_attribute<symbol_type>;
+		using size_type = std::size_t;
+
+		using iterator = const node_type*;
+		using const_iterator = const node_type*;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param root - root узел исходного документа или nullptr
+		* @param version - версия документа
+		* @param encoding_type - кодировка документа
+		**********************************************************************/
+		Frozen_document(const Node<symbol_type>* root, float version,
+			string_wrapper encoding_type);
+
+		Frozen_document(const Frozen_document&) = delete;
+		Frozen_document& operator=(const Frozen_document&) = delete;
+		/// @}
+
+
+
+		/// @name Методы доступа
+		/// @{
+		/**********************************************************************
+		* @brief Получить root узел
+		*
+		* @throw std::out_of_range - если документ пустой
+		**********************************************************************/
+		const node_type& root() const;
+
+		float get_version() const noexcept;
+		string_wrapper get_encoding_type() const noexcept;
+
+		/**********************************************************************
+		* @brief Итераторы по всем узлам, включая root узел
+		**********************************************************************/
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+
+		size_type size() const noexcept;
+		bool is_empty() const noexcept;
+		/// @}
+
+
+
+		/// @name Методы поиска
+		/// @{
+		/**********************************************************************
+		* @brief Найти узел среди потомков root узла
+		*
+		* @details Подробнее в Frozen_node::find()
+		**********************************************************************/
+		const_iterator find(string_wrapper name, 
+			const_iterator offset = nullptr) const noexcept;
+
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+			!std::is_convertible_v<const ContT&, string_wrapper>,
+			std::nullptr_t> = nullptr>
+		const_iterator find(const ContT& container) const;
+		/// @}
+
+	private:
+		std::vector<symbol_type> m_symbols;
+		std::vector<attribute_type> m_attributes;
+		std::vector<node_type> m_nodes;
+		float m_version;
+		string_wrapper m_encoding_type;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//				FROZEN_NODE::FIRST_LEVEL_CONST_ITERATOR IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Frozen_node<CharT>::first_level_const_iterator::
+		first_level_const_iterator(pointer ptr) noexcept
+		:m_ptr{ ptr }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Frozen_node<CharT>::first_level_const_iterator::operator==(
+		const first_level_const_iterator& iter) const noexcept
+	{
+		return m_ptr == iter.m_ptr;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Frozen_node<CharT>::first_level_const_iterator::operator!=(
+		const first_level_const_iterator& iter) const noexcept
+	{
+		return !(*this == iter);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator::reference
+		Frozen_node<CharT>::first_level_const_iterator::operator*() const 
+		noexcept
+	{
+		return *m_ptr;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator::pointer
+		Frozen_node<CharT>::first_level_const_iterator::operator->() const 
+		noexcept
+	{
+		return m_ptr;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator&
+		Frozen_node<CharT>::first_level_const_iterator::operator++() noexcept
+	{
+		//Следующий брат идёт сразу после всех потомков узла
+		m_ptr += m_ptr->m_size + 1;
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator
+		Frozen_node<CharT>::first_level_const_iterator::operator++(int) 
+		noexcept
+	{
+		first_level_const_iterator temp_iterator{ *this };
+
+		++(*this);
+
+		return temp_iterator;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						FROZEN_NODE IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::string_wrapper 
+		Frozen_node<CharT>::get_name() const noexcept
+	{
+		return m_name;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::string_wrapper 
+		Frozen_node<CharT>::get_value() const noexcept
+	{
+		return m_value;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const Frozen_node<CharT>* Frozen_node<CharT>::get_parent() const 
+		noexcept
+	{
+		return m_parent;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::size_type 
+		Frozen_node<CharT>::get_depth() const noexcept
+	{
+		return m_depth;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::attr_const_iterator 
+		Frozen_node<CharT>::attr_begin() const noexcept
+	{
+		return m_attr_first;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::attr_const_iterator 
+		Frozen_node<CharT>::attr_end() const noexcept
+	{
+		return m_attr_last;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::size_type 
+		Frozen_node<CharT>::attr_size() const noexcept
+	{
+		return static_cast<size_type>(m_attr_last - m_attr_first);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::attr_const_iterator 
+		Frozen_node<CharT>::find_attribute(string_wrapper attribute_name) 
+		const noexcept
+	{
+		for (auto first = m_attr_first; first != m_attr_last; ++first)
+		{
+			if (first->name == attribute_name)
+			{
+				return first;
+			}
+		}
+
+		return m_attr_last;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::const_iterator 
+		Frozen_node<CharT>::begin() const noexcept
+	{
+		return this + 1;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::const_iterator 
+		Frozen_node<CharT>::end() const noexcept
+	{
+		return this + 1 + m_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator 
+		Frozen_node<CharT>::first_level_begin() const noexcept
+	{
+		return first_level_const_iterator{ begin() };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::first_level_const_iterator 
+		Frozen_node<CharT>::first_level_end() const noexcept
+	{
+		return first_level_const_iterator{ end() };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::size_type 
+		Frozen_node<CharT>::size() const noexcept
+	{
+		return m_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::size_type 
+		Frozen_node<CharT>::child_size() const noexcept
+	{
+		return m_child_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_node<CharT>::const_iterator 
+		Frozen_node<CharT>::find(string_wrapper name, const_iterator offset) 
+		const noexcept
+	{
+		const_iterator first = begin();
+		const_iterator last = end();
+
+		if (offset && offset >= first && offset <= last)
+		{
+			first = offset;
+		}
+
+		for (; first != last; ++first)
+		{
+			if (first->m_name == name)
+			{
+				return first;
+			}
+		}
+
+		return last;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT, std::enable_if_t<
+		!std::is_convertible_v<const ContT&, std::basic_string_view<CharT>>,
+		std::nullptr_t>>
+	inline typename Frozen_node<CharT>::const_iterator 
+		Frozen_node<CharT>::find(const ContT& container) const
+	{
+		const Frozen_node* current = this;
+
+		for (auto&& name : container)
+		{
+			const_iterator found = current->find(string_wrapper{ name });
+
+			if (found == current->end())
+			{
+				return end();
+			}
+
+			current = found;
+		}
+
+		return current != this ? current : end();
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						FROZEN_DOCUMENT IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Frozen_document<CharT>::Frozen_document(
+		const Node<symbol_type>* root, float version, 
+		string_wrapper encoding_type)
+		:m_version{ version }
+	{
+		//Размер буфера считается заранее: строки узлов ссылаются на него,
+		//поэтому он не должен перевыделяться
+		std::size_t symbol_count = encoding_type.size();
+		std::size_t attribute_count = 0;
+		std::size_t node_count = 0;
+
+		auto&& count = [&](const Node<symbol_type>& node)
+		{
+			symbol_count += node.get_name().size() + node.get_value().size();
+
+			for (auto first = node.attr_cbegin(), last = node.attr_cend();
+				first != last; ++first)
+			{
+				symbol_count += first->name.size() + first->value.size();
+				++attribute_count;
+			}
+
+			++node_count;
+		};
+
+		if (root)
+		{
+			count(*root);
+
+			for (auto&& node : *root)
+			{
+				count(node);
+			}
+		}
+
+		m_symbols.reserve(symbol_count);
+		m_attributes.reserve(attribute_count);
+		m_nodes.reserve(node_count);
+
+		auto&& store = [&](string_wrapper text)
+		{
+			const symbol_type* data = m_symbols.data() + m_symbols.size();
+
+			m_symbols.insert(m_symbols.end(), text.begin(), text.end());
+
+			return string_wrapper{ data, text.size() };
+		};
+
+		m_encoding_type = store(encoding_type);
+
+		if (!root)
+		{
+			return;
+		}
+
+		//Стек предков: у каждого следующего узла родитель - один из них
+		std::vector<std::pair<const Node<symbol_type>*, node_type*>> parents;
+
+		auto&& add = [&](const Node<symbol_type>& node)
+		{
+			while (parents.size() && 
+				parents.back().first != node.get_parent())
+			{
+				parents.pop_back();
+			}
+
+			node_type result;
+
+			result.m_name = store(node.get_name());
+			result.m_value = store(node.get_value());
+			result.m_attr_first = m_attributes.data() + m_attributes.size();
+
+			for (auto first = node.attr_cbegin(), last = node.attr_cend();
+				first != last; ++first)
+			{
+				m_attributes.push_back(
+					attribute_type{ store(first->name), store(first->value) });
+			}
+
+			result.m_attr_last = m_attributes.data() + m_attributes.size();
+			result.m_size = node.size();
+			result.m_child_size = node.child_size();
+
+			if (parents.size())
+			{
+				result.m_parent = parents.back().second;
+				result.m_depth = parents.back().second->m_depth + 1;
+			}
+
+			m_nodes.push_back(result);
+
+			parents.emplace_back(&node, &m_nodes.back());
+		};
+
+		add(*root);
+
+		for (auto&& node : *root)
+		{
+			add(node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Frozen_document<CharT>::node_type& 
+		Frozen_document<CharT>::root() const
+	{
+		if (m_nodes.empty())
+		{
+			throw std::out_of_range{ "The frozen document is empty!" };
+		}
+
+		return m_nodes.front();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline float Frozen_document<CharT>::get_version() const noexcept
+	{
+		return m_version;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_document<CharT>::string_wrapper 
+		Frozen_document<CharT>::get_encoding_type() const noexcept
+	{
+		return m_encoding_type;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_document<CharT>::const_iterator 
+		Frozen_document<CharT>::begin() const noexcept
+	{
+		return m_nodes.data();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_document<CharT>::const_iterator 
+		Frozen_document<CharT>::end() const noexcept
+	{
+		return m_nodes.data() + m_nodes.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_document<CharT>::size_type 
+		Frozen_document<CharT>::size() const noexcept
+	{
+		return m_nodes.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Frozen_document<CharT>::is_empty() const noexcept
+	{
+		return m_nodes.empty();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Frozen_document<CharT>::const_iterator 
+		Frozen_document<CharT>::find(string_wrapper name, 
+			const_iterator offset) const noexcept
+	{
+		return is_empty() ? end() : m_nodes.front().find(name, offset);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT, std::enable_if_t<
+		!std::is_convertible_v<const ContT&, std::basic_string_view<CharT>>,
+		std::nullptr_t>>
+	inline typename Frozen_document<CharT>::const_iterator 
+		Frozen_document<CharT>::find(const ContT& container) const
+	{
+		return is_empty() ? end() : m_nodes.front().find(container);
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_FROZEN_DOCUMENT_H
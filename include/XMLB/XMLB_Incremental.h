@@ -0,0 +1,654 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+
+#ifndef XMLB_INCREMENTAL_H
+#define XMLB_INCREMENTAL_H
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include "XMLB_Sink.h"
+#include "XMLB_Document.h"
+#include "XMLB_Output_format.h"
+#include "XMLB/detail/XMLB_Decorator.h"
+#include "XMLB/detail/XMLB_Node_context.h"
+#include "XMLB/detail/traits/XMLB_Type_methods_traits.h"
+
+#ifdef XMLB_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif // XMLB_POSIX
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Исходный текст документа, который хранится после загрузки
+	*
+	* @ingroup secondary
+	*
+	* @details Текст либо принадлежит объекту, либо отображён из файла в 
+	* память(mmap) - тогда дескриптор файла остаётся открытым, чтобы 
+	* копировать участки текста из файла в файл. Файл не должен меняться,
+	* пока объект существует
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Retained_source final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_type = std::basic_string<symbol_type>;
+		using size_type = std::size_t;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param text - исходный текст
+		**********************************************************************/
+		explicit Retained_source(string_type text) noexcept;
+
+		/**********************************************************************
+		* @brief Отобразить файл в память
+		*
+		* @details Символы файла берутся как есть, без перекодирования
+		*
+		* @param path - путь к файлу
+		*
+		* @throw std::system_error - если файл не удалось открыть или 
+		* отобразить
+		**********************************************************************/
+		explicit Retained_source(const std::filesystem::path& path);
+
+		Retained_source(const Retained_source&) = delete;
+		Retained_source& operator=(const Retained_source&) = delete;
+
+		~Retained_source();
+		/// @}
+
+
+
+		/// @name Методы доступа
+		/// @{
+		const symbol_type* data() const noexcept;
+		size_type size() const noexcept;
+
+		/**********************************************************************
+		* @return дескриптор файла или -1, если текст не из файла
+		**********************************************************************/
+		int get_fd() const noexcept;
+		/// @}
+
+	private:
+		string_type m_text;
+		const symbol_type* m_data;
+		size_type m_size;
+		int m_fd;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Доступ функций загрузки и сохранения к исходному тексту 
+	* документа
+	*
+	* @ingroup secondary
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Source_access final
+	{
+	public:
+		using document_type = Document<CharT>;
+		using source_map = Source_map<Node<CharT>>;
+
+		template<typename DecorT>
+		static bool retain(document_type& document,
+			std::shared_ptr<const Retained_source<CharT>> source,
+			const DecorT& decorator);
+
+		static const source_map* get_source_map(
+			const document_type& document) noexcept;
+	};
+
+	//*************************************************************************
+
+	///Участки меньше этого размера в байтах копируются через память, а не
+	///средствами ядра
+	inline constexpr std::size_t kMin_file_copy_size = 64 * 1024;
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						RETAINED_SOURCE IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Retained_source<CharT>::Retained_source(string_type text) noexcept
+		:m_text{ std::move(text) },
+		m_data{ m_text.data() },
+		m_size{ m_text.size() },
+		m_fd{ -1 }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Retained_source<CharT>::Retained_source(
+		const std::filesystem::path& path)
+		:m_data{ nullptr },
+		m_size{ 0 },
+		m_fd{ -1 }
+	{
+#ifdef XMLB_POSIX
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (fd < 0)
+		{
+			throw std::system_error{ errno, std::generic_category(),
+				"Can't open the file!" };
+		}
+
+		struct ::stat info;
+
+		if (::fstat(fd, &info) != 0)
+		{
+			const int error = errno;
+
+			::close(fd);
+
+			throw std::system_error{ error, std::generic_category(),
+				"Can't read the file size!" };
+		}
+
+		const auto size = static_cast<size_type>(info.st_size) / 
+			sizeof(symbol_type);
+
+		//Пустой файл нельзя отобразить в память
+		if (!size)
+		{
+			::close(fd);
+
+			m_data = m_text.data();
+
+			return;
+		}
+
+		void* memory = ::mmap(nullptr, size * sizeof(symbol_type), PROT_READ,
+			MAP_PRIVATE, fd, 0);
+
+		if (memory == MAP_FAILED)
+		{
+			const int error = errno;
+
+			::close(fd);
+
+			throw std::system_error{ error, std::generic_category(),
+				"Can't map the file!" };
+		}
+
+		m_data = static_cast<const symbol_type*>(memory);
+		m_size = size;
+		m_fd = fd;
+#else
+		std::ifstream file{ path, std::ios_base::binary };
+
+		if (!file)
+		{
+			throw std::system_error{ 
+				std::make_error_code(std::errc::no_such_file_or_directory),
+				"Can't open the file!" };
+		}
+
+		std::string bytes{ std::istreambuf_iterator<char>{ file },
+			std::istreambuf_iterator<char>{} };
+
+		m_text.resize(bytes.size() / sizeof(symbol_type));
+		std::memcpy(m_text.data(), bytes.data(), 
+			m_text.size() * sizeof(symbol_type));
+
+		m_data = m_text.data();
+		m_size = m_text.size();
+#endif // XMLB_POSIX
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Retained_source<CharT>::~Retained_source()
+	{
+#ifdef XMLB_POSIX
+		if (m_fd >= 0)
+		{
+			::munmap(const_cast<symbol_type*>(m_data), 
+				m_size * sizeof(symbol_type));
+			::close(m_fd);
+		}
+#endif // XMLB_POSIX
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Retained_source<CharT>::symbol_type* 
+		Retained_source<CharT>::data() const noexcept
+	{
+		return m_data;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Retained_source<CharT>::size_type 
+		Retained_source<CharT>::size() const noexcept
+	{
+		return m_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline int Retained_source<CharT>::get_fd() const noexcept
+	{
+		return m_fd;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						SOURCE_ACCESS IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename DecorT>
+	inline bool Source_access<CharT>::retain(document_type& document,
+		std::shared_ptr<const Retained_source<CharT>> source,
+		const DecorT& decorator)
+	{
+		return document.retain_source(std::move(source), decorator);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Source_access<CharT>::source_map* 
+		Source_access<CharT>::get_source_map(const document_type& document)
+		noexcept
+	{
+		return document.get_source_map();
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Скопировать в приёмник участок исходного текста [first, last)
+	*
+	* @details Если приёмник пишет в файл, а текст отображён из файла, то 
+	* большие участки копируются средствами ядра
+	**************************************************************************/
+	template<typename CharT, typename SinkT>
+	inline void copy_source(const Source_map<Node<CharT>>& map, 
+		std::size_t first, std::size_t last, SinkT& sink)
+	{
+		if (first >= last)
+		{
+			return;
+		}
+
+		if constexpr (is_has_copy_from_v<SinkT>)
+		{
+			if (map.get_fd() >= 0 && 
+				(last - first) * sizeof(CharT) >= kMin_file_copy_size)
+			{
+				sink.copy_from(map.get_fd(), first, last - first);
+
+				return;
+			}
+		}
+
+		sink.append(map.get_source().data() + first, last - first);
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать в приёмник XML узел, копируя неизменённые части из
+	* исходного текста
+	*
+	* @details Чистое поддерево копируется целиком. У чистого узла с 
+	* грязными потомками копируются теги и промежутки между дочерними 
+	* узлами, а дочерние узлы записываются этой же функцией. Грязный узел
+	* записывается заново в формате FormatT, а его дочерние узлы - этой же
+	* функцией. Узлы, добавленные после загрузки, участков не имеют, как и 
+	* их потомки, поэтому записываются как обычно
+	*
+	* @tparam FormatT - формат вывода
+	* @param node - XML узел
+	* @param offset - уровень вложенности узла
+	* @param is_inline - окружение узла(отступ и перевод строки) уже 
+	* скопировано из исходного текста
+	* @param map - карта исходного текста
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	inline void write_retained_node(const Node<CharT>& node, 
+		std::size_t offset, bool is_inline, 
+		const Source_map<Node<CharT>>& map, SinkT& sink, 
+		const DecorT& decorator)
+	{
+		const auto* span = map.find(node);
+
+		const auto is_childs_retained = [&]()
+		{
+			return std::all_of(node.first_level_cbegin(), 
+				node.first_level_cend(), [&](auto&& child)
+				{
+					return map.find(*child) != nullptr;
+				});
+		};
+
+		if (!is_inline)
+		{
+			write_indent<FormatT>(offset, sink, decorator);
+		}
+
+		if (span && span->is_subtree_clean)
+		{
+			copy_source(map, span->first, span->last, sink);
+		}
+		else if (span && span->is_clean && is_childs_retained())
+		{
+			std::size_t position = span->first;
+
+			for (auto it = node.first_level_cbegin(), 
+				end = node.first_level_cend(); it != end; ++it)
+			{
+				const auto* child_span = map.find(**it);
+
+				copy_source(map, position, child_span->first, sink);
+
+				write_retained_node<FormatT>(**it, offset + 1, true, map, 
+					sink, decorator);
+
+				position = child_span->last;
+			}
+
+			copy_source(map, position, span->last, sink);
+		}
+		else
+		{
+			write_element_start<FormatT>(node, sink, decorator);
+
+			if (node.child_size())
+			{
+				if constexpr (FormatT::is_pretty)
+				{
+					sink.append(decorator.line_break_symbol);
+				}
+
+				if (span)
+				{
+					for (auto it = node.first_level_cbegin(),
+						end = node.first_level_cend(); it != end; ++it)
+					{
+						write_retained_node<FormatT>(**it, offset + 1, false,
+							map, sink, decorator);
+					}
+				}
+				else
+				{
+					save_to_sink<FormatT>(node.cbegin(), node.cend(), sink,
+						decorator, offset + 1);
+				}
+
+				write_indent<FormatT>(offset, sink, decorator);
+				write_element_end(node, sink, decorator);
+			}
+		}
+
+		if constexpr (FormatT::is_pretty)
+		{
+			if (!is_inline)
+			{
+				sink.append(decorator.line_break_symbol);
+			}
+		}
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+
+
+namespace XMLB
+{
+
+	/// @name Функции загрузки и сохранения с исходным текстом
+	/// @{
+	/**************************************************************************
+	* @brief Прочитать XML документ из строки и сохранить строку в документе
+	* 
+	* @ingroup general
+	* 
+	* @details Документ запоминает, какой участок строки занимает каждый
+	* узел, и отслеживает изменения узлов: имени, значения, атрибутов и 
+	* дочерних узлов. Узел, получивший неконстантный итератор атрибутов, 
+	* тоже считается изменённым. После этого save_incremental копирует
+	* неизменённые поддеревья из строки как есть.
+	* Если структура строки не совпала с деревом(например, из-за
+	* конструкций, которые парсер понимает иначе), документ загружается как
+	* обычно, без исходного текста
+	* 
+	* @tparam CharT - тип символов
+	* @tparam DecorT - тип декоратора
+	*
+	* @param source - XML данные
+	* @param decorator - декоратор
+	*
+	* @return в случае успешного завершения функции - документ с XML узлами. В
+	* противном случае, документ со значением nullptr
+	**************************************************************************/
+	template<typename CharT, 
+		typename DecorT = detail::default_decorator<CharT>>
+	[[nodiscard]] inline typename Document<CharT>::Ptr load_retained(
+		std::basic_string<CharT> source,
+		const DecorT& decorator = DecorT{})
+	{
+		auto retained = std::make_shared<const detail::Retained_source<CharT>>(
+			std::move(source));
+
+		auto result = load_from(retained->data(), 
+			retained->data() + retained->size(), decorator);
+
+		if (result && !result->is_empty())
+		{
+			detail::Source_access<CharT>::retain(*result, std::move(retained),
+				decorator);
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Прочитать XML документ из файла и сохранить файл отображённым в
+	* память
+	* 
+	* @ingroup general
+	* 
+	* @details То же, что load_retained, но текст не копируется в память
+	* процесса: файл отображается через mmap и остаётся открытым, пока
+	* существует документ или его копии. Поэтому save_incremental в Fd_sink
+	* копирует большие неизменённые участки из файла в файл средствами ядра.
+	* Символы файла берутся как есть, без перекодирования. Файл нельзя 
+	* менять, пока документ существует, в том числе сохранять документ в
+	* этот же файл
+	* 
+	* @tparam CharT - тип символов
+	* @tparam DecorT - тип декоратора
+	*
+	* @param path - путь к файлу
+	* @param decorator - декоратор
+	*
+	* @return в случае успешного завершения функции - документ с XML узлами. В
+	* противном случае, документ со значением nullptr
+	*
+	* @throw std::system_error - если файл не удалось открыть или отобразить
+	**************************************************************************/
+	template<typename CharT = char, 
+		typename DecorT = detail::default_decorator<CharT>>
+	[[nodiscard]] inline typename Document<CharT>::Ptr load_retained_file(
+		const std::filesystem::path& path,
+		const DecorT& decorator = DecorT{})
+	{
+		auto retained = 
+			std::make_shared<const detail::Retained_source<CharT>>(path);
+
+		auto result = load_from(retained->data(), 
+			retained->data() + retained->size(), decorator);
+
+		if (result && !result->is_empty())
+		{
+			detail::Source_access<CharT>::retain(*result, std::move(retained),
+				decorator);
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Записать XML документ в приёмник, копируя неизменённые 
+	* поддеревья из исходного текста
+	* 
+	* @ingroup general
+	* 
+	* @details Неизменённые поддеревья, комментарии и текст до и после 
+	* корневого узла копируются байт в байт, а изменённые узлы записываются
+	* заново в формате FormatT. Если после загрузки ничего не менялось, 
+	* результат совпадает с исходным текстом. Если у документа нет 
+	* исходного текста, работает как save_to
+	* 
+	* @tparam FormatT - формат изменённых узлов(Output_format)
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника. Если у него есть метод 
+	* copy_from(fd, offset, size), как у Fd_sink, и документ загружен 
+	* load_retained_file, большие участки копируются из файла в файл без
+	* копирования через память процесса
+	* @tparam DecorT - тип декоратора
+	*
+	* @param document - XML Документа
+	* @param sink - приёмник, в который будут заноситься данные
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT, 
+		typename SinkT, typename DecorT = detail::default_decorator<CharT>,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT> &&
+		detail::is_sink_to_symbol_v<SinkT, CharT>,
+		std::nullptr_t> = nullptr>
+	inline void save_incremental(const Document<CharT>& document, 
+		SinkT& sink, const DecorT& decorator = DecorT{})
+	{
+		const auto* map = 
+			detail::Source_access<CharT>::get_source_map(document);
+
+		if (!map || document.is_empty())
+		{
+			save_to<FormatT>(document, sink, decorator);
+
+			return;
+		}
+
+		const auto source = map->get_source();
+		std::size_t position = 0;
+
+		//Изменённое объявление записывается заново, а текст после него 
+		//копируется
+		if (!map->is_declaration_same(document.get_version(), 
+			document.get_encoding_type()))
+		{
+			detail::write_declaration<FormatT>(document, sink, decorator);
+
+			position = map->get_declaration_last();
+
+			while (position < map->get_root_first() &&
+				(source[position] == decorator.line_break_symbol ||
+				source[position] == decorator.carriage_symbol))
+			{
+				++position;
+			}
+		}
+
+		detail::copy_source(*map, position, map->get_root_first(), sink);
+
+		detail::write_retained_node<FormatT>(document.root(), 0, true, *map,
+			sink, decorator);
+
+		detail::copy_source(*map, map->get_root_last(), source.size(), sink);
+	}
+
+	//*************************************************************************
+	/// @}
+
+} // namespace XMLB
+
+#endif // !XMLB_INCREMENTAL_H
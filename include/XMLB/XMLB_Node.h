@@ -31,8 +31,17 @@
 #include <string_view>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
 
+#include "XMLB/XMLB_Number_conversion.h"
+#include "XMLB/detail/XMLB_Node_value.h"
 #include "XMLB/detail/XMLB_Node_iterator.h"
+#include "XMLB/detail/XMLB_Node_builder.h"
+#include "XMLB/detail/XMLB_Node_context.h"
+#include "XMLB/detail/XMLB_Query_iterator.h"
 #include "XMLB/detail/XMLB_Diagnostic_iterator.h"
 #include "XMLB/detail/traits/XMLB_Type_traits.h"
 #include "XMLB/detail/traits/XMLB_Type_methods_traits.h"
@@ -95,6 +104,13 @@ namespace XMLB
 		using iterator = detail::Node_iterator<node_type>;
 		using const_iterator = detail::Node_const_iterator<node_type>;
 
+		using preorder_iterator = detail::Node_preorder_iterator<node_type>;
+		using preorder_const_iterator = 
+			detail::Node_preorder_const_iterator<node_type>;
+
+		using find_range = detail::Query_range<node_type>;
+		using find_const_range = detail::Query_range<const node_type>;
+
 
 
 		/// @name Конструкторы, деструктор
@@ -116,7 +132,16 @@ namespace XMLB
 		Node& operator=(const Node& node);
 
 		Node(Node&& node) noexcept;
-		Node& operator=(Node&& node) noexcept;
+
+		/**********************************************************************
+		* @details Выполняется через swap(), поэтому, в отличие от 
+		* перемещающего конструктора, не noexcept. Без уникальных индексов
+		* атрибутов исключений не бывает
+		*
+		* @throw std::invalid_argument - если в документе узла нарушится 
+		* уникальность значений атрибута
+		**********************************************************************/
+		Node& operator=(Node&& node);
 
 		~Node() = default;
 		/// @}
@@ -171,6 +196,48 @@ namespace XMLB
 		* @return невладеющий объект-обертку строки со значением узла
 		**********************************************************************/
 		string_wrapper get_value() const & noexcept;
+
+		/**********************************************************************
+		* @brief Изменить значение узла на число
+		*
+		* @details Целые числа, double и bool хранятся в узле как есть и 
+		* переводятся в текст только при сохранении или вызове get_value().
+		* Остальные числа сразу записываются через format_number()
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param value - новое значение узла
+		**********************************************************************/
+		template<typename T, std::enable_if_t<detail::is_number_v<T>, 
+			std::nullptr_t> = nullptr>
+		void set_value(T value);
+
+		/**********************************************************************
+		* @brief Получить значение узла в виде числа
+		*
+		* @details Текст разбирается при первом чтении, а int64, double и 
+		* bool результат запоминается до следующего изменения значения
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		*
+		* @throw std::invalid_argument - если значение не является числом 
+		* типа T
+		*
+		* @return число из значения узла
+		**********************************************************************/
+		template<typename T>
+		T get_value_as() const;
+
+		/**********************************************************************
+		* @brief Получить значение узла в виде числа
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param default_value - результат, если значение не является числом
+		* типа T
+		*
+		* @return число из значения узла или default_value
+		**********************************************************************/
+		template<typename T>
+		T get_value_as(T default_value) const noexcept;
 		/// @}
 
 
@@ -194,10 +261,81 @@ namespace XMLB
 		* @return текущий узел
 		**********************************************************************/
 		node_type& add_attribute(attribute_type&& attribute) &;
+
+		/**********************************************************************
+		* @brief Изменить значение атрибута или добавить атрибут, если его
+		* нет
+		*
+		* @details В отличие от изменения значения через итератор атрибута,
+		* обновляет индексы атрибутов документа и отмечает узел изменённым 
+		* для save_incremental
+		*
+		* @param attribute_name - название атрибута
+		* @param value - новое значение атрибута
+		*
+		* @throw std::invalid_argument - если значение уже занято другим
+		* узлом в уникальном индексе атрибута документа
+		*
+		* @return текущий узел
+		**********************************************************************/
+		node_type& set_attribute(const string_type& attribute_name,
+			const string_type& value) &;
+
+		/**********************************************************************
+		* @brief Изменить значение атрибута на число или добавить атрибут, 
+		* если его нет
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param attribute_name - название атрибута
+		* @param value - новое значение атрибута
+		*
+		* @throw std::invalid_argument - если значение уже занято другим
+		* узлом в уникальном индексе атрибута документа
+		*
+		* @return текущий узел
+		**********************************************************************/
+		template<typename T, std::enable_if_t<detail::is_number_v<T>, 
+			std::nullptr_t> = nullptr>
+		node_type& set_attribute(const string_type& attribute_name,
+			T value) &;
+
+		/**********************************************************************
+		* @brief Получить значение атрибута в виде числа
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param attribute_name - название атрибута
+		*
+		* @throw std::invalid_argument - если атрибута нет или его значение
+		* не является числом типа T
+		*
+		* @return число из значения атрибута
+		**********************************************************************/
+		template<typename T>
+		T get_attribute_as(const string_type& attribute_name) const;
+
+		/**********************************************************************
+		* @brief Получить значение атрибута в виде числа
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param attribute_name - название атрибута
+		* @param default_value - результат, если атрибута нет или его 
+		* значение не является числом типа T
+		*
+		* @return число из значения атрибута или default_value
+		**********************************************************************/
+		template<typename T>
+		T get_attribute_as(const string_type& attribute_name,
+			T default_value) const;
 		
 		/**********************************************************************
 		* @brief Найти атрибут
 		*
+		* @details Атрибут можно изменить через итератор, поэтому узел
+		* считается изменённым: индексы атрибутов документа будут построены 
+		* заново, а save_incremental() запишет узел из его данных. 
+		* Уникальность значений, записанных через итератор, не проверяется.
+		* Для чтения используйте константную перегрузку
+		*
 		* @param attribute_name - название атрибута
 		*
 		* @return текущий узел
@@ -255,6 +393,12 @@ namespace XMLB
 		**********************************************************************/
 		size_type attr_size() const noexcept;
 
+		/**********************************************************************
+		* @brief Неконстантные итераторы атрибутов
+		*
+		* @details Узел считается изменённым так же, как в неконстантном 
+		* find_attribute(). Для чтения используйте attr_cbegin()/attr_cend()
+		**********************************************************************/
 		attr_iterator attr_begin() noexcept;
 		attr_iterator attr_end() noexcept;
 
@@ -299,6 +443,25 @@ namespace XMLB
 		**********************************************************************/
 		node_type& add_child(Ptr node) &;
 
+		/**********************************************************************
+		* @brief Добавить последовательность дочерних узлов
+		*
+		* @details Все узлы из диапазона [first, last) присоединяются к 
+		* текущему узлу за один проход, а общее количество узлов у родителей
+		* обновляется один раз для всей последовательности. Если value_type
+		* итератора - Ptr, то узлы перемещаются из последовательности, пустые
+		* указатели и указатель на текущий узел пропускаются. В противном 
+		* случае узлы копируются (или перемещаются, если итератор возвращает
+		* rvalue, например std::move_iterator)
+		*
+		* @tparam IterT - тип итератора на узлы или на Ptr
+		* @param first - итератор на первый добавляемый узел
+		* @param last - итератор за последним добавляемым узлом
+		*
+		* @return текущий узел
+		**********************************************************************/
+		template<typename IterT>
+		node_type& add_children(IterT first, IterT last) &;
 
 		/**********************************************************************
 		* @brief Удалить дочерний узел
@@ -345,6 +508,29 @@ namespace XMLB
 		iterator erase_child(const_iterator node_first, 
 			const_iterator node_last);
 
+		/**********************************************************************
+		* @brief Перенести узел вместе с его дочерними узлами
+		*
+		* @details Узел вынимается из текущего места (в том числе из другого
+		* документа) и становится дочерним узлом текущего узла перед 
+		* position. Узлы не копируются: меняются связи обхода на концах 
+		* поддерева, количество узлов у родителей обоих мест и индексы 
+		* документов. Глубина узлов поддерева пересчитывается, только если
+		* она изменилась
+		*
+		* @param position - итератор на дочерний узел первого уровня, перед
+		* которым встанет узел
+		* @param node - переносимый узел, у которого есть родитель
+		*
+		* @return перенесённый узел
+		*
+		* @throw std::invalid_argument - если у узла нет родителя, если 
+		* текущий узел находится в его поддереве или если в документе 
+		* нарушится уникальность значений атрибута
+		**********************************************************************/
+		node_type& splice(first_level_const_iterator position, 
+			node_type& node);
+
 		first_level_iterator first_level_begin() noexcept;
 		first_level_iterator first_level_end() noexcept;
 
@@ -362,6 +548,21 @@ namespace XMLB
 
 		const_iterator cbegin() const noexcept;
 		const_iterator cend() const noexcept;
+
+		/**********************************************************************
+		* @brief Итераторы прямого обхода дочерних узлов
+		*
+		* @details Обходят те же узлы, что и begin()/end(), но не хранят
+		* глубину начального узла и не умеют считать отступ
+		**********************************************************************/
+		preorder_iterator preorder_begin() noexcept;
+		preorder_iterator preorder_end() noexcept;
+
+		preorder_const_iterator preorder_begin() const noexcept;
+		preorder_const_iterator preorder_end() const noexcept;
+
+		preorder_const_iterator preorder_cbegin() const noexcept;
+		preorder_const_iterator preorder_cend() const noexcept;
 		/// @}
 
 
@@ -393,9 +594,34 @@ namespace XMLB
 		/**********************************************************************
 		* @brief Обменять данные
 		*
+		* @details Узлы остаются на своих местах и обмениваются именем, 
+		* значением, атрибутами и дочерними узлами. Обмен с предком или 
+		* потомком не выполняется
+		*
 		* @param node - правый Node
+		*
+		* @throw std::invalid_argument - если в документе одного из узлов 
+		* нарушится уникальность значений атрибута. Узлы при этом не 
+		* меняются. Проверка выполняется, только если узлы из разных 
+		* документов и у документа есть уникальный индекс атрибута
+		**********************************************************************/
+		void swap(node_type& node);
+
+		/**********************************************************************
+		* @brief Поменять местами поддеревья текущего узла и node
+		*
+		* @details В отличие от swap(), узлы не обмениваются данными, а 
+		* переходят на места друг друга, в том числе между документами. 
+		* Меняются только связи на концах поддеревьев, количество узлов у
+		* родителей и индексы документов
+		*
+		* @param node - узел, с которым нужно поменяться местами
+		*
+		* @throw std::invalid_argument - если у одного из узлов нет родителя,
+		* если один узел - предок другого или если в документе нарушится 
+		* уникальность значений атрибута
 		**********************************************************************/
-		void swap(node_type& node) noexcept;
+		void swap_subtrees(node_type& node);
 		/// @}
 
 
@@ -581,193 +807,369 @@ namespace XMLB
 		const_iterator find(const ContT& container, 
 			const_iterator offset = const_iterator{ nullptr }) const;
 
-		//*********************************************************************
-		/// @}
+		/**********************************************************************
+		* @brief Найти узел по пути из имён дочерних узлов
+		*
+		* @details В отличие от find(), каждое имя ищется только среди
+		* прямых дочерних узлов найденного на предыдущем шаге узла, например:
+		* find_child_path({ "config", "db", "host" }). Поиск стоит сумму
+		* количеств дочерних узлов на пути, а не размер поддерева, и не 
+		* находит одноимённые узлы на другой глубине
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return итератор на узел - если он был найден. В противном случае
+		* возвращает итератор указывающий на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	private:
-		tree_node* find_last_tree_node() const;
-		void connect_tree_nodes(tree_node* current_node, tree_node* add_node);
+			detail::is_has_begin_and_end_v<ContT>&&
 
-		iterator erase_element(const_iterator node);
-		iterator erase_element(const_iterator node_first, 
-			const_iterator node_last);
+			detail::is_has_value_type_v<ContT> &&
 
-		iterator find_element(const_iterator first,
-			const_iterator last, string_wrapper tag_name) const;
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-		void update_size(int size) noexcept;
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	private:
-		string_type m_name;
-		string_type m_value;
-		std::list<attribute_type> m_attributes;
-		std::list<Ptr> m_childs;
-		size_type m_size;
-		mutable tree_node m_tree_node;
-	};
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-	//*************************************************************************
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
+			std::nullptr_t> = nullptr>
+		iterator find_child_path(const ContT& container);
 
+		/**********************************************************************
+		* @brief Найти узел по пути из имён дочерних узлов
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return константный итератор на узел - если он был найден. 
+		* В противном случае возвращает константный итератор указывающий 
+		* на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	//*************************************************************************
-	//							NODE IMPLEMENTATION
-	//*************************************************************************
+			detail::is_has_begin_and_end_v<ContT>&&
 
-	template<typename CharT>
-	inline Node<CharT>::Node(const string_type& name, const string_type& value)
-		:m_name{ name }, m_value{ value }, m_size{ 0 }
-	{
-		m_tree_node.element = this;
-	}
+			detail::is_has_value_type_v<ContT> &&
 
-	//*************************************************************************
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	template<typename CharT>
-	inline Node<CharT>::Node(string_type&& name, string_type&& value) noexcept
-		:m_name{ std::move(name) }, m_value{ std::move(value) }, m_size{ 0 }	
-	{
-		m_tree_node.element = this;
-	}
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	//*************************************************************************
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-	template<typename CharT>
-	inline Node<CharT>::Node(const Node<CharT>& node)
-		:m_name{ node.m_name },
-		m_value{ node.m_value },
-		m_attributes{ node.m_attributes.cbegin(), node.m_attributes.cend() },
-		m_size{ 0 }
-	{
-		m_tree_node.element = this;
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
-		for (auto& elem : node.m_childs)
-		{
-			add_child(*elem);
-		}
-	}
+			std::nullptr_t> = nullptr>
+		const_iterator find_child_path(const ContT& container) const;
 
-	//*************************************************************************
+		/**********************************************************************
+		* @brief Найти все узлы с именем
+		*
+		* @details Узлы ищутся среди потомков текущего узла за один проход, 
+		* по мере продвижения по диапазону. В отличие от повторных вызовов
+		* find() со смещением, каждый следующий узел ищется с места, где
+		* закончился поиск предыдущего
+		*
+		* @param name - имя узлов
+		*
+		* @return ленивый диапазон найденных узлов в порядке документа
+		**********************************************************************/
+		find_range find_all(string_wrapper name);
+		find_const_range find_all(string_wrapper name) const;
 
-	template<typename CharT>
-	inline Node<CharT>& Node<CharT>::operator=(const Node<CharT>& node)
-	{
-		if (this != &node)
-		{
-			*this = Node{ node };
-		}
+		/**********************************************************************
+		* @brief Найти все узлы по пути из имён
+		*
+		* @details Путь понимается так же, как в find(): каждое следующее имя
+		* ищется среди потомков узла с предыдущим именем. Каждый подходящий
+		* узел выдаётся один раз, даже если к нему ведут несколько путей
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов пути
+		*
+		* @return ленивый диапазон найденных узлов в порядке документа
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-		return *this;
-	}
+			detail::is_has_begin_and_end_v<ContT>&&
 
-	//*************************************************************************
+			detail::is_has_value_type_v<ContT> &&
 
-	template<typename CharT>
-	inline Node<CharT>::Node(Node<CharT>&& node) noexcept
-		:m_name{ std::move(node.m_name) },
-		m_value{ std::move(node.m_value) },
-		m_attributes{ std::move(node.m_attributes) },
-		m_childs{ std::move(node.m_childs) },
-		m_size{ 0 }
-	{
-		m_tree_node.element = this;
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-		node.m_tree_node.next = nullptr;
-		node.m_tree_node.prev = nullptr;
-		node.m_tree_node.parent = nullptr;
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-		//Конектим первый дочерний элемент с текущим и изменяем им родителя на
-		//текущий элемент
-		if (m_childs.size())
-		{
-			m_tree_node.next = &m_childs.front()->m_tree_node;
-			m_childs.front()->m_tree_node.prev = &m_tree_node;
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-			for (auto&& elem : m_childs)
-			{
-				elem->m_tree_node.parent = &m_tree_node;
-			}
-		}
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
-		auto last_child = find_last_tree_node();
+			std::nullptr_t> = nullptr>
+		find_range find_all(const ContT& container);
 
-		if (last_child != &m_tree_node)
-		{
-			last_child->next = &m_tree_node;
-			m_tree_node.prev = last_child;
-		}
-	}
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
 
-	//*************************************************************************
+			detail::is_has_begin_and_end_v<ContT>&&
 
-	template<typename CharT>
-	inline Node<CharT>& Node<CharT>::operator=(Node<CharT>&& node) noexcept
-	{
-		if (this != &node)
-		{
-			swap(node);
-		}
+			detail::is_has_value_type_v<ContT> &&
 
-		return *this;
-	}
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
 
-	//*************************************************************************
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
 
-	template<typename CharT>
-	inline void Node<CharT>::set_name(const string_type& name)
-	{
-		m_name = name;
-	}
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
 
-	//*************************************************************************
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
 
-	template<typename CharT>
-	inline void Node<CharT>::set_name(string_type&& name) noexcept
-	{
-		m_name = std::move(name);
-	}
+			std::nullptr_t> = nullptr>
+		find_const_range find_all(const ContT& container) const;
+
+		/**********************************************************************
+		* @brief Найти первый узел с любым из имён
+		*
+		* @details Имена один раз собираются в хеш-множество, после чего
+		* имя каждого просмотренного узла проверяется одним поиском в нём.
+		* Поэтому поиск любого из K имён стоит одного прохода, а не K. 
+		* Следующие совпадения находятся повторным вызовом со смещением
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов
+		* @param offset - итератор, с которого начать искать
+		*
+		* @return итератор на узел - если он был найден. В противном случае
+		* возвращает итератор указывающий на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+
+			detail::is_has_begin_and_end_v<ContT>&&
+
+			detail::is_has_value_type_v<ContT> &&
+
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		iterator find_any(const ContT& container, 
+			const_iterator offset = const_iterator{ nullptr });
+
+		/**********************************************************************
+		* @brief Найти первый узел с любым из имён
+		*
+		* @tparam ContT - тип контейнера
+		* @param container - список имён узлов
+		* @param offset - итератор, с которого начать искать
+		*
+		* @return константный итератор на узел - если он был найден. 
+		* В противном случае возвращает константный итератор указывающий 
+		* на end()
+		**********************************************************************/
+		template<typename ContT = std::initializer_list<string_wrapper>,
+			std::enable_if_t<
+
+			detail::is_has_begin_and_end_v<ContT>&&
+
+			detail::is_has_value_type_v<ContT> &&
+
+			!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+			(std::is_constructible_v<string_wrapper,
+				std::decay_t<
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+				std::is_constructible_v<string_wrapper,
+				detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+			std::is_same_v<std::remove_const_t<
+			detail::universal_value_type_t<ContT>>, symbol_type>,
+
+			std::nullptr_t> = nullptr>
+		const_iterator find_any(const ContT& container, 
+			const_iterator offset = const_iterator{ nullptr }) const;
+
+		//*********************************************************************
+		/// @}
+
+	private:
+		tree_node* find_last_tree_node() const;
+		void connect_tree_nodes(tree_node* add_node);
+		tree_node* link_tree_nodes(tree_node* current_node, 
+			unsigned int current_depth, tree_node* add_node) noexcept;
+		void unlink_tree_nodes() noexcept;
+
+		iterator erase_element(const_iterator node);
+		iterator erase_element(const_iterator node_first, 
+			const_iterator node_last);
+
+		iterator find_element(const_iterator first,
+			const_iterator last, string_wrapper tag_name) const;
+		template<typename IterT>
+		node_type* find_child_path_node(IterT word_it, IterT word_end) const;
+		template<typename IterT>
+		iterator find_any_element(const_iterator first, const_iterator last,
+			IterT word_it, IterT word_end) const;
+
+		node_type* update_size(int size) noexcept;
+		void update_last(tree_node* old_last, tree_node* new_last,
+			unsigned int depth) noexcept;
+
+		node_type* find_top() const noexcept;
+		bool is_descendant_of(const node_type& node) const noexcept;
+		bool is_in_subtree(const_iterator node) const noexcept;
+		first_level_iterator find_first_level_position() const noexcept;
+		void notify_attach(tree_node* first, tree_node* last, 
+			node_type* top) noexcept;
+		static void share_context(tree_node* first, tree_node* last,
+			detail::Node_context<node_type>* context) noexcept;
+
+		const detail::Name_index<node_type>* get_name_index() const noexcept;
+		const detail::Name_summary<node_type>* get_name_summary() const 
+			noexcept;
+		void update_context() noexcept;
+
+		void check_attach(const node_type& node) const;
+
+		template<typename FuncT>
+		void change_attributes(FuncT&& func);
+		void expose_attributes() noexcept;
+		attr_iterator find_attribute_element(
+			const string_type& attribute_name) noexcept;
+		std::unique_lock<detail::Change_mutex> lock_changes() const noexcept;
+
+		template<typename NodeT>
+		friend class detail::Node_builder;
+
+		template<typename NodeT>
+		friend class detail::Concurrent_changes;
+
+		template<typename T>
+		friend class Document;
+
+		template<typename NodeT>
+		friend class detail::Node_context;
+
+		template<typename NodeT>
+		friend class detail::Source_map;
+
+		template<typename T>
+		friend class detail::Value_access;
+
+	private:
+		string_type m_name;
+		detail::Node_value<symbol_type> m_value;
+		std::list<attribute_type> m_attributes;
+		std::list<Ptr> m_childs;
+		size_type m_size;
+		mutable tree_node m_tree_node;
+		first_level_iterator m_position;
+		std::unique_ptr<detail::Node_context<node_type>> m_context;
+		detail::Node_context<node_type>* m_top_context = nullptr;
+	};
 
 	//*************************************************************************
 
-	template<typename CharT>
-	inline typename Node<CharT>::string_wrapper Node<CharT>::get_name() 
-		const & noexcept
-	{
-		return string_wrapper{ m_name };
-	}
 
+
+	//*************************************************************************
+	//							NODE IMPLEMENTATION
 	//*************************************************************************
 
 	template<typename CharT>
-	inline void Node<CharT>::set_value(const string_type& value)
+	inline Node<CharT>::Node(const string_type& name, const string_type& value)
+		:m_name{ name }, m_value{ value }, m_size{ 0 }
 	{
-		m_value = value;
+		m_tree_node.element = this;
+		m_tree_node.last = &m_tree_node;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline void Node<CharT>::set_value(string_type&& value) noexcept
+	inline Node<CharT>::Node(string_type&& name, string_type&& value) noexcept
+		:m_name{ std::move(name) }, m_value{ std::move(value) }, m_size{ 0 }	
 	{
-		m_value = std::move(value);
+		m_tree_node.element = this;
+		m_tree_node.last = &m_tree_node;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::string_wrapper Node<CharT>::get_value() 
-		const & noexcept
+	inline Node<CharT>::Node(const Node<CharT>& node)
+		:m_name{ node.m_name },
+		m_value{ node.m_value },
+		m_attributes{ node.m_attributes.cbegin(), node.m_attributes.cend() },
+		m_size{ 0 }
 	{
-		return string_wrapper{ m_value };
+		m_tree_node.element = this;
+		m_tree_node.last = &m_tree_node;
+
+		//Копируем дочерние узлы в порядке документа - так каждая копия
+		//сразу получает свою глубину и количество узлов без подъёма по
+		//родителям
+		detail::Node_builder<node_type> builder{ *this };
+
+		for (auto first = node.cbegin(), last = node.cend(); 
+			first != last; ++first)
+		{
+			while (builder.level() > first.get_offset())
+			{
+				builder.close();
+			}
+
+			auto copy = std::make_unique<node_type>(
+				first->m_name, string_type{});
+
+			copy->m_value = first->m_value;
+			copy->m_attributes = first->m_attributes;
+
+			builder.open(std::move(copy));
+		}
+
+		builder.finish();
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::node_type& 
-		Node<CharT>::add_attribute(const attribute_type& attribute) &
+	inline Node<CharT>& Node<CharT>::operator=(const Node<CharT>& node)
 	{
-		m_attributes.push_back(attribute);
+		if (this != &node)
+		{
+			*this = Node{ node };
+		}
 
 		return *this;
 	}
@@ -775,116 +1177,431 @@ namespace XMLB
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::node_type& 
-		Node<CharT>::add_attribute(attribute_type&& attribute) &
+	inline Node<CharT>::Node(Node<CharT>&& node) noexcept
+		:m_name{ std::move(node.m_name) },
+		m_value{ std::move(node.m_value) },
+		m_attributes{ std::move(node.m_attributes) },
+		m_childs{ std::move(node.m_childs) },
+		m_size{ node.m_size }
 	{
-		m_attributes.push_back(std::move(attribute));
+		m_tree_node.element = this;
+		m_tree_node.last = &m_tree_node;
 
-		return *this;
+		//Индексы перемещённого узла ссылаются на узлы, которых у него
+		//больше нет
+		if (node.m_context)
+		{
+			node.m_context->invalidate();
+		}
+
+		//Конектим первый дочерний элемент с текущим и изменяем им родителя на
+		//текущий элемент. Глубины внутри поддерева хранятся относительно
+		//соседей, поэтому не меняются
+		if (m_childs.size())
+		{
+			m_tree_node.next = &m_childs.front()->m_tree_node;
+			m_childs.front()->m_tree_node.prev = &m_tree_node;
+
+			for (auto&& elem : m_childs)
+			{
+				elem->m_tree_node.parent = &m_tree_node;
+			}
+
+			m_tree_node.last = node.m_tree_node.last;
+			m_tree_node.last_depth = node.m_tree_node.last_depth;
+
+			m_tree_node.last->next = &m_tree_node;
+			m_tree_node.prev = m_tree_node.last;
+			m_tree_node.step = -static_cast<int>(m_tree_node.last_depth);
+
+			//Дочерние узлы ушли из дерева перемещённого узла
+			share_context(m_tree_node.next, m_tree_node.last, nullptr);
+		}
+
+		node.m_size = 0;
+		node.m_tree_node.next = nullptr;
+		node.m_tree_node.prev = nullptr;
+		node.m_tree_node.parent = nullptr;
+		node.m_tree_node.last = &node.m_tree_node;
+		node.m_tree_node.last_depth = 0;
+		node.m_tree_node.step = 0;
 	}
-	
+
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator 
-		Node<CharT>::find_attribute(const string_type& attribute_name)
+	inline Node<CharT>& Node<CharT>::operator=(Node<CharT>&& node)
 	{
-		using std::begin;
-		using std::end;
-		
-		auto&& attr_founder = [&](auto&& attribute)
+		if (this != &node)
 		{
-			return attribute.name == attribute_name;
-		};
-		
-		return std::find_if(begin(m_attributes), end(m_attributes), 
-			attr_founder);
+			swap(node);
+		}
+
+		return *this;
 	}
-	
+
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_const_iterator 
-		Node<CharT>::find_attribute(const string_type& attribute_name) const
+	inline void Node<CharT>::set_name(const string_type& name)
 	{
-		using std::begin;
-		using std::end;
-		
-		auto&& attr_founder = [&](auto&& attribute)
+		auto lock = lock_changes();
+
+		if (m_top_context)
 		{
-			return attribute.name == attribute_name;
-		};
-		
-		return std::find_if(begin(m_attributes), end(m_attributes), 
-			attr_founder);
+			m_top_context->rename(&m_tree_node, name);
+		}
+
+		m_name = name;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator 
-		Node<CharT>::erase_attribute(std::size_t index)
+	inline void Node<CharT>::set_name(string_type&& name) noexcept
 	{
-		if (index < m_attributes.size())
-		{
-			return m_attributes.erase(std::next(m_attributes.cbegin(), index));
-		}
-		else
+		auto lock = lock_changes();
+
+		if (m_top_context)
 		{
-			return m_attributes.end();
+			m_top_context->rename(&m_tree_node, name);
 		}
+
+		m_name = std::move(name);
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator Node<CharT>::erase_attribute(
-		attr_const_iterator attr_iter)
+	inline typename Node<CharT>::string_wrapper Node<CharT>::get_name() 
+		const & noexcept
 	{
-		return m_attributes.erase(attr_iter);
+		return string_wrapper{ m_name };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator 
-		Node<CharT>::erase_attribute(attr_const_iterator attribute_fisrt, 
-		attr_const_iterator attribute_last)
+	inline void Node<CharT>::set_value(const string_type& value)
 	{
-		return m_attributes.erase(attribute_fisrt, attribute_last);
+		auto lock = lock_changes();
+
+		m_value.assign(value);
+
+		if (m_top_context)
+		{
+			m_top_context->change(&m_tree_node);
+		}
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::size_type Node<CharT>::attr_size() const 
-		noexcept
+	inline void Node<CharT>::set_value(string_type&& value) noexcept
 	{
-		return m_attributes.size();
+		auto lock = lock_changes();
+
+		m_value.assign(std::move(value));
+
+		if (m_top_context)
+		{
+			m_top_context->change(&m_tree_node);
+		}
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator Node<CharT>::attr_begin() 
-		noexcept
+	inline typename Node<CharT>::string_wrapper Node<CharT>::get_value() 
+		const & noexcept
 	{
-		return m_attributes.begin();
+		return m_value.get_text();
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_iterator Node<CharT>::attr_end() noexcept
+	template<typename T, std::enable_if_t<detail::is_number_v<T>, 
+		std::nullptr_t>>
+	inline void Node<CharT>::set_value(T value)
 	{
-		return m_attributes.end();
+		auto lock = lock_changes();
+
+		m_value.assign_number(value);
+
+		if (m_top_context)
+		{
+			m_top_context->change(&m_tree_node);
+		}
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::attr_const_iterator Node<CharT>::attr_begin() 
-		const noexcept
+	template<typename T>
+	inline T Node<CharT>::get_value_as() const
+	{
+		T result{};
+
+		if (!m_value.get_number(result))
+		{
+			throw std::invalid_argument{ "The node value isn't a number!" };
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline T Node<CharT>::get_value_as(T default_value) const noexcept
+	{
+		m_value.get_number(default_value);
+
+		return default_value;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::node_type& 
+		Node<CharT>::add_attribute(const attribute_type& attribute) &
+	{
+		auto lock = lock_changes();
+
+		if (m_top_context && 
+			find_attribute_element(attribute.name) == m_attributes.end())
+		{
+			m_top_context->check_attribute(
+				&m_tree_node, attribute.name, attribute.value);
+		}
+
+		change_attributes([&]() { m_attributes.push_back(attribute); });
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::node_type& 
+		Node<CharT>::add_attribute(attribute_type&& attribute) &
+	{
+		auto lock = lock_changes();
+
+		if (m_top_context &&
+			find_attribute_element(attribute.name) == m_attributes.end())
+		{
+			m_top_context->check_attribute(
+				&m_tree_node, attribute.name, attribute.value);
+		}
+
+		change_attributes([&]() 
+			{ 
+				m_attributes.push_back(std::move(attribute)); 
+			});
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::node_type& Node<CharT>::set_attribute(
+		const string_type& attribute_name, const string_type& value) &
+	{
+		auto lock = lock_changes();
+
+		if (m_top_context)
+		{
+			m_top_context->check_attribute(&m_tree_node, attribute_name, 
+				value);
+		}
+
+		change_attributes([&]()
+			{
+				auto attribute = find_attribute_element(attribute_name);
+
+				if (attribute != m_attributes.end())
+				{
+					attribute->value = value;
+				}
+				else
+				{
+					m_attributes.push_back(
+						attribute_type{ attribute_name, value });
+				}
+			});
+
+		return *this;
+	}
+	
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T, std::enable_if_t<detail::is_number_v<T>, 
+		std::nullptr_t>>
+	inline typename Node<CharT>::node_type& Node<CharT>::set_attribute(
+		const string_type& attribute_name, T value) &
+	{
+		return set_attribute(attribute_name, 
+			format_number<symbol_type>(value));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline T Node<CharT>::get_attribute_as(
+		const string_type& attribute_name) const
+	{
+		auto attribute = find_attribute(attribute_name);
+
+		if (attribute == m_attributes.end())
+		{
+			throw std::invalid_argument{ "The node has no such attribute!" };
+		}
+
+		T result{};
+
+		if (!parse_number(string_wrapper{ attribute->value }, result))
+		{
+			throw std::invalid_argument{ 
+				"The attribute value isn't a number!" };
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline T Node<CharT>::get_attribute_as(
+		const string_type& attribute_name, T default_value) const
+	{
+		auto attribute = find_attribute(attribute_name);
+
+		if (attribute != m_attributes.end())
+		{
+			parse_number(string_wrapper{ attribute->value }, default_value);
+		}
+
+		return default_value;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator 
+		Node<CharT>::find_attribute(const string_type& attribute_name)
+	{
+		expose_attributes();
+
+		return find_attribute_element(attribute_name);
+	}
+	
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_const_iterator 
+		Node<CharT>::find_attribute(const string_type& attribute_name) const
+	{
+		using std::begin;
+		using std::end;
+		
+		auto&& attr_founder = [&](auto&& attribute)
+		{
+			return attribute.name == attribute_name;
+		};
+		
+		return std::find_if(begin(m_attributes), end(m_attributes), 
+			attr_founder);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator 
+		Node<CharT>::erase_attribute(std::size_t index)
+	{
+		if (index < m_attributes.size())
+		{
+			return erase_attribute(std::next(m_attributes.cbegin(), index));
+		}
+		else
+		{
+			return m_attributes.end();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator Node<CharT>::erase_attribute(
+		attr_const_iterator attr_iter)
+	{
+		attr_iterator result = m_attributes.end();
+
+		change_attributes([&]() { result = m_attributes.erase(attr_iter); });
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator 
+		Node<CharT>::erase_attribute(attr_const_iterator attribute_fisrt, 
+		attr_const_iterator attribute_last)
+	{
+		attr_iterator result = m_attributes.end();
+
+		change_attributes([&]() 
+			{ 
+				result = m_attributes.erase(attribute_fisrt, attribute_last);
+			});
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::size_type Node<CharT>::attr_size() const 
+		noexcept
+	{
+		return m_attributes.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator Node<CharT>::attr_begin()
+		noexcept
+	{
+		expose_attributes();
+
+		return m_attributes.begin();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_iterator Node<CharT>::attr_end()
+		noexcept
+	{
+		expose_attributes();
+
+		return m_attributes.end();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::attr_const_iterator Node<CharT>::attr_begin() 
+		const noexcept
 	{
 		return m_attributes.cbegin();
 	}
@@ -922,12 +1639,11 @@ namespace XMLB
 	inline typename Node<CharT>::node_type& 
 		Node<CharT>::add_child(const node_type& node) &
 	{
-		tree_node* last_tree_node = find_last_tree_node();
+		check_attach(node);
 
 		m_childs.push_back(std::make_unique<Node<CharT>>(node));
 
-		connect_tree_nodes(
-			last_tree_node, &m_childs.back().get()->m_tree_node);
+		connect_tree_nodes(&m_childs.back().get()->m_tree_node);
 
 		return *m_childs.back();
 	}
@@ -943,12 +1659,11 @@ namespace XMLB
 			return *this;
 		}
 
-		tree_node* last_tree_node = find_last_tree_node();
+		check_attach(node);
 
 		m_childs.push_back(std::make_unique<Node<CharT>>(std::move(node)));
 
-		connect_tree_nodes(
-			last_tree_node, &m_childs.back().get()->m_tree_node);
+		connect_tree_nodes(&m_childs.back().get()->m_tree_node);
 
 		return *m_childs.back();
 	}
@@ -964,18 +1679,102 @@ namespace XMLB
 			return *this;
 		}
 
-		tree_node* last_tree_node = find_last_tree_node();
+		check_attach(*node);
 
 		m_childs.push_back(std::move(node));
 
-		connect_tree_nodes(
-			last_tree_node, &m_childs.back().get()->m_tree_node);
+		connect_tree_nodes(&m_childs.back().get()->m_tree_node);
 
 		return *m_childs.back();
 	}
 
 	//*************************************************************************
 
+	template<typename CharT>
+	template<typename IterT>
+	inline typename Node<CharT>::node_type& 
+		Node<CharT>::add_children(IterT first, IterT last) &
+	{
+		node_type* top = find_top();
+		tree_node* const old_last = find_last_tree_node();
+		tree_node* last_tree_node = old_last;
+		unsigned int last_depth = m_tree_node.last_depth;
+
+		int added_count = 0;
+
+		//Если очередной узел не удалось добавить, уже присоединённые узлы
+		//остаются и учитываются в количестве узлов у родителей
+		try
+		{
+			for (; first != last; ++first)
+			{
+				Ptr node{ nullptr };
+
+				if constexpr (std::is_same_v<
+					std::decay_t<detail::dereferenced_t<IterT>>, Ptr>)
+				{
+					if (!*first || this == (*first).get())
+					{
+						continue;
+					}
+
+					if (top->m_context)
+					{
+						top->m_context->check_attach(**first);
+					}
+
+					node = std::move(*first);
+				}
+				else
+				{
+					if (top->m_context)
+					{
+						top->m_context->check_attach(*first);
+					}
+
+					node = std::make_unique<node_type>(*first);
+				}
+
+				m_childs.push_back(std::move(node));
+				m_childs.back()->m_position = std::prev(m_childs.end());
+
+				tree_node* add_node = &m_childs.back()->m_tree_node;
+
+				last_tree_node = 
+					link_tree_nodes(last_tree_node, last_depth, add_node);
+				last_depth = 1 + add_node->last_depth;
+
+				added_count += static_cast<int>(m_childs.back()->m_size + 1);
+
+				//Индексы документа учитывают каждый узел сразу, чтобы 
+				//следующие узлы последовательности проверялись и с ним
+				notify_attach(add_node, last_tree_node, top);
+			}
+		}
+		catch (...)
+		{
+			if (added_count)
+			{
+				update_last(old_last, last_tree_node, last_depth);
+				update_size(added_count);
+			}
+
+			throw;
+		}
+
+		//Количество узлов и последний узел у родителей обновляем один раз 
+		//для всей последовательности
+		if (added_count)
+		{
+			update_last(old_last, last_tree_node, last_depth);
+			update_size(added_count);
+		}
+
+		return *this;
+	}
+
+	//*************************************************************************
+
 	template<typename CharT>
 	inline typename Node<CharT>::iterator Node<CharT>::erase_child(
 		std::size_t index)
@@ -1000,7 +1799,7 @@ namespace XMLB
 	{
 		auto result = end();
 
-		if (node._is_in_sequences(begin()))
+		if (is_in_subtree(node))
 		{
 			if (node != result)
 			{
@@ -1019,7 +1818,7 @@ namespace XMLB
 	{
 		auto result = end();
 
-		if (node_first != node_last && node_first._is_in_sequences(begin()))
+		if (node_first != node_last && is_in_subtree(node_first))
 		{
 			result = erase_element(node_first, node_last);
 		}
@@ -1136,172 +1935,518 @@ namespace XMLB
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::size_type Node<CharT>::child_size() const 
-		noexcept
+	inline typename Node<CharT>::preorder_iterator 
+		Node<CharT>::preorder_begin() noexcept
 	{
-		return m_childs.size();
+		return preorder_iterator{ m_tree_node.next };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::size_type Node<CharT>::size() const
-		noexcept
+	inline typename Node<CharT>::preorder_iterator 
+		Node<CharT>::preorder_end() noexcept
 	{
-		return m_size;
+		return preorder_iterator{ find_last_tree_node()->next };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline const typename Node<CharT>::node_type* Node<CharT>::get_parent() 
-		const noexcept
+	inline typename Node<CharT>::preorder_const_iterator 
+		Node<CharT>::preorder_begin() const noexcept
 	{
-		if (m_tree_node.parent)
-		{
-			return m_tree_node.parent->element;
-		}
-		else
-		{
-			return nullptr;
-		}
+		return preorder_const_iterator{ m_tree_node.next };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline void Node<CharT>::swap(node_type& node) noexcept
+	inline typename Node<CharT>::preorder_const_iterator 
+		Node<CharT>::preorder_end() const noexcept
 	{
-		using std::swap;
+		return preorder_const_iterator{ find_last_tree_node()->next };
+	}
 
-		//Получаем необходимые начальные узлы текущего элемента
-		//start -> swap_element -> end
+	//*************************************************************************
 
-		auto lhs_start = m_tree_node.prev;
-		auto lhs_end = find_last_tree_node()->next;
-		auto lhs_parent = m_tree_node.parent;	
+	template<typename CharT>
+	inline typename Node<CharT>::preorder_const_iterator 
+		Node<CharT>::preorder_cbegin() const noexcept
+	{
+		return preorder_const_iterator{ m_tree_node.next };
+	}
 
-		auto rhs_start = node.m_tree_node.prev;
-		auto rhs_end = node.find_last_tree_node()->next;
-		auto rhs_parent = node.m_tree_node.parent;
+	//*************************************************************************
 
-		swap(m_name, node.m_name);
-		swap(m_value, node.m_value);
-		swap(m_attributes, node.m_attributes);
-		swap(m_childs, node.m_childs);
-		swap(m_size, node.m_size);
-		swap(m_tree_node, node.m_tree_node);
+	template<typename CharT>
+	inline typename Node<CharT>::preorder_const_iterator 
+		Node<CharT>::preorder_cend() const noexcept
+	{
+		return preorder_const_iterator{ find_last_tree_node()->next };
+	}
 
-		//Присваиваем узлам указатели на текущие элементы
-		m_tree_node.element = this;
-		node.m_tree_node.element = &node;
+	//*************************************************************************
 
-		//Конектим первый дочерний элемент с текущим и изменяем им родителя на
-		//текущий элемент
-		if (m_childs.size())
+	template<typename CharT>
+	inline typename Node<CharT>::size_type Node<CharT>::child_size() const 
+		noexcept
+	{
+		return m_childs.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::size_type Node<CharT>::size() const
+		noexcept
+	{
+		return m_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Node<CharT>::node_type* Node<CharT>::get_parent() 
+		const noexcept
+	{
+		if (m_tree_node.parent)
 		{
-			m_tree_node.next = &m_childs.front()->m_tree_node;
-			m_childs.front()->m_tree_node.prev = &m_tree_node;
+			return m_tree_node.parent->element;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
 
-			for (auto&& elem : m_childs)
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node<CharT>::swap(node_type& node)
+	{
+		using std::swap;
+
+		//Обменять содержимое узла со своим предком или потомком нельзя - 
+		//узел оказался бы внутри самого себя
+		if (this == &node || is_descendant_of(node) || 
+			node.is_descendant_of(*this))
+		{
+			return;
+		}
+
+		//Узлы остаются на своих местах, меняются только их дочерние узлы
+		tree_node* lhs_last = find_last_tree_node();
+		tree_node* rhs_last = node.find_last_tree_node();
+
+		const int lhs_size_old = static_cast<int>(m_size);
+		const int rhs_size_old = static_cast<int>(node.m_size);
+
+		//Индексы убирают старое содержимое, пока оно ещё связано
+		node_type* lhs_top = find_top();
+		node_type* rhs_top = node.find_top();
+
+		if (m_tree_node.parent && lhs_top->m_context)
+		{
+			lhs_top->m_context->erase(&m_tree_node, lhs_last);
+		}
+
+		if (node.m_tree_node.parent && rhs_top->m_context)
+		{
+			rhs_top->m_context->erase(&node.m_tree_node, rhs_last);
+		}
+
+		//Уникальность значений проверяется без уходящего содержимого, как в
+		//swap_subtrees(). Внутри одного документа значения не меняются. При
+		//ошибке индексы получают старое содержимое обратно
+		if (lhs_top != rhs_top)
+		{
+			try
 			{
-				elem->m_tree_node.parent = &m_tree_node;
+				if (m_tree_node.parent && lhs_top->m_context)
+				{
+					lhs_top->m_context->check_attach(node);
+				}
+
+				if (node.m_tree_node.parent && rhs_top->m_context)
+				{
+					rhs_top->m_context->check_attach(*this);
+				}
+			}
+			catch (...)
+			{
+				if (m_tree_node.parent)
+				{
+					notify_attach(&m_tree_node, lhs_last, lhs_top);
+				}
+
+				if (node.m_tree_node.parent)
+				{
+					notify_attach(&node.m_tree_node, rhs_last, rhs_top);
+				}
+
+				throw;
+			}
+		}
+
+		swap(m_name, node.m_name);
+		m_value.swap(node.m_value);
+		swap(m_attributes, node.m_attributes);
+		swap(m_childs, node.m_childs);
+		swap(m_size, node.m_size);
+
+		//Дочерние узлы первого уровня получают нового родителя, остальные 
+		//связи внутри поддеревьев не меняются
+		for (node_type* current : { this, &node })
+		{
+			for (auto&& elem : current->m_childs)
+			{
+				elem->m_tree_node.parent = &current->m_tree_node;
 			}
 		}
 
-		//Конектим первый дочерний элемент с текущим node элементов и изменяем
-		//им родителя на текущий node элемент
-		if (node.m_childs.size())
+		struct Tree_chain
 		{
-			node.m_tree_node.next = &node.m_childs.front()->m_tree_node;
-			node.m_childs.front()->m_tree_node.prev = &node.m_tree_node;
+			tree_node* first;
+			tree_node* last;
+			unsigned int depth;
+		};
+
+		//Цепочка дочерних узлов вынимается из обхода так, будто у узла их
+		//нет. Глубины внутри цепочки заданы относительно соседей и при 
+		//переносе не меняются
+		const auto take_chain = [](tree_node& current) noexcept
+		{
+			Tree_chain result{ nullptr, nullptr, 0 };
+
+			if (current.last != &current)
+			{
+				result = Tree_chain{ current.next, current.last, 
+					current.last_depth };
+
+				tree_node* next = current.last->next;
+
+				current.next = next;
+				next->prev = &current;
+				next->step += static_cast<int>(current.last_depth);
+
+				current.last = &current;
+				current.last_depth = 0;
+			}
+
+			return result;
+		};
 
-			for (auto&& elem : node.m_childs)
+		//Цепочка вставляется сразу после узла. Отсоединённый узел без
+		//дочерних узлов замыкается сам на себя
+		const auto put_chain = [](tree_node& current, const Tree_chain& chain)
+			noexcept
+		{
+			if (chain.first)
 			{
-				elem->m_tree_node.parent = &node.m_tree_node;
+				tree_node* next = current.next ? current.next : &current;
+
+				current.next = chain.first;
+				chain.first->prev = &current;
+				chain.last->next = next;
+				next->prev = chain.last;
+				next->step -= static_cast<int>(chain.depth);
+
+				current.last = chain.last;
+				current.last_depth = chain.depth;
 			}
+		};
+
+		const Tree_chain lhs_chain = take_chain(m_tree_node);
+		const Tree_chain rhs_chain = take_chain(node.m_tree_node);
+
+		put_chain(m_tree_node, rhs_chain);
+		put_chain(node.m_tree_node, lhs_chain);
+
+		tree_node* lhs_new_last = find_last_tree_node();
+		tree_node* rhs_new_last = node.find_last_tree_node();
+
+		//Предки могут заканчиваться любым из поддеревьев. Сначала помечаем
+		//предков первого узла, чтобы не спутать их с предками второго
+		if (m_tree_node.parent)
+		{
+			m_tree_node.parent->element->update_last(lhs_last, nullptr, 0);
+		}
+
+		if (node.m_tree_node.parent)
+		{
+			node.m_tree_node.parent->element->update_last(rhs_last, 
+				rhs_new_last, node.m_tree_node.last_depth + 1);
+		}
+
+		if (m_tree_node.parent)
+		{
+			m_tree_node.parent->element->update_last(nullptr, lhs_new_last, 
+				m_tree_node.last_depth + 1);
 		}
 
-		//Получем новый узел, который является самым последним дочерним узлом
-		//или же текущим
+		//Обновляем общее количество узлов у родителей
+		if (m_tree_node.parent)
+		{
+			m_tree_node.parent->element->update_size(
+				static_cast<int>(m_size) - lhs_size_old);
+		}
 
-		auto lhs_last_child = find_last_tree_node();
-		auto rhs_last_child = node.find_last_tree_node();
+		if (node.m_tree_node.parent)
+		{
+			node.m_tree_node.parent->element->update_size(
+				static_cast<int>(node.m_size) - rhs_size_old);
+		}
 
+		//Узел без родителя не сообщает о присоединении, но дочерние узлы
+		//всё равно получают данные своего нового дерева
+		share_context(&m_tree_node, lhs_new_last, lhs_top->m_context.get());
+		share_context(&node.m_tree_node, rhs_new_last, 
+			rhs_top->m_context.get());
 
-		//Коннектим начальные узлы текущего объекта
+		if (m_tree_node.parent)
+		{
+			notify_attach(&m_tree_node, lhs_new_last, lhs_top);
+		}
 
-		if (lhs_start && lhs_start != rhs_last_child)
+		if (node.m_tree_node.parent)
 		{
-			lhs_start->next = &m_tree_node;
-			m_tree_node.prev = lhs_start;
+			notify_attach(&node.m_tree_node, rhs_new_last, rhs_top);
 		}
-		else
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::node_type& Node<CharT>::splice(
+		first_level_const_iterator position, node_type& node)
+	{
+		if (!node.m_tree_node.parent)
 		{
-			lhs_last_child->next = &m_tree_node;
-			m_tree_node.prev = lhs_last_child;
+			throw std::invalid_argument{
+				"The node isn't attached! Use add_child instead" };
 		}
 
-		if (lhs_end && lhs_end != rhs_start)
+		if (this == &node || is_descendant_of(node))
 		{
-			lhs_end->prev = lhs_last_child;
-			lhs_last_child->next = lhs_end;
+			throw std::invalid_argument{
+				"Can't splice the node into its own subtree!" };
 		}
 
-		if (&m_tree_node == lhs_last_child)
+		node_type* parent = node.m_tree_node.parent->element;
+		node_type* src_top = parent->find_top();
+		node_type* dst_top = find_top();
+
+		//Уникальность значений проверяется до изменений. Внутри одного 
+		//документа значения не меняются
+		if (src_top != dst_top && dst_top->m_context)
 		{
-			m_tree_node.prev = nullptr;
-			m_tree_node.next = nullptr;
+			dst_top->m_context->check_attach(node);
 		}
 
-		m_tree_node.parent = lhs_parent;
+		auto node_iterator = node.find_first_level_position();
 
-		//Коннектим узлы в переданном node
+		tree_node* first = &node.m_tree_node;
+		tree_node* last = node.find_last_tree_node();
 
-		if (rhs_start && rhs_start != lhs_last_child)
+		if (src_top->m_context)
 		{
-			rhs_start->next = &node.m_tree_node;
-			node.m_tree_node.prev = rhs_start;
+			src_top->m_context->erase(first, last);
 		}
-		else
+
+		//Вынимаем поддерево из обхода старого места
+		node.unlink_tree_nodes();
+
+		const int count = static_cast<int>(node.m_size + 1);
+
+		parent->update_size(-count);
+
+		m_childs.splice(position, parent->m_childs, node_iterator);
+
+		//Поддерево встаёт после своего предыдущего брата со всеми его 
+		//дочерними узлами или сразу после текущего узла
+		tree_node* prev = &m_tree_node;
+		unsigned int prev_depth = 0;
+
+		if (node_iterator != m_childs.begin())
 		{
-			rhs_last_child->next = &node.m_tree_node;
-			node.m_tree_node.prev = rhs_last_child;
+			auto&& prev_sibling = (*std::prev(node_iterator))->m_tree_node;
+
+			prev = prev_sibling.last;
+			prev_depth = prev_sibling.last_depth + 1;
 		}
 
-		if (rhs_end && rhs_end != lhs_start)
+		link_tree_nodes(prev, prev_depth, first);
+		update_last(prev, last, first->last_depth + 1);
+
+		node_type* top = update_size(count);
+
+		notify_attach(first, last, top);
+
+		return node;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node<CharT>::swap_subtrees(node_type& node)
+	{
+		if (!m_tree_node.parent || !node.m_tree_node.parent)
 		{
-			rhs_end->prev = rhs_last_child;
-			rhs_last_child->next = rhs_end;
+			throw std::invalid_argument{ 
+				"Can't swap positions of the detached nodes!" };
 		}
 
-		if (&node.m_tree_node == rhs_last_child)
+		if (this == &node)
 		{
-			node.m_tree_node.prev = nullptr;
-			node.m_tree_node.next = nullptr;
+			return;
 		}
 
-		node.m_tree_node.parent = rhs_parent;
+		if (is_descendant_of(node) || node.is_descendant_of(*this))
+		{
+			throw std::invalid_argument{
+				"Can't swap the node with its ancestor!" };
+		}
 
-		//Обновляем общее количество узлов
-		
-		int lhs_size_old = static_cast<int>(node.m_size);
-		int rhs_size_old = static_cast<int>(m_size);
+		node_type* lhs_parent = m_tree_node.parent->element;
+		node_type* rhs_parent = node.m_tree_node.parent->element;
+		node_type* lhs_top = lhs_parent->find_top();
+		node_type* rhs_top = rhs_parent->find_top();
 
-		int lhs_size_new = rhs_size_old;
-		int rhs_size_new = lhs_size_old;
+		tree_node* lhs_first = &m_tree_node;
+		tree_node* lhs_last = find_last_tree_node();
+		tree_node* rhs_first = &node.m_tree_node;
+		tree_node* rhs_last = node.find_last_tree_node();
 
-		if (node.m_tree_node.parent)
+		//Индексы убирают оба поддерева, пока они связаны со своими местами
+		if (lhs_top->m_context)
 		{
-			node.m_tree_node.parent->element->update_size(
-				rhs_size_new - rhs_size_old);
+			lhs_top->m_context->erase(lhs_first, lhs_last);
 		}
 
-		if (m_tree_node.parent)
+		if (rhs_top->m_context)
 		{
-			m_tree_node.parent->element->update_size(
-				lhs_size_new - lhs_size_old);
+			rhs_top->m_context->erase(rhs_first, rhs_last);
+		}
+
+		//Между документами уникальность значений проверяется без 
+		//уходящего из документа поддерева. При ошибке всё возвращается
+		if (lhs_top != rhs_top)
+		{
+			try
+			{
+				if (lhs_top->m_context)
+				{
+					lhs_top->m_context->check_attach(node);
+				}
+
+				if (rhs_top->m_context)
+				{
+					rhs_top->m_context->check_attach(*this);
+				}
+			}
+			catch (...)
+			{
+				notify_attach(lhs_first, lhs_last, lhs_top);
+				notify_attach(rhs_first, rhs_last, rhs_top);
+
+				throw;
+			}
+		}
+
+		auto lhs_iterator = find_first_level_position();
+		auto rhs_iterator = node.find_first_level_position();
+
+		tree_node* lhs_prev = lhs_first->prev;
+		tree_node* lhs_next = lhs_last->next;
+		tree_node* rhs_prev = rhs_first->prev;
+		tree_node* rhs_next = rhs_last->next;
+
+		//Соседние поддеревья просто идут в обратном порядке
+		if (lhs_next == rhs_first)
+		{
+			lhs_prev->next = rhs_first;
+			rhs_first->prev = lhs_prev;
+			rhs_last->next = lhs_first;
+			lhs_first->prev = rhs_last;
+			lhs_last->next = rhs_next;
+			rhs_next->prev = lhs_last;
+		}
+		else if (rhs_next == lhs_first)
+		{
+			rhs_prev->next = lhs_first;
+			lhs_first->prev = rhs_prev;
+			lhs_last->next = rhs_first;
+			rhs_first->prev = lhs_last;
+			rhs_last->next = lhs_next;
+			lhs_next->prev = rhs_last;
+		}
+		else
+		{
+			lhs_prev->next = rhs_first;
+			rhs_first->prev = lhs_prev;
+			rhs_last->next = lhs_next;
+			lhs_next->prev = rhs_last;
+
+			rhs_prev->next = lhs_first;
+			lhs_first->prev = rhs_prev;
+			lhs_last->next = rhs_next;
+			rhs_next->prev = lhs_last;
+		}
+
+		//Глубины внутри поддеревьев заданы относительно соседей, поэтому
+		//меняются только разницы глубин на концах поддеревьев
+		const int lhs_last_depth = static_cast<int>(m_tree_node.last_depth);
+		const int rhs_last_depth = 
+			static_cast<int>(node.m_tree_node.last_depth);
+		const int lhs_step = lhs_first->step;
+		const int rhs_step = rhs_first->step;
+
+		if (lhs_next == rhs_first)
+		{
+			rhs_first->step = lhs_step;
+			lhs_first->step = rhs_step + lhs_last_depth - rhs_last_depth;
+			rhs_next->step += rhs_last_depth - lhs_last_depth;
+		}
+		else if (rhs_next == lhs_first)
+		{
+			lhs_first->step = rhs_step;
+			rhs_first->step = lhs_step + rhs_last_depth - lhs_last_depth;
+			lhs_next->step += lhs_last_depth - rhs_last_depth;
+		}
+		else
+		{
+			rhs_first->step = lhs_step;
+			lhs_first->step = rhs_step;
+			lhs_next->step += lhs_last_depth - rhs_last_depth;
+			rhs_next->step += rhs_last_depth - lhs_last_depth;
+		}
+
+		std::swap(*lhs_iterator, *rhs_iterator);
+		std::swap(m_position, node.m_position);
+
+		lhs_first->parent = &rhs_parent->m_tree_node;
+		rhs_first->parent = &lhs_parent->m_tree_node;
+
+		//Предки могут заканчиваться любым из поддеревьев. Сначала помечаем
+		//предков первого узла, чтобы не спутать их с предками второго
+		lhs_parent->update_last(lhs_last, nullptr, 0);
+		rhs_parent->update_last(rhs_last, lhs_last, 
+			static_cast<unsigned int>(lhs_last_depth) + 1);
+		lhs_parent->update_last(nullptr, rhs_last, 
+			static_cast<unsigned int>(rhs_last_depth) + 1);
+
+		if (lhs_parent != rhs_parent)
+		{
+			const int difference = 
+				static_cast<int>(node.m_size) - static_cast<int>(m_size);
+
+			lhs_parent->update_size(difference);
+			rhs_parent->update_size(-difference);
 		}
+
+		notify_attach(rhs_first, rhs_last, lhs_top);
+		notify_attach(lhs_first, lhs_last, rhs_top);
 	}
 
 	//*************************************************************************
@@ -1320,11 +2465,14 @@ namespace XMLB
 		using std::begin;
 		using std::end;
 
+		//Устаревшие индексы перестраиваются перед поиском
+		update_context();
+
 		iterator first = this->begin();
 		iterator last = this->end();
 
 		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+			is_in_subtree(offset))
 		{
 			first = iterator{ &offset->m_tree_node };
 		}
@@ -1370,6 +2518,9 @@ namespace XMLB
 		using std::begin;
 		using std::end;
 
+		//Устаревшие индексы перестраиваются перед поиском
+		update_context();
+
 		iterator first = this->begin();
 		iterator last = this->end();
 
@@ -1377,7 +2528,7 @@ namespace XMLB
 		auto word_end = end(container);
 
 		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+			is_in_subtree(offset))
 		{
 			first = iterator{ &offset->m_tree_node };
 		}
@@ -1430,6 +2581,9 @@ namespace XMLB
 		using std::begin;
 		using std::end;
 
+		//Устаревшие индексы перестраиваются перед поиском
+		update_context();
+
 		iterator first = this->begin();
 		iterator last = this->end();
 
@@ -1437,369 +2591,1013 @@ namespace XMLB
 		auto word_end = end(container);
 
 		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+			is_in_subtree(offset))
+		{
+			first = iterator{ &offset->m_tree_node };
+		}
+
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		for (; first != last && word_it != word_end;)
+		{
+			first = find_element(first, last, *word_it);
+
+			if (first != last)
+			{
+				++word_it;
+
+				if (word_it != word_end)
+				{
+					last = first->end();
+					first = first->begin();
+				}
+			}
+		}
+
+		//Если не нашлось одно из вложенных имён, first указывает на конец
+		//поддерева, а не на конец текущего узла
+		if (word_it != word_end)
+		{
+			first = this->end();
+		}
+
+		return first;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<std::is_same_v<ContT, CharT>&&
+
+		std::is_constructible_v<
+		std::basic_string_view<CharT>, const ContT*>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::const_iterator Node<CharT>::find(
+			const ContT* container, const_iterator offset) const
+	{
+		using std::begin;
+		using std::end;
+
+		const_iterator first = this->begin();
+		const_iterator last = this->end();
+
+		if (offset != const_iterator{ nullptr } &&
+			is_in_subtree(offset))
 		{
 			first = iterator{ &offset->m_tree_node };
 		}
 
-		if (offset == last)
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		for (; first != last;)
+		{
+			first = find_element(first, last, string_wrapper{ container });
+
+			if (first != last)
+			{
+				break;
+			}
+		}
+
+		return first;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT>&&
+
+		std::is_constructible_v<std::basic_string_view<CharT>,
+		std::add_pointer_t<std::remove_reference_t<
+		detail::dereferenced_t<detail::const_iterator_t<ContT>>>>>&&
+
+		std::is_same_v<detail::universal_value_type_t<ContT>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::const_iterator Node<CharT>::find(
+			const ContT& container, const_iterator offset) const
+	{
+		using std::begin;
+		using std::end;
+
+		const_iterator first = this->begin();
+		const_iterator last = this->end();
+
+		auto word_it = begin(container);
+		auto word_end = end(container);
+
+		if (offset != const_iterator{ nullptr } &&
+			is_in_subtree(offset))
+		{
+			first = const_iterator{ &offset->m_tree_node };
+		}
+
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		for (; first != last;)
+		{
+			first = find_element(first, last,
+				string_wrapper{ &*container.begin(), container.size() });
+
+			if (first != last)
+			{
+				break;
+			}
+		}
+
+		return first;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::const_iterator Node<CharT>::find(
+			const ContT& container, const_iterator offset) const
+	{
+		using std::begin;
+		using std::end;
+
+		const_iterator first = this->begin();
+		const_iterator last = this->end();
+
+		auto word_it = begin(container);
+		auto word_end = end(container);
+
+		if (offset != const_iterator{ nullptr } &&
+			is_in_subtree(offset))
+		{
+			first = const_iterator{ &offset->m_tree_node };
+		}
+
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		for (; first != last && word_it != word_end;)
+		{
+			first = find_element(first, last, *word_it);
+
+			if (first != last)
+			{
+				++word_it;
+
+				if (word_it != word_end)
+				{
+					last = first->end();
+					first = first->begin();
+				}
+			}
+		}
+
+		//Если не нашлось одно из вложенных имён, first указывает на конец
+		//поддерева, а не на конец текущего узла
+		if (word_it != word_end)
+		{
+			first = this->end();
+		}
+
+		return first;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::iterator Node<CharT>::find_child_path(
+			const ContT& container)
+	{
+		using std::begin;
+		using std::end;
+
+		node_type* result = find_child_path_node(begin(container), 
+			end(container));
+
+		return result ? iterator{ &result->m_tree_node } : this->end();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::const_iterator 
+		Node<CharT>::find_child_path(const ContT& container) const
+	{
+		using std::begin;
+		using std::end;
+
+		node_type* result = find_child_path_node(begin(container), 
+			end(container));
+
+		return result ? const_iterator{ &result->m_tree_node } : this->end();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::find_range Node<CharT>::find_all(
+		string_wrapper name)
+	{
+		return find_range{ detail::make_path_program<CharT>(&name, &name + 1),
+			this };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::find_const_range Node<CharT>::find_all(
+		string_wrapper name) const
+	{
+		return find_const_range{ 
+			detail::make_path_program<CharT>(&name, &name + 1), this };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::find_range Node<CharT>::find_all(
+			const ContT& container)
+	{
+		using std::begin;
+		using std::end;
+
+		return find_range{ detail::make_path_program<CharT>(begin(container),
+			end(container)), this };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::find_const_range Node<CharT>::find_all(
+			const ContT& container) const
+	{
+		using std::begin;
+		using std::end;
+
+		return find_const_range{ detail::make_path_program<CharT>(
+			begin(container), end(container)), this };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::iterator Node<CharT>::find_any(
+			const ContT& container, const_iterator offset)
+	{
+		using std::begin;
+		using std::end;
+
+		//Устаревшие индексы перестраиваются перед поиском
+		update_context();
+
+		const_iterator first = this->begin();
+		const_iterator last = this->end();
+
+		if (offset != const_iterator{ nullptr } &&
+			is_in_subtree(offset))
+		{
+			first = const_iterator{ &offset->m_tree_node };
+		}
+
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		return find_any_element(first, last, begin(container), 
+			end(container));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename ContT,
+		std::enable_if_t<
+
+		detail::is_has_begin_and_end_v<ContT>&&
+
+		detail::is_has_value_type_v<ContT> &&
+
+		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+
+		(std::is_constructible_v<std::basic_string_view<CharT>,
+			std::decay_t<
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+
+			std::is_constructible_v<std::basic_string_view<CharT>,
+			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+
+		std::is_same_v<std::remove_const_t<
+		detail::universal_value_type_t<ContT>>, CharT>,
+
+		std::nullptr_t>>
+		inline typename Node<CharT>::const_iterator Node<CharT>::find_any(
+			const ContT& container, const_iterator offset) const
+	{
+		using std::begin;
+		using std::end;
+
+		const_iterator first = this->begin();
+		const_iterator last = this->end();
+
+		if (offset != const_iterator{ nullptr } &&
+			is_in_subtree(offset))
+		{
+			first = const_iterator{ &offset->m_tree_node };
+		}
+
+		if (offset == last)
+		{
+			first = last;
+		}
+
+		return find_any_element(first, last, begin(container), 
+			end(container));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::tree_node* Node<CharT>::find_last_tree_node() 
+		const
+	{
+		return m_tree_node.last;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node<CharT>::connect_tree_nodes(tree_node* add_node)
+	{
+		if (!add_node)
+		{
+			return;
+		}
+
+		add_node->element->m_position = std::prev(m_childs.end());
+
+		tree_node* last_tree_node = find_last_tree_node();
+		tree_node* last_add_node = link_tree_nodes(
+			last_tree_node, m_tree_node.last_depth, add_node);
+
+		update_last(last_tree_node, last_add_node, add_node->last_depth + 1);
+
+		//Увелививаем общее количество узлов
+		node_type* top = 
+			update_size(static_cast<int>(add_node->element->m_size + 1));
+
+		notify_attach(add_node, last_add_node, top);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::tree_node* Node<CharT>::link_tree_nodes(
+		tree_node* current_node, unsigned int current_depth, 
+		tree_node* add_node) noexcept
+	{
+		//Следующей узел, после текущего. После отсоединённого узла без
+		//дочерних узлов идёт он сам
+		tree_node* next_node = current_node->next ? current_node->next : 
+			&m_tree_node;
+
+		//Последний дочерний узел у добавочного узла
+		tree_node* last_add_node = add_node->last;
+
+		//Коннектим между собой текущий, добавочный и следующий узлы
+		current_node->next = add_node;
+		add_node->prev = current_node;
+
+		last_add_node->next = next_node;
+		next_node->prev = last_add_node;
+
+		//Добавочный узел на единицу глубже текущего элемента, а следующий
+		//узел теперь отсчитывает глубину от конца добавленного поддерева
+		add_node->step = 1 - static_cast<int>(current_depth);
+		next_node->step -= 
+			add_node->step + static_cast<int>(add_node->last_depth);
+
+		add_node->parent = &m_tree_node;
+
+		return last_add_node;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node<CharT>::unlink_tree_nodes() noexcept
+	{
+		tree_node* first = &m_tree_node;
+		tree_node* last = m_tree_node.last;
+		tree_node* prev_node = first->prev;
+		tree_node* next_node = last->next;
+
+		prev_node->next = next_node;
+		next_node->prev = prev_node;
+
+		//Следующий узел теперь отсчитывает глубину от узла перед поддеревом
+		next_node->step += first->step + static_cast<int>(first->last_depth);
+
+		//Поддеревья предков, которые заканчивались этим поддеревом, теперь
+		//заканчиваются узлом перед ним
+		first->parent->element->update_last(last, prev_node, 
+			static_cast<unsigned int>(1 - first->step));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::iterator Node<CharT>::erase_element(
+		const_iterator node)
+	{
+		//Удаляем элемент и уменьшаем общее количество узлов.
+		//Временное решение с const_castom...
+		Node* erase_node = const_cast<Node*>(&*node);
+		Node* parent = const_cast<Node*>(node->get_parent());
+
+		//Узел элемента, который идёт после элемента, который нужно удалить
+		tree_node* next_node = erase_node->find_last_tree_node()->next;
+
+		//Индексы убирают удаляемые узлы, пока они ещё живы
+		node_type* top = parent->find_top();
+
+		if (top->m_context)
+		{
+			top->m_context->erase(&erase_node->m_tree_node,
+				erase_node->find_last_tree_node());
+		}
+
+		erase_node->unlink_tree_nodes();
+
+		//Количество удаляемых узлов запоминаем до удаления элемента
+		int erase_count = static_cast<int>(node->m_size + 1);
+
+		parent->m_childs.erase(erase_node->m_position);
+
+		//Уменьшаем общее количество узлов у родителя удаленного элемента и у
+		//всех его родителей
+		parent->update_size(-erase_count);
+
+		return iterator{ next_node };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::iterator Node<CharT>::erase_element(
+		const_iterator node_first, const_iterator node_last)
+	{
+		auto result = end();
+
+		if (node_first != node_last)
+		{
+			result = erase_element(node_first);
+
+			while (result != node_last)
+			{
+				result = erase_element(result);
+			}
+		}
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node<CharT>::iterator Node<CharT>::find_element(
+		const_iterator first, const_iterator last, 
+		string_wrapper tag_name) const
+	{
+		//Индекс по имени отвечает на тот же вопрос без обхода диапазона
+		if (first != last)
+		{
+			if (auto name_index = get_name_index())
+			{
+				tree_node* result = name_index->find(tag_name,
+					&first->m_tree_node, &last->m_tree_node);
+
+				return iterator{ result ? result : &last->m_tree_node };
+			}
+
+			//Сводка имён позволяет пропускать поддеревья, в которых узлов с
+			//таким именем точно нет
+			if (auto name_summary = get_name_summary())
+			{
+				tree_node* current = &first->m_tree_node;
+				tree_node* end = &last->m_tree_node;
+
+				while (current != end)
+				{
+					//Сводка действительна только вместе с порядковыми
+					//номерами, поэтому конец поддерева известен сразу
+					if (!name_summary->may_contain(current, tag_name))
+					{
+						current = current->last->next;
+					}
+					else if (current->element->get_name() == tag_name)
+					{
+						return iterator{ current };
+					}
+					else
+					{
+						current = current->next;
+					}
+				}
+
+				return iterator{ end };
+			}
+		}
+
+		for (; first != last; ++first)
+		{
+			if (first->get_name() == tag_name)
+			{
+				return iterator{ &first->m_tree_node };
+			}
+		}
+
+		return iterator{ &last->m_tree_node };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename IterT>
+	inline typename Node<CharT>::node_type* Node<CharT>::find_child_path_node(
+		IterT word_it, IterT word_end) const
+	{
+		//Пустой путь не указывает ни на один дочерний узел
+		auto current = word_it != word_end ? 
+			const_cast<node_type*>(this) : nullptr;
+
+		//На каждом шаге просматриваются только прямые дочерние узлы
+		for (; word_it != word_end && current; ++word_it)
 		{
-			first = last;
-		}
+			string_wrapper tag_name{ *word_it };
 
-		for (; first != last && word_it != word_end;)
-		{
-			first = find_element(first, last, *word_it);
+			auto first = current->m_childs.begin();
+			auto last = current->m_childs.end();
 
-			if (first != last)
+			for (; first != last && (*first)->get_name() != tag_name; ++first)
 			{
-				++word_it;
 
-				if (word_it != word_end)
-				{
-					last = first->end();
-					first = first->begin();
-				}
 			}
+
+			current = first != last ? first->get() : nullptr;
 		}
 
-		return first;
+		return current;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	template<typename ContT,
-		std::enable_if_t<std::is_same_v<ContT, CharT>&&
-
-		std::is_constructible_v<
-		std::basic_string_view<CharT>, const ContT*>,
-
-		std::nullptr_t>>
-		inline typename Node<CharT>::const_iterator Node<CharT>::find(
-			const ContT* container, const_iterator offset) const
+	template<typename IterT>
+	inline typename Node<CharT>::iterator Node<CharT>::find_any_element(
+		const_iterator first, const_iterator last, IterT word_it, 
+		IterT word_end) const
 	{
-		using std::begin;
-		using std::end;
-
-		const_iterator first = this->begin();
-		const_iterator last = this->end();
-
-		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+		if (first == last || word_it == word_end)
 		{
-			first = iterator{ &offset->m_tree_node };
+			return iterator{ &last->m_tree_node };
 		}
 
-		if (offset == last)
+		//Индекс по имени отвечает на запрос K поисками без обхода диапазона,
+		//из найденных узлов берётся первый в порядке документа
+		if (auto name_index = get_name_index())
 		{
-			first = last;
+			tree_node* result = nullptr;
+
+			for (; word_it != word_end; ++word_it)
+			{
+				tree_node* current = name_index->find(
+					string_wrapper{ *word_it }, &first->m_tree_node, 
+					&last->m_tree_node);
+
+				if (current && (!result || current->order < result->order))
+				{
+					result = current;
+				}
+			}
+
+			return iterator{ result ? result : &last->m_tree_node };
 		}
 
-		for (; first != last;)
-		{
-			first = find_element(first, last, string_wrapper{ container });
+		const std::unordered_set<string_wrapper> names(word_it, word_end);
 
-			if (first != last)
+		for (; first != last; ++first)
+		{
+			if (names.count(first->get_name()))
 			{
-				break;
+				return iterator{ &first->m_tree_node };
 			}
 		}
 
-		return first;
+		return iterator{ &last->m_tree_node };
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	template<typename ContT,
-		std::enable_if_t<
+	inline typename Node<CharT>::node_type* Node<CharT>::update_size(
+		int size) noexcept
+	{
+		//Корректируем количество узлов у текущего узла и у всех его родителей
+		//за один проход вверх по дереву
+		tree_node* current = &m_tree_node;
 
-		detail::is_has_begin_and_end_v<ContT>&&
+		for (; ; current = current->parent)
+		{
+			current->element->m_size += size;
 
-		detail::is_has_value_type_v<ContT>&&
+			if (!current->parent)
+			{
+				break;
+			}
+		}
 
-		std::is_constructible_v<std::basic_string_view<CharT>,
-		std::add_pointer_t<std::remove_reference_t<
-		detail::dereferenced_t<detail::const_iterator_t<ContT>>>>>&&
+		return current->element;
+	}
 
-		std::is_same_v<detail::universal_value_type_t<ContT>, CharT>,
+	//*************************************************************************
 
-		std::nullptr_t>>
-		inline typename Node<CharT>::const_iterator Node<CharT>::find(
-			const ContT& container, const_iterator offset) const
+	template<typename CharT>
+	inline void Node<CharT>::update_last(tree_node* old_last, 
+		tree_node* new_last, unsigned int depth) noexcept
 	{
-		using std::begin;
-		using std::end;
+		//Поднимаемся, пока поддеревья предков заканчиваются тем же узлом.
+		//Каждый следующий предок на единицу выше последнего узла
+		for (tree_node* current = &m_tree_node; 
+			current && current->last == old_last; current = current->parent)
+		{
+			current->last = new_last;
+			current->last_depth = depth++;
+		}
+	}
 
-		const_iterator first = this->begin();
-		const_iterator last = this->end();
+	//*************************************************************************
 
-		auto word_it = begin(container);
-		auto word_end = end(container);
+	template<typename CharT>
+	inline typename Node<CharT>::node_type* Node<CharT>::find_top() const 
+		noexcept
+	{
+		tree_node* current = &m_tree_node;
 
-		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+		while (current->parent)
 		{
-			first = cosnt_iterator{ &offset->m_tree_node };
+			current = current->parent;
 		}
 
-		if (offset == last)
-		{
-			first = last;
-		}
+		return current->element;
+	}
 
-		for (; first != last;)
-		{
-			first = find_element(first, last,
-				string_wrapper{ &*container.begin(), container.size() });
+	//*************************************************************************
 
-			if (first != last)
+	template<typename CharT>
+	inline bool Node<CharT>::is_descendant_of(const node_type& node) const
+		noexcept
+	{
+		for (tree_node* current = m_tree_node.parent; current; 
+			current = current->parent)
+		{
+			if (current == &node.m_tree_node)
 			{
-				break;
+				return true;
 			}
 		}
 
-		return first;
+		return false;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	template<typename ContT,
-		std::enable_if_t<
-
-		detail::is_has_begin_and_end_v<ContT>&&
-
-		detail::is_has_value_type_v<ContT> &&
+	inline bool Node<CharT>::is_in_subtree(const_iterator node) const 
+		noexcept
+	{
+		if (node == const_iterator{ nullptr })
+		{
+			return false;
+		}
 
-		!std::is_arithmetic_v<detail::value_type_t<ContT>> &&
+		//Пока порядковые номера действительны, потомки узла занимают 
+		//отрезок номеров (order, last->order]. Узел другого дерева ссылается
+		//на другие общие данные, поэтому его номер с отрезком не сравнивается
+		const tree_node& current = node->m_tree_node;
 
-		(std::is_constructible_v<std::basic_string_view<CharT>,
-			std::decay_t<
-			detail::dereferenced_t<detail::const_iterator_t<ContT>>>> ||
+		if (m_top_context && m_top_context->is_order_valid() &&
+			current.element->m_top_context == m_top_context)
+		{
+			return m_tree_node.order < current.order && 
+				current.order <= m_tree_node.last->order;
+		}
 
-			std::is_constructible_v<std::basic_string_view<CharT>,
-			detail::dereferenced_t<detail::const_iterator_t<ContT>>>) &&
+		return node._is_in_sequences(begin());
+	}
 
-		std::is_same_v<std::remove_const_t<
-		detail::universal_value_type_t<ContT>>, CharT>,
+	//*************************************************************************
 
-		std::nullptr_t>>
-		inline typename Node<CharT>::const_iterator Node<CharT>::find(
-			const ContT& container, const_iterator offset) const
+	template<typename CharT>
+	inline typename Node<CharT>::first_level_iterator 
+		Node<CharT>::find_first_level_position() const noexcept
 	{
-		using std::begin;
-		using std::end;
+		return m_position;
+	}
 
-		const_iterator first = this->begin();
-		const_iterator last = this->end();
+	//*************************************************************************
 
-		auto word_it = begin(container);
-		auto word_end = end(container);
+	template<typename CharT>
+	inline void Node<CharT>::notify_attach(tree_node* first, tree_node* last,
+		node_type* top) noexcept
+	{
+		share_context(first, last, top->m_context.get());
 
-		if (offset != const_iterator{ nullptr } &&
-			offset._is_in_sequences(this->begin()))
+		if (top->m_context)
 		{
-			first = const_iterator{ &offset->m_tree_node };
+			top->m_context->attach(first, last, &top->m_tree_node);
 		}
+	}
 
-		if (offset == last)
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node<CharT>::share_context(tree_node* first, tree_node* last,
+		detail::Node_context<node_type>* context) noexcept
+	{
+		//Узлы диапазона пришли из одного дерева, кроме, может быть, 
+		//первого, поэтому по его концам видно, нужно ли что-то менять. Без
+		//индексов у обоих деревьев обход не нужен
+		if (first->element->m_top_context == context && 
+			last->element->m_top_context == context)
 		{
-			first = last;
+			return;
 		}
 
-		for (; first != last && word_it != word_end;)
+		for (tree_node* current = first; ; current = current->next)
 		{
-			first = find_element(first, last, *word_it);
+			current->element->m_top_context = context;
 
-			if (first != last)
+			if (current == last)
 			{
-				++word_it;
-
-				if (word_it != word_end)
-				{
-					last = first->end();
-					first = first->begin();
-				}
+				break;
 			}
 		}
-
-		return first;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::tree_node* Node<CharT>::find_last_tree_node() 
-		const
+	inline const detail::Name_index<typename Node<CharT>::node_type>* 
+		Node<CharT>::get_name_index() const noexcept
 	{
-		//Инициализируем узел, узлом текущего элемента
-		tree_node* result = &m_tree_node;
+		return m_top_context ? m_top_context->get_name_index() : nullptr;
+	}
 
-		//Проходимся по всем последним дочерним элементам, чтобы дойти до
-		//последнего узла
-		while (result->element->m_childs.size())
-		{
-			result = &result->element->m_childs.back()->m_tree_node;
-		}
+	//*************************************************************************
 
-		return result;
+	template<typename CharT>
+	inline const detail::Name_summary<typename Node<CharT>::node_type>* 
+		Node<CharT>::get_name_summary() const noexcept
+	{
+		return m_top_context ? m_top_context->get_name_summary() : nullptr;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline void Node<CharT>::connect_tree_nodes(tree_node* current_node, 
-		tree_node* add_node)
+	inline void Node<CharT>::update_context() noexcept
 	{
-		if (!add_node)
+		if (m_top_context)
 		{
-			return;
+			m_top_context->update(&find_top()->m_tree_node);
 		}
+	}
 
-		//Следующей узел, после текущего
-		tree_node* next_node = current_node->next;
-
-		//Последний дочерний узел у добавочного узла
-		tree_node* last_add_node = add_node->element->find_last_tree_node();
-
-		//Коннектим между собой текущий, добавочный и следующий узлы
-
-		current_node->next = add_node;
-		add_node->prev = current_node;
+	//*************************************************************************
 
-		if (next_node)
-		{
-			last_add_node->next = next_node;
-			next_node->prev = last_add_node;
-		}
-		else
+	template<typename CharT>
+	inline void Node<CharT>::check_attach(const node_type& node) const
+	{
+		if (m_top_context)
 		{
-			last_add_node->next = current_node;
-			current_node->prev = last_add_node;
+			m_top_context->check_attach(node);
 		}
-		
-		//Меняем родителя у добавочного узла
-		add_node->parent = &m_tree_node;
-
-		//Увелививаем общее количество узлов
-		update_size(static_cast<int>(add_node->element->m_size + 1));
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::iterator Node<CharT>::erase_element(
-		const_iterator node)
+	template<typename FuncT>
+	inline void Node<CharT>::change_attributes(FuncT&& func)
 	{
-		auto erase_iterator = node->get_parent()->m_childs.begin();
-
-		//Ищем среди дочерних узлов родителя узла, на который указывает
-		//итератор. Ищем для того, чтобы удалить его из контейнера std::list
-		for (auto it = node->get_parent()->m_childs.begin(),
-			end = node->get_parent()->m_childs.end();
-			it != end;
-			++it)
+		if (!m_top_context || !m_tree_node.parent)
 		{
-			if (it->get() == &*node)
-			{
-				erase_iterator = it;
-				break;
-			}
-		}
+			func();
 
-		//Элемент, которй нужно удалить и который будет указывать на последний
-		//элемент, который является дочерним этого элемент
-		Node<CharT>* erase_child = erase_iterator->get();
-
-		//Находим элемент, который является последним элементов в списка
-		//удаляемого элемента
-		while (erase_child->m_childs.size())
-		{
-			erase_child = erase_child->m_childs.back().get();
+			return;
 		}
 
-		//Узел, расположенный до элемента, который нужно удалить
-		tree_node* prev_node = erase_iterator->get()->m_tree_node.prev;
-
-		//Узел элемента, который идёт после элемента, который нужно удалить
-		tree_node* next_node = erase_child->m_tree_node.next;
-
-		//Конектим узлы между собой
-		prev_node->next = next_node;
-
-		next_node->prev = prev_node;
+		auto lock = lock_changes();
 
-		//Удаляем элемент и уменьшаем общее количество узлов.
-		//Временное решение с const_castom...
-		Node* parent = const_cast<Node*>(node->get_parent());
+		m_top_context->change(&m_tree_node);
 
-		parent->m_childs.erase(erase_iterator);
+		//Узел убирается из индексов атрибутов по старым значениям и
+		//возвращается по новым, даже если изменение прервалось исключением
+		m_top_context->remove_attributes(&m_tree_node);
 
-		//В родителях тоже корректируем количество узлов
-		tree_node* parent_tree = node->m_tree_node.parent;
+		try
+		{
+			func();
+		}
+		catch (...)
+		{
+			m_top_context->add_attributes(&m_tree_node);
 
-		//Уменьшаем общее количество узлов
-		update_size(static_cast<int>(-1 * node->m_size + 1));
+			throw;
+		}
 
-		return iterator{ next_node };
+		m_top_context->add_attributes(&m_tree_node);
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::iterator Node<CharT>::erase_element(
-		const_iterator node_first, const_iterator node_last)
+	inline void Node<CharT>::expose_attributes() noexcept
 	{
-		auto result = end();
-
-		if (node_first != node_last)
+		if (m_top_context && m_tree_node.parent)
 		{
-			result = erase_element(node_first);
+			auto lock = lock_changes();
 
-			while (result != node_last)
-			{
-				result = erase_element(result);
-			}
+			m_top_context->expose_attributes(&m_tree_node);
 		}
-
-		return result;
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline typename Node<CharT>::iterator Node<CharT>::find_element(
-		const_iterator first, const_iterator last, 
-		string_wrapper tag_name) const
+	inline typename Node<CharT>::attr_iterator 
+		Node<CharT>::find_attribute_element(
+		const string_type& attribute_name) noexcept
 	{
-		for (; first != last; ++first)
+		using std::begin;
+		using std::end;
+		
+		auto&& attr_founder = [&](auto&& attribute)
 		{
-			if (first->get_name() == tag_name)
-			{
-				return iterator{ &first->m_tree_node };
-			}
-		}
-
-		return iterator{ &last->m_tree_node };
+			return attribute.name == attribute_name;
+		};
+		
+		return std::find_if(begin(m_attributes), end(m_attributes), 
+			attr_founder);
 	}
 
 	//*************************************************************************
 
 	template<typename CharT>
-	inline void Node<CharT>::update_size(int size) noexcept
+	inline std::unique_lock<detail::Change_mutex> 
+		Node<CharT>::lock_changes() const noexcept
 	{
-		m_size += size;
-
-		auto current_parent = m_tree_node.parent;
-
-		while (current_parent)
-		{	
-			current_parent->element->update_size(size);
-			
-			current_parent = current_parent->parent;
+		if (!m_top_context)
+		{
+			return std::unique_lock<detail::Change_mutex>{};
 		}
+
+		return m_top_context->lock_changes();
 	}
 
 	//*************************************************************************
@@ -1928,9 +3726,12 @@ namespace XMLB
 	*
 	* @param lhs - первый Node
 	* @param rhs - второй Node
+	*
+	* @throw std::invalid_argument - если в документе одного из узлов 
+	* нарушится уникальность значений атрибута
 	**************************************************************************/
 	template<typename CharT>
-	inline void swap(Node<CharT>& lhs, Node<CharT>& rhs) noexcept
+	inline void swap(Node<CharT>& lhs, Node<CharT>& rhs)
 	{
 		lhs.swap(rhs);
 	}
@@ -0,0 +1,672 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_NUMBER_CONVERSION_H
+#define XMLB_NUMBER_CONVERSION_H
+
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+#include <limits>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+#include <charconv>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <system_error>
+
+//std::from_chars и std::to_chars для чисел с плавающей точкой есть не во 
+//всех стандартных библиотеках. Без них используются strtod и snprintf
+#ifndef XMLB_FLOAT_CHARCONV
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define XMLB_FLOAT_CHARCONV 1
+#else
+#define XMLB_FLOAT_CHARCONV 0
+#endif
+#endif
+
+
+
+namespace XMLB { namespace detail {
+
+	//*************************************************************************
+	//					SUPPORT FUNCTIONS FOR NUMBER CONVERSION
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Проверка, является ли тип числом, которое можно хранить в 
+	* значении узла или атрибута: целые, с плавающей точкой и bool. Символьные
+	* типы числами не считаются
+	**************************************************************************/
+	template<typename T>
+	struct is_number : std::bool_constant<
+		std::is_arithmetic_v<T> &&
+		!std::is_same_v<std::remove_cv_t<T>, char> &&
+		!std::is_same_v<std::remove_cv_t<T>, wchar_t> &&
+		!std::is_same_v<std::remove_cv_t<T>, char16_t> &&
+		!std::is_same_v<std::remove_cv_t<T>, char32_t>> {};
+
+	template<typename T>
+	constexpr bool is_number_v = is_number<T>::value;
+
+	//*************************************************************************
+
+	/// Размер буфера, которого хватает для любого числа
+	constexpr std::size_t kMax_number_size = 128;
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Проверить, что 8 байт подряд - десятичные цифры
+	*
+	* @param chunk - 8 символов, прочитанных как число в порядке little endian
+	**************************************************************************/
+	inline bool is_eight_digits(std::uint64_t chunk) noexcept
+	{
+		return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+			(((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+			0x3333333333333333;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Получить число из 8 десятичных цифр за несколько умножений, 
+	* без цикла по цифрам
+	*
+	* @param chunk - 8 цифр, прочитанных как число в порядке little endian
+	**************************************************************************/
+	inline std::uint32_t parse_eight_digits(std::uint64_t chunk) noexcept
+	{
+		constexpr std::uint64_t kMask = 0x000000FF000000FF;
+		constexpr std::uint64_t kMul1 = 100 + (1000000ULL << 32);
+		constexpr std::uint64_t kMul2 = 1 + (10000ULL << 32);
+
+		chunk -= 0x3030303030303030;
+		chunk = (chunk * 10) + (chunk >> 8);
+		chunk = (((chunk & kMask) * kMul1) + 
+			(((chunk >> 16) & kMask) * kMul2)) >> 32;
+
+		return static_cast<std::uint32_t>(chunk);
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разобрать строку десятичных цифр в беззнаковое число
+	*
+	* @details На little endian системах длинные серии цифр разбираются по 8
+	* штук за раз, остаток - по одной
+	*
+	* @param first - начало строки
+	* @param last - конец строки
+	* @param value - результат
+	*
+	* @return true - если вся строка состоит из цифр и число не 
+	* переполнилось
+	**************************************************************************/
+	inline bool parse_digits(const char* first, const char* last,
+		std::uint64_t& value) noexcept
+	{
+		constexpr std::uint64_t kMax = 
+			std::numeric_limits<std::uint64_t>::max();
+
+		//Число из 16 цифр ещё точно помещается в 64 бита
+		constexpr std::ptrdiff_t kFast_digits = 16;
+
+		if (first == last)
+		{
+			return false;
+		}
+
+		std::uint64_t result = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+	|| defined(_WIN32)
+		const char* fast_last = last - first > kFast_digits ? 
+			first + kFast_digits : last;
+
+		while (fast_last - first >= 8)
+		{
+			std::uint64_t chunk;
+			std::memcpy(&chunk, first, sizeof(chunk));
+
+			if (!is_eight_digits(chunk))
+			{
+				break;
+			}
+
+			result = result * 100000000 + parse_eight_digits(chunk);
+			first += 8;
+		}
+#endif
+
+		for (; first != last; ++first)
+		{
+			const unsigned int digit = 
+				static_cast<unsigned char>(*first) - '0';
+
+			if (digit > 9 || result > (kMax - digit) / 10)
+			{
+				return false;
+			}
+
+			result = result * 10 + digit;
+		}
+
+		value = result;
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разобрать строку в число с плавающей точкой через strtod
+	*
+	* @details strtod читает десятичный разделитель текущей локали, поэтому
+	* точка заменяется на него - результат такой же, как в локали "C". 
+	* Пробелы, знак '+' и шестнадцатеричная запись, которые strtod 
+	* принимает, а std::from_chars нет, отбрасываются заранее
+	*
+	* @param first - начало строки
+	* @param last - конец строки
+	* @param value - результат. Не меняется, если разобрать строку не удалось
+	*
+	* @return true - если вся строка - число, которое помещается в тип T
+	**************************************************************************/
+	template<typename T>
+	inline bool parse_float_chars(const char* first, const char* last,
+		T& value) noexcept
+	{
+		const std::size_t size = static_cast<std::size_t>(last - first);
+
+		if (!size || size >= kMax_number_size)
+		{
+			return false;
+		}
+
+		const std::size_t sign_size = *first == '-' ? 1 : 0;
+
+		if (size == sign_size || 
+			!(std::isalnum(static_cast<unsigned char>(first[sign_size])) || 
+			first[sign_size] == '.') ||
+			(size > sign_size + 1 && first[sign_size] == '0' && 
+			(first[sign_size + 1] == 'x' || first[sign_size + 1] == 'X')))
+		{
+			return false;
+		}
+
+		const char radix = *std::localeconv()->decimal_point;
+
+		char buffer[kMax_number_size];
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			//Разделитель локали, отличный от точки, числом не является
+			if (first[i] == radix && radix != '.')
+			{
+				return false;
+			}
+
+			buffer[i] = first[i] == '.' ? radix : first[i];
+		}
+
+		buffer[size] = '\0';
+
+		char* end = nullptr;
+		T result{};
+
+		errno = 0;
+
+		if constexpr (std::is_same_v<T, float>)
+		{
+			result = std::strtof(buffer, &end);
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			result = std::strtod(buffer, &end);
+		}
+		else
+		{
+			result = std::strtold(buffer, &end);
+		}
+
+		//Денормализованные числа strtod тоже отмечает ERANGE, но 
+		//std::from_chars их принимает. Отвергаются, как и там, только 
+		//переполнение и потеря значимости до нуля
+		if (end != buffer + size || (errno == ERANGE && 
+			(std::isinf(result) || result == 0)))
+		{
+			return false;
+		}
+
+		value = result;
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать число с плавающей точкой в буфер через snprintf
+	*
+	* @details Точность растёт от digits10 до max_digits10, пока 
+	* parse_float_chars() не вернёт то же самое число. Разделитель локали
+	* заменяется на точку
+	*
+	* @param buffer - буфер размером не меньше kMax_number_size
+	* @param value - число
+	*
+	* @return количество записанных символов
+	**************************************************************************/
+	template<typename T>
+	inline std::size_t format_float_chars(char* buffer, T value) noexcept
+	{
+		const char radix = *std::localeconv()->decimal_point;
+
+		std::size_t size = 0;
+
+		for (int precision = std::numeric_limits<T>::digits10; 
+			precision <= std::numeric_limits<T>::max_digits10; ++precision)
+		{
+			int count = 0;
+
+			if constexpr (std::is_same_v<T, long double>)
+			{
+				count = std::snprintf(buffer, kMax_number_size, "%.*Lg", 
+					precision, value);
+			}
+			else
+			{
+				count = std::snprintf(buffer, kMax_number_size, "%.*g", 
+					precision, static_cast<double>(value));
+			}
+
+			size = count > 0 ? static_cast<std::size_t>(count) : 0;
+
+			std::replace(buffer, buffer + size, radix, '.');
+
+			T result{};
+
+			if (std::isnan(value) || (parse_float_chars(buffer, 
+				buffer + size, result) && result == value))
+			{
+				break;
+			}
+		}
+
+		return size;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разобрать строку в число целиком
+	*
+	* @details Целые числа - необязательный минус и десятичные цифры. Числа с
+	* плавающей точкой - всё, что принимает std::from_chars в общем формате:
+	* экспонента, inf и nan. bool - true, false, 1 или 0
+	*
+	* @param first - начало строки
+	* @param last - конец строки
+	* @param value - результат. Не меняется, если разобрать строку не удалось
+	*
+	* @return true - если вся строка - число, которое помещается в тип T
+	**************************************************************************/
+	template<typename T>
+	inline bool parse_number_chars(const char* first, const char* last,
+		T& value) noexcept
+	{
+		static_assert(is_number_v<T>, "T must be a number type");
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			const std::string_view str(first, 
+				static_cast<std::size_t>(last - first));
+
+			if (str == "true" || str == "1")
+			{
+				value = true;
+			}
+			else if (str == "false" || str == "0")
+			{
+				value = false;
+			}
+			else
+			{
+				return false;
+			}
+
+			return true;
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			static_assert(sizeof(T) <= sizeof(std::uint64_t),
+				"Integer types wider than 64 bits aren't supported");
+
+			const bool is_negative = first != last && *first == '-';
+
+			if (is_negative && std::is_unsigned_v<T>)
+			{
+				return false;
+			}
+
+			std::uint64_t digits = 0;
+
+			if (!parse_digits(first + (is_negative ? 1 : 0), last, digits))
+			{
+				return false;
+			}
+
+			constexpr std::uint64_t kMax = 
+				static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+
+			if (!is_negative)
+			{
+				if (digits > kMax)
+				{
+					return false;
+				}
+
+				value = static_cast<T>(digits);
+			}
+			else
+			{
+				//Модуль минимального значения на единицу больше максимума
+				if (digits > kMax + 1)
+				{
+					return false;
+				}
+
+				value = digits ? 
+					static_cast<T>(-static_cast<T>(digits - 1) - 1) : T{};
+			}
+
+			return true;
+		}
+		else
+		{
+#if XMLB_FLOAT_CHARCONV
+			T result{};
+
+			const auto [ptr, error] = std::from_chars(first, last, result);
+
+			if (error != std::errc{} || ptr != last)
+			{
+				return false;
+			}
+
+			value = result;
+
+			return true;
+#else
+			return parse_float_chars(first, last, value);
+#endif
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать число в буфер
+	*
+	* @details Числа с плавающей точкой записываются кратчайшей строкой, из 
+	* которой parse_number_chars() вернёт то же самое число
+	*
+	* @param buffer - буфер размером не меньше kMax_number_size
+	* @param value - число
+	*
+	* @return количество записанных символов
+	**************************************************************************/
+	template<typename T>
+	inline std::size_t format_number_chars(char* buffer, T value) noexcept
+	{
+		static_assert(is_number_v<T>, "T must be a number type");
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			const std::string_view str = value ? "true" : "false";
+			std::memcpy(buffer, str.data(), str.size());
+
+			return str.size();
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			const auto result = 
+				std::to_chars(buffer, buffer + kMax_number_size, value);
+
+			return static_cast<std::size_t>(result.ptr - buffer);
+		}
+		else
+		{
+#if XMLB_FLOAT_CHARCONV
+			const auto result = 
+				std::to_chars(buffer, buffer + kMax_number_size, value);
+
+			return static_cast<std::size_t>(result.ptr - buffer);
+#else
+			return format_float_chars(buffer, value);
+#endif
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать число с плавающей точкой в буфер в шестнадцатеричной 
+	* записи, как std::chars_format::hex: без префикса 0x, с двоичной 
+	* экспонентой
+	*
+	* @param buffer - буфер размером не меньше kMax_number_size
+	* @param value - число
+	*
+	* @return количество записанных символов
+	**************************************************************************/
+	template<typename T>
+	inline std::size_t format_hex_float_chars(char* buffer, T value) noexcept
+	{
+		static_assert(std::is_floating_point_v<T>, 
+			"T must be a floating point type");
+
+#if XMLB_FLOAT_CHARCONV
+		const auto result = std::to_chars(buffer, 
+			buffer + kMax_number_size, value, std::chars_format::hex);
+
+		return static_cast<std::size_t>(result.ptr - buffer);
+#else
+		int count = 0;
+
+		if constexpr (std::is_same_v<T, long double>)
+		{
+			count = std::snprintf(buffer, kMax_number_size, "%La", value);
+		}
+		else
+		{
+			count = std::snprintf(buffer, kMax_number_size, "%a", 
+				static_cast<double>(value));
+		}
+
+		std::size_t size = count > 0 ? static_cast<std::size_t>(count) : 0;
+
+		std::replace(buffer, buffer + size, 
+			*std::localeconv()->decimal_point, '.');
+
+		//snprintf пишет префикс 0x после знака
+		char* digits = buffer + (size && *buffer == '-' ? 1 : 0);
+
+		if (size >= 2 && digits[0] == '0' && digits[1] == 'x')
+		{
+			std::memmove(digits, digits + 2, 
+				size - static_cast<std::size_t>(digits - buffer) - 2);
+			size -= 2;
+		}
+
+		return size;
+#endif
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разобрать строку из символов CharT в число целиком
+	*
+	* @details Символы, отличные от char, сначала переводятся в char. 
+	* Строка с символами вне ASCII числом не является
+	**************************************************************************/
+	template<typename T, typename CharT>
+	inline bool parse_number_symbols(std::basic_string_view<CharT> str,
+		T& value) noexcept
+	{
+		if constexpr (std::is_same_v<CharT, char>)
+		{
+			return parse_number_chars(str.data(), str.data() + str.size(),
+				value);
+		}
+		else
+		{
+			//Число длиннее буфера - заведомо не число
+			if (str.size() > kMax_number_size)
+			{
+				return false;
+			}
+
+			char buffer[kMax_number_size];
+
+			for (std::size_t i = 0; i < str.size(); ++i)
+			{
+				if (static_cast<std::uint32_t>(str[i]) > 127)
+				{
+					return false;
+				}
+
+				buffer[i] = static_cast<char>(str[i]);
+			}
+
+			return parse_number_chars(buffer, buffer + str.size(), value);
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать число в приёмник, без выделения памяти
+	*
+	* @param sink - приёмник
+	* @param value - число
+	**************************************************************************/
+	template<typename CharT, typename SinkT, typename T>
+	inline void write_number(SinkT& sink, T value)
+	{
+		char buffer[kMax_number_size];
+		const std::size_t size = format_number_chars(buffer, value);
+
+		if constexpr (std::is_same_v<CharT, char>)
+		{
+			sink.append(buffer, size);
+		}
+		else
+		{
+			CharT symbols[kMax_number_size];
+
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				symbols[i] = static_cast<CharT>(buffer[i]);
+			}
+
+			sink.append(symbols, size);
+		}
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Конвертировать строку в число
+	*
+	* @ingroup general
+	*
+	* @details Строка должна целиком быть числом, без пробелов и знака '+'.
+	* Целые числа проверяются на переполнение, числа с плавающей точкой 
+	* разбираются с полной точностью и поддерживают экспоненту
+	*
+	* @tparam T - целый тип, тип с плавающей точкой или bool
+	* @tparam CharT - тип символов
+	* @param str - строка
+	* @param value - результат. Не меняется, если конвертировать не удалось
+	*
+	* @return true - если строка является числом типа T
+	**************************************************************************/
+	template<typename T, typename CharT>
+	inline bool parse_number(std::basic_string_view<CharT> str, T& value) 
+		noexcept
+	{
+		return detail::parse_number_symbols(str, value);
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Конвертировать число в строку
+	*
+	* @ingroup general
+	*
+	* @details Числа с плавающей точкой записываются кратчайшей строкой, из 
+	* которой parse_number() вернёт то же самое число
+	*
+	* @tparam CharT - тип символов
+	* @tparam T - целый тип, тип с плавающей точкой или bool
+	* @param value - число
+	*
+	* @return строку с числом
+	**************************************************************************/
+	template<typename CharT, typename T>
+	inline std::basic_string<CharT> format_number(T value)
+	{
+		char buffer[detail::kMax_number_size];
+		const std::size_t size = detail::format_number_chars(buffer, value);
+
+		return std::basic_string<CharT>(buffer, buffer + size);
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_NUMBER_CONVERSION_H
@@ -0,0 +1,108 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_OUTPUT_FORMAT_H
+#define XMLB_OUTPUT_FORMAT_H
+
+#include <cstddef>
+#include <type_traits>
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Формат вывода XML данных, который выбирается на этапе компиляции
+	*
+	* @ingroup general
+	*
+	* @details Передаётся первым шаблонным параметром в функции сохранения,
+	* например save_to<Minified_format>(document, sink). Функции сохранения
+	* специализируются под формат, поэтому в сжатом выводе нет ни подсчёта
+	* отступов, ни лишних проверок
+	*
+	* @tparam IndentWidth - количество заполняющих символов на один уровень
+	* вложенности, 0 - без отступов
+	* @tparam IsSpaceIndent - true - отступ из Decorator::white_space_symbol,
+	* false - из Decorator::fill_symbol
+	* @tparam IsPretty - true - каждый тег с новой строки, одиночный тег
+	* записывается как "<tag />". false - без переводов строки, одиночный
+	* тег записывается как "<tag/>"
+	**************************************************************************/
+	template<std::size_t IndentWidth, bool IsSpaceIndent, bool IsPretty>
+	struct Output_format final
+	{
+		static constexpr std::size_t indent_width = IndentWidth;
+		static constexpr bool is_space_indent = IsSpaceIndent;
+		static constexpr bool is_pretty = IsPretty;
+	};
+
+	//*************************************************************************
+
+	///Сжатый вывод: без отступов и переводов строки
+	using Minified_format = Output_format<0, false, false>;
+
+	///Вывод с отступом в один Decorator::fill_symbol(по умолчанию табуляция)
+	using Tab_format = Output_format<1, false, true>;
+
+	///Вывод с отступом в N пробелов
+	template<std::size_t N>
+	using Space_format = Output_format<N, true, true>;
+
+	///Формат вывода по умолчанию
+	using Default_format = Tab_format;
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+
+
+namespace XMLB { namespace detail {
+
+	//#########################################################################
+
+	template<typename>
+	struct is_output_format : std::false_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<std::size_t IndentWidth, bool IsSpaceIndent, bool IsPretty>
+	struct is_output_format<
+		Output_format<IndentWidth, IsSpaceIndent, IsPretty>> 
+		: std::true_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename T>
+	inline constexpr bool is_output_format_v = is_output_format<T>::value;
+
+	//#########################################################################
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_OUTPUT_FORMAT_H
@@ -0,0 +1,899 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_PARALLEL_H
+#define XMLB_PARALLEL_H
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <string>
+#include <optional>
+#include <exception>
+#include <algorithm>
+#include <type_traits>
+#include <condition_variable>
+
+#include "XMLB_Node.h"
+#include "XMLB_Document.h"
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Задача параллельного обхода
+	*
+	* @tparam NodeT - тип узла(Node<CharT> или const Node<CharT>)
+	**************************************************************************/
+	template<typename NodeT>
+	struct Parallel_task final
+	{
+		NodeT* node;		///<Узел задачи
+		bool is_subtree;	///<Обойти всё поддерево, иначе только сам узел
+	};
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разбить дерево на задачи примерно одинакового размера
+	*
+	* @details Поддерево, в котором не больше grain узлов, становится одной
+	* задачей. Более крупный узел становится отдельной задачей, а его 
+	* дочерние узлы разбиваются дальше. Размеры поддеревьев берутся из 
+	* Node::size(), поэтому разбиение не обходит узлы внутри задач. Задачи
+	* идут в порядке документа. Вместо рекурсии используется свой стек, 
+	* поэтому глубина дерева не ограничена стеком потока.
+	*
+	* @tparam NodeT - тип узла
+	* @param node - узел, поддерево которого разбивается
+	* @param grain - наибольшее количество узлов в одной задаче
+	* @param tasks - список задач
+	**************************************************************************/
+	template<typename NodeT>
+	void make_parallel_tasks(NodeT& node, std::size_t grain,
+		std::vector<Parallel_task<NodeT>>& tasks)
+	{
+		std::vector<NodeT*> stack{ &node };
+
+		while (!stack.empty())
+		{
+			NodeT* current = stack.back();
+
+			stack.pop_back();
+
+			if (current->size() + 1 <= grain)
+			{
+				tasks.push_back({ current, true });
+
+				continue;
+			}
+
+			tasks.push_back({ current, false });
+
+			//Дочерние узлы кладутся в обратном порядке, чтобы доставаться
+			//в порядке документа
+			for (auto first = current->first_level_end(), 
+				last = current->first_level_begin(); first != last; )
+			{
+				stack.push_back((--first)->get());
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Работа, которую выполняют вызвавший поток и потоки пула
+	*
+	* @details Потоки берут следующую задачу из общего атомарного счётчика,
+	* поэтому освободившийся поток сразу забирает работу у занятых. Первое
+	* исключение из задачи останавливает раздачу.
+	**************************************************************************/
+	struct Parallel_job final
+	{
+		void (*invoke)(const void*, std::size_t) = nullptr;	///<Вызов функции
+		const void* func = nullptr;			///<Функция выполнения задачи
+		std::size_t task_count = 0;			///<Количество задач
+		std::size_t free_helpers = 0;		///<Сколько потоков пула ещё возьмут
+		std::size_t active_helpers = 0;		///<Сколько потоков пула работают
+		std::atomic<std::size_t> next_task{ 0 };	///<Следующая задача
+		std::exception_ptr error;			///<Первое исключение из задачи
+		std::mutex error_mutex;				///<Защита error
+
+		void work() noexcept;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Общий пул потоков параллельных алгоритмов
+	*
+	* @details Потоки создаются при первой необходимости и живут до конца
+	* программы, поэтому повторные вызовы не платят за создание потоков. 
+	* Вызвавший поток сам выполняет свою работу, а потоки пула только 
+	* помогают ему. Поэтому вложенный вызов из задачи не может зависнуть, 
+	* даже если все потоки пула заняты: его работу доделает вызвавший поток.
+	**************************************************************************/
+	class Thread_pool final
+	{
+	public:
+		static Thread_pool& instance();
+
+		~Thread_pool();
+
+		Thread_pool(const Thread_pool&) = delete;
+		Thread_pool& operator=(const Thread_pool&) = delete;
+
+		/**********************************************************************
+		* @brief Выполнить работу вместе с потоками пула
+		*
+		* @details Возвращает управление, когда все задачи выполнены и все
+		* подключившиеся потоки пула закончили работу
+		*
+		* @param job - работа
+		* @param helper_count - наибольшее количество потоков пула
+		**********************************************************************/
+		void run(Parallel_job& job, std::size_t helper_count);
+
+	private:
+		Thread_pool() = default;
+
+		void grow(std::size_t thread_count) noexcept;
+		void worker_loop() noexcept;
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_job_added;
+		std::condition_variable m_job_done;
+		std::vector<Parallel_job*> m_jobs;
+		std::vector<std::thread> m_threads;
+		bool m_is_stopped = false;
+	};
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Выполнить задачи на нескольких потоках
+	*
+	* @details Задачи выполняют вызвавший поток и не больше 
+	* thread_count - 1 потоков общего пула. Первое исключение из задачи 
+	* останавливает раздачу и пробрасывается после завершения всех потоков.
+	*
+	* @tparam FuncT - тип функции, принимающей номер задачи
+	* @param task_count - количество задач
+	* @param thread_count - количество потоков
+	* @param func - функция выполнения задачи
+	**************************************************************************/
+	template<typename FuncT>
+	void run_parallel_tasks(std::size_t task_count, std::size_t thread_count,
+		FuncT&& func)
+	{
+		using func_type = std::remove_reference_t<FuncT>;
+
+		thread_count = std::min(thread_count, task_count);
+
+		if (thread_count <= 1)
+		{
+			for (std::size_t i = 0; i < task_count; ++i)
+			{
+				func(i);
+			}
+
+			return;
+		}
+
+		Parallel_job job;
+
+		job.invoke = [](const void* func, std::size_t i)
+		{
+			(*static_cast<func_type*>(const_cast<void*>(func)))(i);
+		};
+		job.func = std::addressof(func);
+		job.task_count = task_count;
+
+		Thread_pool::instance().run(job, thread_count - 1);
+
+		if (job.error)
+		{
+			std::rethrow_exception(job.error);
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						PARALLEL_JOB IMPLEMENTATION
+	//*************************************************************************
+
+	inline void Parallel_job::work() noexcept
+	{
+		for (std::size_t i = next_task++; i < task_count; i = next_task++)
+		{
+			try
+			{
+				invoke(func, i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock{ error_mutex };
+
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+
+				next_task = task_count;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						THREAD_POOL IMPLEMENTATION
+	//*************************************************************************
+
+	inline Thread_pool& Thread_pool::instance()
+	{
+		static Thread_pool pool;
+
+		return pool;
+	}
+
+	//*************************************************************************
+
+	inline Thread_pool::~Thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			m_is_stopped = true;
+		}
+
+		m_job_added.notify_all();
+
+		for (auto&& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	//*************************************************************************
+
+	inline void Thread_pool::run(Parallel_job& job, std::size_t helper_count)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			grow(helper_count);
+
+			job.free_helpers = helper_count;
+			m_jobs.push_back(&job);
+		}
+
+		m_job_added.notify_all();
+
+		job.work();
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		//Задачи кончились, новые потоки к работе больше не подключаются
+		auto found = std::find(m_jobs.begin(), m_jobs.end(), &job);
+
+		if (found != m_jobs.end())
+		{
+			m_jobs.erase(found);
+		}
+
+		m_job_done.wait(lock, [&job]() { return !job.active_helpers; });
+	}
+
+	//*************************************************************************
+
+	inline void Thread_pool::grow(std::size_t thread_count) noexcept
+	{
+		try
+		{
+			while (m_threads.size() < thread_count)
+			{
+				m_threads.emplace_back(&Thread_pool::worker_loop, this);
+			}
+		}
+		catch (...)
+		{
+			//Если поток не создался, работу доделают уже созданные потоки
+			//и вызвавший поток
+		}
+	}
+
+	//*************************************************************************
+
+	inline void Thread_pool::worker_loop() noexcept
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		while (true)
+		{
+			m_job_added.wait(lock, 
+				[this]() { return m_is_stopped || !m_jobs.empty(); });
+
+			if (m_is_stopped)
+			{
+				return;
+			}
+
+			Parallel_job& job = *m_jobs.front();
+
+			if (!--job.free_helpers)
+			{
+				m_jobs.erase(m_jobs.begin());
+			}
+
+			++job.active_helpers;
+
+			lock.unlock();
+
+			job.work();
+
+			lock.lock();
+
+			if (!--job.active_helpers)
+			{
+				m_job_done.notify_all();
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разбить дерево на задачи для указанного количества потоков
+	*
+	* @tparam NodeT - тип узла
+	* @param node - узел, поддерево которого разбивается(вместе с ним)
+	* @param thread_count - количество потоков, 0 - по числу ядер. 
+	* Заменяется на итоговое количество
+	*
+	* @return список задач в порядке документа
+	**************************************************************************/
+	template<typename NodeT>
+	std::vector<Parallel_task<NodeT>> make_parallel_tasks(NodeT& node,
+		std::size_t& thread_count)
+	{
+		if (!thread_count)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		//По несколько задач на поток, чтобы выровнять нагрузку
+		const std::size_t task_target = thread_count * 8;
+		const std::size_t grain = std::max<std::size_t>(1, 
+			(node.size() + 1) / task_target);
+
+		std::vector<Parallel_task<NodeT>> tasks;
+
+		make_parallel_tasks<NodeT>(node, grain, tasks);
+
+		return tasks;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Выполнить функцию для узла задачи, а если нужно, то и для всех
+	* его потомков
+	*
+	* @tparam NodeT - тип узла
+	* @tparam FuncT - тип функции
+	* @param task - задача
+	* @param func - функция, принимающая узел
+	**************************************************************************/
+	template<typename NodeT, typename FuncT>
+	void visit_parallel_task(const Parallel_task<NodeT>& task, FuncT& func)
+	{
+		func(*task.node);
+
+		if (task.is_subtree)
+		{
+			for (auto first = task.node->begin(), last = task.node->end();
+				first != last; ++first)
+			{
+				func(*first);
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Часть вывода при параллельном сохранении
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	struct Save_piece final
+	{
+		/// Что записывается для узла
+		enum class Kind
+		{
+			kOpen_tag,		///<Только открывающий тег
+			kClose_tag,		///<Только закрывающий тег
+			kSubtree		///<Узел вместе со всеми потомками
+		};
+
+		const Node<CharT>* node;	///<Узел
+		std::size_t offset;			///<Отступ узла от начального
+		Kind kind;					///<Что записывается
+	};
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Разбить дерево на части вывода в порядке документа
+	*
+	* @details Как и в make_parallel_tasks(), поддерево, в котором не больше
+	* grain узлов, становится одной частью. Для более крупного узла 
+	* открывающий и закрывающий теги становятся отдельными частями вокруг 
+	* частей его дочерних узлов. Вместо рекурсии используется свой стек
+	*
+	* @tparam CharT - тип символов
+	* @param node - узел, поддерево которого разбивается
+	* @param offset - отступ узла
+	* @param grain - наибольшее количество узлов в одной части
+	* @param pieces - список частей
+	**************************************************************************/
+	template<typename CharT>
+	void make_save_pieces(const Node<CharT>& node, std::size_t offset,
+		std::size_t grain, std::vector<Save_piece<CharT>>& pieces)
+	{
+		using kind = typename Save_piece<CharT>::Kind;
+
+		//В стеке закрывающий тег лежит под частями дочерних узлов, а 
+		//kSubtree означает узел, который ещё не разбит
+		std::vector<Save_piece<CharT>> stack{ { &node, offset, 
+			kind::kSubtree } };
+
+		while (!stack.empty())
+		{
+			Save_piece<CharT> current = stack.back();
+
+			stack.pop_back();
+
+			if (current.kind == kind::kClose_tag || 
+				current.node->size() + 1 <= grain)
+			{
+				pieces.push_back(current);
+
+				continue;
+			}
+
+			pieces.push_back({ current.node, current.offset, 
+				kind::kOpen_tag });
+			stack.push_back({ current.node, current.offset, 
+				kind::kClose_tag });
+
+			for (auto first = current.node->first_level_end(),
+				last = current.node->first_level_begin(); first != last; )
+			{
+				stack.push_back({ (--first)->get(), current.offset + 1,
+					kind::kSubtree });
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать в приёмник XML узел вместе с потомками
+	*
+	* @details Итераторы узла обходят только его потомков, поэтому теги 
+	* самого узла записываются отдельно
+	*
+	* @tparam FormatT - формат вывода
+	* @param node - узел
+	* @param offset - уровень вложенности узла
+	* @param sink - приёмник
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT, typename CharT, typename SinkT, 
+		typename DecorT>
+	void save_node_to_sink(const Node<CharT>& node, std::size_t offset,
+		SinkT& sink, const DecorT& decorator)
+	{
+		write_open_tag<FormatT>(node, offset, sink, decorator);
+
+		if (node.child_size())
+		{
+			save_to_sink<FormatT>(node.cbegin(), node.cend(), sink, 
+				decorator, offset + 1);
+
+			write_close_tag<FormatT>(node, offset, sink, decorator);
+		}
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Выполнить функцию для узла и всех его потомков на нескольких
+	* потоках
+	*
+	* @ingroup general
+	*
+	* @details Дерево делится на поддеревья примерно одинакового размера по
+	* Node::size(), и потоки разбирают их по мере освобождения. Обход только
+	* читает связи узлов, поэтому одновременный обход разными потоками 
+	* безопасен. Функция может менять имя, значение и атрибуты переданного
+	* ей узла через методы Node, в том числе через неконстантные итераторы
+	* атрибутов: на время обхода общие данные документа (индексы и карта 
+	* исходного текста) меняются под блокировкой, а поиск в поддереве 
+	* узла идёт без индекса и сводки имён. Функция не должна менять
+	* структуру дерева и обращаться к другим узлам на запись. Порядок 
+	* вызовов не определён
+	*
+	* @tparam CharT - тип символов
+	* @tparam FuncT - тип функции, принимающей Node<CharT>&
+	* @param node - узел
+	* @param func - функция
+	* @param thread_count - количество потоков, 0 - по числу ядер
+	*
+	* @throw исключение, брошенное функцией. Остальные узлы при этом могут
+	* остаться необработанными
+	**************************************************************************/
+	template<typename CharT, typename FuncT>
+	void parallel_for_each(Node<CharT>& node, FuncT func, 
+		std::size_t thread_count = 0)
+	{
+		auto tasks = detail::make_parallel_tasks(node, thread_count);
+
+		detail::Concurrent_changes<Node<CharT>> changes{ node };
+
+		detail::run_parallel_tasks(tasks.size(), thread_count,
+			[&](std::size_t i)
+			{
+				detail::visit_parallel_task(tasks[i], func);
+			});
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @overload void parallel_for_each(Node<CharT>& node, FuncT func, 
+	*	std::size_t thread_count = 0)
+	*
+	* @ingroup general
+	**************************************************************************/
+	template<typename CharT, typename FuncT>
+	void parallel_for_each(const Node<CharT>& node, FuncT func,
+		std::size_t thread_count = 0)
+	{
+		auto tasks = detail::make_parallel_tasks(node, thread_count);
+
+		detail::run_parallel_tasks(tasks.size(), thread_count,
+			[&](std::size_t i)
+			{
+				detail::visit_parallel_task(tasks[i], func);
+			});
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Выполнить функцию для всех узлов документа на нескольких потоках
+	*
+	* @ingroup general
+	*
+	* @details Подробнее в parallel_for_each() для Node
+	*
+	* @tparam CharT - тип символов
+	* @tparam FuncT - тип функции, принимающей Node<CharT>&
+	* @param doc - документ
+	* @param func - функция
+	* @param thread_count - количество потоков, 0 - по числу ядер
+	**************************************************************************/
+	template<typename CharT, typename FuncT>
+	void parallel_for_each(Document<CharT>& doc, FuncT func,
+		std::size_t thread_count = 0)
+	{
+		if (!doc.is_empty())
+		{
+			parallel_for_each(*doc.begin(), std::move(func), thread_count);
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @overload void parallel_for_each(Document<CharT>& doc, FuncT func,
+	*	std::size_t thread_count = 0)
+	*
+	* @ingroup general
+	**************************************************************************/
+	template<typename CharT, typename FuncT>
+	void parallel_for_each(const Document<CharT>& doc, FuncT func,
+		std::size_t thread_count = 0)
+	{
+		if (!doc.is_empty())
+		{
+			parallel_for_each(*doc.cbegin(), std::move(func), thread_count);
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Преобразовать узлы и свернуть результаты на нескольких потоках
+	*
+	* @ingroup general
+	*
+	* @details Каждый поток сворачивает результаты своих поддеревьев, а 
+	* частичные результаты сворачиваются в порядке документа, начиная с 
+	* init. Поэтому reduce должна быть ассоциативной, но может быть 
+	* некоммутативной
+	*
+	* @tparam CharT - тип символов
+	* @tparam T - тип результата
+	* @tparam ReduceT - тип функции T(T, T)
+	* @tparam TransformT - тип функции T(const Node<CharT>&)
+	* @param node - узел
+	* @param init - начальное значение
+	* @param reduce - функция свёртки
+	* @param transform - функция преобразования узла
+	* @param thread_count - количество потоков, 0 - по числу ядер
+	*
+	* @return результат свёртки
+	**************************************************************************/
+	template<typename CharT, typename T, typename ReduceT, typename TransformT>
+	T parallel_transform_reduce(const Node<CharT>& node, T init, 
+		ReduceT reduce, TransformT transform, std::size_t thread_count = 0)
+	{
+		auto tasks = detail::make_parallel_tasks(node, thread_count);
+
+		std::vector<std::optional<T>> results(tasks.size());
+
+		detail::run_parallel_tasks(tasks.size(), thread_count,
+			[&](std::size_t i)
+			{
+				auto& result = results[i];
+
+				auto&& func = [&](const Node<CharT>& current)
+				{
+					if (result)
+					{
+						result = reduce(std::move(*result), 
+							transform(current));
+					}
+					else
+					{
+						result.emplace(transform(current));
+					}
+				};
+
+				detail::visit_parallel_task(tasks[i], func);
+			});
+
+		for (auto&& result : results)
+		{
+			init = reduce(std::move(init), std::move(*result));
+		}
+
+		return init;
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Преобразовать узлы документа и свернуть результаты на 
+	* нескольких потоках
+	*
+	* @ingroup general
+	*
+	* @details Подробнее в parallel_transform_reduce() для Node
+	*
+	* @return результат свёртки или init, если документ пустой
+	**************************************************************************/
+	template<typename CharT, typename T, typename ReduceT, typename TransformT>
+	T parallel_transform_reduce(const Document<CharT>& doc, T init,
+		ReduceT reduce, TransformT transform, std::size_t thread_count = 0)
+	{
+		if (doc.is_empty())
+		{
+			return init;
+		}
+
+		return parallel_transform_reduce(*doc.cbegin(), std::move(init),
+			std::move(reduce), std::move(transform), thread_count);
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать XML узел вместе с потомками в приёмник на нескольких
+	* потоках
+	*
+	* @ingroup general
+	*
+	* @details Дерево делится на поддеревья примерно одинакового размера по
+	* Node::size(). Каждое поддерево записывается в свой буфер с нужным 
+	* отступом, после чего буферы по порядку дописываются в приёмник. Узел
+	* записывается без отступа, так же, как корень в save_to() для 
+	* документа
+	*
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника
+	* @tparam DecorT - тип декоратора
+	* @param node - узел
+	* @param sink - приёмник
+	* @param thread_count - количество потоков, 0 - по числу ядер
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT, 
+		typename SinkT, typename DecorT = detail::default_decorator<CharT>,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT> &&
+		detail::is_sink_to_symbol_v<SinkT, CharT>,
+		std::nullptr_t> = nullptr>
+	void save_to_parallel(const Node<CharT>& node, SinkT& sink,
+		std::size_t thread_count = 0, const DecorT& decorator = DecorT{})
+	{
+		using piece_type = detail::Save_piece<CharT>;
+		using kind = typename piece_type::Kind;
+
+		if (!thread_count)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		if (thread_count == 1)
+		{
+			detail::save_node_to_sink<FormatT>(node, 0, sink, decorator);
+
+			return;
+		}
+
+		//По несколько частей на поток, чтобы выровнять нагрузку
+		const std::size_t grain = std::max<std::size_t>(1,
+			(node.size() + 1) / (thread_count * 8));
+
+		std::vector<piece_type> pieces;
+
+		detail::make_save_pieces(node, 0, grain, pieces);
+
+		//Параллельно записываются только поддеревья, теги крупных узлов
+		//дописываются при склейке
+		std::vector<std::size_t> subtrees;
+
+		for (std::size_t i = 0; i < pieces.size(); ++i)
+		{
+			if (pieces[i].kind == kind::kSubtree)
+			{
+				subtrees.push_back(i);
+			}
+		}
+
+		std::vector<std::basic_string<CharT>> buffers(subtrees.size());
+
+		detail::run_parallel_tasks(subtrees.size(), thread_count,
+			[&](std::size_t i)
+			{
+				const piece_type& piece = pieces[subtrees[i]];
+
+				Buffer_sink<CharT> buffer;
+
+				detail::save_node_to_sink<FormatT>(*piece.node, piece.offset,
+					buffer, decorator);
+
+				buffers[i] = buffer.release();
+			});
+
+		std::size_t buffer_index = 0;
+
+		for (auto&& piece : pieces)
+		{
+			switch (piece.kind)
+			{
+			case kind::kOpen_tag:
+				detail::write_open_tag<FormatT>(*piece.node, piece.offset, 
+					sink, decorator);
+				break;
+
+			case kind::kClose_tag:
+				detail::write_close_tag<FormatT>(*piece.node, piece.offset, 
+					sink, decorator);
+				break;
+
+			case kind::kSubtree:
+			{
+				auto& buffer = buffers[buffer_index++];
+
+				sink.append(buffer.data(), buffer.size());
+
+				std::basic_string<CharT>{}.swap(buffer);
+				break;
+			}
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Записать XML документ в приёмник на нескольких потоках
+	*
+	* @ingroup general
+	*
+	* @details Подробнее в save_to_parallel() для Node. Результат совпадает
+	* с save_to<FormatT>(document, sink)
+	*
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника
+	* @tparam DecorT - тип декоратора
+	* @param document - документ
+	* @param sink - приёмник
+	* @param thread_count - количество потоков, 0 - по числу ядер
+	* @param decorator - декоратор
+	**************************************************************************/
+	template<typename FormatT = Default_format, typename CharT, 
+		typename SinkT, typename DecorT = detail::default_decorator<CharT>,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT> &&
+		detail::is_sink_to_symbol_v<SinkT, CharT>,
+		std::nullptr_t> = nullptr>
+	void save_to_parallel(const Document<CharT>& document, SinkT& sink,
+		std::size_t thread_count = 0, const DecorT& decorator = DecorT{})
+	{
+		detail::write_declaration<FormatT>(document, sink, decorator);
+
+		if (!document.is_empty())
+		{
+			save_to_parallel<FormatT>(*document.cbegin(), sink, 
+				thread_count, decorator);
+		}
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_PARALLEL_H
@@ -0,0 +1,419 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_QUERY_H
+#define XMLB_QUERY_H
+
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <string_view>
+
+#include "XMLB_Node.h"
+#include "XMLB_Document.h"
+#include "XMLB/detail/XMLB_Query_iterator.h"
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Скомпилированный запрос к XML структуре
+	* 
+	* @ingroup general
+	*
+	* @details Поддерживается подмножество XPath: шаги по оси детей(/) и
+	* потомков(//), имя узла или *, условия [@name], [@name='value'] и
+	* позиционное условие [N]. Например:
+	* /catalog/book[@lang='en']/title, //book[2], item[@id]. Путь 
+	* вычисляется относительно узла, переданного в execute(): первый шаг
+	* проверяет его дочерние узлы. Для документа первый шаг проверяет root
+	* узел. Запрос компилируется один раз и может выполняться сколько угодно
+	* раз, результаты выдаются лениво в порядке документа.
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Query final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_type = std::basic_string<symbol_type>;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using node_type = Node<symbol_type>;
+		using document_type = Document<symbol_type>;
+		using program_type = detail::Query_program<symbol_type>;
+
+		using range = detail::Query_range<node_type>;
+		using const_range = detail::Query_range<const node_type>;
+
+
+
+		/// @name Методы создания
+		/// @{
+		/**********************************************************************
+		* @brief Скомпилировать запрос
+		*
+		* @param expression - текст запроса
+		*
+		* @throw std::invalid_argument - если в запросе есть синтаксическая
+		* ошибка
+		*
+		* @return скомпилированный запрос
+		**********************************************************************/
+		static Query compile(string_wrapper expression);
+		/// @}
+
+
+
+		/// @name Методы выполнения
+		/// @{
+		/**********************************************************************
+		* @brief Выполнить запрос относительно узла
+		*
+		* @param node - узел, дочерние узлы которого проверяет первый шаг
+		*
+		* @return ленивый диапазон найденных узлов
+		**********************************************************************/
+		range execute(node_type& node) const;
+		const_range execute(const node_type& node) const;
+
+		/**********************************************************************
+		* @brief Выполнить запрос относительно документа
+		*
+		* @param doc - документ, первый шаг проверяет его root узел
+		*
+		* @return ленивый диапазон найденных узлов
+		**********************************************************************/
+		range execute(document_type& doc) const;
+		const_range execute(const document_type& doc) const;
+		/// @}
+
+	private:
+		explicit Query(std::shared_ptr<const program_type> program) noexcept;
+
+		static constexpr symbol_type symbol(char value) noexcept;
+		static bool is_name_symbol(symbol_type value) noexcept;
+
+		static void skip_spaces(string_wrapper expression, 
+			std::size_t& position) noexcept;
+		static string_type parse_name(string_wrapper expression, 
+			std::size_t& position);
+		static detail::Query_predicate<symbol_type> parse_predicate(
+			string_wrapper expression, std::size_t& position,
+			std::size_t& counter_count);
+
+	private:
+		std::shared_ptr<const program_type> m_program;
+	};
+
+	//*************************************************************************
+
+
+
+
+
+	//*************************************************************************
+	//							QUERY IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Query<CharT>::Query(std::shared_ptr<const program_type> program) 
+		noexcept
+		:m_program{ std::move(program) }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Query<CharT> Query<CharT>::compile(string_wrapper expression)
+	{
+		auto program = std::make_shared<program_type>();
+
+		std::size_t position = 0;
+
+		if (expression.empty())
+		{
+			throw std::invalid_argument{ "The query is empty!" };
+		}
+
+		while (position < expression.size())
+		{
+			detail::Query_step<symbol_type> step{ 
+				string_type{}, false, false, {} };
+
+			//Первый шаг может не начинаться с '/', остальные - обязаны
+			if (expression[position] == symbol('/'))
+			{
+				++position;
+
+				if (position < expression.size() && 
+					expression[position] == symbol('/'))
+				{
+					step.is_descendant = true;
+
+					++position;
+				}
+			}
+			else if (program->steps.size())
+			{
+				throw std::invalid_argument{ 
+					"Expected '/' between the query steps!" };
+			}
+
+			if (position < expression.size() && 
+				expression[position] == symbol('*'))
+			{
+				step.is_any_name = true;
+
+				++position;
+			}
+			else
+			{
+				step.name = parse_name(expression, position);
+			}
+
+			while (position < expression.size() &&
+				expression[position] == symbol('['))
+			{
+				step.predicates.push_back(parse_predicate(expression, 
+					position, program->counter_count));
+			}
+
+			program->steps.push_back(std::move(step));
+		}
+
+		if (program->steps.size() > 64)
+		{
+			throw std::invalid_argument{ 
+				"The query has more than 64 steps!" };
+		}
+
+		return Query{ std::move(program) };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Query<CharT>::range Query<CharT>::execute(node_type& node)
+		const
+	{
+		return range{ m_program, &node };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Query<CharT>::const_range Query<CharT>::execute(
+		const node_type& node) const
+	{
+		return const_range{ m_program, &node };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Query<CharT>::range Query<CharT>::execute(
+		document_type& doc) const
+	{
+		return range{ m_program, doc.m_parent.get() };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Query<CharT>::const_range Query<CharT>::execute(
+		const document_type& doc) const
+	{
+		return const_range{ m_program, doc.m_parent.get() };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline constexpr typename Query<CharT>::symbol_type Query<CharT>::symbol(
+		char value) noexcept
+	{
+		return static_cast<symbol_type>(value);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Query<CharT>::is_name_symbol(symbol_type value) noexcept
+	{
+		return value != symbol('/') && value != symbol('[') &&
+			value != symbol(']') && value != symbol('@') &&
+			value != symbol('=') && value != symbol('\'') &&
+			value != symbol('"') && value != symbol('*') &&
+			value != symbol(' ') && value != symbol('\t') &&
+			value != symbol('\n') && value != symbol('\r');
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Query<CharT>::skip_spaces(string_wrapper expression,
+		std::size_t& position) noexcept
+	{
+		while (position < expression.size() &&
+			(expression[position] == symbol(' ') ||
+				expression[position] == symbol('\t')))
+		{
+			++position;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Query<CharT>::string_type Query<CharT>::parse_name(
+		string_wrapper expression, std::size_t& position)
+	{
+		const std::size_t first = position;
+
+		while (position < expression.size() && 
+			is_name_symbol(expression[position]))
+		{
+			++position;
+		}
+
+		if (first == position)
+		{
+			throw std::invalid_argument{ "Expected a name in the query!" };
+		}
+
+		return string_type{ expression.substr(first, position - first) };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline detail::Query_predicate<CharT> Query<CharT>::parse_predicate(
+		string_wrapper expression, std::size_t& position, 
+		std::size_t& counter_count)
+	{
+		using predicate_type = detail::Query_predicate<symbol_type>;
+
+		predicate_type result{ predicate_type::Kind::position, 
+			string_type{}, string_type{}, 0, 0 };
+
+		//Пропускаем '['
+		++position;
+
+		skip_spaces(expression, position);
+
+		if (position < expression.size() && 
+			expression[position] == symbol('@'))
+		{
+			++position;
+
+			result.kind = predicate_type::Kind::attribute_exists;
+			result.attribute_name = parse_name(expression, position);
+
+			skip_spaces(expression, position);
+
+			if (position < expression.size() && 
+				expression[position] == symbol('='))
+			{
+				++position;
+
+				skip_spaces(expression, position);
+
+				if (position >= expression.size() ||
+					(expression[position] != symbol('\'') &&
+						expression[position] != symbol('"')))
+				{
+					throw std::invalid_argument{ 
+						"Expected a quoted attribute value in the query!" };
+				}
+
+				const symbol_type quote = expression[position++];
+				const std::size_t first = position;
+
+				while (position < expression.size() && 
+					expression[position] != quote)
+				{
+					++position;
+				}
+
+				if (position >= expression.size())
+				{
+					throw std::invalid_argument{ 
+						"Unterminated attribute value in the query!" };
+				}
+
+				result.kind = predicate_type::Kind::attribute_equals;
+				result.attribute_value = 
+					string_type{ expression.substr(first, position - first) };
+
+				++position;
+			}
+		}
+		else
+		{
+			while (position < expression.size() &&
+				expression[position] >= symbol('0') &&
+				expression[position] <= symbol('9'))
+			{
+				result.position = result.position * 10 + 
+					static_cast<std::size_t>(
+						expression[position] - symbol('0'));
+
+				++position;
+			}
+
+			if (!result.position)
+			{
+				throw std::invalid_argument{ 
+					"Expected an attribute or a position above zero in the "
+					"query predicate!" };
+			}
+
+			result.counter = counter_count++;
+		}
+
+		skip_spaces(expression, position);
+
+		if (position >= expression.size() || 
+			expression[position] != symbol(']'))
+		{
+			throw std::invalid_argument{ "Expected ']' in the query!" };
+		}
+
+		++position;
+
+		return result;
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_QUERY_H
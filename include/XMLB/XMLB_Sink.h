@@ -0,0 +1,792 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_SINK_H
+#define XMLB_SINK_H
+
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/uio.h>
+#define XMLB_POSIX 1
+#endif
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Приёмник выходных данных в растущем непрерывном буфере
+	*
+	* @ingroup general
+	*
+	* @details Приёмник - это объект с методами append(symbol), 
+	* append(symbol, count) и append(data, size), в который функции 
+	* сохранения дописывают символы без промежуточных строк
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Buffer_sink final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_type = std::basic_string<symbol_type>;
+		using size_type = typename string_type::size_type;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		Buffer_sink() = default;
+
+		/**********************************************************************
+		* @param capacity - сколько символов зарезервировать сразу
+		**********************************************************************/
+		explicit Buffer_sink(size_type capacity);
+		/// @}
+
+
+
+		/// @name Методы записи
+		/// @{
+		void append(symbol_type symbol);
+		void append(symbol_type symbol, size_type count);
+		void append(const symbol_type* data, size_type size);
+		/// @}
+
+
+
+		/// @name Методы доступа к буферу
+		/// @{
+		const symbol_type* data() const noexcept;
+		size_type size() const noexcept;
+
+		/**********************************************************************
+		* @brief Забрать накопленные данные. Приёмник остаётся пустым
+		*
+		* @return строка с записанными символами
+		**********************************************************************/
+		string_type release() noexcept;
+
+		void clear() noexcept;
+		/// @}
+
+	private:
+		string_type m_buffer;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Приёмник выходных данных в буфере вызывающего кода
+	*
+	* @ingroup general
+	*
+	* @details Приёмник не выделяет память. Если данные не помещаются в
+	* буфер, то ничего из них не записывается и бросается исключение
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Fixed_sink final
+	{
+	public:
+		using symbol_type = CharT;
+		using size_type = std::size_t;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param buffer - начало буфера
+		* @param capacity - размер буфера в символах
+		**********************************************************************/
+		Fixed_sink(symbol_type* buffer, size_type capacity) noexcept;
+		/// @}
+
+
+
+		/// @name Методы записи
+		/// @{
+		/**********************************************************************
+		* @throw std::out_of_range - если символы не помещаются в буфер
+		**********************************************************************/
+		void append(symbol_type symbol);
+		void append(symbol_type symbol, size_type count);
+		void append(const symbol_type* data, size_type size);
+		/// @}
+
+
+
+		/// @name Методы доступа к буферу
+		/// @{
+		const symbol_type* data() const noexcept;
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+		/// @}
+
+	private:
+		void check_free(size_type count) const;
+
+	private:
+		symbol_type* m_buffer;
+		size_type m_capacity;
+		size_type m_size;
+	};
+
+	//*************************************************************************
+
+
+
+#ifdef XMLB_POSIX
+	/**************************************************************************
+	* @brief Приёмник выходных данных в файловый дескриптор
+	*
+	* @ingroup general
+	*
+	* @details Символы копятся во внутреннем буфере и пишутся блоками его 
+	* размера. Данные, которые больше свободного места, не копируются в буфер,
+	* а пишутся вместе с ним одним вызовом writev. Дескриптор приёмником не
+	* закрывается
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Fd_sink final
+	{
+	public:
+		using symbol_type = CharT;
+		using size_type = std::size_t;
+
+		///Размер буфера по умолчанию в байтах
+		static constexpr size_type kDefault_buffer_size = 256 * 1024;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param fd - открытый для записи файловый дескриптор
+		* @param buffer_size - размер буфера в байтах
+		**********************************************************************/
+		explicit Fd_sink(int fd, size_type buffer_size = kDefault_buffer_size);
+
+		Fd_sink(const Fd_sink&) = delete;
+		Fd_sink& operator=(const Fd_sink&) = delete;
+
+		/**********************************************************************
+		* @brief Записывает оставшиеся данные. Ошибки записи игнорируются - 
+		* чтобы узнать о них, нужно вызвать flush() явно
+		**********************************************************************/
+		~Fd_sink();
+		/// @}
+
+
+
+		/// @name Методы записи
+		/// @{
+		/**********************************************************************
+		* @throw std::system_error - если запись в дескриптор не удалась
+		**********************************************************************/
+		void append(symbol_type symbol);
+		void append(symbol_type symbol, size_type count);
+		void append(const symbol_type* data, size_type size);
+
+		/**********************************************************************
+		* @brief Записать накопленные в буфере данные
+		*
+		* @throw std::system_error - если запись в дескриптор не удалась
+		**********************************************************************/
+		void flush();
+
+		/**********************************************************************
+		* @brief Дописать символы из другого файла
+		*
+		* @details Накопленные данные записываются, после чего символы 
+		* копируются из файла в файл средствами ядра(copy_file_range или
+		* sendfile на Linux) без копирования через память процесса. Если 
+		* ядро так не умеет, символы читаются через буфер приёмника
+		*
+		* @param fd - открытый для чтения файловый дескриптор
+		* @param offset - позиция первого символа в файле, в символах
+		* @param size - количество символов
+		*
+		* @throw std::system_error - если чтение или запись не удались
+		**********************************************************************/
+		void copy_from(int fd, size_type offset, size_type size);
+		/// @}
+
+	private:
+		void write_all(::iovec* vectors, int count);
+		bool copy_range(int fd, ::off_t& offset, size_type& size);
+
+	private:
+		int m_fd;
+		std::unique_ptr<symbol_type[]> m_buffer;
+		size_type m_capacity;
+		size_type m_size;
+	};
+#endif // XMLB_POSIX
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							BUFFER_SINK IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Buffer_sink<CharT>::Buffer_sink(size_type capacity)
+	{
+		m_buffer.reserve(capacity);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Buffer_sink<CharT>::append(symbol_type symbol)
+	{
+		m_buffer.push_back(symbol);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Buffer_sink<CharT>::append(symbol_type symbol, 
+		size_type count)
+	{
+		m_buffer.append(count, symbol);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Buffer_sink<CharT>::append(const symbol_type* data, 
+		size_type size)
+	{
+		m_buffer.append(data, size);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Buffer_sink<CharT>::symbol_type* 
+		Buffer_sink<CharT>::data() const noexcept
+	{
+		return m_buffer.data();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Buffer_sink<CharT>::size_type 
+		Buffer_sink<CharT>::size() const noexcept
+	{
+		return m_buffer.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Buffer_sink<CharT>::string_type 
+		Buffer_sink<CharT>::release() noexcept
+	{
+		string_type result;
+
+		result.swap(m_buffer);
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Buffer_sink<CharT>::clear() noexcept
+	{
+		m_buffer.clear();
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							FIXED_SINK IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Fixed_sink<CharT>::Fixed_sink(symbol_type* buffer, 
+		size_type capacity) noexcept
+		:m_buffer{ buffer }, m_capacity{ capacity }, m_size{ 0 }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fixed_sink<CharT>::append(symbol_type symbol)
+	{
+		check_free(1);
+
+		m_buffer[m_size++] = symbol;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fixed_sink<CharT>::append(symbol_type symbol, size_type count)
+	{
+		check_free(count);
+
+		std::fill_n(m_buffer + m_size, count, symbol);
+		m_size += count;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fixed_sink<CharT>::append(const symbol_type* data, 
+		size_type size)
+	{
+		check_free(size);
+
+		std::copy_n(data, size, m_buffer + m_size);
+		m_size += size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const typename Fixed_sink<CharT>::symbol_type* 
+		Fixed_sink<CharT>::data() const noexcept
+	{
+		return m_buffer;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Fixed_sink<CharT>::size_type 
+		Fixed_sink<CharT>::size() const noexcept
+	{
+		return m_size;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Fixed_sink<CharT>::size_type 
+		Fixed_sink<CharT>::capacity() const noexcept
+	{
+		return m_capacity;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fixed_sink<CharT>::check_free(size_type count) const
+	{
+		if (count > m_capacity - m_size)
+		{
+			throw std::out_of_range{ "The sink buffer is full!" };
+		}
+	}
+
+	//*************************************************************************
+
+
+
+#ifdef XMLB_POSIX
+	//*************************************************************************
+	//							FD_SINK IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Fd_sink<CharT>::Fd_sink(int fd, size_type buffer_size)
+		:m_fd{ fd },
+		m_buffer{ nullptr },
+		m_capacity{ std::max<size_type>(buffer_size / sizeof(symbol_type), 1) },
+		m_size{ 0 }
+	{
+		m_buffer = std::make_unique<symbol_type[]>(m_capacity);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Fd_sink<CharT>::~Fd_sink()
+	{
+		try
+		{
+			flush();
+		}
+		catch (...)
+		{
+
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::append(symbol_type symbol)
+	{
+		if (m_size == m_capacity)
+		{
+			flush();
+		}
+
+		m_buffer[m_size++] = symbol;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::append(symbol_type symbol, size_type count)
+	{
+		while (count)
+		{
+			if (m_size == m_capacity)
+			{
+				flush();
+			}
+
+			const size_type part = std::min(count, m_capacity - m_size);
+
+			std::fill_n(m_buffer.get() + m_size, part, symbol);
+			m_size += part;
+			count -= part;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::append(const symbol_type* data, 
+		size_type size)
+	{
+		if (size <= m_capacity - m_size)
+		{
+			std::copy_n(data, size, m_buffer.get() + m_size);
+			m_size += size;
+
+			return;
+		}
+
+		//Большие данные пишутся без копирования, вместе с буфером
+		::iovec vectors[2];
+
+		vectors[0].iov_base = m_buffer.get();
+		vectors[0].iov_len = m_size * sizeof(symbol_type);
+		vectors[1].iov_base = 
+			const_cast<void*>(static_cast<const void*>(data));
+		vectors[1].iov_len = size * sizeof(symbol_type);
+
+		m_size = 0;
+
+		write_all(vectors, 2);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::flush()
+	{
+		if (!m_size)
+		{
+			return;
+		}
+
+		::iovec vector;
+
+		vector.iov_base = m_buffer.get();
+		vector.iov_len = m_size * sizeof(symbol_type);
+
+		m_size = 0;
+
+		write_all(&vector, 1);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::copy_from(int fd, size_type offset, 
+		size_type size)
+	{
+		flush();
+
+		auto position = static_cast<::off_t>(offset * sizeof(symbol_type));
+		size *= sizeof(symbol_type);
+
+		if (copy_range(fd, position, size))
+		{
+			return;
+		}
+
+		//Оставшиеся байты читаются через буфер приёмника
+		char* buffer = reinterpret_cast<char*>(m_buffer.get());
+		const size_type capacity = m_capacity * sizeof(symbol_type);
+
+		while (size)
+		{
+			const ::ssize_t count = ::pread(fd, buffer, 
+				std::min(size, capacity), position);
+
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				throw std::system_error{ count ? errno : EIO, 
+					std::generic_category(), 
+					"Can't read from the file descriptor!" };
+			}
+
+			::iovec vector;
+
+			vector.iov_base = buffer;
+			vector.iov_len = static_cast<size_type>(count);
+
+			write_all(&vector, 1);
+
+			position += count;
+			size -= static_cast<size_type>(count);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Fd_sink<CharT>::copy_range(int fd, ::off_t& offset, 
+		size_type& size)
+	{
+#if defined(__linux__)
+		bool is_copy_file_range = true;
+
+		while (size)
+		{
+			::ssize_t count = -1;
+
+			if (is_copy_file_range)
+			{
+				count = ::copy_file_range(fd, &offset, m_fd, nullptr, size, 0);
+
+				//Например, файлы на разных файловых системах в старых ядрах
+				if (count < 0 && errno != EINTR)
+				{
+					is_copy_file_range = false;
+
+					continue;
+				}
+			}
+			else
+			{
+				count = ::sendfile(m_fd, fd, &offset, size);
+			}
+
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			size -= static_cast<size_type>(count);
+		}
+
+		return true;
+#else
+		(void)fd;
+		(void)offset;
+
+		return !size;
+#endif
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Fd_sink<CharT>::write_all(::iovec* vectors, int count)
+	{
+		while (count)
+		{
+			const ::ssize_t written = ::writev(m_fd, vectors, count);
+
+			if (written < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				throw std::system_error{ errno, std::generic_category(),
+					"Can't write to the file descriptor!" };
+			}
+
+			//Пропускаем полностью записанные блоки и сдвигаем начало
+			//частично записанного
+			auto rest = static_cast<std::size_t>(written);
+
+			while (count && rest >= vectors->iov_len)
+			{
+				rest -= vectors->iov_len;
+				++vectors;
+				--count;
+			}
+
+			if (count)
+			{
+				vectors->iov_base = static_cast<char*>(vectors->iov_base) + rest;
+				vectors->iov_len -= rest;
+			}
+		}
+	}
+
+	//*************************************************************************
+#endif // XMLB_POSIX
+
+} // namespace XMLB
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Приёмник, который пишет символы в выходной итератор
+	*
+	* @ingroup secondary
+	*
+	* @tparam IterT - тип выходного итератора
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename IterT, typename CharT>
+	class Iterator_sink final
+	{
+	public:
+		using symbol_type = CharT;
+		using size_type = std::size_t;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param out - итератор, в который будут заноситься данные
+		**********************************************************************/
+		explicit Iterator_sink(IterT out);
+		/// @}
+
+
+
+		/// @name Методы записи
+		/// @{
+		void append(symbol_type symbol);
+		void append(symbol_type symbol, size_type count);
+		void append(const symbol_type* data, size_type size);
+		/// @}
+
+	private:
+		IterT m_out;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						ITERATOR_SINK IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename IterT, typename CharT>
+	inline Iterator_sink<IterT, CharT>::Iterator_sink(IterT out)
+		:m_out{ std::move(out) }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename IterT, typename CharT>
+	inline void Iterator_sink<IterT, CharT>::append(symbol_type symbol)
+	{
+		*m_out = symbol;
+		++m_out;
+	}
+
+	//*************************************************************************
+
+	template<typename IterT, typename CharT>
+	inline void Iterator_sink<IterT, CharT>::append(symbol_type symbol, 
+		size_type count)
+	{
+		for (; count; --count)
+		{
+			*m_out = symbol;
+			++m_out;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename IterT, typename CharT>
+	inline void Iterator_sink<IterT, CharT>::append(const symbol_type* data,
+		size_type size)
+	{
+		for (const symbol_type* last = data + size; data != last; ++data)
+		{
+			*m_out = *data;
+			++m_out;
+		}
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_SINK_H
@@ -0,0 +1,973 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_XML_TEMPLATE_H
+#define XMLB_XML_TEMPLATE_H
+
+#include <array>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "XMLB_Node.h"
+#include "XMLB_Sink.h"
+#include "XMLB_Document.h"
+#include "XMLB_Output_format.h"
+#include "XMLB_Number_conversion.h"
+#include "XMLB/detail/XMLB_Decorator.h"
+#include "XMLB/detail/utilities/XMLB_sup_functions.h"
+
+
+
+namespace XMLB { namespace detail {
+
+	//*************************************************************************
+	//					SUPPORT TRAITS FOR XML TEMPLATE ARGUMENTS
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Проверка, является ли тип диапазоном, по которому можно пройти
+	* через std::begin/std::end
+	**************************************************************************/
+	template<typename T, typename = void>
+	struct is_template_range : std::false_type {};
+
+	template<typename T>
+	struct is_template_range<T, std::void_t<
+		decltype(std::begin(std::declval<const T&>())),
+		decltype(std::end(std::declval<const T&>()))>> : std::true_type {};
+
+	template<typename T>
+	constexpr bool is_template_range_v = is_template_range<T>::value;
+
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Проверка, поддерживает ли тип std::tuple_size (std::tuple,
+	* std::pair, std::array)
+	**************************************************************************/
+	template<typename T, typename = void>
+	struct is_tuple_like : std::false_type {};
+
+	template<typename T>
+	struct is_tuple_like<T, std::void_t<
+		decltype(std::tuple_size<T>::value)>> : std::true_type {};
+
+	template<typename T>
+	constexpr bool is_tuple_like_v = is_tuple_like<T>::value;
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Заранее скомпилированный шаблон XML документа
+	*
+	* @ingroup general
+	*
+	* @details Шаблон один раз превращается в статический текст и "дырки". 
+	* Дыркой становится вставка {{name}} в значении тега или атрибута. 
+	* Тег с атрибутом xmlb:repeat="name" становится повторяемой секцией: он
+	* выводится по одному разу на каждый элемент переданного диапазона, а сам
+	* атрибут в вывод не попадает. Форматирование такое же, как у save_to()
+	* с тем же форматом и декоратором, но тег со вставкой в значении всегда
+	* записывается парой тегов.
+	*
+	* render() получает аргументы в порядке первого появления имён в 
+	* шаблоне, одинаковые имена занимают один аргумент. Строки и значения 
+	* экранируются, числа и bool форматируются без выделения памяти. 
+	* Аргумент секции - диапазон, элементы которого - кортежи(std::tuple, 
+	* std::pair) значений дырок секции в том же порядке, а для секции с
+	* одной дыркой - сами значения. Дырки внутри секции нумеруются 
+	* отдельно и видят только свои значения. Вывод - это последовательность
+	* дописываний статических кусков и экранированных значений, без
+	* построения узлов. render() не меняет шаблон, поэтому один шаблон можно
+	* использовать из разных потоков
+	*
+	* @code
+	* auto tpl = XMLB::Xml_template<char>::compile(
+	* 	"<users count=\"{{count}}\">"
+	* 	"<user xmlb:repeat=\"users\" id=\"{{id}}\">{{name}}</user>"
+	* 	"</users>");
+	*
+	* std::vector<std::pair<int, std::string>> users{ { 1, "Tom" } };
+	* auto text = tpl.render_to_string(users.size(), users);
+	* @endcode
+	*
+	* @tparam CharT - тип символов
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam DecorT - тип декоратора
+	**************************************************************************/
+	template<typename CharT, typename FormatT = Default_format,
+		typename DecorT = detail::Decorator<CharT>>
+	class Xml_template final
+	{
+		static_assert(detail::is_output_format_v<FormatT>,
+			"FormatT must be an Output_format");
+
+	public:
+		using symbol_type = CharT;
+		using decorator_type = DecorT;
+		using string_type = std::basic_string<symbol_type>;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using size_type = std::size_t;
+		using node_type = Node<symbol_type>;
+		using document_type = Document<symbol_type>;
+
+
+
+		/// @name Методы создания
+		/// @{
+		/**********************************************************************
+		* @brief Скомпилировать шаблон из XML документа, вместе с объявлением
+		*
+		* @param document - XML документ
+		* @param decorator - декоратор
+		*
+		* @throw std::invalid_argument - если вставка не закрыта, имя 
+		* пустое или одно имя используется и для секции, и для значения
+		*
+		* @return скомпилированный шаблон
+		**********************************************************************/
+		static Xml_template compile(const document_type& document,
+			const decorator_type& decorator = decorator_type{});
+
+		/**********************************************************************
+		* @brief Скомпилировать шаблон из XML узла, без объявления
+		*
+		* @param node - XML узел
+		* @param decorator - декоратор
+		*
+		* @throw std::invalid_argument - в тех же случаях, что и для 
+		* документа
+		*
+		* @return скомпилированный шаблон
+		**********************************************************************/
+		static Xml_template compile(const node_type& node,
+			const decorator_type& decorator = decorator_type{});
+
+		/**********************************************************************
+		* @brief Скомпилировать шаблон из текста XML документа
+		*
+		* @param xml - текст XML документа
+		* @param decorator - декоратор
+		*
+		* @throw std::invalid_argument - если текст не удалось разобрать, а
+		* также в тех же случаях, что и для документа
+		*
+		* @return скомпилированный шаблон
+		**********************************************************************/
+		static Xml_template compile(string_wrapper xml,
+			const decorator_type& decorator = decorator_type{});
+		/// @}
+
+
+
+		/// @name Методы вывода
+		/// @{
+		/**********************************************************************
+		* @brief Записать шаблон с подставленными значениями в приёмник
+		*
+		* @param sink - приёмник
+		* @param args - значения дырок в порядке их первого появления
+		*
+		* @throw std::invalid_argument - если количество значений не 
+		* совпадает с количеством дырок или для секции передан не диапазон
+		**********************************************************************/
+		template<typename SinkT, typename... ArgsT>
+		void render(SinkT& sink, const ArgsT&... args) const;
+
+		/**********************************************************************
+		* @brief Получить строку с подставленными значениями
+		*
+		* @param args - значения дырок в порядке их первого появления
+		*
+		* @throw std::invalid_argument - в тех же случаях, что и render()
+		*
+		* @return строку с XML текстом
+		**********************************************************************/
+		template<typename... ArgsT>
+		string_type render_to_string(const ArgsT&... args) const;
+		/// @}
+
+
+
+		/// @name Методы состояния
+		/// @{
+		/**********************************************************************
+		* @return количество аргументов render()
+		**********************************************************************/
+		size_type hole_size() const noexcept;
+
+		/**********************************************************************
+		* @param index - номер аргумента render()
+		*
+		* @throw std::out_of_range - если номер больше количества аргументов
+		*
+		* @return имя дырки или секции
+		**********************************************************************/
+		string_wrapper get_hole_name(size_type index) const;
+
+		/**********************************************************************
+		* @return размер статического текста шаблона
+		**********************************************************************/
+		size_type static_size() const noexcept;
+
+		/**********************************************************************
+		* @return имя атрибута секции: xmlb:repeat
+		**********************************************************************/
+		static string_type repeat_attribute_name();
+		/// @}
+
+	private:
+		/// Тип операции вывода
+		enum class Op_kind
+		{
+			kStatic,		///<Статический текст [first, last) из m_text
+			kText,			///<Значение тега под номером index
+			kAttribute,		///<Значение атрибута под номером index
+			kSection		///<Секция index с операциями [first, last)
+		};
+
+		/// Операция вывода
+		struct Op
+		{
+			Op_kind kind;
+			size_type index;
+			size_type first;
+			size_type last;
+			size_type scope;
+		};
+
+		/// Дырка области видимости: корня шаблона или секции
+		struct Hole
+		{
+			string_type name;
+			bool is_section;
+		};
+
+		/// Стертый аргумент render() и функция его вывода
+		template<typename SinkT>
+		struct Argument
+		{
+			const void* value;
+			void (*write)(const Xml_template&, SinkT&, const Op&, 
+				const void*);
+		};
+
+		class Compiler;
+
+	private:
+		Xml_template() = default;
+
+		template<typename SinkT, typename... ArgsT>
+		void render_scope(SinkT& sink, const Op* op, 
+			const ArgsT&... args) const;
+
+		template<typename SinkT>
+		void execute(SinkT& sink, size_type first, size_type last,
+			const Argument<SinkT>* args) const;
+
+		template<typename SinkT, typename T>
+		static void write_argument(const Xml_template& tpl, SinkT& sink,
+			const Op& op, const void* value);
+
+		template<typename SinkT, typename T>
+		static void write_value(SinkT& sink, const T& value, 
+			bool is_attribute, const decorator_type& decorator);
+
+	private:
+		string_type m_text;
+		std::vector<Op> m_ops;
+		std::vector<std::vector<Hole>> m_scopes;
+		decorator_type m_decorator;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							COMPILER IMPLEMENTATION
+	//*************************************************************************
+
+	/**************************************************************************
+	* @brief Сборщик шаблона. Одновременно служит приёмником для функций 
+	* записи тегов: всё, что в него записано, становится статическим текстом
+	**************************************************************************/
+	template<typename CharT, typename FormatT, typename DecorT>
+	class Xml_template<CharT, FormatT, DecorT>::Compiler final
+	{
+	public:
+		explicit Compiler(Xml_template& result);
+
+		void append(symbol_type symbol);
+		void append(symbol_type symbol, size_type count);
+		void append(const symbol_type* data, size_type size);
+
+		void write_node(const node_type& node);
+		void write_nodes(
+			typename node_type::const_iterator first,
+			typename node_type::const_iterator last,
+			size_type base_offset);
+
+	private:
+		size_type write_open_tag(const node_type& node, size_type offset);
+		void write_close_tag(const node_type& node, size_type offset);
+		void write_text(string_wrapper str, Op_kind kind);
+
+		size_type add_hole(string_wrapper name, bool is_section);
+		void push_op(const Op& op);
+
+		size_type begin_section(string_wrapper name);
+		void end_section(size_type section);
+
+	private:
+		/// Отсутствие секции у тега
+		static constexpr size_type kNo_section = static_cast<size_type>(-1);
+
+		Xml_template& m_result;
+		string_type m_repeat_name;
+
+		///Номера областей видимости: корень шаблона и открытые секции
+		std::vector<size_type> m_scope_stack;
+
+		///Номер последней статической операции, которую можно дописывать
+		size_type m_static_op;
+	};
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline Xml_template<CharT, FormatT, DecorT>::Compiler::Compiler(
+		Xml_template& result)
+		:m_result{ result },
+		m_repeat_name{ repeat_attribute_name() },
+		m_scope_stack{ 0 },
+		m_static_op{ kNo_section }
+	{
+		m_result.m_scopes.emplace_back();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::append(
+		symbol_type symbol)
+	{
+		append(&symbol, 1);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::append(
+		symbol_type symbol, size_type count)
+	{
+		for (size_type i = 0; i < count; ++i)
+		{
+			append(&symbol, 1);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::append(
+		const symbol_type* data, size_type size)
+	{
+		if (!size)
+		{
+			return;
+		}
+
+		//Соседние куски статического текста склеиваются в одну операцию
+		if (m_static_op == kNo_section)
+		{
+			m_static_op = m_result.m_ops.size();
+
+			m_result.m_ops.push_back(Op{ Op_kind::kStatic, 0, 
+				m_result.m_text.size(), m_result.m_text.size(), 0 });
+		}
+
+		m_result.m_text.append(data, size);
+		m_result.m_ops[m_static_op].last = m_result.m_text.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::write_node(
+		const node_type& node)
+	{
+		const size_type section = write_open_tag(node, 0);
+
+		if (node.child_size())
+		{
+			write_nodes(node.cbegin(), node.cend(), 1);
+			write_close_tag(node, 0);
+		}
+
+		if (section != kNo_section)
+		{
+			end_section(section);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::write_nodes(
+		typename node_type::const_iterator first,
+		typename node_type::const_iterator last,
+		size_type base_offset)
+	{
+		using const_iterator = typename node_type::const_iterator;
+
+		//Открытые теги с потомками и номера их секций
+		std::vector<std::pair<const_iterator, size_type>> node_groups;
+
+		const auto close_group = [this, &node_groups, base_offset]()
+		{
+			auto&& [node, section] = node_groups.back();
+
+			write_close_tag(*node, base_offset + node.get_offset());
+
+			if (section != kNo_section)
+			{
+				end_section(section);
+			}
+
+			node_groups.pop_back();
+		};
+
+		for (; first != last; ++first)
+		{
+			while (!node_groups.empty() &&
+				first.get_offset() <= node_groups.back().first.get_offset())
+			{
+				close_group();
+			}
+
+			const size_type section = 
+				write_open_tag(*first, base_offset + first.get_offset());
+
+			if (first->child_size())
+			{
+				node_groups.emplace_back(first, section);
+			}
+			else if (section != kNo_section)
+			{
+				end_section(section);
+			}
+		}
+
+		while (!node_groups.empty())
+		{
+			close_group();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::size_type
+		Xml_template<CharT, FormatT, DecorT>::Compiler::write_open_tag(
+			const node_type& node, size_type offset)
+	{
+		const decorator_type& decorator = m_result.m_decorator;
+		const bool has_childs = node.child_size() != 0;
+
+		size_type section = kNo_section;
+
+		for (auto at_it = node.attr_begin(), at_end = node.attr_end();
+			at_it != at_end;
+			++at_it)
+		{
+			if (at_it->name == m_repeat_name)
+			{
+				section = begin_section(at_it->value);
+				break;
+			}
+		}
+
+		detail::write_indent<FormatT>(offset, *this, decorator);
+
+		append(decorator.open_tag_symbol);
+		detail::write_to_sink(*this, node.get_name());
+
+		for (auto at_it = node.attr_begin(), at_end = node.attr_end();
+			at_it != at_end;
+			++at_it)
+		{
+			if (section != kNo_section && at_it->name == m_repeat_name)
+			{
+				continue;
+			}
+
+			append(decorator.white_space_symbol);
+			detail::write_to_sink(*this, string_wrapper{ at_it->name });
+			append(decorator.equal_attribute_symbol);
+			append(decorator.open_attribute_symbol);
+			write_text(at_it->value, Op_kind::kAttribute);
+			append(decorator.close_attribute_symbol);
+		}
+
+		if (!has_childs && node.get_value().size())
+		{
+			append(decorator.close_tag_symbol);
+			write_text(node.get_value(), Op_kind::kText);
+			detail::write_element_end(node, *this, decorator);
+		}
+		else if (!has_childs)
+		{
+			if constexpr (FormatT::is_pretty)
+			{
+				append(decorator.white_space_symbol);
+			}
+
+			append(decorator.single_tag_symbol);
+			append(decorator.close_tag_symbol);
+		}
+		else
+		{
+			append(decorator.close_tag_symbol);
+		}
+
+		if constexpr (FormatT::is_pretty)
+		{
+			append(decorator.line_break_symbol);
+		}
+
+		return section;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::
+		write_close_tag(const node_type& node, size_type offset)
+	{
+		detail::write_close_tag<FormatT>(node, offset, *this, 
+			m_result.m_decorator);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::write_text(
+		string_wrapper str, Op_kind kind)
+	{
+		const symbol_type kOpen = static_cast<symbol_type>('{');
+		const symbol_type kClose = static_cast<symbol_type>('}');
+
+		const string_type kOpen_hole = 
+			detail::to_string<symbol_type>(kOpen, kOpen);
+		const string_type kClose_hole = 
+			detail::to_string<symbol_type>(kClose, kClose);
+
+		for (size_type position = str.find(kOpen_hole); 
+			position != string_wrapper::npos;
+			position = str.find(kOpen_hole))
+		{
+			const size_type name_last = str.find(kClose_hole, position + 2);
+
+			if (name_last == string_wrapper::npos)
+			{
+				throw std::invalid_argument{ 
+					"The template placeholder isn't closed!" };
+			}
+
+			append(str.data(), position);
+
+			const size_type index = add_hole(
+				str.substr(position + 2, name_last - position - 2), false);
+
+			push_op(Op{ kind, index, 0, 0, 0 });
+
+			str.remove_prefix(name_last + 2);
+		}
+
+		append(str.data(), str.size());
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::size_type
+		Xml_template<CharT, FormatT, DecorT>::Compiler::add_hole(
+			string_wrapper name, bool is_section)
+	{
+		if (name.empty())
+		{
+			throw std::invalid_argument{ 
+				"The template placeholder name is empty!" };
+		}
+
+		auto&& holes = m_result.m_scopes[m_scope_stack.back()];
+
+		for (size_type i = 0; i < holes.size(); ++i)
+		{
+			if (holes[i].name != name)
+			{
+				continue;
+			}
+
+			if (holes[i].is_section || is_section)
+			{
+				throw std::invalid_argument{
+					"The template name is used by a section and a value!" };
+			}
+
+			return i;
+		}
+
+		holes.push_back(Hole{ string_type{ name }, is_section });
+
+		return holes.size() - 1;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::push_op(
+		const Op& op)
+	{
+		m_result.m_ops.push_back(op);
+		m_static_op = kNo_section;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::size_type
+		Xml_template<CharT, FormatT, DecorT>::Compiler::begin_section(
+			string_wrapper name)
+	{
+		const size_type index = add_hole(name, true);
+		const size_type section = m_result.m_ops.size();
+		const size_type scope = m_result.m_scopes.size();
+
+		push_op(Op{ Op_kind::kSection, index, section + 1, section + 1, 
+			scope });
+
+		m_result.m_scopes.emplace_back();
+		m_scope_stack.push_back(scope);
+
+		return section;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline void Xml_template<CharT, FormatT, DecorT>::Compiler::end_section(
+		size_type section)
+	{
+		m_result.m_ops[section].last = m_result.m_ops.size();
+		m_scope_stack.pop_back();
+
+		//Текст после секции не должен попасть в её последнюю операцию
+		m_static_op = kNo_section;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							XML_TEMPLATE IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline Xml_template<CharT, FormatT, DecorT> 
+		Xml_template<CharT, FormatT, DecorT>::compile(
+			const document_type& document, const decorator_type& decorator)
+	{
+		Xml_template result;
+		result.m_decorator = decorator;
+
+		Compiler compiler{ result };
+
+		detail::write_declaration<FormatT>(document, compiler, decorator);
+		compiler.write_nodes(document.cbegin(), document.cend(), 0);
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline Xml_template<CharT, FormatT, DecorT> 
+		Xml_template<CharT, FormatT, DecorT>::compile(const node_type& node,
+			const decorator_type& decorator)
+	{
+		Xml_template result;
+		result.m_decorator = decorator;
+
+		Compiler compiler{ result };
+
+		compiler.write_node(node);
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline Xml_template<CharT, FormatT, DecorT> 
+		Xml_template<CharT, FormatT, DecorT>::compile(string_wrapper xml,
+			const decorator_type& decorator)
+	{
+		auto document = load_from(xml.begin(), xml.end(), decorator);
+
+		if (!document)
+		{
+			throw std::invalid_argument{ "The template isn't a valid XML!" };
+		}
+
+		return compile(*document, decorator);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename SinkT, typename... ArgsT>
+	inline void Xml_template<CharT, FormatT, DecorT>::render(SinkT& sink,
+		const ArgsT&... args) const
+	{
+		static_assert(detail::is_sink_to_symbol_v<SinkT, symbol_type>,
+			"SinkT must be a sink of CharT symbols");
+
+		render_scope(sink, nullptr, args...);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename... ArgsT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::string_type
+		Xml_template<CharT, FormatT, DecorT>::render_to_string(
+			const ArgsT&... args) const
+	{
+		Buffer_sink<symbol_type> sink{ m_text.size() };
+
+		render(sink, args...);
+
+		return sink.release();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::size_type
+		Xml_template<CharT, FormatT, DecorT>::hole_size() const noexcept
+	{
+		return m_scopes.empty() ? 0 : m_scopes.front().size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::string_wrapper
+		Xml_template<CharT, FormatT, DecorT>::get_hole_name(
+			size_type index) const
+	{
+		if (index >= hole_size())
+		{
+			throw std::out_of_range{ "The template hole index is too big!" };
+		}
+
+		return m_scopes.front()[index].name;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::size_type
+		Xml_template<CharT, FormatT, DecorT>::static_size() const noexcept
+	{
+		return m_text.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	inline typename Xml_template<CharT, FormatT, DecorT>::string_type
+		Xml_template<CharT, FormatT, DecorT>::repeat_attribute_name()
+	{
+		return detail::to_string<symbol_type>('x', 'm', 'l', 'b', ':',
+			'r', 'e', 'p', 'e', 'a', 't');
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename SinkT, typename... ArgsT>
+	inline void Xml_template<CharT, FormatT, DecorT>::render_scope(
+		SinkT& sink, const Op* op, const ArgsT&... args) const
+	{
+		//Корень шаблона - это все операции и нулевая область видимости
+		const size_type scope = op ? op->scope : 0;
+		const size_type first = op ? op->first : 0;
+		const size_type last = op ? op->last : m_ops.size();
+
+		if (sizeof...(ArgsT) != m_scopes[scope].size())
+		{
+			throw std::invalid_argument{ 
+				"The number of template arguments doesn't match!" };
+		}
+
+		const std::array<Argument<SinkT>, sizeof...(ArgsT)> arguments{ {
+			{ &args, &Xml_template::write_argument<SinkT, ArgsT> }... } };
+
+		execute(sink, first, last, arguments.data());
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename SinkT>
+	inline void Xml_template<CharT, FormatT, DecorT>::execute(SinkT& sink,
+		size_type first, size_type last, const Argument<SinkT>* args) const
+	{
+		while (first != last)
+		{
+			const Op& op = m_ops[first];
+
+			if (op.kind == Op_kind::kStatic)
+			{
+				sink.append(m_text.data() + op.first, op.last - op.first);
+				++first;
+
+				continue;
+			}
+
+			args[op.index].write(*this, sink, op, args[op.index].value);
+
+			//Операции секции уже выполнены для каждого её элемента
+			first = op.kind == Op_kind::kSection ? op.last : first + 1;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename SinkT, typename T>
+	inline void Xml_template<CharT, FormatT, DecorT>::write_argument(
+		const Xml_template& tpl, SinkT& sink, const Op& op, const void* value)
+	{
+		const T& argument = *static_cast<const T*>(value);
+
+		if constexpr (std::is_convertible_v<const T&, string_wrapper> ||
+			!detail::is_template_range_v<T>)
+		{
+			if (op.kind == Op_kind::kSection)
+			{
+				throw std::invalid_argument{ 
+					"The template section argument must be a range!" };
+			}
+
+			write_value(sink, argument, op.kind == Op_kind::kAttribute, 
+				tpl.m_decorator);
+		}
+		else
+		{
+			if (op.kind != Op_kind::kSection)
+			{
+				throw std::invalid_argument{ 
+					"The template value argument can't be a range!" };
+			}
+
+			for (auto&& element : argument)
+			{
+				using element_type = std::decay_t<decltype(element)>;
+
+				if constexpr (detail::is_tuple_like_v<element_type>)
+				{
+					std::apply([&tpl, &sink, &op](const auto&... items)
+						{
+							tpl.render_scope(sink, &op, items...);
+						}, element);
+				}
+				else
+				{
+					tpl.render_scope(sink, &op, element);
+				}
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename FormatT, typename DecorT>
+	template<typename SinkT, typename T>
+	inline void Xml_template<CharT, FormatT, DecorT>::write_value(
+		SinkT& sink, const T& value, bool is_attribute,
+		const decorator_type& decorator)
+	{
+		if constexpr (std::is_convertible_v<const T&, string_wrapper>)
+		{
+			detail::write_escaped(sink, string_wrapper{ value }, 
+				is_attribute, decorator);
+		}
+		else if constexpr (std::is_same_v<T, symbol_type>)
+		{
+			detail::write_escaped(sink, string_wrapper{ &value, 1 },
+				is_attribute, decorator);
+		}
+		else if constexpr (detail::is_number_v<T>)
+		{
+			//Цифры, знак и экспонента не требуют экранирования
+			detail::write_number<symbol_type>(sink, value);
+		}
+		else
+		{
+			static_assert(detail::is_number_v<T>, 
+				"Unsupported template argument type");
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	using u8Xml_template = Xml_template<char>;
+	using u16Xml_template = Xml_template<char16_t>;
+	using u32Xml_template = Xml_template<char32_t>;
+	using wXml_template = Xml_template<wchar_t>;
+
+} // namespace XMLB
+
+#endif // !XMLB_XML_TEMPLATE_H
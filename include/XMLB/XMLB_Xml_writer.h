@@ -0,0 +1,467 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_XML_WRITER_H
+#define XMLB_XML_WRITER_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <string_view>
+
+#include "XMLB_Sink.h"
+#include "XMLB_Document.h"
+#include "XMLB_Output_format.h"
+#include "XMLB/detail/XMLB_Decorator.h"
+#include "XMLB/detail/traits/XMLB_Type_methods_traits.h"
+#include "XMLB/detail/utilities/XMLB_sup_functions.h"
+
+
+
+namespace XMLB
+{
+	/**************************************************************************
+	* @brief Потоковая запись XML данных без построения Document
+	*
+	* @ingroup general
+	*
+	* @details Теги записываются в приёмник сразу, в памяти хранятся только
+	* имена незакрытых тегов. Форматирование такое же, как у save_to() с 
+	* тем же форматом и декоратором: элемент без потомков и значения 
+	* записывается одиночным тегом, элемент со значением - в одну строку. 
+	* Значения текста и атрибутов экранируются: &, < и > всегда, а в 
+	* атрибутах ещё и символ кавычки декоратора. save_to() записывает 
+	* значения узлов как есть, поэтому для документа со спецсимволами в
+	* значениях вывод Xml_writer и save_to() различается. Для записи в файл
+	* удобно использовать Fd_sink, который копит данные в большом буфере
+	*
+	* @code
+	* XMLB::Fd_sink<char> sink{ fd };
+	* XMLB::Xml_writer<char, XMLB::Fd_sink<char>> writer{ sink };
+	*
+	* writer.start_document();
+	* writer.start_element("items");
+	* writer.start_element("item");
+	* writer.attribute("id", "1");
+	* writer.text("first");
+	* writer.end_element();
+	* writer.end_document();
+	* @endcode
+	*
+	* @tparam CharT - тип символов
+	* @tparam SinkT - тип приёмника
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam DecorT - тип декоратора
+	**************************************************************************/
+	template<typename CharT, typename SinkT, 
+		typename FormatT = Default_format, 
+		typename DecorT = detail::Decorator<CharT>>
+	class Xml_writer final
+	{
+		static_assert(detail::is_sink_to_symbol_v<SinkT, CharT>,
+			"SinkT must be a sink of CharT symbols");
+
+		static_assert(detail::is_output_format_v<FormatT>,
+			"FormatT must be an Output_format");
+
+	public:
+		using symbol_type = CharT;
+		using sink_type = SinkT;
+		using decorator_type = DecorT;
+		using string_type = std::basic_string<symbol_type>;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using size_type = std::size_t;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param sink - приёмник, в который будут заноситься данные
+		* @param decorator - декоратор
+		**********************************************************************/
+		explicit Xml_writer(sink_type& sink, 
+			const decorator_type& decorator = decorator_type{});
+
+		Xml_writer(const Xml_writer&) = delete;
+		Xml_writer& operator=(const Xml_writer&) = delete;
+		/// @}
+
+
+
+		/// @name Методы записи
+		/// @{
+		/**********************************************************************
+		* @brief Записать объявление XML документа с версией 1.0 и 
+		* кодировкой UTF-8
+		*
+		* @throw std::logic_error - если объявление или какой-нибудь тег 
+		* уже записаны
+		**********************************************************************/
+		void start_document();
+
+		/**********************************************************************
+		* @brief Записать объявление XML документа
+		*
+		* @param version - версия XML документа
+		* @param encoding_type - кодировка XML документа
+		*
+		* @throw std::logic_error - если объявление или какой-нибудь тег 
+		* уже записаны
+		**********************************************************************/
+		void start_document(float version, string_wrapper encoding_type);
+
+		/**********************************************************************
+		* @brief Открыть тег. Он станет потомком текущего открытого тега
+		*
+		* @param name - имя тега
+		*
+		* @throw std::logic_error - если у текущего тега уже записан текст
+		* или корневой тег уже закрыт
+		**********************************************************************/
+		void start_element(string_wrapper name);
+
+		/**********************************************************************
+		* @brief Добавить атрибут к только что открытому тегу
+		*
+		* @param name - имя атрибута
+		* @param value - значение атрибута, будет экранировано
+		*
+		* @throw std::logic_error - если после открытия тега уже был записан
+		* текст или потомок
+		**********************************************************************/
+		void attribute(string_wrapper name, string_wrapper value);
+
+		/**********************************************************************
+		* @brief Записать значение текущего тега. Несколько вызовов подряд 
+		* дописывают значение
+		*
+		* @param value - значение, будет экранировано
+		*
+		* @throw std::logic_error - если нет открытого тега или у него уже 
+		* есть потомки
+		**********************************************************************/
+		void text(string_wrapper value);
+
+		/**********************************************************************
+		* @brief Закрыть текущий тег
+		*
+		* @throw std::logic_error - если нет открытого тега
+		**********************************************************************/
+		void end_element();
+
+		/**********************************************************************
+		* @brief Закрыть все открытые теги и сбросить приёмник, если у него 
+		* есть метод flush()
+		**********************************************************************/
+		void end_document();
+		/// @}
+
+
+
+		/// @name Методы состояния
+		/// @{
+		/**********************************************************************
+		* @return количество открытых тегов
+		**********************************************************************/
+		size_type depth() const noexcept;
+		/// @}
+
+	private:
+		/// Состояние текущего тега
+		enum class State
+		{
+			kBefore_root,		///<Ещё ничего не записано
+			kDeclared,			///<Записано только объявление документа
+			kOpen_tag,			///<Открывающий тег не закрыт символом '>'
+			kText,				///<Записан текст тега
+			kContent,			///<Записаны потомки тега
+			kAfter_root			///<Корневой тег закрыт
+		};
+
+		string_wrapper current_name() const noexcept;
+
+		void write(string_wrapper str);
+		void write_escaped(string_wrapper str, bool is_attribute);
+
+	private:
+		sink_type& m_sink;
+		decorator_type m_decorator;
+		State m_state;
+
+		///Имена открытых тегов подряд, без выделения памяти на каждый тег
+		string_type m_names;
+		std::vector<size_type> m_name_offsets;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							XML_WRITER IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline Xml_writer<CharT, SinkT, FormatT, DecorT>::Xml_writer(
+		sink_type& sink, const decorator_type& decorator)
+		:m_sink{ sink },
+		m_decorator{ decorator },
+		m_state{ State::kBefore_root },
+		m_names{},
+		m_name_offsets{}
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::start_document()
+	{
+		start_document(1.f, 
+			detail::to_string<symbol_type>('U', 'T', 'F', '-', '8'));
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::start_document(
+		float version, string_wrapper encoding_type)
+	{
+		if (m_state == State::kDeclared)
+		{
+			throw std::logic_error{ "The declaration is already written!" };
+		}
+
+		if (m_state != State::kBefore_root)
+		{
+			throw std::logic_error{ 
+				"The declaration must be written before the root tag!" };
+		}
+
+		detail::write_declaration<FormatT, symbol_type>(version, 
+			encoding_type, m_sink, m_decorator);
+
+		m_state = State::kDeclared;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::start_element(
+		string_wrapper name)
+	{
+		switch (m_state)
+		{
+		case State::kOpen_tag:
+			m_sink.append(m_decorator.close_tag_symbol);
+
+			if constexpr (FormatT::is_pretty)
+			{
+				m_sink.append(m_decorator.line_break_symbol);
+			}
+			break;
+
+		case State::kText:
+			throw std::logic_error{ "The tag already has a value!" };
+
+		case State::kAfter_root:
+			throw std::logic_error{ "The root tag is already closed!" };
+
+		default:
+			break;
+		}
+
+		detail::write_indent<FormatT>(depth(), m_sink, m_decorator);
+
+		m_sink.append(m_decorator.open_tag_symbol);
+		write(name);
+
+		m_name_offsets.push_back(m_names.size());
+		m_names.append(name);
+
+		m_state = State::kOpen_tag;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::attribute(
+		string_wrapper name, string_wrapper value)
+	{
+		if (m_state != State::kOpen_tag)
+		{
+			throw std::logic_error{ 
+				"Attributes must follow the start of the tag!" };
+		}
+
+		m_sink.append(m_decorator.white_space_symbol);
+		write(name);
+		m_sink.append(m_decorator.equal_attribute_symbol);
+		m_sink.append(m_decorator.open_attribute_symbol);
+		write_escaped(value, true);
+		m_sink.append(m_decorator.close_attribute_symbol);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::text(
+		string_wrapper value)
+	{
+		if (m_state == State::kOpen_tag)
+		{
+			//Пустое значение не меняет вид тега, как и в save_to()
+			if (value.empty())
+			{
+				return;
+			}
+
+			m_sink.append(m_decorator.close_tag_symbol);
+
+			m_state = State::kText;
+		}
+		else if (m_state == State::kContent)
+		{
+			throw std::logic_error{ "The tag already has child tags!" };
+		}
+		else if (m_state != State::kText)
+		{
+			throw std::logic_error{ "There is no open tag!" };
+		}
+
+		write_escaped(value, false);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::end_element()
+	{
+		if (m_name_offsets.empty())
+		{
+			throw std::logic_error{ "There is no open tag!" };
+		}
+
+		switch (m_state)
+		{
+		case State::kOpen_tag:
+			if constexpr (FormatT::is_pretty)
+			{
+				m_sink.append(m_decorator.white_space_symbol);
+			}
+
+			m_sink.append(m_decorator.single_tag_symbol);
+			m_sink.append(m_decorator.close_tag_symbol);
+			break;
+
+		case State::kContent:
+			detail::write_indent<FormatT>(depth() - 1, m_sink, m_decorator);
+
+			[[fallthrough]];
+
+		default:
+			m_sink.append(m_decorator.open_tag_symbol);
+			m_sink.append(m_decorator.last_tag_symbol);
+			write(current_name());
+			m_sink.append(m_decorator.close_tag_symbol);
+			break;
+		}
+
+		if constexpr (FormatT::is_pretty)
+		{
+			m_sink.append(m_decorator.line_break_symbol);
+		}
+
+		m_names.resize(m_name_offsets.back());
+		m_name_offsets.pop_back();
+
+		m_state = m_name_offsets.empty() ? State::kAfter_root : 
+			State::kContent;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::end_document()
+	{
+		while (!m_name_offsets.empty())
+		{
+			end_element();
+		}
+
+		m_state = State::kAfter_root;
+
+		if constexpr (detail::is_has_flush_v<sink_type>)
+		{
+			m_sink.flush();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline typename Xml_writer<CharT, SinkT, FormatT, DecorT>::size_type
+		Xml_writer<CharT, SinkT, FormatT, DecorT>::depth() const noexcept
+	{
+		return m_name_offsets.size();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline typename Xml_writer<CharT, SinkT, FormatT, DecorT>::string_wrapper
+		Xml_writer<CharT, SinkT, FormatT, DecorT>::current_name() 
+		const noexcept
+	{
+		return string_wrapper{ m_names }.substr(m_name_offsets.back());
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::write(
+		string_wrapper str)
+	{
+		m_sink.append(str.data(), str.size());
+	}
+
+	//*************************************************************************
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	inline void Xml_writer<CharT, SinkT, FormatT, DecorT>::write_escaped(
+		string_wrapper str, bool is_attribute)
+	{
+		detail::write_escaped(m_sink, str, is_attribute, m_decorator);
+	}
+
+	//*************************************************************************
+
+} // namespace XMLB
+
+#endif // !XMLB_XML_WRITER_H
@@ -27,9 +27,19 @@
 #ifndef XMLB_UTILITY_H
 #define XMLB_UTILITY_H
 
+#include <cmath>
+#include <stack>
 #include <string>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
 #include <string_view>
 
+#include "XMLB/XMLB_Output_format.h"
+#include "XMLB/XMLB_Number_conversion.h"
+#include "XMLB/detail/utilities/XMLB_sup_functions.h"
 #include "XMLB/detail/XMLB_fwd.h"
 
 
@@ -41,93 +51,21 @@ namespace XMLB
 	* 
 	* @ingroup general
 	*
+	* @details Строка разбирается через parse_number(): с полной точностью и
+	* экспонентой
+	*
 	* @tparam CharT - тип символов
 	* @param str - строка, которую нужно конвертировать
 	*
 	* @return 0.0 - если не удасться конвертировать строку. В противном случае
 	* конвертированное число, которое тоже может быть равно 0.0
-	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение. Нужно добавить hex, oct и binary
 	**************************************************************************/
 	template<typename CharT>
 	inline float to_float(std::basic_string_view<CharT> str)
 	{
-		using symbol_type = CharT;
-		using size_type =
-			typename std::basic_string_view<symbol_type>::size_type;
-
 		float result = 0.f;
 
-		if (str.size())
-		{
-			const unsigned int base = 10;
-			const unsigned int start_ascii_for_dec = 48;
-			const unsigned int dot_count = 1;
-			const symbol_type dot_symbol = '.';
-			const symbol_type minus_symbol = '-';
-
-			auto found_minus = str.find_first_of(minus_symbol);
-			auto found_dot = str.find_first_of(dot_symbol);
-
-			size_type head_count = 0;
-			size_type tail_count = 0;
-
-			if (found_dot != std::basic_string_view<CharT>::npos)
-			{
-				head_count = found_dot;
-				tail_count = str.size() - dot_count - head_count;
-			}
-			else
-			{
-				head_count = str.size();
-			}
-
-			if (found_minus != std::basic_string_view<CharT>::npos)
-			{
-				--head_count;
-			}
-
-			float head = 0.f;
-			float tail = 0.f;
-
-			float start_base = 1.f;
-			size_type digit_position = found_dot - 1;
-
-			while (head_count)
-			{
-				float digit = static_cast<float>(str[digit_position] -
-					start_ascii_for_dec);
-
-				head += digit * start_base;
-				start_base *= base;
-
-				--head_count;
-				--digit_position;
-			}
-
-			start_base = base;
-			digit_position = found_dot + 1;
-
-			while (tail_count)
-			{
-				float digit = static_cast<float>(str[digit_position] -
-					start_ascii_for_dec);
-
-				tail += digit > 0 ? digit / start_base : 0.f;
-				start_base *= base;
-
-				--tail_count;
-				++digit_position;
-			}
-
-			result = head + tail;
-
-			if (found_minus != std::basic_string_view<CharT>::npos)
-			{
-				result *= -1.f;
-			}
-		}
+		parse_number(str, result);
 
 		return result;
 	}
@@ -141,118 +79,101 @@ namespace XMLB
 	* 
 	* @ingroup general
 	*
+	* @details В десятичной системе число записывается кратчайшей строкой,
+	* из которой to_float() вернёт то же самое число. В остальных системах
+	* число записывается позиционно, без экспоненты: цифры больше 9 - 
+	* строчные латинские буквы, дробная часть обрезается после точности 
+	* float. Шестнадцатеричную запись с двоичной экспонентой даёт 
+	* to_hex_string()
+	*
 	* @tparam CharT - тип сиволов
 	* @param value - число, которое нужно конвертировать
-	* @param base - основание числа
+	* @param base - основание числа от 2 до 36
 	* 
-	* @return строку содержащую переданное число
+	* @throw std::invalid_argument - если основание вне диапазона [2, 36]
 	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение. Нужно добавить hex, oct и binary
+	* @return строку содержащую переданное число
 	**************************************************************************/
 	template<typename CharT>
 	inline std::basic_string<CharT> to_string(float value, int base = 10)
 	{
-		using std::begin;
-		using std::end;
-
 		using symbol_type = CharT;
-		using string_type = std::basic_string<symbol_type>;
-		using size_type = typename std::basic_string<symbol_type>::size_type;
-
-		const unsigned int digit_count = 7;
-		const unsigned int dot_count = 1;
-		const unsigned int sign_count = 1;
-		const unsigned int start_ascii_for_hex = 87;
-		const unsigned int start_ascii_for_dec = 48;
-		const symbol_type dot_symbol = '.';
-		const symbol_type minus_symbol = '-';
 
-		string_type result;
-		int result_char_count;
-		size_type head_count = 1;
-		int digit_position = 1;
-
-		// Корректируем размер результирующей строки и значение вспомагательной
-		// позиции цыфры
-
-		if (value < 0)
+		if (base < 2 || base > 36)
 		{
-			result_char_count = digit_count + dot_count + sign_count;
-			result.resize(result_char_count, 
-				static_cast<char>(start_ascii_for_dec));
-
-			digit_position = 0;
+			throw std::invalid_argument{ "The base must be from 2 to 36!" };
 		}
-		else
+
+		if (base == 10 || !std::isfinite(value))
 		{
-			result_char_count = digit_count + dot_count;
-			result.resize(result_char_count, 
-				static_cast<char>(start_ascii_for_dec));
-		}	
+			return format_number<symbol_type>(value);
+		}
 
-		// Инициализируем целую и дробные части входного числа
+		constexpr std::string_view kDigits = 
+			"0123456789abcdefghijklmnopqrstuvwxyz";
 
-		int head = static_cast<int>(std::abs(value));
+		std::basic_string<symbol_type> result;
 
+		if (std::signbit(value))
 		{
-			int temp_base = base;
-
-			while (head > temp_base)
-			{
-				temp_base *= base;
-				++head_count;
-			}
+			result.push_back('-');
 		}
 
-		float tail_raw = (std::abs(value) - static_cast<float>(head));
-		float tail_count = static_cast<float>(
-			std::pow(base, digit_count - head_count));
+		//Целая и дробная части float точно представимы в double
+		double head = std::floor(std::abs(static_cast<double>(value)));
+		double tail = std::abs(static_cast<double>(value)) - head;
 
-		int tail = static_cast<int>(std::round(tail_raw * tail_count));
-
-		// Конвертация целой части в строку
+		//Цифры целой части получаем с конца
+		const std::size_t head_first = result.size();
 
 		do
 		{
-			int digit = head % base;
-			char symbol = static_cast<char>(digit + start_ascii_for_dec);
+			const double digit = std::fmod(head, base);
+
+			result.push_back(kDigits[static_cast<std::size_t>(digit)]);
+			head = (head - digit) / base;
+		} while (head > 0);
 
-			result[head_count - digit_position] = symbol;
-			--result_char_count;
-			++digit_position;
+		std::reverse(result.begin() + head_first, result.end());
 
-			head /= base;
+		//Значащих цифр в записи столько, сколько хватает для точности float
+		const int significant_count = static_cast<int>(std::ceil(
+			std::numeric_limits<float>::digits / std::log2(base))) + 1;
 
-		} while (head && result_char_count >= 0);
+		int digit_count = result[head_first] == '0' ? 0 : 
+			static_cast<int>(result.size() - head_first);
 
-		// Добавляем знак, если он нужен, и точку
-		
-		if (value < 0)
+		if (tail > 0 && digit_count < significant_count)
 		{
-			result.front() = minus_symbol;
-			--result_char_count;
-		}
+			result.push_back('.');
 
-		result[result.size() - result_char_count] = dot_symbol;
-		--result_char_count;
+			while (tail > 0 && digit_count < significant_count)
+			{
+				tail *= base;
 
-		// Конвертация дробной части в строку
+				const double digit = std::floor(tail);
 
-		digit_position = 1;
+				tail -= digit;
 
-		while (tail && result_char_count > 0)
-		{
-			int digit = tail % base;
-			char symbol = static_cast<char>(digit + start_ascii_for_dec);
+				if (digit_count || digit > 0)
+				{
+					++digit_count;
+				}
 
-			result[result.size() - digit_position] = symbol;
-			--result_char_count;
-			++digit_position;
+				result.push_back(kDigits[static_cast<std::size_t>(digit)]);
+			}
 
-			tail /= base;
+			//Нули в конце дробной части не нужны
+			while (result.back() == '0')
+			{
+				result.pop_back();
+			}
 
-		};
+			if (result.back() == '.')
+			{
+				result.pop_back();
+			}
+		}
 
 		return result;
 	}
@@ -261,6 +182,34 @@ namespace XMLB
 
 
 
+	/**************************************************************************
+	* @brief Конвертировать float в шестнадцатеричную строку
+	* 
+	* @ingroup general
+	*
+	* @details Запись такая же, как у std::chars_format::hex: без префикса
+	* 0x и с двоичной экспонентой, например 1.8p+1 для 3.0
+	*
+	* @tparam CharT - тип сиволов
+	* @param value - число, которое нужно конвертировать
+	* 
+	* @return строку содержащую переданное число
+	**************************************************************************/
+	template<typename CharT>
+	inline std::basic_string<CharT> to_hex_string(float value)
+	{
+		char buffer[detail::kMax_number_size];
+
+		const std::size_t size = 
+			detail::format_hex_float_chars(buffer, value);
+
+		return std::basic_string<CharT>(buffer, buffer + size);
+	}
+
+	//*************************************************************************
+
+
+
 	/**************************************************************************
 	* @brief Обрезать версию XML документа в строку с точностью до последней 
 	* значащей цыфры в дробной части
@@ -270,151 +219,85 @@ namespace XMLB
 	* @tparam CharT - тип символов
 	* @param verstion - версия XML документа
 	*
-	* @return строку с обрезанной версией XML документа
-	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение.
+	* @return строку с обрезанной версией XML документа. У целой версии 
+	* остаётся один ноль после точки: 1.0
 	**************************************************************************/
 	template<typename CharT>
 	inline std::basic_string<CharT> cut_doc_version(float version)
 	{
 		using symbol_type = CharT;
-		using size_type = typename std::basic_string<symbol_type>::size_type;
 
-		auto result = to_string<symbol_type>(version);
+		auto result = format_number<symbol_type>(version);
 
 		const symbol_type dot_symbol = '.';
 		const symbol_type zero_digit_symbol = '0';
 
-		auto found_dot = result.find_first_of(dot_symbol);
-
-		size_type not_zero_digit_index = std::basic_string<symbol_type>::npos;
-
-		for (auto index = found_dot + 1; index != result.size(); ++index)
-		{
-			if (result[index] != zero_digit_symbol)
-			{
-				not_zero_digit_index = index;
-			}
-		}
-
-		if (not_zero_digit_index != std::basic_string<symbol_type>::npos)
+		//Кратчайшая запись целого числа не содержит дробной части
+		if (std::isfinite(version) && 
+			result.find_first_not_of(
+				detail::to_string<symbol_type>('-', '0', '1', '2', '3', '4', 
+					'5', '6', '7', '8', '9')) == result.npos)
 		{
-			result.erase(not_zero_digit_index + 1);
+			result.push_back(dot_symbol);
+			result.push_back(zero_digit_symbol);
 		}
-		else
-		{
-			result.erase(found_dot + 2);
-		}
-
-		result.shrink_to_fit();
 
 		return result;
 	}
 
 	//*************************************************************************
 
+} // namespace XMLB
+
 
 
+namespace XMLB { namespace detail {
+
 	/**************************************************************************
-	* @brief Получить суммарное количество символов, необходимое для хранения 
-	* готового XML документа
-	* 
-	* @ingroup general
+	* @brief Получить количество символов строки объявления XML документа
 	*
 	* @tparam CharT - тип символов
 	* @param document - XML документ
-	* @param fill_status - false - если не учитывать заполняющие символы(табы)
-	* @param line_break_status - false - если не учитывать перевод на новую
-	* строку
-	*
-	* @return количество необходимых символов для хранения готового XML
-	* документа
-	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение.
+	* @param line_break_status - учитывать ли перевод строки после неё
 	**************************************************************************/
 	template<typename CharT>
-	inline std::size_t symbols_count(
-		const XMLB::Document<CharT>& document, bool fill_status = true, 
-		bool line_break_status = true)
+	inline std::size_t count_declaration_symbols(
+		const XMLB::Document<CharT>& document, bool line_break_status)
 	{
-		using symbol_type = CharT;
-		std::size_t result = 0;
+		//Символы '<', '?', ' ', '=', '"', '"', ' ', '=', '"', '"', '?', '>'
+		constexpr std::size_t kSingle_symbols = 12;
 
-		constexpr auto kSpace = 1;
-		constexpr auto kOpen_tag = 1;
-		constexpr auto kClose_tag = 1;
-		constexpr auto kOpen_attr = 1;
-		constexpr auto kClose_attr = 1;
-		constexpr auto kEqual_attr = 1;
-		constexpr auto kDoc_info = 1;
-		constexpr auto kDoc_last_info = 1;
-		constexpr auto kLine_break = line_break_status ? 1 : 0;
-
-		constexpr auto kXml = 3;
-		constexpr auto kVersion = 7;
-		constexpr auto kEncoding = 8;
-
-		result += kOpen_tag;
-		result += kDoc_info;
-		result += kXml;
-
-		result += kSpace;
-		result += kVersion;
-		result += kEqual_attr;
-		result += kOpen_attr;
-		result += cut_doc_version<symbol_type>(document.get_version()).size();
-		result += kClose_attr;
-
-		result += kSpace;
-		result += kEncoding;
-		result += kEqual_attr;
-		result += kOpen_attr;
-		result += document.get_encoding_type().size();
-		result += kClose_attr;
-
-		result += kDoc_last_info;
-		result += kClose_tag;
-		result += kLine_break;
-
-		result += symbols_count(document.cbegin(), document.cend(), 
-			fill_status, line_break_status);
+		constexpr std::size_t kXml = 3;
+		constexpr std::size_t kVersion = 7;
+		constexpr std::size_t kEncoding = 8;
 
-		return result;
+		return kSingle_symbols + kXml + kVersion + kEncoding +
+			cut_doc_version<CharT>(document.get_version()).size() +
+			document.get_encoding_type().size() + 
+			(line_break_status ? 1 : 0);
 	}
 
 	//*************************************************************************
 
-
-
 	/**************************************************************************
-	* @brief Получить суммарное количество символов, необходимое для хранения 
-	* готового XML документа
-	* 
-	* @ingroup general
+	* @brief Получить количество символов последовательности XML узлов
 	*
 	* @tparam CharT - тип символов
 	* @param first - итератор на начало XML последовательности
 	* @param last - итератор на конец XML последовательности
-	* @param fill_status - false - если не учитывать заполняющие символы(табы)
-	* @param line_break_status - false - если не учитывать перевод на новую
-	* строку
-	*
-	* @return количество необходимых символов для хранения готового XML
-	* документа
-	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение.
+	* @param fill_width - количество заполняющих символов на уровень
+	* @param line_break_status - учитывать ли переводы строки
+	* @param single_space_status - учитывать ли пробел в "<tag />"
 	**************************************************************************/
 	template<typename CharT>
-	inline std::size_t symbols_count(
-		detail::Node_const_iterator<CharT> first, 
-		detail::Node_const_iterator<CharT> last,
-		bool fill_status = true,
-		bool line_break_status = true)
+	inline std::size_t count_symbols(
+		Node_const_iterator<Node<CharT>> first,
+		Node_const_iterator<Node<CharT>> last,
+		std::size_t fill_width,
+		bool line_break_status,
+		bool single_space_status)
 	{
-		using const_iterator = detail::Node_const_iterator<CharT>;
+		using const_iterator = Node_const_iterator<Node<CharT>>;
 
 		std::size_t result = 0;
 
@@ -423,121 +306,85 @@ namespace XMLB
 			return result;
 		}
 
-		constexpr auto kFill = fill_status ? 1 : 0;
-		constexpr auto kSpace = 1;
-		constexpr auto kOpen_tag = 1;
-		constexpr auto kClose_tag = 1;
-		constexpr auto kSingle_tag = 1;
-		constexpr auto kLast_tag = 1;
-		constexpr auto kOpen_attr = 1;
-		constexpr auto kClose_attr = 1;
-		constexpr auto kEqual_attr = 1;
-		constexpr auto kLine_break = line_break_status ? 1 : 0;
-		constexpr auto kTab = 1;
-		constexpr auto kCarriage = 1;
+		const std::size_t kLine_break = line_break_status ? 1 : 0;
+
+		//Символы "</" и ">" закрывающего тега
+		constexpr std::size_t kLast_tag_symbols = 3;
+
+		//Символы ' ', '=', '"', '"' атрибута
+		constexpr std::size_t kAttribute_symbols = 4;
+
+		//Символы "<" и ">" открывающего тега
+		constexpr std::size_t kOpen_tag_symbols = 2;
+
+		//Символы "<", " ", "/" и ">" одиночного тега
+		const std::size_t kSingle_tag_symbols = single_space_status ? 4 : 3;
 
 		//Контейнер итераторова, чтобы правильно закрывать теги с потомками
-		std::stack<const_iterator> node_groups;
+		std::stack<const_iterator, std::vector<const_iterator>> node_groups;
+
+		const auto count_close_tag = [&](const const_iterator& node)
+		{
+			return node.get_offset() * fill_width + kLast_tag_symbols +
+				node->get_name().size() + kLine_break;
+		};
 
 		for (; first != last; ++first)
 		{
-			//Проверяем, пустой ли стэк с итераторома-группами
-			if (!node_groups.empty())
+			while (!node_groups.empty() &&
+				first.get_offset() <= node_groups.top().get_offset())
 			{
-				//Если текущее значение табуляции равно с последним
-				//добавленным в стэк итератором, то заносим в файл
-				//закрытие предыдущего тега
-				while (first.get_offset() <= node_groups.top().get_offset())
-				{
-					//Записываем нужное количество табов для тега
-					result += node_groups.top().get_offset() * kFill;
-
-					result += kOpen_tag;
-					result += kLast_tag;
-					result += node_groups.top()->get_name().size();
-					result += kClose_tag;
-					result += kLine_break;
+				result += count_close_tag(node_groups.top());
 
-					node_groups.pop();
-				}
+				node_groups.pop();
 			}
 
-			//Если у текущего тега есть под-теги, то добавляем его
-			//в стек в качестве итератора-группы
-			if (first->child_size())
+			const bool has_childs = first->child_size() != 0;
+
+			if (has_childs)
 			{
 				node_groups.push(first);
 			}
 
-			//Устанавливаем нужное количество табов для тега
-			result += first.get_offset() * kFill;
-
-			//Заносим в файл сам тег и его информацию
-			result += kOpen_tag;
+			result += first.get_offset() * fill_width;
 			result += first->get_name().size();
+			result += kLine_break;
 
-			//Если у XML тега есть аттрибуты, то записываем в файл
-			//их имена и значения
-			if (first->attr_size())
+			for (auto at_it = first->attr_begin(), at_end = first->attr_end();
+				at_it != at_end;
+				++at_it)
 			{
-				for (auto at_it = first->attr_begin(),
-					at_end = first->attr_end();
-					at_it != at_end;
-					++at_it)
-				{
-					result += kSpace;
-
-					result += at_it->name.size();
-					result += kEqual_attr;
-
-					result += kOpen_attr;
-					result += at_it->value.size();
-					result += kClose_attr;
-				}
+				result += kAttribute_symbols;
+				result += at_it->name.size();
+				result += at_it->value.size();
 			}
 
-			//Если у XML тега нет дочерних узлов и есть значение, то
-			//записываем это значение и доп. символы по шаблону
-			if (!first->child_size() && first->get_value().size())
-			{
-				result += kClose_tag;
-				result += first->get_value().size();
-
-				result += kOpen_tag;
-				result += kLast_tag;
+			//Тег со значением: <name>value</name>
+			auto&& value = Value_access<CharT>::get(*first);
 
+			if (!has_childs && !value.empty())
+			{
+				result += kOpen_tag_symbols;
+				result += value.size();
+				result += kLast_tag_symbols;
 				result += first->get_name().size();
-				result += kClose_tag;
 			}
-			//Если у XML тега нет дочерних узлов и нет значения, то
-			//записываем доп. символы по шаблону одиночного XML тега
-			else if (!first->child_size())
+			//Одиночный тег: <name />
+			else if (!has_childs)
 			{
-				result += kSpace;
-				result += kSingle_tag;
-				result += kClose_tag;
+				result += kSingle_tag_symbols;
 			}
-			//В противном случае, просто записываем в файл символ
-			//закрытия XML тега
+			//Открывающий тег: <name>
 			else
 			{
-				result += kClose_tag;
+				result += kOpen_tag_symbols;
 			}
-
-			result += kLine_break;
 		}
 
-		//Если остались ещё незакрытые теги, то заносим в файл их закрытие
+		//Закрывающие теги оставшихся групп
 		while (!node_groups.empty())
 		{
-			//Записываем нужное количество табов для тега
-			result += node_groups.top().get_offset() * kFill;
-
-			result += kOpen_tag;
-			result += kLast_tag;
-			result += node_groups.top()->get_name().size();
-			result += kClose_tag;
-			result += kLine_break;
+			result += count_close_tag(node_groups.top());
 
 			node_groups.pop();
 		}
@@ -547,111 +394,193 @@ namespace XMLB
 
 	//*************************************************************************
 
+}} // namespace XMLB::detail
 
 
+
+namespace XMLB
+{
 	/**************************************************************************
-	* @brief Получить суммарное количество символов, необходимое для хранения
+	* @brief Получить суммарное количество символов, необходимое для хранения 
 	* готового XML документа
 	* 
 	* @ingroup general
 	*
+	* @details Результат совпадает с количеством символов, которое запишет 
+	* save_to(document, ...). Все символы декоратора одиночные, поэтому 
+	* результат не зависит от их значений. Значения и атрибуты записываются
+	* как есть, без экранирования
+	*
 	* @tparam CharT - тип символов
-	* @param node - XML узел
+	* @param document - XML документ
 	* @param fill_status - false - если не учитывать заполняющие символы(табы)
 	* @param line_break_status - false - если не учитывать перевод на новую
 	* строку
 	*
 	* @return количество необходимых символов для хранения готового XML
 	* документа
+	**************************************************************************/
+	template<typename CharT>
+	inline std::size_t symbols_count(
+		const XMLB::Document<CharT>& document, bool fill_status = true, 
+		bool line_break_status = true)
+	{
+		return detail::count_declaration_symbols(document, 
+			line_break_status) + 
+			detail::count_symbols(document.cbegin(), document.cend(),
+				fill_status ? 1 : 0, line_break_status, true);
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Получить суммарное количество символов, необходимое для хранения 
+	* последовательности XML узлов
+	* 
+	* @ingroup general
+	*
+	* @details Результат совпадает с количеством символов, которое запишет 
+	* save_to(first, last, ...)
+	*
+	* @tparam CharT - тип символов
+	* @param first - итератор на начало XML последовательности
+	* @param last - итератор на конец XML последовательности
+	* @param fill_status - false - если не учитывать заполняющие символы(табы)
+	* @param line_break_status - false - если не учитывать перевод на новую
+	* строку
+	*
+	* @return количество необходимых символов для хранения XML 
+	* последовательности
+	**************************************************************************/
+	template<typename CharT>
+	inline std::size_t symbols_count(
+		detail::Node_const_iterator<Node<CharT>> first, 
+		detail::Node_const_iterator<Node<CharT>> last,
+		bool fill_status = true,
+		bool line_break_status = true)
+	{
+		return detail::count_symbols(first, last, fill_status ? 1 : 0, 
+			line_break_status, true);
+	}
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Получить суммарное количество символов, необходимое для хранения
+	* потомков XML узла
 	* 
-	* @todo Нужно переписать данную функцию, так как она пока-что как
-	* временное решение.
+	* @ingroup general
+	*
+	* @details Результат совпадает с количеством символов, которое запишет 
+	* save_to(node.cbegin(), node.cend(), ...)
+	*
+	* @tparam CharT - тип символов
+	* @param node - XML узел
+	* @param fill_status - false - если не учитывать заполняющие символы(табы)
+	* @param line_break_status - false - если не учитывать перевод на новую
+	* строку
+	*
+	* @return количество необходимых символов для хранения потомков XML узла
 	**************************************************************************/
 	template<typename CharT>
 	inline std::size_t symbols_count(const Node<CharT>& node,
 		bool fill_status = true,
 		bool line_break_status = true)
 	{
-		using const_iterator = detail::Node_const_iterator<CharT>;
+		return symbols_count(node.cbegin(), node.cend(),
+			fill_status, line_break_status);
+	}
 
-		std::size_t result = 0;
+	//*************************************************************************
 
-		constexpr auto kFill = fill_status ? 1 : 0;
-		constexpr auto kSpace = 1;
-		constexpr auto kOpen_tag = 1;
-		constexpr auto kClose_tag = 1;
-		constexpr auto kSingle_tag = 1;
-		constexpr auto kLast_tag = 1;
-		constexpr auto kOpen_attr = 1;
-		constexpr auto kClose_attr = 1;
-		constexpr auto kEqual_attr = 1;
-		constexpr auto kLine_break = line_break_status ? 1 : 0;
-		constexpr auto kTab = 1;
-		constexpr auto kCarriage = 1;
-
-		result += kOpen_tag;
-		result += node.get_name().size();
-
-		//Если у XML тега есть аттрибуты, то записываем в файл
-		//их имена и значения
-		if (node.attr_size())
-		{
-			for (auto at_it = node.attr_begin(),
-				at_end = node.attr_end();
-				at_it != at_end;
-				++at_it)
-			{
-				result += kSpace;
 
-				result += at_it->name.size();
-				result += kEqual_attr;
 
-				result += kOpen_attr;
-				result += at_it->value.size();
-				result += kClose_attr;
-			}
-		}
+	/**************************************************************************
+	* @overload std::size_t symbols_count(const XMLB::Document<CharT>& 
+	* document, bool fill_status = true, bool line_break_status = true)
+	* 
+	* @brief Получить количество символов XML документа в формате FormatT
+	* 
+	* @ingroup general
+	*
+	* @details Результат совпадает с количеством символов, которое запишет 
+	* save_to<FormatT>(document, ...)
+	*
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @param document - XML документ
+	**************************************************************************/
+	template<typename FormatT, typename CharT,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT>,
+		std::nullptr_t> = nullptr>
+	inline std::size_t symbols_count(const XMLB::Document<CharT>& document)
+	{
+		return detail::count_declaration_symbols(document, 
+			FormatT::is_pretty) + 
+			symbols_count<FormatT>(document.cbegin(), document.cend());
+	}
 
-		//Если у XML тега нет дочерних узлов и есть значение, то
-		//записываем это значение и доп. символы по шаблону
-		if (!node.child_size() && node.get_value().size())
-		{
-			result += kClose_tag;
-			result += node.get_value().size();
+	//*************************************************************************
 
-			result += kOpen_tag;
-			result += kLast_tag;
 
-			result += node.get_name().size();
-			result += kClose_tag;
-		}
-		//Если у XML тега нет дочерних узлов и нет значения, то
-		//записываем доп. символы по шаблону одиночного XML тега
-		else if (!node.child_size())
-		{
-			result += kSpace;
-			result += kSingle_tag;
-			result += kClose_tag;
-		}
-		//В противном случае, просто записываем в файл символ
-		//закрытия XML тега
-		else
-		{
-			result += kClose_tag;
 
-			result += kLine_break;
-			result += kFill;
+	/**************************************************************************
+	* @overload std::size_t symbols_count(
+	* detail::Node_const_iterator<Node<CharT>> first, 
+	* detail::Node_const_iterator<Node<CharT>> last,
+	* bool fill_status = true, bool line_break_status = true)
+	* 
+	* @brief Получить количество символов последовательности XML узлов в 
+	* формате FormatT
+	* 
+	* @ingroup general
+	*
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @param first - итератор на начало XML последовательности
+	* @param last - итератор на конец XML последовательности
+	**************************************************************************/
+	template<typename FormatT, typename CharT,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT>,
+		std::nullptr_t> = nullptr>
+	inline std::size_t symbols_count(
+		detail::Node_const_iterator<Node<CharT>> first,
+		detail::Node_const_iterator<Node<CharT>> last)
+	{
+		return detail::count_symbols(first, last, FormatT::indent_width,
+			FormatT::is_pretty, FormatT::is_pretty);
+	}
 
-			result += kOpen_tag;
-			result += kLast_tag;
-			result += node.get_name().size();
-			result += kClose_tag;
-		}
+	//*************************************************************************
 
-		result += symbols_count(node.begin(), node.end(),
-			fill_status, line_break_status);
 
-		return result;
+
+	/**************************************************************************
+	* @overload std::size_t symbols_count(const Node<CharT>& node,
+	* bool fill_status = true, bool line_break_status = true)
+	* 
+	* @brief Получить количество символов потомков XML узла в формате 
+	* FormatT
+	* 
+	* @ingroup general
+	*
+	* @tparam FormatT - формат вывода(Output_format)
+	* @tparam CharT - тип символов
+	* @param node - XML узел
+	**************************************************************************/
+	template<typename FormatT, typename CharT,
+		std::enable_if_t<
+		detail::is_output_format_v<FormatT>,
+		std::nullptr_t> = nullptr>
+	inline std::size_t symbols_count(const Node<CharT>& node)
+	{
+		return symbols_count<FormatT>(node.cbegin(), node.cend());
 	}
 
 	//*************************************************************************
@@ -0,0 +1,294 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_NODE_BUILDER_H
+#define XMLB_NODE_BUILDER_H
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Построитель XML структуры в порядке документа
+	* 
+	* @ingroup secondary
+	*
+	* @details Узлы добавляются в том порядке, в котором они идут в
+	* документе: open() - дочерние узлы - close(). Каждый новый узел сразу
+	* связывается с последним узлом обхода и получает разницу глубины с ним,
+	* поэтому построение структуры из N узлов занимает O(N) - без поиска
+	* последнего дочернего узла и без подъёма по родителям на каждом
+	* добавлении. Количество дочерних узлов и последний узел поддерева
+	* родителю записываются при закрытии узла, а родителям корневого узла и
+	* индексам документа - в finish().
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Node_builder final
+	{
+	public:
+		using node_type = NodeT;
+		using node_pointer = typename NodeT::Ptr;
+		using tree_node = typename NodeT::tree_node;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param root - узел, в который будут добавляться дочерние узлы. 
+		* Новые узлы добавляются после уже существующих
+		**********************************************************************/
+		explicit Node_builder(node_type& root) noexcept;
+
+		Node_builder(const Node_builder& builder) = delete;
+		Node_builder& operator=(const Node_builder& builder) = delete;
+
+		~Node_builder();
+		/// @}
+
+
+
+		/// @name Методы построения
+		/// @{
+		/**********************************************************************
+		* @brief Добавить узел последним дочерним узлом текущего открытого
+		* узла и сделать его текущим
+		*
+		* @param node - добавляемый узел, который не должен иметь родителя
+		*
+		* @return ссылка на добавленный узел
+		**********************************************************************/
+		node_type& open(node_pointer node);
+
+		/**********************************************************************
+		* @brief Добавить узел последним дочерним узлом текущего открытого
+		* узла, не делая его текущим
+		*
+		* @param node - добавляемый узел, который не должен иметь родителя
+		*
+		* @return ссылка на добавленный узел
+		**********************************************************************/
+		node_type& add(node_pointer node);
+
+		/**********************************************************************
+		* @brief Закрыть текущий открытый узел. Корневой узел не закрывается
+		**********************************************************************/
+		void close() noexcept;
+
+		/**********************************************************************
+		* @brief Закрыть все открытые узлы, обновить количество узлов у
+		* родителей корневого узла и сообщить документу о новых узлах
+		**********************************************************************/
+		void finish() noexcept;
+
+		/**********************************************************************
+		* @brief Получить количество открытых узлов, не считая корневого
+		*
+		* @return количество открытых узлов
+		**********************************************************************/
+		unsigned int level() const noexcept;
+		/// @}
+
+	private:
+		node_type* m_root;
+		node_type* m_current;
+		tree_node* m_first;
+		tree_node* m_last;
+		tree_node* m_end;
+		tree_node* m_root_last;
+		int m_last_depth;
+		int m_end_depth;
+		unsigned int m_level;
+		int m_added;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						NODE_BUILDER IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Node_builder<NodeT>::Node_builder(node_type& root) noexcept
+		:m_root{ &root },
+		m_current{ &root },
+		m_first{ nullptr },
+		m_last{ root.find_last_tree_node() },
+		m_end{ m_last->next },
+		m_root_last{ m_last },
+		m_last_depth{ static_cast<int>(root.m_tree_node.last_depth) },
+		m_end_depth{ 0 },
+		m_level{ 0 },
+		m_added{ 0 }
+	{
+		//У отсоединённого узла без дочерних узлов нет следующего узла -
+		//после него идёт он сам
+		if (!m_end)
+		{
+			m_end = &root.m_tree_node;
+		}
+
+		//Глубины считаются относительно корневого узла
+		m_end_depth = m_last_depth + m_end->step;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Node_builder<NodeT>::~Node_builder()
+	{
+		finish();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Node_builder<NodeT>::node_type& 
+		Node_builder<NodeT>::open(node_pointer node)
+	{
+		node_type& result = *node;
+
+		m_current->m_childs.push_back(std::move(node));
+		result.m_position = std::prev(m_current->m_childs.end());
+
+		tree_node* add_node = &result.m_tree_node;
+		tree_node* last_add_node = result.find_last_tree_node();
+		const int depth = static_cast<int>(m_level) + 1;
+
+		//Вставляем узел между последним узлом обхода и узлом, который идёт
+		//после всей строящейся структуры
+		m_last->next = add_node;
+		add_node->prev = m_last;
+
+		last_add_node->next = m_end;
+		m_end->prev = last_add_node;
+
+		add_node->step = depth - m_last_depth;
+
+		m_last = last_add_node;
+		m_last_depth = depth + static_cast<int>(add_node->last_depth);
+		m_end->step = m_end_depth - m_last_depth;
+
+		if (!m_first)
+		{
+			m_first = add_node;
+		}
+
+		add_node->parent = &m_current->m_tree_node;
+
+		m_current = &result;
+		++m_level;
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Node_builder<NodeT>::node_type& 
+		Node_builder<NodeT>::add(node_pointer node)
+	{
+		node_type& result = open(std::move(node));
+
+		close();
+
+		return result;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_builder<NodeT>::close() noexcept
+	{
+		if (m_current != m_root)
+		{
+			node_type* parent = m_current->m_tree_node.parent->element;
+
+			m_current->m_tree_node.last = m_last;
+			m_current->m_tree_node.last_depth = 
+				static_cast<unsigned int>(m_last_depth) - m_level;
+
+			parent->m_size += m_current->m_size + 1;
+
+			if (parent == m_root)
+			{
+				m_added += static_cast<int>(m_current->m_size + 1);
+			}
+
+			m_current = parent;
+			--m_level;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_builder<NodeT>::finish() noexcept
+	{
+		while (m_current != m_root)
+		{
+			close();
+		}
+
+		if (m_first)
+		{
+			node_type* top = m_root;
+
+			m_root->update_last(m_root_last, m_last, 
+				static_cast<unsigned int>(m_last_depth));
+			m_root_last = m_last;
+
+			if (m_root->m_tree_node.parent)
+			{
+				top = m_root->m_tree_node.parent->element->update_size(
+					m_added);
+			}
+
+			m_root->notify_attach(m_first, m_last, top);
+		}
+
+		m_first = nullptr;
+		m_added = 0;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline unsigned int Node_builder<NodeT>::level() const noexcept
+	{
+		return m_level;
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_NODE_BUILDER_H
@@ -0,0 +1,2476 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_NODE_CONTEXT_H
+#define XMLB_NODE_CONTEXT_H
+
+#include <list>
+#include <limits>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "XMLB/detail/XMLB_fwd.h"
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Индекс узлов документа по имени
+	* 
+	* @ingroup secondary
+	*
+	* @details Для каждого имени хранит узлы в порядке документа. Порядок
+	* определяется порядковыми номерами узлов(Node_tree::order), которые
+	* назначает Node_context. Пока номера действительны, присоединение узлов
+	* в конец документа, удаление и переименование узлов обновляют индекс 
+	* сразу. 
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Name_index final
+	{
+	public:
+		using node_type = NodeT;
+		using tree_node = typename NodeT::tree_node;
+		using string_type = typename NodeT::string_type;
+		using string_wrapper = typename NodeT::string_wrapper;
+
+
+
+		/// @name Методы обновления индекса
+		/// @{
+		/**********************************************************************
+		* @brief Построить индекс заново для всех дочерних узлов
+		*
+		* @details Если не хватило памяти, индекс остаётся 
+		* недействительным
+		*
+		* @param top - верхний узел дерева(без родителя)
+		**********************************************************************/
+		void rebuild(tree_node* top) noexcept;
+
+		/**********************************************************************
+		* @brief Сделать индекс недействительным
+		**********************************************************************/
+		void invalidate() noexcept;
+
+		/**********************************************************************
+		* @brief Учесть узлы, присоединённые в конец документа
+		*
+		* @param first - первый присоединённый узел
+		* @param last - последний присоединённый узел в порядке обхода
+		**********************************************************************/
+		void attach(tree_node* first, tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть удаление узлов. Вызывается до удаления
+		*
+		* @param first - первый удаляемый узел
+		* @param last - последний удаляемый узел в порядке обхода
+		**********************************************************************/
+		void erase(tree_node* first, tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть смену имени узла. Вызывается до смены имени
+		*
+		* @param node - узел, у которого меняется имя
+		* @param name - новое имя узла
+		**********************************************************************/
+		void rename(tree_node* node, string_wrapper name) noexcept;
+		/// @}
+
+
+
+		/// @name Методы поиска
+		/// @{
+		/**********************************************************************
+		* @brief Проверить, действителен ли индекс
+		*
+		* @return true - если индексом можно пользоваться
+		**********************************************************************/
+		bool is_valid() const noexcept;
+
+		/**********************************************************************
+		* @brief Найти первый узел с именем name в диапазоне [first, last)
+		* порядка документа
+		*
+		* @param name - имя узла
+		* @param first - начало диапазона
+		* @param last - конец диапазона. Верхний узел дерева означает конец 
+		* документа
+		*
+		* @return найденный узел или nullptr
+		**********************************************************************/
+		tree_node* find(string_wrapper name, const tree_node* first,
+			const tree_node* last) const noexcept;
+		/// @}
+
+	private:
+		void add(tree_node* node);
+
+	private:
+		std::list<string_type> m_names;
+		std::unordered_map<string_wrapper, std::vector<tree_node*>> m_nodes;
+		bool m_valid = false;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Сводка имён поддеревьев
+	* 
+	* @ingroup secondary
+	*
+	* @details Для каждого узла хранит 64-битный фильтр Блума имён узла и
+	* всех его потомков. Если в фильтре нет битов имени, узлов с таким
+	* именем в поддереве точно нет и поиск его пропускает. Фильтры 
+	* хранятся по порядковым номерам узлов(Node_tree::order). Удаление узлов
+	* фильтры не меняет: лишние биты делают фильтр лишь менее точным.
+	* Занимает 8 байт на узел, поэтому создаётся только по запросу.
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Name_summary final
+	{
+	public:
+		using node_type = NodeT;
+		using tree_node = typename NodeT::tree_node;
+		using string_wrapper = typename NodeT::string_wrapper;
+
+
+
+		/// @name Методы обновления сводки
+		/// @{
+		/**********************************************************************
+		* @brief Построить сводку заново для всех узлов
+		*
+		* @details Если не хватило памяти, сводка остаётся 
+		* недействительной
+		*
+		* @param top - верхний узел дерева(без родителя)
+		**********************************************************************/
+		void rebuild(tree_node* top) noexcept;
+
+		/**********************************************************************
+		* @brief Сделать сводку недействительной
+		**********************************************************************/
+		void invalidate() noexcept;
+
+		/**********************************************************************
+		* @brief Учесть узлы, присоединённые в конец документа
+		*
+		* @param first - первый присоединённый узел
+		* @param last - последний присоединённый узел в порядке обхода
+		**********************************************************************/
+		void attach(tree_node* first, tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть смену имени узла
+		*
+		* @param node - узел, у которого меняется имя
+		* @param name - новое имя узла
+		**********************************************************************/
+		void rename(tree_node* node, string_wrapper name) noexcept;
+		/// @}
+
+
+
+		/// @name Методы поиска
+		/// @{
+		bool is_valid() const noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, может ли в поддереве узла быть имя
+		*
+		* @param node - узел, поддерево которого проверяется(вместе с ним)
+		* @param name - имя узла
+		*
+		* @return false - если узлов с таким именем в поддереве точно нет
+		**********************************************************************/
+		bool may_contain(const tree_node* node, string_wrapper name) const 
+			noexcept;
+		/// @}
+
+	private:
+		static std::uint64_t get_mask(string_wrapper name) noexcept;
+		void add_to_ancestors(tree_node* node, std::uint64_t mask) noexcept;
+
+	private:
+		std::vector<std::uint64_t> m_masks;
+		bool m_valid = false;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Индекс узлов документа по значению атрибута
+	* 
+	* @ingroup secondary
+	*
+	* @details Учитывается первый атрибут узла с именем индекса. Узлы одного
+	* значения хранятся в порядке добавления, поэтому индексу не нужны
+	* порядковые номера и он не устаревает при вставке в середину документа.
+	* Уникальный индекс не допускает двух узлов с одинаковым значением -
+	* изменения, которые нарушают это, отклоняются до их выполнения.
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Attribute_index final
+	{
+	public:
+		using node_type = NodeT;
+		using tree_node = typename NodeT::tree_node;
+		using string_type = typename NodeT::string_type;
+		using string_wrapper = typename NodeT::string_wrapper;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		/**********************************************************************
+		* @param attribute_name - имя индексируемого атрибута
+		* @param unique - запрещены ли одинаковые значения
+		**********************************************************************/
+		Attribute_index(const string_type& attribute_name, bool unique);
+		/// @}
+
+
+
+		/// @name Методы обновления индекса
+		/// @{
+		/**********************************************************************
+		* @brief Построить индекс заново для всех дочерних узлов
+		*
+		* @param top - верхний узел дерева(без родителя)
+		*
+		* @throw std::invalid_argument - если индекс уникальный, а значения
+		* атрибута повторяются
+		**********************************************************************/
+		void rebuild(tree_node* top);
+
+		/**********************************************************************
+		* @brief Учесть присоединённые узлы
+		*
+		* @param first - первый присоединённый узел
+		* @param last - последний присоединённый узел в порядке обхода
+		**********************************************************************/
+		void attach(tree_node* first, tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть удаление узлов. Вызывается до удаления
+		*
+		* @param first - первый удаляемый узел
+		* @param last - последний удаляемый узел в порядке обхода
+		**********************************************************************/
+		void erase(tree_node* first, tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Добавить узел по текущему значению атрибута
+		*
+		* @param node - узел
+		**********************************************************************/
+		void add(tree_node* node) noexcept;
+
+		/**********************************************************************
+		* @brief Убрать узел по текущему значению атрибута
+		*
+		* @param node - узел
+		**********************************************************************/
+		void remove(tree_node* node) noexcept;
+
+		/**********************************************************************
+		* @brief Сделать индекс недействительным. Он будет построен заново
+		* при следующем обновлении документа
+		**********************************************************************/
+		void invalidate() noexcept;
+		/// @}
+
+
+
+		/// @name Методы поиска
+		/// @{
+		const string_type& get_attribute_name() const noexcept;
+		bool is_unique() const noexcept;
+		bool is_valid() const noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, можно ли узлу получить значение атрибута
+		*
+		* @param value - значение атрибута
+		* @param node - узел, которому присваивается значение
+		*
+		* @return true - если индекс не уникальный или значение не занято
+		* другим узлом
+		**********************************************************************/
+		bool is_available(const string_type& value, const tree_node* node)
+			const;
+
+		/**********************************************************************
+		* @brief Найти узлы с указанным значением атрибута
+		*
+		* @param value - значение атрибута
+		*
+		* @return узлы в порядке добавления или nullptr, если их нет
+		**********************************************************************/
+		const std::vector<tree_node*>* find(const string_type& value) const;
+
+		/**********************************************************************
+		* @brief Получить значение индексируемого атрибута узла
+		*
+		* @param node - узел
+		*
+		* @return указатель на значение или nullptr, если атрибута нет
+		**********************************************************************/
+		const string_type* get_value(const tree_node* node) const noexcept;
+		/// @}
+
+	private:
+		string_type m_attribute_name;
+		std::unordered_map<string_type, std::vector<tree_node*>> m_nodes;
+		bool m_unique;
+		bool m_valid;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Карта исходного текста документа
+	* 
+	* @ingroup secondary
+	*
+	* @details Для каждого узла хранит участок исходного текста, который он
+	* занимает: от символа открытия тега до символа закрытия завершающего 
+	* тега, и два признака. Узел "чистый", если его имя, значение, атрибуты 
+	* и список дочерних узлов не менялись после загрузки, а поддерево
+	* "чистое", если чистые узел и все его потомки. Изменение узла делает
+	* грязными его поддерево и поддеревья предков, подъём прекращается на 
+	* первом уже грязном предке. Удалённые и присоединённые узлы теряют свои
+	* участки, а их родитель становится грязным. Изменения атрибутов через 
+	* итераторы атрибутов не отслеживаются.
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Source_map final
+	{
+	public:
+		using node_type = NodeT;
+		using tree_node = typename NodeT::tree_node;
+		using symbol_type = typename NodeT::symbol_type;
+		using string_type = typename NodeT::string_type;
+		using string_wrapper = typename NodeT::string_wrapper;
+		using source_type = Retained_source<symbol_type>;
+
+		/**********************************************************************
+		* @brief Участок исходного текста узла
+		**********************************************************************/
+		struct Span final
+		{
+			std::size_t first = 0;			///<Позиция символа открытия тега
+			std::size_t last = 0;			///<Позиция после конца узла
+			bool is_clean = true;			///<Узел не менялся
+			bool is_subtree_clean = true;	///<Поддерево не менялось
+		};
+
+
+
+		/// @name Методы построения карты
+		/// @{
+		/**********************************************************************
+		* @brief Сопоставить узлы дерева тегам исходного текста
+		*
+		* @details Теги исходного текста просматриваются по порядку и 
+		* сопоставляются узлам в порядке обхода. Объявление, комментарии,
+		* CDATA и DOCTYPE пропускаются. Если структура или имена тегов не
+		* совпадают с деревом, карта остаётся пустой
+		*
+		* @tparam DecorT - тип декоратора
+		* @param top - верхний узел дерева(без родителя)
+		* @param source - исходный текст документа
+		* @param decorator - декоратор, с которым текст был прочитан
+		* @param version - версия документа после загрузки
+		* @param encoding_type - кодировка документа после загрузки
+		*
+		* @return true - если всем узлам нашлись участки текста
+		**********************************************************************/
+		template<typename DecorT>
+		bool build(const tree_node* top, 
+			std::shared_ptr<const source_type> source, 
+			const DecorT& decorator, float version, 
+			string_wrapper encoding_type);
+
+		/**********************************************************************
+		* @brief Перенести карту на копию дерева
+		*
+		* @param map - карта исходного дерева
+		* @param top - верхний узел копии с той же структурой
+		**********************************************************************/
+		void assign(const Source_map& map, const tree_node* top);
+		/// @}
+
+
+
+		/// @name Методы уведомления об изменениях
+		/// @{
+		/**********************************************************************
+		* @brief Отметить узел грязным
+		*
+		* @param node - изменённый узел
+		**********************************************************************/
+		void touch(const tree_node* node) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть присоединение узлов. Вызывается после присоединения
+		*
+		* @param first - первый присоединённый узел
+		* @param last - последний присоединённый узел в порядке обхода
+		**********************************************************************/
+		void attach(const tree_node* first, const tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть удаление узлов. Вызывается до удаления
+		*
+		* @param first - первый удаляемый узел
+		* @param last - последний удаляемый узел в порядке обхода
+		**********************************************************************/
+		void erase(const tree_node* first, const tree_node* last) noexcept;
+
+		/**********************************************************************
+		* @brief Забыть участки всех узлов
+		**********************************************************************/
+		void invalidate() noexcept;
+		/// @}
+
+
+
+		/// @name Методы доступа
+		/// @{
+		/**********************************************************************
+		* @brief Найти участок исходного текста узла
+		*
+		* @param node - узел
+		*
+		* @return участок или nullptr, если узел добавлен после загрузки
+		**********************************************************************/
+		const Span* find(const node_type& node) const noexcept;
+
+		/**********************************************************************
+		* @brief Проверить, совпадает ли объявление с загруженным
+		*
+		* @param version - текущая версия документа
+		* @param encoding_type - текущая кодировка документа
+		*
+		* @return true - если объявление можно скопировать из исходного 
+		* текста
+		**********************************************************************/
+		bool is_declaration_same(float version, 
+			string_wrapper encoding_type) const noexcept;
+
+		string_wrapper get_source() const noexcept;
+
+		/**********************************************************************
+		* @return файловый дескриптор исходного текста или -1
+		**********************************************************************/
+		int get_fd() const noexcept;
+
+		std::size_t get_declaration_last() const noexcept;
+		std::size_t get_root_first() const noexcept;
+		std::size_t get_root_last() const noexcept;
+		/// @}
+
+	private:
+		void remove(const tree_node* first, const tree_node* last) noexcept;
+
+	private:
+		std::shared_ptr<const source_type> m_source;
+		std::unordered_map<const tree_node*, Span> m_spans;
+		const tree_node* m_top = nullptr;
+		string_type m_encoding_type;
+		float m_version = 0.f;
+		std::size_t m_declaration_last = 0;
+		std::size_t m_root_first = 0;
+		std::size_t m_root_last = 0;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Рекурсивная блокировка изменений, которая не бросает исключений
+	*
+	* @details В отличие от std::recursive_mutex, захват не может завершиться
+	* ошибкой, поэтому её можно брать в noexcept методах узла. Под ней 
+	* меняются индексы одного узла, поэтому ожидающий поток не засыпает, а
+	* уступает процессор
+	**************************************************************************/
+	class Change_mutex final
+	{
+	public:
+		Change_mutex() noexcept = default;
+
+		Change_mutex(const Change_mutex&) = delete;
+		Change_mutex& operator=(const Change_mutex&) = delete;
+
+		void lock() noexcept;
+		void unlock() noexcept;
+
+	private:
+		std::atomic<std::thread::id> m_owner{};
+		std::size_t m_depth = 0;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Данные верхнего узла дерева, общие для всего документа
+	*
+	* @details Хранится только у верхнего узла(без родителя). Узлы, которые
+	* меняют структуру дерева, поднимаются до верхнего узла и сообщают ему о
+	* изменениях через этот объект. Объект назначает узлам порядковые номера
+	* и обновляет индексы документа.
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Node_context final
+	{
+	public:
+		using node_type = NodeT;
+		using tree_node = typename NodeT::tree_node;
+		using string_type = typename NodeT::string_type;
+		using string_wrapper = typename NodeT::string_wrapper;
+
+
+
+		/// @name Методы для работы с индексами
+		/// @{
+		void create_name_index(tree_node* top);
+		void drop_name_index() noexcept;
+		bool has_name_index() const noexcept;
+		const Name_index<NodeT>* get_name_index() const noexcept;
+
+		void create_name_summary(tree_node* top);
+		void drop_name_summary() noexcept;
+		bool has_name_summary() const noexcept;
+		const Name_summary<NodeT>* get_name_summary() const noexcept;
+
+		/**********************************************************************
+		* @throw std::invalid_argument - если индекс уникальный, а значения
+		* атрибута повторяются
+		**********************************************************************/
+		void create_attribute_index(tree_node* top, 
+			const string_type& attribute_name, bool unique);
+		void drop_attribute_index(const string_type& attribute_name) 
+			noexcept;
+		bool has_attribute_index(const string_type& attribute_name) const 
+			noexcept;
+		const Attribute_index<NodeT>* get_attribute_index(
+			const string_type& attribute_name) const noexcept;
+
+		/**********************************************************************
+		* @brief Создать карту исходного текста документа
+		*
+		* @tparam DecorT - тип декоратора
+		* @param top - верхний узел дерева
+		* @param source - исходный текст документа
+		* @param decorator - декоратор, с которым текст был прочитан
+		* @param version - версия документа после загрузки
+		* @param encoding_type - кодировка документа после загрузки
+		*
+		* @return true - если текст совпал с деревом и карта создана
+		**********************************************************************/
+		template<typename DecorT>
+		bool create_source_map(const tree_node* top, 
+			std::shared_ptr<const Retained_source<typename NodeT::symbol_type>>
+			source, const DecorT& decorator, float version, 
+			string_wrapper encoding_type);
+		void drop_source_map() noexcept;
+		bool has_source_map() const noexcept;
+		const Source_map<NodeT>* get_source_map() const noexcept;
+
+		/**********************************************************************
+		* @brief Создать такие же индексы, как в другом документе
+		*
+		* @param context - данные другого документа
+		* @param top - верхний узел дерева
+		**********************************************************************/
+		void assign_indexes(const Node_context& context, tree_node* top);
+
+		/**********************************************************************
+		* @brief Поддерживать порядковые номера, даже если индексов нет
+		**********************************************************************/
+		void require_order() noexcept;
+
+		bool is_empty() const noexcept;
+		bool is_order_valid() const noexcept;
+
+		/**********************************************************************
+		* @brief Назначить порядковые номера и перестроить устаревшие индексы
+		*
+		* @param top - верхний узел дерева
+		**********************************************************************/
+		void update(tree_node* top) noexcept;
+		/// @}
+
+
+
+		/// @name Методы уведомления об изменениях
+		/// @{
+		void attach(tree_node* first, tree_node* last, const tree_node* top)
+			noexcept;
+		void erase(tree_node* first, tree_node* last) noexcept;
+		void rename(tree_node* node, string_wrapper name) noexcept;
+		void invalidate() noexcept;
+
+		void remove_attributes(tree_node* node) noexcept;
+		void add_attributes(tree_node* node) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть изменение значения или атрибутов узла
+		*
+		* @param node - изменённый узел
+		**********************************************************************/
+		void change(tree_node* node) noexcept;
+
+		/**********************************************************************
+		* @brief Учесть, что атрибуты узла могут меняться через выданные 
+		* неконстантные итераторы без уведомления
+		*
+		* @details Индексы атрибутов строятся заново при следующем 
+		* обновлении документа, узел перестаёт совпадать с исходным текстом
+		*
+		* @param node - узел, атрибуты которого выданы на изменение
+		**********************************************************************/
+		void expose_attributes(tree_node* node) noexcept;
+		/// @}
+
+
+
+		/// @name Методы проверки уникальных индексов
+		/// @{
+		/**********************************************************************
+		* @brief Проверить, можно ли присоединить узел со всеми дочерними 
+		* узлами
+		*
+		* @param node - присоединяемый узел
+		*
+		* @throw std::invalid_argument - если значение уникального атрибута
+		* уже занято или повторяется внутри узла
+		**********************************************************************/
+		void check_attach(const node_type& node) const;
+
+		/**********************************************************************
+		* @brief Проверить, можно ли узлу получить значение атрибута
+		*
+		* @param node - узел
+		* @param attribute_name - имя атрибута
+		* @param value - новое значение атрибута
+		*
+		* @throw std::invalid_argument - если значение уникального атрибута
+		* уже занято другим узлом
+		**********************************************************************/
+		void check_attribute(const tree_node* node, 
+			const string_type& attribute_name, const string_type& value) 
+			const;
+		/// @}
+
+
+
+		/// @name Методы параллельного изменения
+		/// @{
+		/**********************************************************************
+		* @brief Включить или выключить блокировку изменений
+		*
+		* @details Включается на время parallel_for_each(), пока разные 
+		* потоки меняют имена, значения и атрибуты разных узлов одного дерева.
+		* Пока блокировка включена, поиск не пользуется индексом и сводкой 
+		* имён, а update() ничего не перестраивает. Переключать можно только 
+		* когда другие потоки не меняют дерево
+		*
+		* @param is_concurrent - включить блокировку
+		*
+		* @return прежнее состояние блокировки
+		**********************************************************************/
+		bool set_concurrent(bool is_concurrent) noexcept;
+
+		/**********************************************************************
+		* @brief Заблокировать изменения данных дерева
+		*
+		* @return блокировку. Если блокировка изменений выключена, то пустую
+		**********************************************************************/
+		std::unique_lock<Change_mutex> lock_changes() noexcept;
+		/// @}
+
+	private:
+		void renumber(tree_node* top) noexcept;
+
+	private:
+		std::optional<Name_index<NodeT>> m_name_index;
+		std::optional<Name_summary<NodeT>> m_name_summary;
+		std::list<Attribute_index<NodeT>> m_attribute_indexes;
+		std::optional<Source_map<NodeT>> m_source_map;
+		std::size_t m_next_order = 1;
+		bool m_order_valid = false;
+		bool m_order_required = false;
+		bool m_is_concurrent = false;
+		Change_mutex m_change_mutex;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Блокировка изменений дерева на время параллельного обхода
+	*
+	* @details Включает блокировку изменений у данных верхнего узла дерева, 
+	* если они есть, и при разрушении возвращает прежнее состояние
+	*
+	* @tparam NodeT - тип узла
+	**************************************************************************/
+	template<typename NodeT>
+	class Concurrent_changes final
+	{
+	public:
+		explicit Concurrent_changes(NodeT& node) noexcept;
+		~Concurrent_changes();
+
+		Concurrent_changes(const Concurrent_changes&) = delete;
+		Concurrent_changes& operator=(const Concurrent_changes&) = delete;
+
+	private:
+		Node_context<NodeT>* m_context = nullptr;
+		bool m_was_concurrent = false;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						NAME_INDEX IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::rebuild(tree_node* top) noexcept
+	{
+		m_valid = false;
+		m_nodes.clear();
+		m_names.clear();
+
+		try
+		{
+			for (tree_node* current = top->next; current && current != top;
+				current = current->next)
+			{
+				add(current);
+			}
+
+			m_valid = true;
+		}
+		catch (...)
+		{
+			m_nodes.clear();
+			m_names.clear();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::invalidate() noexcept
+	{
+		m_valid = false;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::attach(tree_node* first, tree_node* last) 
+		noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		try
+		{
+			for (tree_node* current = first; ; current = current->next)
+			{
+				add(current);
+
+				if (current == last)
+				{
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			invalidate();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::erase(tree_node* first, tree_node* last)
+		noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		//Удаляемые узлы идут подряд в порядке документа, поэтому узлы 
+		//одного имени в них - это непрерывный отрезок в списке этого имени
+		auto&& order_less = [](const tree_node* node, std::size_t order)
+		{
+			return node->order < order;
+		};
+
+		for (tree_node* current = first; ; current = current->next)
+		{
+			auto found = m_nodes.find(current->element->get_name());
+
+			if (found != m_nodes.end())
+			{
+				auto& nodes = found->second;
+
+				auto range_first = std::lower_bound(nodes.begin(), 
+					nodes.end(), first->order, order_less);
+
+				auto range_last = std::lower_bound(range_first, nodes.end(), 
+					last->order + 1, order_less);
+
+				nodes.erase(range_first, range_last);
+			}
+
+			if (current == last)
+			{
+				break;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::rename(tree_node* node, string_wrapper name)
+		noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		auto&& order_less = [](const tree_node* current, std::size_t order)
+		{
+			return current->order < order;
+		};
+
+		auto found = m_nodes.find(node->element->get_name());
+
+		if (found != m_nodes.end())
+		{
+			auto& nodes = found->second;
+
+			auto position = std::lower_bound(nodes.begin(), nodes.end(), 
+				node->order, order_less);
+
+			if (position != nodes.end() && *position == node)
+			{
+				nodes.erase(position);
+			}
+		}
+
+		try
+		{
+			found = m_nodes.find(name);
+
+			if (found == m_nodes.end())
+			{
+				m_names.emplace_back(name);
+
+				found = m_nodes.emplace(string_wrapper{ m_names.back() },
+					std::vector<tree_node*>{}).first;
+			}
+
+			auto& nodes = found->second;
+
+			nodes.insert(std::lower_bound(nodes.begin(), nodes.end(),
+				node->order, order_less), node);
+		}
+		catch (...)
+		{
+			invalidate();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Name_index<NodeT>::is_valid() const noexcept
+	{
+		return m_valid;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Name_index<NodeT>::tree_node* Name_index<NodeT>::find(
+		string_wrapper name, const tree_node* first, const tree_node* last) 
+		const noexcept
+	{
+		auto found = m_nodes.find(name);
+
+		if (found == m_nodes.end())
+		{
+			return nullptr;
+		}
+
+		//Верхний узел дерева, как конец диапазона, означает конец документа
+		const std::size_t last_order = last && last->parent ? 
+			last->order : std::numeric_limits<std::size_t>::max();
+
+		auto& nodes = found->second;
+
+		auto position = std::lower_bound(nodes.begin(), nodes.end(), 
+			first->order, [](const tree_node* node, std::size_t order)
+			{
+				return node->order < order;
+			});
+
+		if (position != nodes.end() && (*position)->order < last_order)
+		{
+			return *position;
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_index<NodeT>::add(tree_node* node)
+	{
+		auto found = m_nodes.find(node->element->get_name());
+
+		if (found == m_nodes.end())
+		{
+			m_names.emplace_back(node->element->get_name());
+
+			found = m_nodes.emplace(string_wrapper{ m_names.back() },
+				std::vector<tree_node*>{}).first;
+		}
+
+		found->second.push_back(node);
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						NAME_SUMMARY IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_summary<NodeT>::rebuild(tree_node* top) noexcept
+	{
+		m_valid = false;
+
+		try
+		{
+			std::vector<tree_node*> nodes;
+
+			nodes.push_back(top);
+
+			for (tree_node* current = top->next; current && current != top;
+				current = current->next)
+			{
+				nodes.push_back(current);
+			}
+
+			//Номера растут в порядке обхода, но после удалений идут с 
+			//пропусками
+			m_masks.assign(nodes.back()->order + 1, 0);
+
+			for (auto&& current : nodes)
+			{
+				m_masks[current->order] = 
+					get_mask(current->element->get_name());
+			}
+
+			//Потомок всегда идёт после предка, поэтому обратный проход 
+			//собирает фильтр поддерева до того, как он попадёт в родителя
+			for (auto first = nodes.rbegin(), last = nodes.rend() - 1; 
+				first != last; ++first)
+			{
+				m_masks[(*first)->parent->order] |= m_masks[(*first)->order];
+			}
+
+			m_valid = true;
+		}
+		catch (...)
+		{
+			m_masks.clear();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_summary<NodeT>::invalidate() noexcept
+	{
+		m_valid = false;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_summary<NodeT>::attach(tree_node* first, tree_node* last)
+		noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		try
+		{
+			m_masks.resize(last->order + 1, 0);
+		}
+		catch (...)
+		{
+			invalidate();
+
+			return;
+		}
+
+		for (tree_node* current = first; ; current = current->next)
+		{
+			m_masks[current->order] = get_mask(current->element->get_name());
+
+			if (current == last)
+			{
+				break;
+			}
+		}
+
+		//Внутри присоединённого поддерева фильтры собираются обратным
+		//проходом, а его фильтр целиком добавляется ко всем предкам
+		for (tree_node* current = last; current != first; 
+			current = current->prev)
+		{
+			m_masks[current->parent->order] |= m_masks[current->order];
+		}
+
+		if (first->parent)
+		{
+			add_to_ancestors(first->parent, m_masks[first->order]);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_summary<NodeT>::rename(tree_node* node, 
+		string_wrapper name) noexcept
+	{
+		if (m_valid)
+		{
+			add_to_ancestors(node, get_mask(name));
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Name_summary<NodeT>::is_valid() const noexcept
+	{
+		return m_valid;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Name_summary<NodeT>::may_contain(const tree_node* node,
+		string_wrapper name) const noexcept
+	{
+		const std::uint64_t mask = get_mask(name);
+
+		return node->order >= m_masks.size() ||
+			(m_masks[node->order] & mask) == mask;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline std::uint64_t Name_summary<NodeT>::get_mask(string_wrapper name)
+		noexcept
+	{
+		//Два бита из одного хеша: меньше ложных совпадений, чем от одного
+		const std::size_t hash = std::hash<string_wrapper>{}(name);
+
+		return (std::uint64_t{ 1 } << (hash & 63)) | 
+			(std::uint64_t{ 1 } << ((hash >> 6) & 63));
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Name_summary<NodeT>::add_to_ancestors(tree_node* node,
+		std::uint64_t mask) noexcept
+	{
+		for (; node; node = node->parent)
+		{
+			//Если биты уже есть у узла, они есть и у всех его предков
+			if ((m_masks[node->order] & mask) == mask)
+			{
+				break;
+			}
+
+			m_masks[node->order] |= mask;
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						ATTRIBUTE_INDEX IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Attribute_index<NodeT>::Attribute_index(
+		const string_type& attribute_name, bool unique)
+		:m_attribute_name{ attribute_name },
+		m_unique{ unique },
+		m_valid{ false }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::rebuild(tree_node* top)
+	{
+		m_valid = false;
+		m_nodes.clear();
+
+		for (tree_node* current = top->next; current && current != top;
+			current = current->next)
+		{
+			if (auto value = get_value(current))
+			{
+				auto& nodes = m_nodes[*value];
+
+				if (m_unique && nodes.size())
+				{
+					m_nodes.clear();
+
+					throw std::invalid_argument{ 
+						"Duplicate value of the unique attribute index!" };
+				}
+
+				nodes.push_back(current);
+			}
+		}
+
+		m_valid = true;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::attach(tree_node* first, 
+		tree_node* last) noexcept
+	{
+		for (tree_node* current = first; ; current = current->next)
+		{
+			add(current);
+
+			if (current == last)
+			{
+				break;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::erase(tree_node* first, 
+		tree_node* last) noexcept
+	{
+		for (tree_node* current = first; ; current = current->next)
+		{
+			remove(current);
+
+			if (current == last)
+			{
+				break;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::add(tree_node* node) noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		if (auto value = get_value(node))
+		{
+			try
+			{
+				m_nodes[*value].push_back(node);
+			}
+			catch (...)
+			{
+				m_valid = false;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::remove(tree_node* node) noexcept
+	{
+		if (!m_valid)
+		{
+			return;
+		}
+
+		if (auto value = get_value(node))
+		{
+			auto found = m_nodes.find(*value);
+
+			if (found != m_nodes.end())
+			{
+				auto& nodes = found->second;
+
+				nodes.erase(std::remove(nodes.begin(), nodes.end(), node),
+					nodes.end());
+
+				if (nodes.empty())
+				{
+					m_nodes.erase(found);
+				}
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Attribute_index<NodeT>::invalidate() noexcept
+	{
+		m_valid = false;
+		m_nodes.clear();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const typename Attribute_index<NodeT>::string_type& 
+		Attribute_index<NodeT>::get_attribute_name() const noexcept
+	{
+		return m_attribute_name;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Attribute_index<NodeT>::is_unique() const noexcept
+	{
+		return m_unique;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Attribute_index<NodeT>::is_valid() const noexcept
+	{
+		return m_valid;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Attribute_index<NodeT>::is_available(const string_type& value,
+		const tree_node* node) const
+	{
+		if (!m_unique)
+		{
+			return true;
+		}
+
+		auto nodes = find(value);
+
+		return !nodes || (nodes->size() == 1 && nodes->front() == node);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const std::vector<typename Attribute_index<NodeT>::tree_node*>* 
+		Attribute_index<NodeT>::find(const string_type& value) const
+	{
+		auto found = m_nodes.find(value);
+
+		return found != m_nodes.end() ? &found->second : nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const typename Attribute_index<NodeT>::string_type* 
+		Attribute_index<NodeT>::get_value(const tree_node* node) const noexcept
+	{
+		const node_type* element = node->element;
+		auto attribute = element->find_attribute(m_attribute_name);
+
+		if (attribute != element->attr_cend())
+		{
+			return &attribute->value;
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						SOURCE_MAP IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	template<typename DecorT>
+	inline bool Source_map<NodeT>::build(const tree_node* top,
+		std::shared_ptr<const source_type> source, const DecorT& decorator,
+		float version, string_wrapper encoding_type)
+	{
+		m_spans.clear();
+		m_top = top;
+		m_source = std::move(source);
+		m_encoding_type = string_type{ encoding_type };
+		m_version = version;
+		m_declaration_last = 0;
+		m_root_first = 0;
+		m_root_last = 0;
+
+		const string_wrapper text = get_source();
+		constexpr std::size_t npos = string_wrapper::npos;
+
+		const auto is_name_end = [&decorator](symbol_type symbol)
+		{
+			return symbol == decorator.white_space_symbol ||
+				symbol == decorator.tab_symbol ||
+				symbol == decorator.line_break_symbol ||
+				symbol == decorator.carriage_symbol ||
+				symbol == decorator.single_tag_symbol ||
+				symbol == decorator.close_tag_symbol;
+		};
+
+		const auto find_name_end = [&](std::size_t position)
+		{
+			while (position < text.size() && !is_name_end(text[position]))
+			{
+				++position;
+			}
+
+			return position;
+		};
+
+		//Символы закрытия тега внутри значений атрибутов пропускаются
+		const auto find_tag_end = [&](std::size_t position)
+		{
+			for (; position < text.size(); ++position)
+			{
+				if (text[position] == decorator.open_attribute_symbol)
+				{
+					position = text.find(decorator.close_attribute_symbol,
+						position + 1);
+
+					if (position == npos)
+					{
+						break;
+					}
+				}
+				else if (text[position] == decorator.close_tag_symbol)
+				{
+					return position;
+				}
+			}
+
+			return npos;
+		};
+
+		const auto find_last = [&](std::size_t position, 
+			string_wrapper pattern)
+		{
+			position = text.find(pattern, position);
+
+			return position == npos ? npos : position + pattern.size() - 1;
+		};
+
+		const symbol_type declaration_end[] = { 
+			decorator.doc_info_last_symbol, decorator.close_tag_symbol };
+		const symbol_type comment_begin[] = { 
+			decorator.comment_last_symbol, decorator.comment_last_symbol };
+		const symbol_type comment_end[] = { 
+			decorator.comment_last_symbol, decorator.comment_last_symbol,
+			decorator.close_tag_symbol };
+		const symbol_type cdata_begin[] = { '[', 'C', 'D', 'A', 'T', 'A', '[' };
+		const symbol_type cdata_end[] = { ']', ']', decorator.close_tag_symbol };
+
+		//Открытые теги и узел, которому должен соответствовать следующий
+		//открывающий тег
+		std::vector<const tree_node*> opened;
+		const tree_node* expected = top->next != top ? top->next : nullptr;
+		bool is_matched = expected != nullptr;
+
+		for (std::size_t position = text.find(decorator.open_tag_symbol);
+			is_matched && position != npos;
+			position = text.find(decorator.open_tag_symbol, position))
+		{
+			if (position + 1 == text.size())
+			{
+				is_matched = false;
+
+				break;
+			}
+
+			const symbol_type kind = text[position + 1];
+			const string_wrapper rest = text.substr(position + 2);
+			std::size_t tag_last = npos;
+
+			if (kind == decorator.doc_info_symbol)
+			{
+				tag_last = find_last(position + 2, 
+					string_wrapper{ declaration_end, 2 });
+
+				if (tag_last != npos && !m_declaration_last && m_spans.empty())
+				{
+					m_declaration_last = tag_last + 1;
+				}
+			}
+			else if (kind == decorator.comment_symbol && 
+				rest.substr(0, 2) == string_wrapper{ comment_begin, 2 })
+			{
+				tag_last = find_last(position + 4, 
+					string_wrapper{ comment_end, 3 });
+			}
+			else if (kind == decorator.comment_symbol &&
+				rest.substr(0, 7) == string_wrapper{ cdata_begin, 7 })
+			{
+				tag_last = find_last(position + 9, 
+					string_wrapper{ cdata_end, 3 });
+			}
+			else if (kind == decorator.comment_symbol)
+			{
+				//DOCTYPE может содержать внутреннее подмножество в 
+				//квадратных скобках
+				int depth = 0;
+
+				for (std::size_t i = position + 2; i < text.size(); ++i)
+				{
+					if (text[i] == cdata_begin[0])
+					{
+						++depth;
+					}
+					else if (text[i] == cdata_end[0])
+					{
+						--depth;
+					}
+					else if (text[i] == decorator.close_tag_symbol && !depth)
+					{
+						tag_last = i;
+
+						break;
+					}
+				}
+			}
+			else if (kind == decorator.last_tag_symbol)
+			{
+				const std::size_t name_last = find_name_end(position + 2);
+
+				tag_last = text.find(decorator.close_tag_symbol, name_last);
+
+				if (opened.empty() || opened.back()->element->get_name() !=
+					text.substr(position + 2, name_last - position - 2))
+				{
+					is_matched = false;
+
+					break;
+				}
+
+				m_spans.find(opened.back())->second.last = tag_last + 1;
+				opened.pop_back();
+			}
+			else
+			{
+				const std::size_t name_last = find_name_end(position + 1);
+				const tree_node* parent = opened.empty() ? top : opened.back();
+
+				tag_last = find_tag_end(name_last);
+
+				if (!expected || tag_last == npos || 
+					expected->parent != parent ||
+					expected->element->get_name() != 
+					text.substr(position + 1, name_last - position - 1))
+				{
+					is_matched = false;
+
+					break;
+				}
+
+				m_spans.emplace(expected, Span{ position, tag_last + 1 });
+
+				if (parent == top)
+				{
+					m_root_first = position;
+				}
+
+				if (text[tag_last - 1] != decorator.single_tag_symbol)
+				{
+					opened.push_back(expected);
+				}
+
+				expected = expected->next != top ? expected->next : nullptr;
+			}
+
+			if (tag_last == npos)
+			{
+				is_matched = false;
+			}
+
+			position = tag_last + 1;
+		}
+
+		if (!is_matched || !opened.empty() || expected)
+		{
+			m_spans.clear();
+
+			return false;
+		}
+
+		m_root_last = m_spans.find(top->next)->second.last;
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::assign(const Source_map& map, 
+		const tree_node* top)
+	{
+		m_spans.clear();
+		m_source = map.m_source;
+		m_top = top;
+		m_encoding_type = map.m_encoding_type;
+		m_version = map.m_version;
+		m_declaration_last = map.m_declaration_last;
+		m_root_first = map.m_root_first;
+		m_root_last = map.m_root_last;
+
+		m_spans.reserve(map.m_spans.size());
+
+		//Копия дерева обходится одновременно с исходным деревом
+		for (const tree_node* current = map.m_top ? map.m_top->next : nullptr,
+			*copy = top->next;
+			current && current != map.m_top && copy && copy != top;
+			current = current->next, copy = copy->next)
+		{
+			auto found = map.m_spans.find(current);
+
+			if (found != map.m_spans.end())
+			{
+				m_spans.emplace(copy, found->second);
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::touch(const tree_node* node) noexcept
+	{
+		if (m_spans.empty())
+		{
+			return;
+		}
+
+		auto found = m_spans.find(node);
+
+		if (found != m_spans.end())
+		{
+			found->second.is_clean = false;
+		}
+
+		//Если поддерево узла уже грязное, то грязные и поддеревья всех
+		//его предков
+		for (; node; node = node->parent)
+		{
+			found = m_spans.find(node);
+
+			if (found == m_spans.end())
+			{
+				continue;
+			}
+
+			if (!found->second.is_subtree_clean)
+			{
+				break;
+			}
+
+			found->second.is_subtree_clean = false;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::attach(const tree_node* first, 
+		const tree_node* last) noexcept
+	{
+		touch(first->parent);
+		remove(first, last);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::erase(const tree_node* first, 
+		const tree_node* last) noexcept
+	{
+		touch(first->parent);
+		remove(first, last);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::invalidate() noexcept
+	{
+		m_spans.clear();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const typename Source_map<NodeT>::Span* Source_map<NodeT>::find(
+		const node_type& node) const noexcept
+	{
+		auto found = m_spans.find(&node.m_tree_node);
+
+		return found != m_spans.end() ? &found->second : nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Source_map<NodeT>::is_declaration_same(float version,
+		string_wrapper encoding_type) const noexcept
+	{
+		return version == m_version && encoding_type == m_encoding_type;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Source_map<NodeT>::string_wrapper 
+		Source_map<NodeT>::get_source() const noexcept
+	{
+		return m_source ? 
+			string_wrapper{ m_source->data(), m_source->size() } :
+			string_wrapper{};
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline int Source_map<NodeT>::get_fd() const noexcept
+	{
+		return m_source ? m_source->get_fd() : -1;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline std::size_t Source_map<NodeT>::get_declaration_last() const 
+		noexcept
+	{
+		return m_declaration_last;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline std::size_t Source_map<NodeT>::get_root_first() const noexcept
+	{
+		return m_root_first;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline std::size_t Source_map<NodeT>::get_root_last() const noexcept
+	{
+		return m_root_last;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Source_map<NodeT>::remove(const tree_node* first, 
+		const tree_node* last) noexcept
+	{
+		if (m_spans.empty())
+		{
+			return;
+		}
+
+		for (const tree_node* current = first; ; current = current->next)
+		{
+			m_spans.erase(current);
+
+			if (current == last)
+			{
+				break;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						CHANGE_MUTEX IMPLEMENTATION
+	//*************************************************************************
+
+	inline void Change_mutex::lock() noexcept
+	{
+		const std::thread::id current = std::this_thread::get_id();
+
+		//Владельца меняет только сам владелец, поэтому свой захват виден
+		//без синхронизации
+		if (m_owner.load(std::memory_order_relaxed) == current)
+		{
+			++m_depth;
+
+			return;
+		}
+
+		std::thread::id expected{};
+
+		while (!m_owner.compare_exchange_weak(expected, current,
+			std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			expected = std::thread::id{};
+
+			std::this_thread::yield();
+		}
+
+		m_depth = 1;
+	}
+
+	//*************************************************************************
+
+	inline void Change_mutex::unlock() noexcept
+	{
+		if (!--m_depth)
+		{
+			m_owner.store(std::thread::id{}, std::memory_order_release);
+		}
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						NODE_CONTEXT IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::create_name_index(tree_node* top)
+	{
+		if (!m_name_index)
+		{
+			m_name_index.emplace();
+		}
+
+		m_name_index->invalidate();
+
+		update(top);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::drop_name_index() noexcept
+	{
+		m_name_index.reset();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::has_name_index() const noexcept
+	{
+		return m_name_index.has_value();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const Name_index<NodeT>* Node_context<NodeT>::get_name_index() 
+		const noexcept
+	{
+		//Во время parallel_for_each() индекс меняется под блокировкой 
+		//другими потоками, поэтому поиск обходится без него
+		if (!m_is_concurrent && m_name_index && m_name_index->is_valid())
+		{
+			return &*m_name_index;
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::create_name_summary(tree_node* top)
+	{
+		if (!m_name_summary)
+		{
+			m_name_summary.emplace();
+		}
+
+		m_name_summary->invalidate();
+
+		update(top);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::drop_name_summary() noexcept
+	{
+		m_name_summary.reset();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::has_name_summary() const noexcept
+	{
+		return m_name_summary.has_value();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const Name_summary<NodeT>* Node_context<NodeT>::get_name_summary() 
+		const noexcept
+	{
+		if (!m_is_concurrent && m_name_summary && 
+			m_name_summary->is_valid())
+		{
+			return &*m_name_summary;
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::create_attribute_index(tree_node* top,
+		const string_type& attribute_name, bool unique)
+	{
+		Attribute_index<NodeT> index{ attribute_name, unique };
+
+		index.rebuild(top);
+
+		drop_attribute_index(attribute_name);
+
+		m_attribute_indexes.push_back(std::move(index));
+
+		if (!m_order_valid)
+		{
+			renumber(top);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::drop_attribute_index(
+		const string_type& attribute_name) noexcept
+	{
+		m_attribute_indexes.remove_if([&](auto&& index)
+			{
+				return index.get_attribute_name() == attribute_name;
+			});
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::has_attribute_index(
+		const string_type& attribute_name) const noexcept
+	{
+		return std::any_of(m_attribute_indexes.begin(), 
+			m_attribute_indexes.end(), [&](auto&& index)
+			{
+				return index.get_attribute_name() == attribute_name;
+			});
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const Attribute_index<NodeT>* 
+		Node_context<NodeT>::get_attribute_index(
+		const string_type& attribute_name) const noexcept
+	{
+		for (auto&& index : m_attribute_indexes)
+		{
+			if (index.get_attribute_name() == attribute_name)
+			{
+				return index.is_valid() ? &index : nullptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	template<typename DecorT>
+	inline bool Node_context<NodeT>::create_source_map(const tree_node* top,
+		std::shared_ptr<const Retained_source<typename NodeT::symbol_type>>
+		source, const DecorT& decorator, float version, 
+		string_wrapper encoding_type)
+	{
+		if (!m_source_map)
+		{
+			m_source_map.emplace();
+		}
+
+		if (!m_source_map->build(top, std::move(source), decorator, version,
+			encoding_type))
+		{
+			m_source_map.reset();
+
+			return false;
+		}
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::drop_source_map() noexcept
+	{
+		m_source_map.reset();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::has_source_map() const noexcept
+	{
+		return m_source_map.has_value();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline const Source_map<NodeT>* Node_context<NodeT>::get_source_map() 
+		const noexcept
+	{
+		return m_source_map ? &*m_source_map : nullptr;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::assign_indexes(
+		const Node_context& context, tree_node* top)
+	{
+		if (context.m_name_index)
+		{
+			create_name_index(top);
+		}
+
+		if (context.m_name_summary)
+		{
+			create_name_summary(top);
+		}
+
+		for (auto&& index : context.m_attribute_indexes)
+		{
+			create_attribute_index(top, index.get_attribute_name(), 
+				index.is_unique());
+		}
+
+		if (context.m_source_map)
+		{
+			m_source_map.emplace();
+			m_source_map->assign(*context.m_source_map, top);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::require_order() noexcept
+	{
+		m_order_required = true;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::is_empty() const noexcept
+	{
+		return !m_name_index && !m_name_summary && 
+			m_attribute_indexes.empty() && !m_source_map && 
+			!m_order_required;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::is_order_valid() const noexcept
+	{
+		return m_order_valid;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::update(tree_node* top) noexcept
+	{
+		//Структура дерева во время parallel_for_each() не меняется, а 
+		//индексы, устаревшие из-за изменений, перестраиваются после него
+		if (m_is_concurrent)
+		{
+			return;
+		}
+
+		if (!m_order_valid)
+		{
+			renumber(top);
+		}
+
+		if (m_name_index && !m_name_index->is_valid())
+		{
+			m_name_index->rebuild(top);
+		}
+
+		if (m_name_summary && !m_name_summary->is_valid())
+		{
+			m_name_summary->rebuild(top);
+		}
+
+		for (auto&& index : m_attribute_indexes)
+		{
+			if (!index.is_valid())
+			{
+				//Уникальность значений проверяется до изменений, поэтому
+				//перестроение может не удаться из-за нехватки памяти или 
+				//повторов, записанных через неконстантные итераторы 
+				//атрибутов. Тогда индекс остаётся недействительным
+				try
+				{
+					index.rebuild(top);
+				}
+				catch (...)
+				{
+
+				}
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::attach(tree_node* first, tree_node* last,
+		const tree_node* top) noexcept
+	{
+		//Порядковые номера можно продолжить только если узлы добавлены в
+		//конец документа. Для вставки в середину номера пришлось бы менять
+		//у всех следующих узлов, а сводка хранит фильтры по номерам. Поэтому
+		//такая вставка делает индекс и сводку устаревшими, и следующий поиск
+		//перестраивает их целиком
+		const bool is_tail = m_order_valid && last->next == top;
+
+		if (is_tail)
+		{
+			for (tree_node* current = first; ; current = current->next)
+			{
+				current->order = m_next_order++;
+
+				if (current == last)
+				{
+					break;
+				}
+			}
+		}
+		else
+		{
+			m_order_valid = false;
+		}
+
+		if (m_name_index)
+		{
+			if (is_tail)
+			{
+				m_name_index->attach(first, last);
+			}
+			else
+			{
+				m_name_index->invalidate();
+			}
+		}
+
+		if (m_name_summary)
+		{
+			if (is_tail)
+			{
+				m_name_summary->attach(first, last);
+			}
+			else
+			{
+				m_name_summary->invalidate();
+			}
+		}
+
+		for (auto&& index : m_attribute_indexes)
+		{
+			index.attach(first, last);
+		}
+
+		if (m_source_map)
+		{
+			m_source_map->attach(first, last);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::erase(tree_node* first, tree_node* last)
+		noexcept
+	{
+		if (m_name_index)
+		{
+			m_name_index->erase(first, last);
+		}
+
+		for (auto&& index : m_attribute_indexes)
+		{
+			index.erase(first, last);
+		}
+
+		if (m_source_map)
+		{
+			m_source_map->erase(first, last);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::rename(tree_node* node, 
+		string_wrapper name) noexcept
+	{
+		if (m_name_index && node->parent)
+		{
+			m_name_index->rename(node, name);
+		}
+
+		if (m_name_summary)
+		{
+			m_name_summary->rename(node, name);
+		}
+
+		if (m_source_map)
+		{
+			m_source_map->touch(node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::invalidate() noexcept
+	{
+		m_order_valid = false;
+
+		if (m_name_index)
+		{
+			m_name_index->invalidate();
+		}
+
+		if (m_name_summary)
+		{
+			m_name_summary->invalidate();
+		}
+
+		if (m_source_map)
+		{
+			m_source_map->invalidate();
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::remove_attributes(tree_node* node) 
+		noexcept
+	{
+		for (auto&& index : m_attribute_indexes)
+		{
+			index.remove(node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::add_attributes(tree_node* node) noexcept
+	{
+		for (auto&& index : m_attribute_indexes)
+		{
+			index.add(node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::change(tree_node* node) noexcept
+	{
+		if (m_source_map)
+		{
+			m_source_map->touch(node);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::expose_attributes(tree_node* node) 
+		noexcept
+	{
+		for (auto&& index : m_attribute_indexes)
+		{
+			index.invalidate();
+		}
+
+		change(node);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::check_attach(const node_type& node) const
+	{
+		for (auto&& index : m_attribute_indexes)
+		{
+			if (!index.is_unique() || !index.is_valid())
+			{
+				continue;
+			}
+
+			std::unordered_set<string_wrapper> values;
+
+			auto&& check_value = [&](const tree_node* current)
+			{
+				if (auto value = index.get_value(current))
+				{
+					if (index.find(*value) || !values.insert(*value).second)
+					{
+						throw std::invalid_argument{
+							"Duplicate value of the unique attribute index!" };
+					}
+				}
+			};
+
+			check_value(&node.m_tree_node);
+
+			for (auto first = node.preorder_cbegin(), 
+				last = node.preorder_cend(); first != last; ++first)
+			{
+				check_value(&first->m_tree_node);
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::check_attribute(const tree_node* node,
+		const string_type& attribute_name, const string_type& value) const
+	{
+		if (!node->parent)
+		{
+			return;
+		}
+
+		for (auto&& index : m_attribute_indexes)
+		{
+			if (index.is_valid() && 
+				index.get_attribute_name() == attribute_name &&
+				!index.is_available(value, node))
+			{
+				throw std::invalid_argument{
+					"Duplicate value of the unique attribute index!" };
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Node_context<NodeT>::set_concurrent(bool is_concurrent) 
+		noexcept
+	{
+		return std::exchange(m_is_concurrent, is_concurrent);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline std::unique_lock<Change_mutex> Node_context<NodeT>::lock_changes()
+		noexcept
+	{
+		if (!m_is_concurrent)
+		{
+			return std::unique_lock<Change_mutex>{};
+		}
+
+		return std::unique_lock<Change_mutex>{ m_change_mutex };
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Node_context<NodeT>::renumber(tree_node* top) noexcept
+	{
+		top->order = 0;
+		m_next_order = 1;
+
+		for (tree_node* current = top->next; current && current != top;
+			current = current->next)
+		{
+			current->order = m_next_order++;
+		}
+
+		m_order_valid = true;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//					CONCURRENT_CHANGES IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Concurrent_changes<NodeT>::Concurrent_changes(NodeT& node) 
+		noexcept : m_context{ node.m_top_context }
+	{
+		if (m_context)
+		{
+			m_was_concurrent = m_context->set_concurrent(true);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Concurrent_changes<NodeT>::~Concurrent_changes()
+	{
+		if (m_context)
+		{
+			m_context->set_concurrent(m_was_concurrent);
+		}
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_NODE_CONTEXT_H
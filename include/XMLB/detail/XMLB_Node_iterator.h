@@ -97,7 +97,11 @@ namespace XMLB { namespace detail {
 		* XML тега в контейнере
 		*
 		* @details Изначально оступ равен нулю - независимо от того, в
-		* какой позиции находится инзначальный итератор.
+		* какой позиции находится инзначальный итератор. Отступ считается
+		* как разница глубины текущего узла и глубины узла, с которого
+		* итератор был создан: каждый шаг прибавляет разницу глубин соседних
+		* узлов обхода. Если текущий узел находится выше начального, то 
+		* отступ равен нулю.
 		*
 		* @return размер отступа, таба, офсета XML тега в контейнере
 		**********************************************************************/
@@ -120,9 +124,11 @@ namespace XMLB { namespace detail {
 		// функциям
 		//
 		// @details Функция не сравнивает на равенство begin и end. Она
-		// просто итератоивно проверяет по родителям. Если у текущего
-		// итератор родитель или один из родителей будет равен родителю
-		// последовательности.
+		// поднимается по родителям текущего узла, пока не встретит 
+		// родителя последовательности или верхний узел дерева, поэтому
+		// стоит O(глубины текущего узла). Node вызывает её, только если у
+		// документа нет действительных порядковых номеров - с ними 
+		// проверка идёт за O(1) по номерам узлов.
 		//
 		// @param[in] seq_start - итератора на начало последовательности
 		//
@@ -131,7 +137,7 @@ namespace XMLB { namespace detail {
 
 	protected:
 		detail::Node_tree<T>* m_ptr;
-		unsigned int m_offset;
+		int m_depth;
 	};
 
 	//*************************************************************************
@@ -173,6 +179,96 @@ namespace XMLB { namespace detail {
 
 
 
+	/**************************************************************************
+	* @brief Константный итератор прямого(preorder) обхода XML структуры
+	*
+	* @details В отличие от Node_const_iterator не хранит ничего, кроме
+	* указателя на узел, и не умеет считать отступ. Предназначен для циклов,
+	* которым нужен только сам узел.
+	*
+	* @tparam T - тип объекта, который будет хранить итератора
+	**************************************************************************/
+	template<typename T>
+	class Node_preorder_const_iterator
+	{
+	public:
+		using value_type = T;
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using reference = const value_type&;
+		using pointer = const value_type*;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		Node_preorder_const_iterator(detail::Node_tree<T>* ptr = nullptr) 
+			noexcept;
+		/// @}
+
+
+
+		/// @name Операторы сравнения
+		/// @{
+		bool operator==(const Node_preorder_const_iterator& iter) const 
+			noexcept;
+		bool operator!=(const Node_preorder_const_iterator& iter) const 
+			noexcept;
+		/// @}
+
+
+
+		/// @name Методы доступа
+		/// @{
+		reference operator*() const;
+		pointer operator->() const;
+
+		Node_preorder_const_iterator& operator++() noexcept;
+		Node_preorder_const_iterator operator++(int) noexcept;
+		/// @}
+
+	protected:
+		detail::Node_tree<T>* m_ptr;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Итератор прямого(preorder) обхода XML структуры
+	*
+	* @tparam T - тип объекта, который будет хранить итератора
+	**************************************************************************/
+	template<typename T>
+	class Node_preorder_iterator : public Node_preorder_const_iterator<T>
+	{
+	public:
+		using base = Node_preorder_const_iterator<T>;
+		using value_type = T;
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using reference = value_type&;
+		using pointer = value_type*;
+
+		using base::base;
+
+
+
+		/// @name Методы доступа
+		/// @{
+		reference operator*() const;
+		pointer operator->() const;
+
+		Node_preorder_iterator& operator++() noexcept;
+		Node_preorder_iterator operator++(int) noexcept;
+		/// @}
+	};
+
+	//*************************************************************************
+
+
+
 	//**************************************************************************
 	//					NODE_CONST_ITERATOR IMPLEMENTATION
 	//**************************************************************************
@@ -181,7 +277,7 @@ namespace XMLB { namespace detail {
 	inline Node_const_iterator<T>::Node_const_iterator(
 		detail::Node_tree<T>* ptr) noexcept
 		:m_ptr{ ptr },
-		m_offset{ 0 }
+		m_depth{ 0 }
 	{
 
 	}
@@ -192,7 +288,7 @@ namespace XMLB { namespace detail {
 	inline Node_const_iterator<T>::Node_const_iterator(
 		const Node_const_iterator& iter) noexcept
 		:m_ptr{ iter.m_ptr },
-		m_offset{ iter.m_offset }
+		m_depth{ iter.m_depth }
 	{
 
 	}
@@ -206,7 +302,7 @@ namespace XMLB { namespace detail {
 		if (this != &iter)
 		{
 			m_ptr = iter.m_ptr;
-			m_offset = iter.m_offset;
+			m_depth = iter.m_depth;
 		}
 
 		return *this;
@@ -218,7 +314,7 @@ namespace XMLB { namespace detail {
 	inline Node_const_iterator<T>::Node_const_iterator(
 		Node_const_iterator&& iter) noexcept
 		:m_ptr{ std::move(iter.m_ptr) },
-		m_offset{ std::move(iter.m_offset) }
+		m_depth{ std::move(iter.m_depth) }
 	{
 
 	}
@@ -278,35 +374,8 @@ namespace XMLB { namespace detail {
 	template<typename T>
 	inline Node_const_iterator<T>& Node_const_iterator<T>::operator++()
 	{
-		//Если текущий узел является родителем следующего. Прибавляем
-		//единицу к значению таба(оступа)
-		if (m_ptr == m_ptr->next->parent)
-		{
-			++m_offset;
-		}
-		//Если родитель текущего узла не равен родителю следующего - значит
-		//текущий узел является последним дочерним узлом родителя. Нужно
-		//отнять N-ое количество табов(оступов)
-		else if (m_ptr->parent != m_ptr->next->parent)
-		{
-			//Временные переменные для удобства
-			auto current_parent = m_ptr->parent;
-			auto next_parent = m_ptr->next->parent;
-
-			//Повторяем цикл до тех пор, пока временный temp_ptr не будет
-			//указывать на родителя следующего узла.
-			while (current_parent->parent && current_parent != next_parent)
-			{
-				current_parent = current_parent->parent;
-
-				if (m_offset > 0)
-				{
-					--m_offset;
-				}
-			}
-		}
-
 		m_ptr = m_ptr->next;
+		m_depth += m_ptr->step;
 
 		return *this;
 	}
@@ -328,34 +397,7 @@ namespace XMLB { namespace detail {
 	template<typename T>
 	inline Node_const_iterator<T>& Node_const_iterator<T>::operator--()
 	{
-		if (m_ptr->parent == m_ptr->prev)
-		{
-			if (m_offset > 0)
-			{
-				--m_offset;
-			}
-		}
-		else if (m_ptr->prev->parent != m_ptr->parent)
-		{
-			//Временные переменные для удобства
-			auto current_parent = m_ptr->prev->parent;
-			auto prev_parent = m_ptr->parent;
-
-			if (m_offset > 0)
-			{
-				--m_offset;
-			}
-
-			//Повторяем цикл до тех пор, пока временный temp_ptr не будет
-			//указывать на родителя следующего узла.
-			while (current_parent->parent && current_parent != prev_parent)
-			{
-				current_parent = current_parent->parent;
-
-				++m_offset;
-			}
-		}
-
+		m_depth -= m_ptr->step;
 		m_ptr = m_ptr->prev;
 
 		return *this;
@@ -378,7 +420,7 @@ namespace XMLB { namespace detail {
 	template<typename T>
 	inline unsigned Node_const_iterator<T>::get_offset() const noexcept
 	{
-		return m_offset;
+		return m_depth > 0 ? static_cast<unsigned int>(m_depth) : 0;
 	}
 
 	//*************************************************************************
@@ -390,7 +432,7 @@ namespace XMLB { namespace detail {
 		using std::swap;
 
 		swap(m_ptr, iter.m_ptr);
-		swap(m_offset, iter.m_offset);
+		swap(m_depth, iter.m_depth);
 	}
 
 	//*************************************************************************
@@ -400,23 +442,24 @@ namespace XMLB { namespace detail {
 		Node_const_iterator seq_start) const noexcept
 	{
 		//Суть функции заключается в том, что она поднимается по родителям
-		//указателя в текущем итераторе и сравнивает родителя начала в
-		//переданном итераторе начала последовательности
+		//указателя в текущем итераторе и сравнивает их с родителем начала
+		//последовательности
 
 		bool result = false;
 
 		if (seq_start.m_ptr && seq_start.m_ptr->parent && m_ptr)
 		{
-			auto current_parent = m_ptr->parent;
+			auto seq_parent = seq_start.m_ptr->parent;
 
-			while (current_parent)
+			for (auto current_parent = m_ptr->parent; current_parent; 
+				current_parent = current_parent->parent)
 			{
-				if (current_parent == seq_start.m_ptr->parent)
+				if (current_parent == seq_parent)
 				{
 					result = true;
-				}
 
-				current_parent = current_parent->parent;
+					break;
+				}
 			}
 		}
 
@@ -495,6 +538,130 @@ namespace XMLB { namespace detail {
 
 
 
+	//*************************************************************************
+	//				NODE_PREORDER_CONST_ITERATOR IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename T>
+	inline Node_preorder_const_iterator<T>::Node_preorder_const_iterator(
+		detail::Node_tree<T>* ptr) noexcept
+		:m_ptr{ ptr }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline bool Node_preorder_const_iterator<T>::operator==(
+		const Node_preorder_const_iterator& iter) const noexcept
+	{
+		return m_ptr == iter.m_ptr;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline bool Node_preorder_const_iterator<T>::operator!=(
+		const Node_preorder_const_iterator& iter) const noexcept
+	{
+		return !(*this == iter);
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline typename Node_preorder_const_iterator<T>::reference
+		Node_preorder_const_iterator<T>::operator*() const
+	{
+		return *m_ptr->element;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline typename Node_preorder_const_iterator<T>::pointer
+		Node_preorder_const_iterator<T>::operator->() const
+	{
+		return m_ptr->element;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline Node_preorder_const_iterator<T>& 
+		Node_preorder_const_iterator<T>::operator++() noexcept
+	{
+		m_ptr = m_ptr->next;
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline Node_preorder_const_iterator<T> 
+		Node_preorder_const_iterator<T>::operator++(int) noexcept
+	{
+		Node_preorder_const_iterator<T> temp_iterator{ *this };
+
+		m_ptr = m_ptr->next;
+
+		return temp_iterator;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//					NODE_PREORDER_ITERATOR IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename T>
+	inline typename Node_preorder_iterator<T>::reference 
+		Node_preorder_iterator<T>::operator*() const
+	{
+		return *this->m_ptr->element;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline typename Node_preorder_iterator<T>::pointer 
+		Node_preorder_iterator<T>::operator->() const
+	{
+		return this->m_ptr->element;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline Node_preorder_iterator<T>& Node_preorder_iterator<T>::operator++() 
+		noexcept
+	{
+		base::operator++();
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename T>
+	inline Node_preorder_iterator<T> Node_preorder_iterator<T>::operator++(int)
+		noexcept
+	{
+		Node_preorder_iterator<T> temp_iterator{ *this };
+
+		base::operator++();
+
+		return temp_iterator;
+	}
+
+	//*************************************************************************
+
+
+
 	//*************************************************************************
 	//					NODE_CONST_ITERATOR SUPPORT FUNCTIONS
 	//*************************************************************************
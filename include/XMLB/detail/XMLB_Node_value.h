@@ -0,0 +1,725 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+
+#ifndef XMLB_NODE_VALUE_H
+#define XMLB_NODE_VALUE_H
+
+#include <atomic>
+#include <limits>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <utility>
+#include <string_view>
+#include <type_traits>
+
+#include "XMLB/XMLB_Number_conversion.h"
+#include "XMLB/detail/XMLB_fwd.h"
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Значение XML узла: текст или число
+	* 
+	* @ingroup secondary
+	*
+	* @details Число, заданное через assign_number(), хранится как int64, 
+	* double или bool и не переводится в текст, пока текст не попросят. 
+	* save_to() записывает такое число прямо в приёмник, без строки. Числа, 
+	* у которых нет точного представления в этих типах(float, long double,
+	* большие unsigned), сразу записываются текстом.
+	*
+	* Текстовое значение разбирается при первом чтении числа, и результат
+	* запоминается. Чтение текста числа и запоминание разобранного числа 
+	* идут из const методов, поэтому они защищены атомарным состоянием: 
+	* одновременное чтение одного значения разными потоками безопасно.
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	class Node_value final
+	{
+	public:
+		using symbol_type = CharT;
+		using string_type = std::basic_string<symbol_type>;
+		using string_wrapper = std::basic_string_view<symbol_type>;
+		using size_type = std::size_t;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		Node_value() noexcept;
+		explicit Node_value(const string_type& text);
+		explicit Node_value(string_type&& text) noexcept;
+
+		Node_value(const Node_value& value);
+		Node_value& operator=(const Node_value& value);
+
+		Node_value(Node_value&& value) noexcept;
+		Node_value& operator=(Node_value&& value) noexcept;
+		/// @}
+
+
+
+		/// @name Методы изменения
+		/// @{
+		/**********************************************************************
+		* @brief Заменить значение текстом
+		*
+		* @param text - текст
+		**********************************************************************/
+		void assign(const string_type& text);
+		void assign(string_type&& text) noexcept;
+
+		/**********************************************************************
+		* @brief Заменить значение числом, без перевода в текст
+		*
+		* @tparam T - целый тип, тип с плавающей точкой или bool
+		* @param value - число
+		**********************************************************************/
+		template<typename T>
+		void assign_number(T value);
+
+		void swap(Node_value& value) noexcept;
+		/// @}
+
+
+
+		/// @name Методы чтения
+		/// @{
+		/**********************************************************************
+		* @return текст значения. Число переводится в текст при первом 
+		* вызове, без выделения памяти
+		**********************************************************************/
+		string_wrapper get_text() const noexcept;
+
+		/**********************************************************************
+		* @brief Получить значение в виде числа
+		*
+		* @param value - результат. Не меняется, если значение не является
+		* числом типа T
+		*
+		* @return true - если значение является числом типа T
+		**********************************************************************/
+		template<typename T>
+		bool get_number(T& value) const noexcept;
+
+		/**********************************************************************
+		* @brief Записать текст значения в приёмник. Число записывается сразу
+		* в приёмник и в тексте значения не запоминается
+		*
+		* @param sink - приёмник
+		**********************************************************************/
+		template<typename SinkT>
+		void write(SinkT& sink) const;
+
+		/**********************************************************************
+		* @return количество символов текста значения
+		**********************************************************************/
+		size_type size() const noexcept;
+
+		/**********************************************************************
+		* @return true - если текст значения пустой
+		**********************************************************************/
+		bool empty() const noexcept;
+		/// @}
+
+	private:
+		/// Биты состояния значения
+		enum State : unsigned char
+		{
+			kNo_payload = 0,		///<Числа нет
+			kInteger = 1,			///<Число int64
+			kReal = 2,				///<Число double
+			kBoolean = 3,			///<Значение bool
+			kPayload_mask = 3,		///<Маска типа числа
+
+			kTyped = 4,				///<Число задано через assign_number()
+			kStale = 8,				///<Текст ещё не получен из числа
+			kBusy = 16				///<Другой поток пишет текст или число
+		};
+
+		/// Число значения
+		union Payload
+		{
+			std::int64_t integer;
+			double real;
+			bool boolean;
+		};
+
+		/// Символов хватает на запись любого int64, double и bool
+		static constexpr size_type kMax_payload_size = 32;
+
+		unsigned char wait_state() const noexcept;
+		void update_text() const noexcept;
+
+		template<typename T>
+		bool get_payload(unsigned char state, T& value) const noexcept;
+
+		template<typename T>
+		void cache_payload(unsigned char state, T value) const noexcept;
+
+		size_type format_payload(unsigned char state, char* buffer) 
+			const noexcept;
+
+		void reserve_text();
+
+	private:
+		mutable string_type m_text;
+		mutable Payload m_payload;
+		mutable std::atomic<unsigned char> m_state;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Доступ функций сохранения к значению XML узла без перевода 
+	* числа в текст
+	**************************************************************************/
+	template<typename CharT>
+	class Value_access final
+	{
+	public:
+		static const Node_value<CharT>& get(const Node<CharT>& node) 
+			noexcept;
+	};
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							NODE_VALUE IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>::Node_value() noexcept
+		:m_text{},
+		m_payload{},
+		m_state{ kNo_payload }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>::Node_value(const string_type& text)
+		:m_text{ text },
+		m_payload{},
+		m_state{ kNo_payload }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>::Node_value(string_type&& text) noexcept
+		:m_text{ std::move(text) },
+		m_payload{},
+		m_state{ kNo_payload }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>::Node_value(const Node_value& value)
+		:m_text{},
+		m_payload{},
+		m_state{ kNo_payload }
+	{
+		const unsigned char state = value.wait_state();
+
+		//Число копируется, пока у него нет текста - копия переведёт его в
+		//текст сама, когда понадобится
+		if (state & kPayload_mask)
+		{
+			m_payload = value.m_payload;
+		}
+
+		if (state & kStale)
+		{
+			m_text.reserve(kMax_payload_size);
+		}
+		else
+		{
+			m_text = value.m_text;
+		}
+
+		m_state.store(state, std::memory_order_relaxed);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>& Node_value<CharT>::operator=(
+		const Node_value& value)
+	{
+		if (this != &value)
+		{
+			Node_value{ value }.swap(*this);
+		}
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>::Node_value(Node_value&& value) noexcept
+		:m_text{ std::move(value.m_text) },
+		m_payload{ value.m_payload },
+		m_state{ value.m_state.load(std::memory_order_relaxed) }
+	{
+		value.m_state.store(kNo_payload, std::memory_order_relaxed);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline Node_value<CharT>& Node_value<CharT>::operator=(
+		Node_value&& value) noexcept
+	{
+		if (this != &value)
+		{
+			m_text = std::move(value.m_text);
+			m_payload = value.m_payload;
+
+			m_state.store(value.m_state.load(std::memory_order_relaxed),
+				std::memory_order_relaxed);
+
+			value.m_state.store(kNo_payload, std::memory_order_relaxed);
+		}
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node_value<CharT>::assign(const string_type& text)
+	{
+		m_text = text;
+		m_state.store(kNo_payload, std::memory_order_relaxed);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node_value<CharT>::assign(string_type&& text) noexcept
+	{
+		m_text = std::move(text);
+		m_state.store(kNo_payload, std::memory_order_relaxed);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline void Node_value<CharT>::assign_number(T value)
+	{
+		static_assert(is_number_v<T>, "T must be a number type");
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			reserve_text();
+
+			m_payload.boolean = value;
+			m_state.store(kBoolean | kTyped | kStale, 
+				std::memory_order_relaxed);
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			if (std::is_signed_v<T> || static_cast<std::uint64_t>(value) <=
+				static_cast<std::uint64_t>(
+					std::numeric_limits<std::int64_t>::max()))
+			{
+				reserve_text();
+
+				m_payload.integer = static_cast<std::int64_t>(value);
+				m_state.store(kInteger | kTyped | kStale, 
+					std::memory_order_relaxed);
+			}
+			else
+			{
+				assign(format_number<symbol_type>(value));
+			}
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			reserve_text();
+
+			m_payload.real = value;
+			m_state.store(kReal | kTyped | kStale, 
+				std::memory_order_relaxed);
+		}
+		else
+		{
+			//Кратчайшая запись float и long double отличается от записи 
+			//того же числа в double
+			assign(format_number<symbol_type>(value));
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node_value<CharT>::swap(Node_value& value) noexcept
+	{
+		using std::swap;
+
+		swap(m_text, value.m_text);
+		swap(m_payload, value.m_payload);
+
+		const unsigned char state = m_state.load(std::memory_order_relaxed);
+
+		m_state.store(value.m_state.load(std::memory_order_relaxed),
+			std::memory_order_relaxed);
+		value.m_state.store(state, std::memory_order_relaxed);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node_value<CharT>::string_wrapper 
+		Node_value<CharT>::get_text() const noexcept
+	{
+		if (m_state.load(std::memory_order_acquire) & kStale)
+		{
+			update_text();
+		}
+
+		return string_wrapper{ m_text };
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline bool Node_value<CharT>::get_number(T& value) const noexcept
+	{
+		static_assert(is_number_v<T>, "T must be a number type");
+
+		const unsigned char state = wait_state();
+
+		if (get_payload(state, value))
+		{
+			return true;
+		}
+
+		T result{};
+
+		if (!parse_number(get_text(), result))
+		{
+			return false;
+		}
+
+		if (!(state & kPayload_mask))
+		{
+			cache_payload(state, result);
+		}
+
+		value = result;
+
+		return true;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename SinkT>
+	inline void Node_value<CharT>::write(SinkT& sink) const
+	{
+		const unsigned char state = wait_state();
+
+		if (!(state & kStale))
+		{
+			sink.append(m_text.data(), m_text.size());
+
+			return;
+		}
+
+		switch (state & kPayload_mask)
+		{
+		case kInteger: write_number<symbol_type>(sink, m_payload.integer); 
+			break;
+		case kReal: write_number<symbol_type>(sink, m_payload.real); 
+			break;
+		default: write_number<symbol_type>(sink, m_payload.boolean); 
+			break;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node_value<CharT>::size_type Node_value<CharT>::size() 
+		const noexcept
+	{
+		const unsigned char state = wait_state();
+
+		if (!(state & kStale))
+		{
+			return m_text.size();
+		}
+
+		char buffer[kMax_payload_size];
+
+		return format_payload(state, buffer);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline bool Node_value<CharT>::empty() const noexcept
+	{
+		//Запись числа никогда не бывает пустой
+		const unsigned char state = wait_state();
+
+		return !(state & kStale) && m_text.empty();
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline unsigned char Node_value<CharT>::wait_state() const noexcept
+	{
+		unsigned char state = m_state.load(std::memory_order_acquire);
+
+		while (state & kBusy)
+		{
+			std::this_thread::yield();
+			state = m_state.load(std::memory_order_acquire);
+		}
+
+		return state;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node_value<CharT>::update_text() const noexcept
+	{
+		for (;;)
+		{
+			unsigned char state = wait_state();
+
+			if (!(state & kStale))
+			{
+				return;
+			}
+
+			if (!m_state.compare_exchange_weak(state, state | kBusy,
+				std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				continue;
+			}
+
+			char buffer[kMax_payload_size];
+			const size_type size = format_payload(state, buffer);
+
+			//Память под текст выделена в assign_number()
+			m_text.resize(size);
+
+			for (size_type i = 0; i < size; ++i)
+			{
+				m_text[i] = static_cast<symbol_type>(buffer[i]);
+			}
+
+			m_state.store(state & ~kStale, std::memory_order_release);
+
+			return;
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline bool Node_value<CharT>::get_payload(unsigned char state, 
+		T& value) const noexcept
+	{
+		switch (state & kPayload_mask)
+		{
+		case kInteger:
+			if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+			{
+				const std::int64_t integer = m_payload.integer;
+
+				if (integer < 0 ? std::is_unsigned_v<T> || 
+					integer < static_cast<std::int64_t>(
+						std::numeric_limits<T>::min()) :
+					static_cast<std::uint64_t>(integer) > 
+					static_cast<std::uint64_t>(
+						std::numeric_limits<T>::max()))
+				{
+					return false;
+				}
+
+				value = static_cast<T>(integer);
+
+				return true;
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				//Разобранный текст может быть записан иначе, например -0
+				if (state & kTyped)
+				{
+					value = static_cast<T>(m_payload.integer);
+
+					return true;
+				}
+			}
+			break;
+
+		case kReal:
+			if constexpr (std::is_same_v<T, double>)
+			{
+				value = m_payload.real;
+
+				return true;
+			}
+			break;
+
+		case kBoolean:
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				value = m_payload.boolean;
+
+				return true;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		//Текст числа, заданного через assign_number(), разбирается как есть
+		return false;
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	template<typename T>
+	inline void Node_value<CharT>::cache_payload(unsigned char state, 
+		T value) const noexcept
+	{
+		unsigned char kind = kNo_payload;
+		Payload payload{};
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			kind = kBoolean;
+			payload.boolean = value;
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			if (std::is_signed_v<T> || static_cast<std::uint64_t>(value) <=
+				static_cast<std::uint64_t>(
+					std::numeric_limits<std::int64_t>::max()))
+			{
+				kind = kInteger;
+				payload.integer = static_cast<std::int64_t>(value);
+			}
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			kind = kReal;
+			payload.real = value;
+		}
+
+		//Если значение уже занято другим потоком, число просто не
+		//запоминается
+		if (kind == kNo_payload || !m_state.compare_exchange_strong(state,
+			state | kBusy, std::memory_order_acquire, 
+			std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		m_payload = payload;
+		m_state.store(state | kind, std::memory_order_release);
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline typename Node_value<CharT>::size_type 
+		Node_value<CharT>::format_payload(unsigned char state, char* buffer)
+		const noexcept
+	{
+		switch (state & kPayload_mask)
+		{
+		case kInteger:
+			return format_number_chars(buffer, m_payload.integer);
+		case kReal:
+			return format_number_chars(buffer, m_payload.real);
+		default:
+			return format_number_chars(buffer, m_payload.boolean);
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename CharT>
+	inline void Node_value<CharT>::reserve_text()
+	{
+		//Текст из числа потом записывается в const методе, который не 
+		//может выделять память
+		m_text.clear();
+		m_text.reserve(kMax_payload_size);
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//							VALUE_ACCESS IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT>
+	inline const Node_value<CharT>& Value_access<CharT>::get(
+		const Node<CharT>& node) noexcept
+	{
+		return node.m_value;
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_NODE_VALUE_H
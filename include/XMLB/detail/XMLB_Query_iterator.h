@@ -0,0 +1,538 @@
+//*****************************************************************************
+// MIT License
+//
+// Copyright(c) 2022 Vladislav Kurmanenko (Bruvamasc)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//*****************************************************************************
+
+
+
+#ifndef XMLB_QUERY_ITERATOR_H
+#define XMLB_QUERY_ITERATOR_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+
+
+namespace XMLB { namespace detail {
+
+	/**************************************************************************
+	* @brief Условие в квадратных скобках шага запроса
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	struct Query_predicate final
+	{
+		using string_type = std::basic_string<CharT>;
+
+		enum class Kind
+		{
+			attribute_exists,		///<[@name]
+			attribute_equals,		///<[@name='value']
+			position				///<[N]
+		};
+
+		Kind kind;						///<Вид условия
+		string_type attribute_name;		///<Имя атрибута
+		string_type attribute_value;	///<Значение атрибута
+		std::size_t position;			///<Позиция, начиная с 1
+		std::size_t counter;			///<Номер счётчика позиции
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Шаг запроса: ось, проверка имени и условия
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	struct Query_step final
+	{
+		using string_type = std::basic_string<CharT>;
+
+		string_type name;		///<Имя узла
+		bool is_any_name;		///<Подходит любое имя(*)
+		bool is_descendant;		///<Ось потомков(//), иначе ось детей(/)
+		std::vector<Query_predicate<CharT>> predicates;	///<Условия шага
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Скомпилированный запрос
+	*
+	* @tparam CharT - тип символов
+	**************************************************************************/
+	template<typename CharT>
+	struct Query_program final
+	{
+		std::vector<Query_step<CharT>> steps;	///<Шаги запроса
+		std::size_t counter_count = 0;			///<Количество счётчиков позиции
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Итератор результатов запроса
+	*
+	* @details Обходит дерево в порядке документа один раз. Для каждого узла
+	* хранится множество шагов, которым могут соответствовать его дочерние
+	* узлы. Если множество пустое, поддерево узла пропускается, поэтому 
+	* запрос только из шагов по оси детей обходит лишь подходящие ветки.
+	* Узлы выдаются в порядке документа и без повторов.
+	*
+	* @tparam NodeT - тип узла(Node<CharT> или const Node<CharT>)
+	**************************************************************************/
+	template<typename NodeT>
+	class Query_iterator final
+	{
+	public:
+		using symbol_type = typename std::remove_const_t<NodeT>::symbol_type;
+		using program_type = Query_program<symbol_type>;
+		using step_type = Query_step<symbol_type>;
+		using predicate_type = Query_predicate<symbol_type>;
+
+		using value_type = NodeT;
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using reference = value_type&;
+		using pointer = value_type*;
+
+
+
+		/// @name Конструкторы, деструктор
+		/// @{
+		Query_iterator() = default;
+
+		/**********************************************************************
+		* @param program - скомпилированный запрос
+		* @param node - узел, дочерние узлы которого проверяются первым шагом
+		**********************************************************************/
+		Query_iterator(std::shared_ptr<const program_type> program, 
+			NodeT& node);
+		/// @}
+
+
+
+		/// @name Операторы сравнения
+		/// @{
+		bool operator==(const Query_iterator& iter) const noexcept;
+		bool operator!=(const Query_iterator& iter) const noexcept;
+		/// @}
+
+
+
+		/// @name Методы доступа
+		/// @{
+		reference operator*() const;
+		pointer operator->() const;
+
+		Query_iterator& operator++();
+		Query_iterator operator++(int);
+		/// @}
+
+	private:
+		using child_iterator = 
+			decltype(std::declval<NodeT&>().first_level_begin());
+
+		struct Frame
+		{
+			child_iterator current;
+			child_iterator last;
+			std::uint64_t states;
+		};
+
+		void push_frame(NodeT& node, std::uint64_t states);
+		void advance();
+		bool is_match(const step_type& step, const NodeT& node, 
+			std::size_t* counters) const;
+
+	private:
+		std::shared_ptr<const program_type> m_program;
+		std::vector<Frame> m_frames;
+		std::vector<std::size_t> m_counters;
+		NodeT* m_current = nullptr;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Ленивый диапазон результатов запроса
+	*
+	* @tparam NodeT - тип узла(Node<CharT> или const Node<CharT>)
+	**************************************************************************/
+	template<typename NodeT>
+	class Query_range final
+	{
+	public:
+		using iterator = Query_iterator<NodeT>;
+		using program_type = typename iterator::program_type;
+
+		Query_range(std::shared_ptr<const program_type> program, 
+			NodeT* node) noexcept;
+
+		iterator begin() const;
+		iterator end() const noexcept;
+
+	private:
+		std::shared_ptr<const program_type> m_program;
+		NodeT* m_node;
+	};
+
+	//*************************************************************************
+
+
+
+	/**************************************************************************
+	* @brief Собрать запрос из шагов по оси потомков
+	*
+	* @details Каждое имя ищется среди потомков узла, найденного по
+	* предыдущему имени, так же как в Node::find() со списком имён
+	*
+	* @tparam CharT - тип символов
+	* @tparam IterT - тип итератора на имена
+	* @param first - итератор на первое имя
+	* @param last - итератор на конец имён
+	*
+	* @return скомпилированный запрос, или nullptr - если имён нет
+	**************************************************************************/
+	template<typename CharT, typename IterT>
+	std::shared_ptr<const Query_program<CharT>> make_path_program(
+		IterT first, IterT last);
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						QUERY_ITERATOR IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Query_iterator<NodeT>::Query_iterator(
+		std::shared_ptr<const program_type> program, NodeT& node)
+		:m_program{ std::move(program) }
+	{
+		push_frame(node, 1);
+
+		advance();
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Query_iterator<NodeT>::operator==(
+		const Query_iterator& iter) const noexcept
+	{
+		return m_current == iter.m_current;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Query_iterator<NodeT>::operator!=(
+		const Query_iterator& iter) const noexcept
+	{
+		return !(*this == iter);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Query_iterator<NodeT>::reference 
+		Query_iterator<NodeT>::operator*() const
+	{
+		return *m_current;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Query_iterator<NodeT>::pointer 
+		Query_iterator<NodeT>::operator->() const
+	{
+		return m_current;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Query_iterator<NodeT>& Query_iterator<NodeT>::operator++()
+	{
+		advance();
+
+		return *this;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Query_iterator<NodeT> Query_iterator<NodeT>::operator++(int)
+	{
+		Query_iterator<NodeT> temp_iterator{ *this };
+
+		advance();
+
+		return temp_iterator;
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Query_iterator<NodeT>::push_frame(NodeT& node, 
+		std::uint64_t states)
+	{
+		m_frames.push_back(Frame{ node.first_level_begin(), 
+			node.first_level_end(), states });
+
+		//Счётчики позиций считают узлы среди детей одного родителя,
+		//поэтому у каждого уровня обхода они свои
+		m_counters.resize(m_frames.size() * m_program->counter_count, 0);
+
+		std::fill(m_counters.end() - m_program->counter_count, 
+			m_counters.end(), 0);
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline void Query_iterator<NodeT>::advance()
+	{
+		const auto& steps = m_program->steps;
+		const std::size_t last_step = steps.size() - 1;
+
+		m_current = nullptr;
+
+		while (m_frames.size())
+		{
+			Frame& frame = m_frames.back();
+
+			if (frame.current == frame.last)
+			{
+				m_frames.pop_back();
+				m_counters.resize(
+					m_frames.size() * m_program->counter_count);
+
+				continue;
+			}
+
+			NodeT& node = **frame.current;
+			++frame.current;
+
+			std::size_t* counters = m_counters.data() +
+				(m_frames.size() - 1) * m_program->counter_count;
+
+			std::uint64_t states = 0;
+			bool is_result = false;
+
+			for (std::size_t i = 0; i <= last_step; ++i)
+			{
+				if (!(frame.states & (std::uint64_t{ 1 } << i)))
+				{
+					continue;
+				}
+
+				//Шаг по оси потомков может подойти и к более глубоким
+				//узлам
+				if (steps[i].is_descendant)
+				{
+					states |= std::uint64_t{ 1 } << i;
+				}
+
+				if (is_match(steps[i], node, counters))
+				{
+					if (i == last_step)
+					{
+						is_result = true;
+					}
+					else
+					{
+						states |= std::uint64_t{ 1 } << (i + 1);
+					}
+				}
+			}
+
+			if (states && node.child_size())
+			{
+				push_frame(node, states);
+			}
+
+			if (is_result)
+			{
+				m_current = &node;
+
+				return;
+			}
+		}
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline bool Query_iterator<NodeT>::is_match(const step_type& step, 
+		const NodeT& node, std::size_t* counters) const
+	{
+		if (!step.is_any_name && node.get_name() != step.name)
+		{
+			return false;
+		}
+
+		for (auto&& predicate : step.predicates)
+		{
+			switch (predicate.kind)
+			{
+			case predicate_type::Kind::attribute_exists:
+			{
+				if (node.find_attribute(predicate.attribute_name) ==
+					node.attr_cend())
+				{
+					return false;
+				}
+
+				break;
+			}
+			case predicate_type::Kind::attribute_equals:
+			{
+				auto attribute = 
+					node.find_attribute(predicate.attribute_name);
+
+				if (attribute == node.attr_cend() ||
+					attribute->value != predicate.attribute_value)
+				{
+					return false;
+				}
+
+				break;
+			}
+			case predicate_type::Kind::position:
+			{
+				if (++counters[predicate.counter] != predicate.position)
+				{
+					return false;
+				}
+
+				break;
+			}
+			}
+		}
+
+		return true;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//					MAKE_PATH_PROGRAM IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename CharT, typename IterT>
+	inline std::shared_ptr<const Query_program<CharT>> make_path_program(
+		IterT first, IterT last)
+	{
+		using string_wrapper = std::basic_string_view<CharT>;
+
+		if (first == last)
+		{
+			return nullptr;
+		}
+
+		auto program = std::make_shared<Query_program<CharT>>();
+
+		for (; first != last; ++first)
+		{
+			program->steps.push_back(Query_step<CharT>{ 
+				std::basic_string<CharT>{ string_wrapper{ *first } }, 
+				false, true, {} });
+		}
+
+		if (program->steps.size() > 64)
+		{
+			throw std::invalid_argument{ "The path has more than 64 names!" };
+		}
+
+		return program;
+	}
+
+	//*************************************************************************
+
+
+
+	//*************************************************************************
+	//						QUERY_RANGE IMPLEMENTATION
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline Query_range<NodeT>::Query_range(
+		std::shared_ptr<const program_type> program, NodeT* node) 
+		noexcept
+		:m_program{ std::move(program) },
+		m_node{ node }
+	{
+
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Query_range<NodeT>::iterator 
+		Query_range<NodeT>::begin() const
+	{
+		if (!m_node || !m_program)
+		{
+			return iterator{};
+		}
+
+		return iterator{ m_program, *m_node };
+	}
+
+	//*************************************************************************
+
+	template<typename NodeT>
+	inline typename Query_range<NodeT>::iterator 
+		Query_range<NodeT>::end() const noexcept
+	{
+		return iterator{};
+	}
+
+	//*************************************************************************
+
+}} // namespace XMLB::detail
+
+#endif // !XMLB_QUERY_ITERATOR_H
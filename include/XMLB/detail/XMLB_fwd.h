@@ -39,11 +39,29 @@ namespace XMLB
 		template<typename T>
 		class Node_iterator;
 
+		template<typename T>
+		class Node_preorder_const_iterator;
+
+		template<typename T>
+		class Node_preorder_iterator;
+
 		template<typename IterT>
 		class Diagnostic_iterator;
 
 		template<typename CharT>
 		struct Decorator;
+
+		template<typename CharT>
+		class Retained_source;
+
+		template<typename CharT>
+		class Source_access;
+
+		template<typename CharT>
+		class Node_value;
+
+		template<typename CharT>
+		class Value_access;
 	}
 
 	template<typename CharT>
@@ -55,6 +73,27 @@ namespace XMLB
 	template<typename CharT>
 	struct Node_attribute;
 
+	template<typename CharT>
+	class Query;
+
+	template<typename CharT>
+	class Frozen_document;
+
+	template<typename CharT>
+	class Document_holder;
+
+	template<typename CharT>
+	class Buffer_sink;
+
+	template<typename CharT>
+	class Fixed_sink;
+
+	template<typename CharT>
+	class Fd_sink;
+
+	template<typename CharT, typename SinkT, typename FormatT, typename DecorT>
+	class Xml_writer;
+
 
 
 	using u8Node_attribute = Node_attribute<char>;
@@ -78,6 +117,48 @@ namespace XMLB
 
 
 
+	using u8Query = Query<char>;
+	using u16Query = Query<char16_t>;
+	using u32Query = Query<char32_t>;
+	using wQuery = Query<wchar_t>;
+
+
+
+	using u8Frozen_document = Frozen_document<char>;
+	using u16Frozen_document = Frozen_document<char16_t>;
+	using u32Frozen_document = Frozen_document<char32_t>;
+	using wFrozen_document = Frozen_document<wchar_t>;
+
+
+
+	using u8Document_holder = Document_holder<char>;
+	using u16Document_holder = Document_holder<char16_t>;
+	using u32Document_holder = Document_holder<char32_t>;
+	using wDocument_holder = Document_holder<wchar_t>;
+
+
+
+	using u8Buffer_sink = Buffer_sink<char>;
+	using u16Buffer_sink = Buffer_sink<char16_t>;
+	using u32Buffer_sink = Buffer_sink<char32_t>;
+	using wBuffer_sink = Buffer_sink<wchar_t>;
+
+
+
+	using u8Fixed_sink = Fixed_sink<char>;
+	using u16Fixed_sink = Fixed_sink<char16_t>;
+	using u32Fixed_sink = Fixed_sink<char32_t>;
+	using wFixed_sink = Fixed_sink<wchar_t>;
+
+
+
+	using u8Fd_sink = Fd_sink<char>;
+	using u16Fd_sink = Fd_sink<char16_t>;
+	using u32Fd_sink = Fd_sink<char32_t>;
+	using wFd_sink = Fd_sink<wchar_t>;
+
+
+
 	using u8Node_iterator = detail::Node_iterator<char>;
 	using u16Node_iterator = detail::Node_iterator<char16_t>;
 	using u32Node_iterator = detail::Node_iterator<char32_t>;
@@ -92,6 +173,27 @@ namespace XMLB
 
 
 
+	using u8Node_preorder_iterator = detail::Node_preorder_iterator<u8Node>;
+	using u16Node_preorder_iterator = detail::Node_preorder_iterator<u16Node>;
+	using u32Node_preorder_iterator = detail::Node_preorder_iterator<u32Node>;
+	using wNode_preorder_iterator = detail::Node_preorder_iterator<wNode>;
+
+
+
+	using u8Node_preorder_const_iterator = 
+		detail::Node_preorder_const_iterator<u8Node>;
+
+	using u16Node_preorder_const_iterator = 
+		detail::Node_preorder_const_iterator<u16Node>;
+
+	using u32Node_preorder_const_iterator = 
+		detail::Node_preorder_const_iterator<u32Node>;
+
+	using wNode_preorder_const_iterator = 
+		detail::Node_preorder_const_iterator<wNode>;
+
+
+
 	using u8Decorator = detail::Decorator<char>;
 	using u16Decorator = detail::Decorator<char16_t>;
 	using u32Decorator = detail::Decorator<char32_t>;
@@ -175,6 +175,39 @@ namespace XMLB { namespace detail {
 
 	//#########################################################################
 
+	template<typename, typename = void>
+	struct is_has_flush : std::false_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename T>
+	struct is_has_flush<T,
+		std::void_t<decltype(std::declval<T&>().flush())>> : std::true_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename T>
+	inline constexpr bool is_has_flush_v = is_has_flush<T>::value;
+
+	//#########################################################################
+
+	template<typename, typename = void>
+	struct is_has_copy_from : std::false_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename T>
+	struct is_has_copy_from<T,
+		std::void_t<decltype(std::declval<T&>().copy_from(
+		0, std::size_t{}, std::size_t{}))>> : std::true_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename T>
+	inline constexpr bool is_has_copy_from_v = is_has_copy_from<T>::value;
+
+	//#########################################################################
+
 }} // namespace XMLB::detail
 
 #endif // !XMLB_TYPE_METHODS_TRAITS_H
\ No newline at end of file
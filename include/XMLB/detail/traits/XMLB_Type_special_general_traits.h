@@ -586,6 +586,33 @@ namespace XMLB { namespace detail {
 
 	//#########################################################################
 
+	template<typename, typename, typename = void>
+	struct is_sink_to_symbol : std::false_type {};
+
+	//-------------------------------------------------------------------------
+
+	template<typename SinkT, typename SymbolT>
+	struct is_sink_to_symbol<SinkT, SymbolT,
+		std::enable_if_t<
+
+		std::is_same_v<symbol_type_t<SinkT>, SymbolT>,
+
+		std::void_t<
+		decltype(std::declval<SinkT&>().append(std::declval<SymbolT>())),
+		decltype(std::declval<SinkT&>().append(
+			std::declval<SymbolT>(), std::size_t{})),
+		decltype(std::declval<SinkT&>().append(
+			std::declval<const SymbolT*>(), std::size_t{}))>>
+		> : std::true_type{};
+
+	//-------------------------------------------------------------------------
+
+	template<typename SinkT, typename SymbolT>
+	inline constexpr bool is_sink_to_symbol_v = 
+		is_sink_to_symbol<SinkT, SymbolT>::value;
+
+	//#########################################################################
+
 }} // namespace XMLB::detail
 
 #endif // !XMLB_TYPE_SPECIAL_GENERAL_TRAITS_H
\ No newline at end of file
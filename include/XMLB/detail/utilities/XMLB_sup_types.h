@@ -27,6 +27,7 @@
 #ifndef XMLB_SUP_TYPES_H
 #define XMLB_SUP_TYPES_H
 
+#include <cstddef>
 
 
 namespace XMLB { namespace detail {
@@ -61,6 +62,11 @@ namespace XMLB { namespace detail {
 	//*************************************************************************
 	// @brief Вспомагательная структура, для "дерева" XML узлов.
 	// Является деталью реализации!
+	//
+	// Глубина хранится относительно соседей по обходу: step - разница
+	// глубины узла и предыдущего узла обхода, last_depth - разница глубины
+	// последнего узла поддерева и самого узла. Поэтому перенос поддерева 
+	// меняет только узлы на его концах, а не всё поддерево
 	template<typename T>
 	struct Node_tree final
 	{
@@ -68,6 +74,10 @@ namespace XMLB { namespace detail {
 		Node_tree<T>* parent = nullptr;		//Указатель на родителя узала
 		Node_tree<T>* next = nullptr;		//Указатель на следующий узел
 		Node_tree<T>* prev = nullptr;		//Указатель на предыдущий узел
+		int step = 0;						//Глубина от предыдущего узла
+		std::size_t order = 0;				//Номер узла в порядке документа
+		Node_tree<T>* last = nullptr;		//Последний узел поддерева
+		unsigned int last_depth = 0;		//Глубина последнего узла
 	};
 
 	//*************************************************************************
@@ -81,6 +91,10 @@ namespace XMLB { namespace detail {
 		swap(lhs.prev, rhs.prev);
 		swap(lhs.parent, rhs.parent);
 		swap(lhs.element, rhs.element);
+		swap(lhs.step, rhs.step);
+		swap(lhs.order, rhs.order);
+		swap(lhs.last, rhs.last);
+		swap(lhs.last_depth, rhs.last_depth);
 	}
 
 	//*************************************************************************